@@ -101,6 +101,8 @@
 #define MOD_CFG_MAP_SHOW_CURS_TRACK   "CURSOR_TRACK"
 #define MOD_CFG_MAP_SHOW_GRID         "SHOW_GRID"
 #define MOD_CFG_MAP_SHOW_TERMINATOR   "SHOW_TERMINATOR"
+#define MOD_CFG_MAP_SHOW_COVERAGE     "SHOW_COVERAGE"
+#define MOD_CFG_MAP_SHOW_DAYNIGHT     "SHOW_DAYNIGHT"
 #define MOD_CFG_MAP_SAT_COL           "SAT_COLOUR"
 #define MOD_CFG_MAP_SAT_SEL_COL       "SAT_SEL_COLOUR"
 #define MOD_CFG_MAP_SAT_COV_COL       "COV_AREA_COLOUR"
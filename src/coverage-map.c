@@ -0,0 +1,424 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Coverage density map.
+ *
+ * The footprint of each satellite is rasterised into a lat/lon grid at
+ * every time step of a time window, and the number of footprints covering
+ * each cell is accumulated. Dividing a cell by the number of time steps
+ * gives the average number of satellites in view from that cell.
+ *
+ * A footprint is a spherical cap around the sub-satellite point, so in
+ * each grid row it covers a single run of columns whose half width follows
+ * from the spherical law of cosines. Rasterising is therefore one acos per
+ * row plus a contiguous increment, which the compiler vectorises.
+ *
+ * Satellites are distributed over one worker thread per CPU core. Each
+ * worker accumulates into its own grid and the grids are summed at the
+ * end, so the workers never share memory they write to.
+ *
+ * The functions do not depend on GTK and can be used for batch analysis.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <string.h>
+
+#include "coverage-map.h"
+#include "gtk-sat-data.h"
+#include "orbit-tools.h"
+#include "predict-tools.h"
+#include "sat-index.h"
+#include "sat-log.h"
+#include "time-tools.h"
+
+
+/** Shared state of the workers of one computation. */
+typedef struct {
+    coverage_map_t *cov;
+    gdouble        *row_sin;    /*!< Sine of the latitude of each row. */
+    gdouble        *row_cos;    /*!< Cosine of the latitude of each row. */
+    gint            next;       /*!< Next satellite to process (atomic). */
+} cov_job_t;
+
+/** State of a single worker. */
+typedef struct {
+    cov_job_t      *job;
+    guint32        *grid;       /*!< Private accumulation grid. */
+} cov_worker_t;
+
+
+static void free_sat(gpointer sat)
+{
+    gtk_sat_data_free_sat((sat_t *) sat);
+}
+
+/**
+ * Create a new, empty coverage map.
+ *
+ * @param nlon The number of grid columns covering 360 degrees longitude.
+ * @param nlat The number of grid rows covering 180 degrees latitude.
+ * @return The new coverage map. Free it with coverage_map_free().
+ */
+coverage_map_t *coverage_map_new(guint nlon, guint nlat)
+{
+    coverage_map_t *cov = g_new0(coverage_map_t, 1);
+
+    cov->nlon = MAX(nlon, 1);
+    cov->nlat = MAX(nlat, 1);
+    cov->counts = g_new0(guint32, cov->nlon * cov->nlat);
+    cov->sats = g_ptr_array_new_with_free_func(free_sat);
+
+    return cov;
+}
+
+void coverage_map_free(coverage_map_t * cov)
+{
+    if (cov == NULL)
+        return;
+
+    g_ptr_array_free(cov->sats, TRUE);
+    g_free(cov->counts);
+    g_free(cov);
+}
+
+/**
+ * Add a satellite to the coverage map.
+ *
+ * @param cov The coverage map.
+ * @param sat The satellite. A private copy is made so the satellite may be
+ *            modified while the coverage is computed in another thread.
+ */
+void coverage_map_add_sat(coverage_map_t * cov, const sat_t * sat)
+{
+    sat_t          *copy = g_new0(sat_t, 1);
+
+    gtk_sat_data_copy_sat(sat, copy, NULL);
+    g_ptr_array_add(cov->sats, copy);
+}
+
+static void add_sat_foreach(gpointer key, gpointer value, gpointer data)
+{
+    (void)key;
+
+    coverage_map_add_sat((coverage_map_t *) data, (const sat_t *)value);
+}
+
+/**
+ * Add all satellites of a module to the coverage map.
+ *
+ * @param cov The coverage map.
+ * @param sats Hash table with the satellites (sat_t) as values.
+ */
+void coverage_map_add_sats(coverage_map_t * cov, GHashTable * sats)
+{
+    g_hash_table_foreach(sats, add_sat_foreach, cov);
+}
+
+/** Increment a run of cells in one row, wrapping around in longitude. */
+static void add_run(guint32 * row, guint nlon, gint first, guint len)
+{
+    guint32        *p;
+    guint           start;
+    guint           n;
+    guint           i;
+
+    start = (guint) (((first % (gint) nlon) + (gint) nlon) % (gint) nlon);
+    n = MIN(len, nlon - start);
+
+    p = row + start;
+    for (i = 0; i < n; i++)
+        p[i]++;
+
+    len -= n;
+    for (i = 0; i < len; i++)
+        row[i]++;
+}
+
+/**
+ * Rasterise one footprint into a grid.
+ *
+ * @param job The computation.
+ * @param grid The grid to accumulate into.
+ * @param lat Latitude of the sub-satellite point in degrees.
+ * @param lon Longitude of the sub-satellite point in degrees.
+ * @param footprint Footprint diameter in km.
+ *
+ * A cell is covered when its centre is within the footprint.
+ */
+static void add_footprint(const cov_job_t * job, guint32 * grid,
+                          gdouble lat, gdouble lon, gdouble footprint)
+{
+    const coverage_map_t *cov = job->cov;
+    gdouble         beta = 0.5 * footprint / xkmper;
+    gdouble         bdeg = beta / de2ra;
+    gdouble         dlat = 180.0 / cov->nlat;
+    gdouble         dlon = 360.0 / cov->nlon;
+    gdouble         cosb = cos(beta);
+    gdouble         slat = sin(lat * de2ra);
+    gdouble         clat = cos(lat * de2ra);
+    gdouble         c, den, hw;
+    gint            jmin, jmax, j;
+    gint            i0, i1;
+
+    /* also rejects NaN */
+    if (!(beta > 0.0))
+        return;
+
+    jmin = (gint) ceil((90.0 - lat - bdeg) / dlat - 0.5);
+    jmax = (gint) floor((90.0 - lat + bdeg) / dlat - 0.5);
+    jmin = MAX(jmin, 0);
+    jmax = MIN(jmax, (gint) cov->nlat - 1);
+
+    for (j = jmin; j <= jmax; j++)
+    {
+        /* cos(dlon) limit for cells in this row to be inside the cap */
+        den = MAX(clat * job->row_cos[j], 1.0e-12);
+        c = (cosb - slat * job->row_sin[j]) / den;
+
+        if (c >= 1.0)
+            continue;
+
+        if (c <= -1.0)
+        {
+            add_run(grid + j * cov->nlon, cov->nlon, 0, cov->nlon);
+            continue;
+        }
+
+        hw = acos(c) / de2ra;
+        i0 = (gint) ceil((lon - hw + 180.0) / dlon - 0.5);
+        i1 = (gint) floor((lon + hw + 180.0) / dlon - 0.5);
+        if (i1 < i0)
+            continue;
+
+        add_run(grid + j * cov->nlon, cov->nlon, i0,
+                MIN((guint) (i1 - i0 + 1), cov->nlon));
+    }
+}
+
+static gpointer coverage_worker(gpointer data)
+{
+    cov_worker_t   *worker = data;
+    cov_job_t      *job = worker->job;
+    coverage_map_t *cov = job->cov;
+    qth_t           qth;
+    sat_t          *sat;
+    gdouble         t;
+    guint           k;
+    gint            i;
+
+    /* coverage does not depend on the observer */
+    memset(&qth, 0, sizeof(qth));
+
+    while ((i = g_atomic_int_add(&job->next, 1)) < (gint) cov->sats->len)
+    {
+        sat = g_ptr_array_index(cov->sats, i);
+        for (k = 0; k < cov->nsteps; k++)
+        {
+            t = cov->t0 + k * cov->step;
+            predict_calc(sat, &qth, t);
+            if (decayed(sat))
+                break;
+            add_footprint(job, worker->grid, sat->ssplat, sat->ssplon,
+                          sat->footprint);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Compute the coverage density over a time window.
+ *
+ * @param cov The coverage map with the satellites added.
+ * @param t0 Start of the time window (Julian date).
+ * @param t1 End of the time window (Julian date).
+ * @param step Time step in days.
+ *
+ * Previous results are discarded. The computation runs on one worker
+ * thread per CPU core and the function returns when it is complete, so it
+ * may be called from any thread that owns the coverage map.
+ */
+void coverage_map_compute(coverage_map_t * cov, gdouble t0, gdouble t1,
+                          gdouble step)
+{
+    cov_job_t       job;
+    cov_worker_t   *workers;
+    GThread       **threads;
+    guint32        *dst = cov->counts;
+    const guint32  *src;
+    gint64          start;
+    gsize           ncells = (gsize) cov->nlon * cov->nlat;
+    gsize           c;
+    guint           nthreads;
+    guint           i, j;
+    gdouble         lat;
+    gdouble         secs;
+
+    start = g_get_monotonic_time();
+
+    cov->t0 = t0;
+    cov->t1 = t1;
+    cov->step = step;
+    cov->nsteps = (step > 0.0 && t1 > t0) ? (guint) ((t1 - t0) / step) + 1 : 0;
+    cov->maxcount = 0;
+    memset(cov->counts, 0, ncells * sizeof(guint32));
+
+    if (cov->sats->len == 0 || cov->nsteps == 0)
+        return;
+
+    job.cov = cov;
+    job.next = 0;
+    job.row_sin = g_new(gdouble, cov->nlat);
+    job.row_cos = g_new(gdouble, cov->nlat);
+    for (j = 0; j < cov->nlat; j++)
+    {
+        lat = (90.0 - (j + 0.5) * 180.0 / cov->nlat) * de2ra;
+        job.row_sin[j] = sin(lat);
+        job.row_cos[j] = cos(lat);
+    }
+
+    nthreads = MIN(g_get_num_processors(), cov->sats->len);
+    workers = g_new0(cov_worker_t, nthreads);
+    threads = g_new0(GThread *, nthreads);
+
+    /* the first worker uses the result grid and runs in this thread */
+    for (i = 0; i < nthreads; i++)
+    {
+        workers[i].job = &job;
+        workers[i].grid = (i == 0) ? cov->counts : g_new0(guint32, ncells);
+        if (i > 0)
+            threads[i] = g_thread_new("coverage", coverage_worker,
+                                      &workers[i]);
+    }
+    coverage_worker(&workers[0]);
+
+    for (i = 1; i < nthreads; i++)
+    {
+        g_thread_join(threads[i]);
+        src = workers[i].grid;
+        for (c = 0; c < ncells; c++)
+            dst[c] += src[c];
+        g_free(workers[i].grid);
+    }
+
+    for (c = 0; c < ncells; c++)
+        cov->maxcount = MAX(cov->maxcount, cov->counts[c]);
+
+    g_free(threads);
+    g_free(workers);
+    g_free(job.row_sin);
+    g_free(job.row_cos);
+
+    secs = (g_get_monotonic_time() - start) / 1.0e6;
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: %u satellites x %u steps on %u threads in %.3f s "
+                  "(%.0f footprints/s)"),
+                __func__, cov->sats->len, cov->nsteps, nthreads, secs,
+                secs > 0.0 ? cov->sats->len * cov->nsteps / secs : 0.0);
+}
+
+/**
+ * Get the coverage density at a location.
+ *
+ * @param cov The coverage map.
+ * @param lat Latitude in degrees North.
+ * @param lon Longitude in degrees East.
+ * @return The average number of satellites in view over the time window.
+ */
+gdouble coverage_map_get(const coverage_map_t * cov, gdouble lat, gdouble lon)
+{
+    gint            i, j;
+
+    if (cov->nsteps == 0)
+        return 0.0;
+
+    lon = fmod(lon + 180.0, 360.0);
+    if (lon < 0.0)
+        lon += 360.0;
+
+    i = CLAMP((gint) (lon * cov->nlon / 360.0), 0, (gint) cov->nlon - 1);
+    j = CLAMP((gint) ((90.0 - lat) * cov->nlat / 180.0), 0,
+              (gint) cov->nlat - 1);
+
+    return (gdouble) cov->counts[j * cov->nlon + i] / cov->nsteps;
+}
+
+/**
+ * Benchmark the coverage computation.
+ *
+ * @param nsats The number of satellites to use.
+ * @return The time spent computing in seconds, or a negative value if no
+ *         satellites could be loaded.
+ *
+ * The first nsats satellites of the satellite database are accumulated on
+ * a 1 degree grid over one day in 1 minute steps, starting now.
+ */
+gdouble coverage_map_benchmark(guint nsats)
+{
+    sat_index_t    *index;
+    gtk_sat_data_loader_t *loader;
+    GHashTable     *sats;
+    coverage_map_t *cov;
+    gint           *catnums;
+    gint64          start;
+    gdouble         t0;
+    gdouble         secs;
+    guint           n, i;
+
+    index = sat_index_load();
+    n = MIN(nsats, index->sats->len);
+    catnums = g_new(gint, n);
+    for (i = 0; i < n; i++)
+        catnums[i] = g_array_index(index->sats, sat_index_entry_t, i).catnum;
+    sat_index_free(index);
+
+    sats = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, free_sat);
+    loader = gtk_sat_data_load_sats_start(catnums, n, NULL);
+    gtk_sat_data_load_sats_finish(loader, sats);
+    g_free(catnums);
+
+    if (g_hash_table_size(sats) == 0)
+    {
+        g_hash_table_destroy(sats);
+        return -1.0;
+    }
+
+    cov = coverage_map_new(360, 180);
+    coverage_map_add_sats(cov, sats);
+
+    t0 = get_current_daynum();
+    start = g_get_monotonic_time();
+    coverage_map_compute(cov, t0, t0 + 1.0, 1.0 / 1440.0);
+    secs = (g_get_monotonic_time() - start) / 1.0e6;
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: %u satellites x %u steps in %.3f s"),
+                __func__, cov->sats->len, cov->nsteps, secs);
+
+    coverage_map_free(cov);
+    g_hash_table_destroy(sats);
+
+    return secs;
+}
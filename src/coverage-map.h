@@ -0,0 +1,51 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef COVERAGE_MAP_H
+#define COVERAGE_MAP_H 1
+
+#include <glib.h>
+
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** Coverage density accumulated on a regular lat/lon grid. */
+typedef struct {
+    guint           nlon;       /*!< Number of columns, starting at -180 lon. */
+    guint           nlat;       /*!< Number of rows, starting at +90 lat. */
+    gdouble         t0;         /*!< Start of the accumulated time window. */
+    gdouble         t1;         /*!< End of the accumulated time window. */
+    gdouble         step;       /*!< Time step in days. */
+    guint           nsteps;     /*!< Number of time steps accumulated. */
+    guint32        *counts;     /*!< Satellite footprints covering each cell. */
+    guint32         maxcount;   /*!< Largest value in counts. */
+    GPtrArray      *sats;       /*!< Private copies of the satellites (sat_t). */
+} coverage_map_t;
+
+
+coverage_map_t *coverage_map_new(guint nlon, guint nlat);
+void            coverage_map_free(coverage_map_t * cov);
+void            coverage_map_add_sat(coverage_map_t * cov, const sat_t * sat);
+void            coverage_map_add_sats(coverage_map_t * cov, GHashTable * sats);
+void            coverage_map_compute(coverage_map_t * cov, gdouble t0,
+                                     gdouble t1, gdouble step);
+gdouble         coverage_map_get(const coverage_map_t * cov,
+                                 gdouble lat, gdouble lon);
+gdouble         coverage_map_benchmark(guint nsats);
+
+#endif
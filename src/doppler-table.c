@@ -0,0 +1,150 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Doppler table of a pass.
+ *
+ * The range rate of the satellite is sampled once, shortly before AOS, for
+ * the whole pass. During the pass the Doppler shift is interpolated from
+ * the table instead of propagating the satellite in every update. The
+ * table holds the range rate and not the frequencies, so that a change of
+ * the transponder, the satellite frequencies or the LO does not invalidate
+ * it: the shift is the product of the range rate and the frequency in use.
+ *
+ * The samples are interpolated with a cubic Hermite spline, whose slopes
+ * are the central differences of the neighbouring samples. It follows the
+ * fast change of the range rate near TCA of a high pass closely with one
+ * sample per second, and it also gives the rate of change of the range
+ * rate, which the radio controller uses to schedule its commands.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <string.h>
+
+#include "doppler-table.h"
+#include "sat-log.h"
+
+
+/**
+ * Create the Doppler table of a pass.
+ *
+ * @param satname The name of the satellite, for log messages.
+ * @param start The time of the first sample (Julian date).
+ * @param step The time between samples [sec].
+ * @param rr The range rate at each sample [km/s].
+ * @param n The number of samples.
+ * @return The table, or NULL if there are less than two samples. Free it
+ *         with doppler_table_free().
+ */
+doppler_table_t *doppler_table_new(const gchar * satname, gdouble start,
+                                   gdouble step, const gdouble * rr, guint n)
+{
+    doppler_table_t *tab;
+
+    if (n < 2 || step <= 0.0)
+        return NULL;
+
+    tab = g_new0(doppler_table_t, 1);
+    tab->satname = g_strdup(satname);
+    tab->start = start;
+    tab->end = start + (n - 1) * step / secday;
+    tab->step = step;
+    tab->rr = g_new(gdouble, n);
+    memcpy(tab->rr, rr, n * sizeof(gdouble));
+    tab->n = n;
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: %u samples for %s, %.0f s apart (%.0f s)"),
+                __func__, n, tab->satname, step, (n - 1) * step);
+
+    return tab;
+}
+
+/** Copy a Doppler table, e.g. to hand it to another thread. */
+doppler_table_t *doppler_table_copy(const doppler_table_t * tab)
+{
+    if (tab == NULL)
+        return NULL;
+
+    return doppler_table_new(tab->satname, tab->start, tab->step, tab->rr,
+                             tab->n);
+}
+
+void doppler_table_free(doppler_table_t * tab)
+{
+    if (tab == NULL)
+        return;
+
+    g_free(tab->satname);
+    g_free(tab->rr);
+    g_free(tab);
+}
+
+/** Slope of the spline at sample i [km/s per sample]. */
+static gdouble slope(const doppler_table_t * tab, guint i)
+{
+    if (i == 0)
+        return tab->rr[1] - tab->rr[0];
+    if (i == tab->n - 1)
+        return tab->rr[i] - tab->rr[i - 1];
+
+    return (tab->rr[i + 1] - tab->rr[i - 1]) / 2.0;
+}
+
+/**
+ * Interpolate the range rate.
+ *
+ * @param tab The Doppler table.
+ * @param t The time (Julian date).
+ * @param rr Location for the range rate [km/s].
+ * @param rr_dot Location for the rate of change of the range rate [km/s/s].
+ * @return FALSE if t is outside of the table.
+ */
+gboolean doppler_table_get(const doppler_table_t * tab, gdouble t,
+                           gdouble * rr, gdouble * rr_dot)
+{
+    gdouble         x, f, f2, f3, p0, p1, m0, m1;
+    guint           i;
+
+    if (t < tab->start || t > tab->end)
+        return FALSE;
+
+    x = (t - tab->start) * secday / tab->step;
+    i = MIN((guint) x, tab->n - 2);
+    f = x - i;
+    f2 = f * f;
+    f3 = f2 * f;
+
+    p0 = tab->rr[i];
+    p1 = tab->rr[i + 1];
+    m0 = slope(tab, i);
+    m1 = slope(tab, i + 1);
+
+    *rr = (2.0 * f3 - 3.0 * f2 + 1.0) * p0 + (f3 - 2.0 * f2 + f) * m0 +
+        (-2.0 * f3 + 3.0 * f2) * p1 + (f3 - f2) * m1;
+    *rr_dot = ((6.0 * f2 - 6.0 * f) * p0 + (3.0 * f2 - 4.0 * f + 1.0) * m0 +
+               (-6.0 * f2 + 6.0 * f) * p1 + (3.0 * f2 - 2.0 * f) * m1) /
+        tab->step;
+
+    return TRUE;
+}
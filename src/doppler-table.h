@@ -0,0 +1,45 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef DOPPLER_TABLE_H
+#define DOPPLER_TABLE_H 1
+
+#include <glib.h>
+
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** Range rate of a satellite sampled over a pass. */
+typedef struct {
+    gchar          *satname;    /*!< Satellite name, for log messages. */
+    gdouble         start;      /*!< Time of the first sample (Julian date). */
+    gdouble         end;        /*!< Time of the last sample (Julian date). */
+    gdouble         step;       /*!< Time between samples [sec]. */
+    gdouble        *rr;         /*!< Range rate at each sample [km/s]. */
+    guint           n;          /*!< Number of samples. */
+} doppler_table_t;
+
+
+doppler_table_t *doppler_table_new(const gchar * satname, gdouble start,
+                                   gdouble step, const gdouble * rr, guint n);
+doppler_table_t *doppler_table_copy(const doppler_table_t * tab);
+void            doppler_table_free(doppler_table_t * tab);
+gboolean        doppler_table_get(const doppler_table_t * tab, gdouble t,
+                                  gdouble * rr, gdouble * rr_dot);
+
+#endif
@@ -0,0 +1,323 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * gpsd reader.
+ *
+ * The connection to gpsd is owned by a thread of its own, which waits for
+ * messages, reads them and connects again when gpsd is gone or silent. A
+ * slow or unreachable gpsd therefore never blocks the main loop.
+ *
+ * The latest fix is published with a sequence counter: the thread makes the
+ * counter odd while it writes the fix and even again when done. A reader
+ * copies the fix and retries if the counter was odd or has changed in the
+ * meantime. Readers take no lock and never wait for the thread, which is
+ * the only writer.
+ *
+ * The thread owns the reader and frees it when it exits. Stopping the reader
+ * only asks the thread to exit, since it may be stuck connecting to a gpsd
+ * that does not answer.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#ifdef HAS_LIBGPS
+#include <gps.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "gpsd-reader.h"
+#include "sat-log.h"
+
+#if defined(HAS_LIBGPS) && \
+    ((GPSD_API_MAJOR_VERSION >= 4 && GPSD_API_MAJOR_VERSION <= 6) || \
+     (GPSD_API_MAJOR_VERSION >= 11 && GPSD_API_MAJOR_VERSION <= 14))
+#define GPSD_READER_SUPPORTED 1
+#endif
+
+#define GPSD_POLL     250       /*!< Wait for a message at most [msec]. */
+#define GPSD_TIMEOUT  30        /*!< Reconnect after this long silence [sec]. */
+
+
+struct _gpsd_reader {
+    gchar          *server;     /*!< gpsd server name. */
+    gint            port;       /*!< gpsd server port. */
+    GThread        *thread;     /*!< The reader thread. */
+    GMutex          lock;       /*!< Protects running. */
+    GCond           cond;       /*!< Signalled to stop the thread. */
+    gboolean        running;    /*!< Cleared to stop the thread. */
+    gint            seq;        /*!< Sequence counter; odd while writing. */
+    gpsd_fix_t      fix;        /*!< The latest fix. */
+};
+
+
+#if defined(GPSD_READER_SUPPORTED) || defined(GPSD_READER_TEST)
+/** Publish a new fix; only the reader thread may call this. */
+static void publish(gpsd_reader_t * reader, gdouble lat, gdouble lon,
+                    gint alt)
+{
+    g_atomic_int_inc(&reader->seq);
+    reader->fix.count++;
+    reader->fix.lat = lat;
+    reader->fix.lon = lon;
+    reader->fix.alt = alt;
+    g_atomic_int_inc(&reader->seq);
+}
+#endif
+
+#ifdef GPSD_READER_SUPPORTED
+static gboolean is_running(gpsd_reader_t * reader)
+{
+    gboolean        running;
+
+    g_mutex_lock(&reader->lock);
+    running = reader->running;
+    g_mutex_unlock(&reader->lock);
+
+    return running;
+}
+
+/** Sleep until the given monotonic time unless the thread is stopped. */
+static void wait_until(gpsd_reader_t * reader, gint64 end)
+{
+    g_mutex_lock(&reader->lock);
+    while (reader->running &&
+           g_cond_wait_until(&reader->cond, &reader->lock, end));
+    g_mutex_unlock(&reader->lock);
+}
+
+/** Open the connection to gpsd and start the stream. */
+static gboolean gpsd_connect(gpsd_reader_t * reader, struct gps_data_t *gps)
+{
+    gchar          *port;
+    gint            ret;
+
+    port = g_strdup_printf("%d", reader->port);
+#if GPSD_API_MAJOR_VERSION == 4
+    ret = gps_open_r(reader->server, port, gps);
+#else
+    ret = gps_open(reader->server, port, gps);
+#endif
+    g_free(port);
+
+    if (ret == -1)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not open gpsd at %s:%d"),
+                    __func__, reader->server, reader->port);
+        return FALSE;
+    }
+
+    (void)gps_stream(gps, WATCH_ENABLE, NULL);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Connected to gpsd at %s:%d"),
+                __func__, reader->server, reader->port);
+
+    return TRUE;
+}
+
+/**
+ * Wait for a message from gpsd and read it.
+ *
+ * @return 1 if a message was read, 0 if there was none within GPSD_POLL
+ *         and -1 if the connection failed.
+ */
+static gint gpsd_read(struct gps_data_t *gps)
+{
+#if GPSD_API_MAJOR_VERSION == 4
+    /* gps_waiting() of libgps 2.9x does not wait */
+    if (!gps_waiting(gps))
+    {
+        g_usleep(GPSD_POLL * 1000);
+        return 0;
+    }
+    return gps_poll(gps) == 0 ? 1 : -1;
+#else
+    if (!gps_waiting(gps, GPSD_POLL * 1000))
+        return 0;
+#if GPSD_API_MAJOR_VERSION >= 11
+    return gps_read(gps, NULL, 0) < 0 ? -1 : 1;
+#else
+    return gps_read(gps) < 0 ? -1 : 1;
+#endif
+#endif
+}
+
+/** Publish the fix of a message, if it has one. */
+static void publish_fix(gpsd_reader_t * reader, const struct gps_data_t *gps)
+{
+    /* handling packet_set inline with
+       http://gpsd.berlios.de/client-howto.html
+     */
+    if (!(gps->set & PACKET_SET) || gps->fix.mode < MODE_2D)
+        return;
+
+    publish(reader, gps->fix.latitude, gps->fix.longitude,
+            gps->fix.mode == MODE_3D ? gps->fix.altitude : 0);
+}
+
+/* The reader thread */
+static gpointer gpsd_reader_run(gpointer data)
+{
+    gpsd_reader_t  *reader = data;
+    struct gps_data_t *gps;
+    gboolean        connected = FALSE;
+    gint64          last = 0;
+    gint            ret;
+
+    gps = g_new0(struct gps_data_t, 1);
+
+    while (is_running(reader))
+    {
+        if (!connected)
+        {
+            connected = gpsd_connect(reader, gps);
+            last = g_get_monotonic_time();
+            if (!connected)
+                wait_until(reader, last + GPSD_TIMEOUT * G_USEC_PER_SEC);
+            continue;
+        }
+
+        ret = gpsd_read(gps);
+        if (ret > 0)
+        {
+            last = g_get_monotonic_time();
+            publish_fix(reader, gps);
+        }
+        else if (ret < 0)
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: Lost connection to gpsd at %s:%d"),
+                        __func__, reader->server, reader->port);
+            gps_close(gps);
+            connected = FALSE;
+            wait_until(reader,
+                       g_get_monotonic_time() +
+                       GPSD_TIMEOUT * G_USEC_PER_SEC);
+        }
+        else if (g_get_monotonic_time() - last >
+                 GPSD_TIMEOUT * G_USEC_PER_SEC)
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: No data from gpsd at %s:%d for %d seconds, "
+                          "reconnecting"), __func__, reader->server,
+                        reader->port, GPSD_TIMEOUT);
+            gps_close(gps);
+            connected = FALSE;
+        }
+    }
+
+    if (connected)
+        gps_close(gps);
+    g_free(gps);
+
+    g_mutex_clear(&reader->lock);
+    g_cond_clear(&reader->cond);
+    g_free(reader->server);
+    g_free(reader);
+
+    return NULL;
+}
+#endif
+
+/**
+ * Start reading positions from gpsd.
+ *
+ * @param server The gpsd server name.
+ * @param port The gpsd server port.
+ * @return The reader, or NULL if gpredict was built without a supported
+ *         libgps. Stop it with gpsd_reader_free().
+ *
+ * The connection is opened by the reader thread, so this returns at once.
+ */
+gpsd_reader_t  *gpsd_reader_new(const gchar * server, gint port)
+{
+#ifdef GPSD_READER_SUPPORTED
+    gpsd_reader_t  *reader;
+
+    reader = g_new0(gpsd_reader_t, 1);
+    reader->server = g_strdup(server);
+    reader->port = port;
+    g_mutex_init(&reader->lock);
+    g_cond_init(&reader->cond);
+
+    reader->running = TRUE;
+    reader->thread = g_thread_new("gpsd_reader", gpsd_reader_run, reader);
+
+    return reader;
+#else
+#ifdef HAS_LIBGPS
+    sat_log_log(SAT_LOG_LEVEL_ERROR,
+                _("%s: Unsupported gpsd api major version (%d)"),
+                __func__, GPSD_API_MAJOR_VERSION);
+#endif
+    (void)server;
+    (void)port;
+
+    return NULL;
+#endif
+}
+
+/**
+ * Stop the reader.
+ *
+ * This does not wait for the reader thread. The thread closes the connection
+ * and frees the reader when it exits, which is within GPSD_POLL unless it is
+ * connecting to gpsd. The reader must not be used after this call.
+ */
+void gpsd_reader_free(gpsd_reader_t * reader)
+{
+    GThread        *thread;
+
+    if (reader == NULL)
+        return;
+
+    /* the thread may free the reader as soon as it is unlocked */
+    g_mutex_lock(&reader->lock);
+    thread = reader->thread;
+    reader->running = FALSE;
+    g_cond_signal(&reader->cond);
+    g_mutex_unlock(&reader->lock);
+
+    g_thread_unref(thread);
+}
+
+/**
+ * Get the latest fix.
+ *
+ * @param reader The gpsd reader.
+ * @param fix Location for the fix. Its count tells whether it is new.
+ *
+ * This never waits for the reader thread.
+ */
+void gpsd_reader_get_fix(gpsd_reader_t * reader, gpsd_fix_t * fix)
+{
+    gint            seq;
+
+    do
+    {
+        seq = g_atomic_int_get(&reader->seq);
+        *fix = reader->fix;
+
+        /* the atomic add orders the copy before the check */
+    } while ((seq & 1) || g_atomic_int_add(&reader->seq, 0) != seq);
+}
@@ -0,0 +1,40 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef GPSD_READER_H
+#define GPSD_READER_H 1
+
+#include <glib.h>
+
+
+/** Position fix published by the gpsd reader. */
+typedef struct {
+    guint           count;      /*!< Number of fixes so far; 0 if none. */
+    gdouble         lat;        /*!< Latitude in dec. deg. North. */
+    gdouble         lon;        /*!< Longitude in dec. deg. East. */
+    gint            alt;        /*!< Altitude in meters; 0 without 3D fix. */
+} gpsd_fix_t;
+
+typedef struct _gpsd_reader gpsd_reader_t;
+
+
+gpsd_reader_t  *gpsd_reader_new(const gchar * server, gint port);
+void            gpsd_reader_free(gpsd_reader_t * reader);
+void            gpsd_reader_get_fix(gpsd_reader_t * reader, gpsd_fix_t * fix);
+
+#endif
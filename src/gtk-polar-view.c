@@ -45,7 +45,15 @@
 /* extra size for line outside 0 deg circle (inside margin) */
 #define POLV_LINE_EXTRA 5
 
-static void     update_sat(gpointer key, gpointer value, gpointer data);
+/* Cell size of the marker and label grids in pixels */
+#define GRID_CELL_SIZE 32.0
+
+/* Radius around a marker that selects the satellite */
+#define HIT_RADIUS 10.0
+
+static void     update_sat(GtkPolarView * polv, sat_obj_t * obj);
+static void     los_time_to_str(GtkPolarView * polv, sat_t * sat,
+                                gchar * buf, gsize size);
 
 static GtkBoxClass *parent_class = NULL;
 
@@ -83,18 +91,70 @@ static void gtk_polar_view_load_showtracks(GtkPolarView * pv)
                                      pv->showtracks_on);
 }
 
-static void free_sat_obj(gpointer data)
+static void free_obj_pool(sat_obj_t * objs, guint nobjs)
 {
-    sat_obj_t *obj = SAT_OBJ(data);
-    if (obj)
+    guint           i;
+
+    for (i = 0; i < nobjs; i++)
     {
-        g_free(obj->nickname);
-        g_free(obj->tooltip);
-        g_slist_free_full(obj->track_points, g_free);
-        if (obj->pass)
-            free_pass(obj->pass);
-        g_free(obj);
+        g_free(objs[i].track_points);
+        if (objs[i].pass)
+            free_pass(objs[i].pass);
     }
+    g_free(objs);
+}
+
+/**
+ * Create the satellite objects for the current satellites.
+ *
+ * @param polv The polar view.
+ *
+ * Objects of satellites that were already in the view keep their state,
+ * pass and track, so this can be used when the satellites are reloaded.
+ */
+static void create_obj_pool(GtkPolarView * polv)
+{
+    GHashTableIter  iter;
+    GHashTable     *index;
+    sat_obj_t      *objs;
+    sat_obj_t      *old;
+    sat_obj_t      *obj;
+    sat_t          *sat;
+    gpointer        value;
+    guint           n = 0;
+
+    objs = g_new0(sat_obj_t, g_hash_table_size(polv->sats));
+    index = g_hash_table_new(g_int_hash, g_int_equal);
+
+    g_hash_table_iter_init(&iter, polv->sats);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        sat = SAT(value);
+        obj = &objs[n++];
+
+        old = polv->obj ? SAT_OBJ(g_hash_table_lookup(polv->obj,
+                                                      &sat->tle.catnr)) : NULL;
+        if (old != NULL)
+        {
+            /* the buffers now belong to the new object */
+            *obj = *old;
+            old->pass = NULL;
+            old->track_points = NULL;
+        }
+
+        obj->sat = sat;
+        obj->catnum = sat->tle.catnr;
+        obj->nickname = sat->nickname;
+        g_hash_table_insert(index, &obj->catnum, obj);
+    }
+
+    if (polv->obj)
+        g_hash_table_destroy(polv->obj);
+    free_obj_pool(polv->objs, polv->nobjs);
+
+    polv->objs = objs;
+    polv->nobjs = n;
+    polv->obj = index;
 }
 
 static void gtk_polar_view_destroy(GtkWidget * widget)
@@ -106,12 +166,6 @@ static void gtk_polar_view_destroy(GtkWidget * widget)
     g_free(polv->curs_text);
     polv->curs_text = NULL;
 
-    g_free(polv->next_text);
-    polv->next_text = NULL;
-
-    g_free(polv->sel_text);
-    polv->sel_text = NULL;
-
     g_free(polv->font);
     polv->font = NULL;
 
@@ -121,6 +175,10 @@ static void gtk_polar_view_destroy(GtkWidget * widget)
         polv->obj = NULL;
     }
 
+    free_obj_pool(polv->objs, polv->nobjs);
+    polv->objs = NULL;
+    polv->nobjs = 0;
+
     if (polv->showtracks_on)
     {
         g_hash_table_destroy(polv->showtracks_on);
@@ -133,6 +191,11 @@ static void gtk_polar_view_destroy(GtkWidget * widget)
         polv->showtracks_off = NULL;
     }
 
+    sat_grid_free(polv->markers);
+    polv->markers = NULL;
+    sat_grid_free(polv->labels);
+    polv->labels = NULL;
+
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
@@ -155,6 +218,8 @@ static void gtk_polar_view_init(GtkPolarView * polview,
 
     polview->sats = NULL;
     polview->qth = NULL;
+    polview->objs = NULL;
+    polview->nobjs = 0;
     polview->obj = NULL;
     polview->naos = 0.0;
     polview->ncat = 0;
@@ -173,9 +238,11 @@ static void gtk_polar_view_init(GtkPolarView * polview,
     polview->extratick = FALSE;
     polview->resize = FALSE;
     polview->curs_text = NULL;
-    polview->next_text = NULL;
-    polview->sel_text = NULL;
+    polview->next_text[0] = '\0';
+    polview->sel_text[0] = '\0';
     polview->font = NULL;
+    polview->markers = sat_grid_new(GRID_CELL_SIZE);
+    polview->labels = sat_grid_new(GRID_CELL_SIZE);
 }
 
 GType gtk_polar_view_get_type()
@@ -366,6 +433,57 @@ correct_pole_coor(GtkPolarView * polv, polar_view_pole_t pole,
     }
 }
 
+/**
+ * Place and draw the label of a satellite.
+ *
+ * The label is drawn below the marker unless it would overlap a label that
+ * has already been drawn, in which case the positions above, right and left
+ * of the marker are tried. When all of them are taken the label is skipped,
+ * except for the selected satellite.
+ */
+static void draw_sat_label(GtkPolarView *polv, cairo_t *cr, PangoLayout *layout,
+                           sat_obj_t *obj)
+{
+    gdouble         r, g, b, a;
+    gdouble         lx[4], ly[4];
+    gint            tw, th;
+    gint            k;
+
+    pango_layout_set_text(layout, obj->nickname, -1);
+    pango_layout_get_pixel_size(layout, &tw, &th);
+
+    lx[0] = obj->x - tw / 2;
+    ly[0] = obj->y + 2;
+    lx[1] = obj->x - tw / 2;
+    ly[1] = obj->y - 2 - th;
+    lx[2] = obj->x + 3;
+    ly[2] = obj->y - th / 2;
+    lx[3] = obj->x - 3 - tw;
+    ly[3] = obj->y - th / 2;
+
+    for (k = 0; k < 4; k++)
+        if (!sat_grid_overlaps(polv->labels, lx[k], ly[k], lx[k] + tw, ly[k] + th))
+            break;
+
+    if (k == 4)
+    {
+        if (!obj->selected)
+            return;
+        k = 0;
+    }
+
+    sat_grid_add(polv->labels, lx[k], ly[k], lx[k] + tw, ly[k] + th, NULL);
+
+    if (obj->selected)
+        rgba_to_cairo(polv->col_sat_sel, &r, &g, &b, &a);
+    else
+        rgba_to_cairo(polv->col_sat, &r, &g, &b, &a);
+
+    cairo_set_source_rgba(cr, r, g, b, a);
+    cairo_move_to(cr, lx[k], ly[k]);
+    pango_cairo_show_layout(cr, layout);
+}
+
 static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
 {
     GtkPolarView   *polv = GTK_POLAR_VIEW(data);
@@ -375,12 +493,9 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     PangoLayout    *layout;
     PangoFontDescription *font_desc;
     gint            tw, th;
-    GHashTableIter  iter;
-    gpointer        key, value;
     sat_obj_t      *obj;
-    GSList         *node;
     gdouble        *point;
-    guint           i;
+    guint           i, n;
 
     (void)widget;
 
@@ -481,7 +596,7 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     }
 
     /* Next event text */
-    if (polv->eventinfo && polv->next_text)
+    if (polv->eventinfo && polv->next_text[0] != '\0')
     {
         rgba_to_cairo(polv->col_info, &r, &g, &b, &a);
         cairo_set_source_rgba(cr, r, g, b, a);
@@ -495,7 +610,7 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     }
 
     /* Selected satellite text */
-    if (polv->sel_text)
+    if (polv->sel_text[0] != '\0')
     {
         rgba_to_cairo(polv->col_info, &r, &g, &b, &a);
         cairo_set_source_rgba(cr, r, g, b, a);
@@ -508,85 +623,84 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
         pango_layout_set_alignment(layout, PANGO_ALIGN_LEFT);
     }
 
-    /* Draw satellite objects */
-    if (polv->obj)
+    /* Draw satellite objects and index the markers for hit testing */
+    sat_grid_reset(polv->markers, 2 * polv->cx, 2 * polv->cy);
+
+    for (n = 0; n < polv->nobjs; n++)
     {
-        g_hash_table_iter_init(&iter, polv->obj);
-        while (g_hash_table_iter_next(&iter, &key, &value))
-        {
-            obj = SAT_OBJ(value);
+        obj = &polv->objs[n];
+        if (!obj->visible)
+            continue;
 
-            /* Draw track if enabled */
-            if (obj->showtrack && obj->track_points)
+        /* Draw track if enabled */
+        if (obj->showtrack && obj->track_count > 0)
+        {
+            rgba_to_cairo(polv->col_track, &r, &g, &b, &a);
+            cairo_set_source_rgba(cr, r, g, b, a);
+            cairo_set_line_width(cr, 1.0);
+
+            point = obj->track_points;
+            cairo_move_to(cr, point[0], point[1]);
+            for (i = 1; i < obj->track_count; i++)
+                cairo_line_to(cr, point[2 * i], point[2 * i + 1]);
+            cairo_stroke(cr);
+
+            /* Draw time ticks */
+            for (i = 0; i < TRACK_TICK_NUM; i++)
             {
-                rgba_to_cairo(polv->col_track, &r, &g, &b, &a);
-                cairo_set_source_rgba(cr, r, g, b, a);
-                cairo_set_line_width(cr, 1.0);
-
-                node = obj->track_points;
-                if (node)
+                if (obj->trtick[i].text[0] != '\0')
                 {
-                    point = (gdouble *)node->data;
-                    cairo_move_to(cr, point[0], point[1]);
-                    node = node->next;
-
-                    while (node)
-                    {
-                        point = (gdouble *)node->data;
-                        cairo_line_to(cr, point[0], point[1]);
-                        node = node->next;
-                    }
-                    cairo_stroke(cr);
-                }
+                    x = obj->trtick[i].x;
+                    y = obj->trtick[i].y;
+                    pango_layout_set_text(layout, obj->trtick[i].text, -1);
+                    pango_layout_get_pixel_size(layout, &tw, &th);
 
-                /* Draw time ticks */
-                for (i = 0; i < TRACK_TICK_NUM; i++)
-                {
-                    if (obj->trtick[i].text[0] != '\0')
-                    {
-                        x = obj->trtick[i].x;
-                        y = obj->trtick[i].y;
-                        pango_layout_set_text(layout, obj->trtick[i].text, -1);
-                        pango_layout_get_pixel_size(layout, &tw, &th);
-
-                        if (x > polv->cx)
-                            cairo_move_to(cr, x - tw - 5, y - th / 2);
-                        else
-                            cairo_move_to(cr, x + 5, y - th / 2);
-
-                        pango_cairo_show_layout(cr, layout);
-                    }
+                    if (x > polv->cx)
+                        cairo_move_to(cr, x - tw - 5, y - th / 2);
+                    else
+                        cairo_move_to(cr, x + 5, y - th / 2);
+
+                    pango_cairo_show_layout(cr, layout);
                 }
             }
+        }
 
-            /* Draw satellite marker */
-            if (polv->satmarker)
-            {
-                if (obj->selected)
-                    rgba_to_cairo(polv->col_sat_sel, &r, &g, &b, &a);
-                else
-                    rgba_to_cairo(polv->col_sat, &r, &g, &b, &a);
+        /* Draw satellite marker */
+        if (polv->satmarker)
+        {
+            if (obj->selected)
+                rgba_to_cairo(polv->col_sat_sel, &r, &g, &b, &a);
+            else
+                rgba_to_cairo(polv->col_sat, &r, &g, &b, &a);
 
-                cairo_set_source_rgba(cr, r, g, b, a);
-                cairo_rectangle(cr, obj->x - MARKER_SIZE_HALF, obj->y - MARKER_SIZE_HALF,
-                                2 * MARKER_SIZE_HALF, 2 * MARKER_SIZE_HALF);
-                cairo_fill(cr);
-            }
+            cairo_set_source_rgba(cr, r, g, b, a);
+            cairo_rectangle(cr, obj->x - MARKER_SIZE_HALF, obj->y - MARKER_SIZE_HALF,
+                            2 * MARKER_SIZE_HALF, 2 * MARKER_SIZE_HALF);
+            cairo_fill(cr);
+        }
 
-            /* Draw satellite name */
-            if (polv->satname && obj->nickname)
-            {
-                if (obj->selected)
-                    rgba_to_cairo(polv->col_sat_sel, &r, &g, &b, &a);
-                else
-                    rgba_to_cairo(polv->col_sat, &r, &g, &b, &a);
+        sat_grid_add(polv->markers, obj->x, obj->y, obj->x, obj->y,
+                     GINT_TO_POINTER(obj->catnum));
+    }
 
-                cairo_set_source_rgba(cr, r, g, b, a);
-                pango_layout_set_text(layout, obj->nickname, -1);
-                pango_layout_get_pixel_size(layout, &tw, &th);
-                cairo_move_to(cr, obj->x - tw / 2, obj->y + 2);
-                pango_cairo_show_layout(cr, layout);
-            }
+    /* Place the names greedily, selected satellite first, so that
+       labels do not overlap */
+    if (polv->satname)
+    {
+        sat_grid_reset(polv->labels, 2 * polv->cx, 2 * polv->cy);
+
+        for (n = 0; n < polv->nobjs; n++)
+        {
+            obj = &polv->objs[n];
+            if (obj->visible && obj->selected && obj->nickname)
+                draw_sat_label(polv, cr, layout, obj);
+        }
+
+        for (n = 0; n < polv->nobjs; n++)
+        {
+            obj = &polv->objs[n];
+            if (obj->visible && !obj->selected && obj->nickname)
+                draw_sat_label(polv, cr, layout, obj);
         }
     }
 
@@ -596,35 +710,35 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     return FALSE;
 }
 
+/**
+ * Find satellite object at given position.
+ *
+ * Uses the marker grid built when the view was last drawn.
+ */
 static sat_obj_t *find_sat_at_pos(GtkPolarView *polv, gfloat mx, gfloat my)
 {
-    GHashTableIter  iter;
-    gpointer        key, value;
     sat_obj_t      *obj;
-    gfloat          dx, dy;
-    const gfloat    hit_radius = 10.0;
+    gint            catnum;
 
     if (polv->obj == NULL)
         return NULL;
 
-    g_hash_table_iter_init(&iter, polv->obj);
-    while (g_hash_table_iter_next(&iter, &key, &value))
-    {
-        obj = SAT_OBJ(value);
-        dx = mx - obj->x;
-        dy = my - obj->y;
-        if (dx * dx + dy * dy < hit_radius * hit_radius)
-            return obj;
-    }
-    return NULL;
+    catnum = GPOINTER_TO_INT(sat_grid_find(polv->markers, mx, my, HIT_RADIUS));
+    if (catnum == 0)
+        return NULL;
+
+    /* the satellite may have set since the markers were drawn */
+    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &catnum));
+    if (obj == NULL || !obj->visible)
+        return NULL;
+
+    return obj;
 }
 
 static gboolean on_button_press(GtkWidget *widget, GdkEventButton *event, gpointer data)
 {
     GtkPolarView   *polv = GTK_POLAR_VIEW(data);
     sat_obj_t      *obj;
-    sat_t          *sat = NULL;
-    gint           *catpoint = NULL;
 
     (void)widget;
 
@@ -639,28 +753,14 @@ static gboolean on_button_press(GtkWidget *widget, GdkEventButton *event, gpoint
         if (event->type == GDK_2BUTTON_PRESS)
         {
             /* Double-click: show satellite info */
-            catpoint = g_try_new0(gint, 1);
-            *catpoint = obj->catnum;
-            sat = SAT(g_hash_table_lookup(polv->sats, catpoint));
-            if (sat != NULL)
-            {
-                show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(polv)));
-            }
-            g_free(catpoint);
+            show_sat_info(obj->sat, gtk_widget_get_toplevel(GTK_WIDGET(polv)));
         }
         break;
 
     case 3:
         /* Right-click: popup menu */
-        catpoint = g_try_new0(gint, 1);
-        *catpoint = obj->catnum;
-        sat = SAT(g_hash_table_lookup(polv->sats, catpoint));
-        if (sat != NULL)
-        {
-            gtk_polar_view_popup_exec(sat, polv->qth, polv, event,
-                                      gtk_widget_get_toplevel(GTK_WIDGET(polv)));
-        }
-        g_free(catpoint);
+        gtk_polar_view_popup_exec(obj->sat, polv->qth, polv, event,
+                                  gtk_widget_get_toplevel(GTK_WIDGET(polv)));
         break;
 
     default:
@@ -670,23 +770,20 @@ static gboolean on_button_press(GtkWidget *widget, GdkEventButton *event, gpoint
     return TRUE;
 }
 
-static void clear_selection(gpointer key, gpointer val, gpointer data)
+/** Clear the selection of all satellites except catnum (0 for all). */
+static void clear_selection(GtkPolarView * polv, gint catnum)
 {
-    gint           *old = key;
-    gint           *new = data;
-    sat_obj_t      *obj = SAT_OBJ(val);
+    guint           i;
 
-    if ((*old != *new) && (obj->selected))
-    {
-        obj->selected = FALSE;
-    }
+    for (i = 0; i < polv->nobjs; i++)
+        if (polv->objs[i].catnum != catnum)
+            polv->objs[i].selected = FALSE;
 }
 
 static gboolean on_button_release(GtkWidget *widget, GdkEventButton *event, gpointer data)
 {
     GtkPolarView   *polv = GTK_POLAR_VIEW(data);
     sat_obj_t      *obj;
-    gint           *catpoint;
 
     (void)widget;
 
@@ -700,22 +797,68 @@ static gboolean on_button_release(GtkWidget *widget, GdkEventButton *event, gpoi
 
     obj->selected = !obj->selected;
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = obj->catnum;
-
-    if (!obj->selected)
+    if (obj->selected)
     {
-        g_free(polv->sel_text);
-        polv->sel_text = NULL;
-        *catpoint = 0;
+        clear_selection(polv, obj->catnum);
+    }
+    else
+    {
+        polv->sel_text[0] = '\0';
+        clear_selection(polv, 0);
     }
 
-    /* clear other selections */
-    g_hash_table_foreach(polv->obj, clear_selection, catpoint);
+    gtk_widget_queue_draw(polv->canvas);
 
-    g_free(catpoint);
+    return TRUE;
+}
 
-    gtk_widget_queue_draw(polv->canvas);
+/** Format the LOS countdown of a satellite in range into buf */
+static void los_text(GtkPolarView *polv, sat_t *sat, gchar *buf, gsize size)
+{
+    if (sat->los > 0.0)
+        los_time_to_str(polv, sat, buf, size);
+    else
+        g_snprintf(buf, size, _("%s\nAlways in range"), sat->nickname);
+}
+
+/**
+ * Show the tooltip of the satellite under the pointer.
+ *
+ * Tooltip texts are only generated here, when GTK asks for them, instead of
+ * for every satellite on every update.
+ */
+static gboolean query_tooltip(GtkWidget *widget, gint x, gint y, gboolean keyboard_mode,
+                              GtkTooltip *tooltip, gpointer data)
+{
+    GtkPolarView   *polv = GTK_POLAR_VIEW(data);
+    sat_obj_t      *obj;
+    sat_t          *sat;
+    GdkRectangle    area;
+    gchar           losstr[POLV_TEXT_SIZE];
+    gchar          *text;
+
+    (void)widget;
+
+    if (keyboard_mode)
+        return FALSE;
+
+    obj = find_sat_at_pos(polv, x, y);
+    if (obj == NULL)
+        return FALSE;
+
+    sat = obj->sat;
+    los_text(polv, sat, losstr, sizeof(losstr));
+    text = g_markup_printf_escaped("<b>%s</b>\nAz: %5.1f\302\260\nEl: %5.1f\302\260\n%s",
+                                   sat->nickname, sat->az, sat->el, losstr);
+    gtk_tooltip_set_markup(tooltip, text);
+    g_free(text);
+
+    /* ask again when the pointer leaves the marker */
+    area.x = obj->x - HIT_RADIUS;
+    area.y = obj->y - HIT_RADIUS;
+    area.width = 2 * HIT_RADIUS;
+    area.height = 2 * HIT_RADIUS;
+    gtk_tooltip_set_tip_area(tooltip, &area);
 
     return TRUE;
 }
@@ -775,7 +918,7 @@ GtkWidget *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats, qth_t * qth
     polv->sats = sats;
     polv->qth = qth;
 
-    polv->obj = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, free_sat_obj);
+    create_obj_pool(polv);
     polv->showtracks_on = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, NULL);
     polv->showtracks_off = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, NULL);
 
@@ -856,6 +999,7 @@ GtkWidget *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats, qth_t * qth
 
     /* connect signals */
     g_signal_connect(polv->canvas, "draw", G_CALLBACK(on_draw), polv);
+    g_signal_connect(polv->canvas, "query-tooltip", G_CALLBACK(query_tooltip), polv);
     g_signal_connect(polv->canvas, "motion-notify-event", G_CALLBACK(on_motion_notify), polv);
     g_signal_connect(polv->canvas, "button-press-event", G_CALLBACK(on_button_press), polv);
     g_signal_connect(polv->canvas, "button-release-event", G_CALLBACK(on_button_release), polv);
@@ -871,6 +1015,8 @@ GtkWidget *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats, qth_t * qth
 static void update_polv_size(GtkPolarView * polv)
 {
     GtkAllocation   allocation;
+    sat_obj_t      *obj;
+    guint           i;
 
     if (gtk_widget_get_realized(GTK_WIDGET(polv)))
     {
@@ -881,17 +1027,23 @@ static void update_polv_size(GtkPolarView * polv)
         polv->cx = allocation.width / 2;
         polv->cy = allocation.height / 2;
 
-        /* Update satellite positions */
-        g_hash_table_foreach(polv->sats, update_sat, polv);
+        /* Update satellite positions and the tracks, which are in pixels */
+        for (i = 0; i < polv->nobjs; i++)
+        {
+            obj = &polv->objs[i];
+            update_sat(polv, obj);
+            if (obj->visible && obj->showtrack && obj->pass)
+                gtk_polar_view_create_track(polv, obj, obj->sat);
+        }
     }
 }
 
 /** Convert LOS timestamp to human readable countdown string */
-static gchar *los_time_to_str(GtkPolarView * polv, sat_t * sat)
+static void los_time_to_str(GtkPolarView * polv, sat_t * sat,
+                            gchar * buf, gsize size)
 {
     guint           h, m, s;
     gdouble         number, now;
-    gchar          *text = NULL;
 
     now = polv->tstamp;
     number = sat->los - now;
@@ -908,21 +1060,18 @@ static gchar *los_time_to_str(GtkPolarView * polv, sat_t * sat)
     s -= 60 * m;
 
     if (h > 0)
-        text = g_strdup_printf(_("LOS in %02d:%02d:%02d"), h, m, s);
+        g_snprintf(buf, size, _("LOS in %02d:%02d:%02d"), h, m, s);
     else
-        text = g_strdup_printf(_("LOS in %02d:%02d"), m, s);
-
-    return text;
+        g_snprintf(buf, size, _("LOS in %02d:%02d"), m, s);
 }
 
 void gtk_polar_view_update(GtkWidget * widget)
 {
     GtkPolarView   *polv = GTK_POLAR_VIEW(widget);
     gdouble         number, now;
-    gchar          *buff;
     guint           h, m, s;
-    sat_t          *sat = NULL;
-    gint           *catnr;
+    guint           i;
+    sat_obj_t      *obj = NULL;
 
     if (polv->resize)
     {
@@ -944,19 +1093,17 @@ void gtk_polar_view_update(GtkWidget * widget)
         polv->ncat = 0;
 
         /* update sats */
-        g_hash_table_foreach(polv->sats, update_sat, polv);
+        for (i = 0; i < polv->nobjs; i++)
+            update_sat(polv, &polv->objs[i]);
 
         /* update countdown to NEXT AOS label */
         if (polv->eventinfo)
         {
             if (polv->ncat > 0)
             {
-                catnr = g_try_new0(gint, 1);
-                *catnr = polv->ncat;
-                sat = SAT(g_hash_table_lookup(polv->sats, catnr));
-                g_free(catnr);
+                obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &polv->ncat));
 
-                if (sat != NULL)
+                if (obj != NULL)
                 {
                     now = polv->tstamp;
                     number = polv->naos - now;
@@ -968,57 +1115,62 @@ void gtk_polar_view_update(GtkWidget * widget)
                     s -= 60 * m;
 
                     if (h > 0)
-                        buff = g_strdup_printf(_("Next: %s\nin %02d:%02d:%02d"),
-                                               sat->nickname, h, m, s);
+                        g_snprintf(polv->next_text, sizeof(polv->next_text),
+                                   _("Next: %s\nin %02d:%02d:%02d"),
+                                   obj->sat->nickname, h, m, s);
                     else
-                        buff = g_strdup_printf(_("Next: %s\nin %02d:%02d"),
-                                               sat->nickname, m, s);
-
-                    g_free(polv->next_text);
-                    polv->next_text = buff;
+                        g_snprintf(polv->next_text, sizeof(polv->next_text),
+                                   _("Next: %s\nin %02d:%02d"),
+                                   obj->sat->nickname, m, s);
                 }
                 else
                 {
                     sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Can not find NEXT satellite."), __func__);
-                    g_free(polv->next_text);
-                    polv->next_text = g_strdup(_("Next: ERR"));
+                    g_strlcpy(polv->next_text, _("Next: ERR"), sizeof(polv->next_text));
                 }
             }
             else
             {
-                g_free(polv->next_text);
-                polv->next_text = g_strdup(_("Next: N/A"));
+                g_strlcpy(polv->next_text, _("Next: N/A"), sizeof(polv->next_text));
             }
         }
         else
         {
-            g_free(polv->next_text);
-            polv->next_text = NULL;
+            polv->next_text[0] = '\0';
         }
 
         gtk_widget_queue_draw(polv->canvas);
     }
 }
 
-static void update_sat(gpointer key, gpointer value, gpointer data)
+/** Replace the pass of a satellite object with the current pass. */
+static void update_pass(GtkPolarView * polv, sat_obj_t * obj, gdouble now)
 {
-    gint           *catnum;
-    sat_t          *sat = SAT(value);
-    GtkPolarView   *polv = GTK_POLAR_VIEW(data);
-    sat_obj_t      *obj = NULL;
-    gfloat          x, y;
-    gdouble         now;
-    gchar          *losstr;
-    gchar          *text;
-    guint           num, i;
-    pass_detail_t  *detail;
-    gdouble        *point;
-    guint           tres, ttidx;
+    if (obj->pass)
+        free_pass(obj->pass);
 
-    (void)key;
+    obj->pass = get_current_pass(obj->sat, polv->qth, now);
+    obj->track_count = 0;
 
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
+    if (obj->showtrack && obj->pass)
+        gtk_polar_view_create_track(polv, obj, obj->sat);
+}
+
+/**
+ * Update a satellite object.
+ *
+ * Objects are never created or freed here. A satellite going below the
+ * horizon only clears the visible flag; when it rises again the pass is
+ * recalculated into the existing object, so apart from the pass itself
+ * the update does not allocate any memory.
+ */
+static void update_sat(GtkPolarView * polv, sat_obj_t * obj)
+{
+    sat_t          *sat = obj->sat;
+    gdouble         now;
+    gchar           losstr[POLV_TEXT_SIZE];
+    gboolean        qth_upd;
+    gboolean        time_upd;
 
     now = polv->tstamp;
 
@@ -1035,135 +1187,69 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     /* if sat is out of range */
     if ((sat->el < 0.00) || decayed(sat))
     {
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catnum));
-
-        if (obj != NULL)
+        if (obj->visible)
         {
             /* if this was the selected satellite we need to
                clear the info text
              */
             if (obj->selected)
-            {
-                g_free(polv->sel_text);
-                polv->sel_text = NULL;
-            }
+                polv->sel_text[0] = '\0';
 
-            /* remove sat object from hash table (this will free it) */
-            g_hash_table_remove(polv->obj, catnum);
+            obj->visible = FALSE;
+            obj->selected = FALSE;
         }
-
-        g_free(catnum);
+        return;
     }
-    else
-    {
-        /* sat is within range */
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catnum));
-        azel_to_xy(polv, sat->az, sat->el, &x, &y);
-
-        if (obj != NULL)
-        {
-            /* update existing satellite */
-            obj->x = x;
-            obj->y = y;
-
-            /* update nickname */
-            g_free(obj->nickname);
-            obj->nickname = g_strdup(sat->nickname);
-
-            /* update LOS count down */
-            if (sat->los > 0.0)
-                losstr = los_time_to_str(polv, sat);
-            else
-                losstr = g_strdup_printf(_("%s\nAlways in range"), sat->nickname);
-
-            /* update tooltip */
-            g_free(obj->tooltip);
-            obj->tooltip = g_markup_printf_escaped("<b>%s</b>\nAz: %5.1f\302\260\nEl: %5.1f\302\260\n%s",
-                                                   sat->nickname, sat->az, sat->el, losstr);
 
-            /* update selection info */
-            if (obj->selected)
-            {
-                g_free(polv->sel_text);
-                polv->sel_text = g_strdup_printf("%s\n%s", sat->nickname, losstr);
-            }
+    /* sat is within range */
+    azel_to_xy(polv, sat->az, sat->el, &obj->x, &obj->y);
 
-            /* Check if pass needs update */
-            if (obj->pass)
-            {
-                /** FIXME: threshold */
-                gboolean qth_upd = qth_small_dist(polv->qth, (obj->pass->qth_comp)) > 1.0;
-                gboolean time_upd = !((obj->pass->aos <= now) && (obj->pass->los >= now));
-
-                if (qth_upd || time_upd)
-                {
-                    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                                _("%s:%s: Updating satellite pass SAT:%d Q:%d T:%d\n"),
-                                __FILE__, __func__, *catnum, qth_upd, time_upd);
-
-                    /* Free old track and pass */
-                    g_slist_free_full(obj->track_points, g_free);
-                    obj->track_points = NULL;
-                    free_pass(obj->pass);
-                    obj->pass = NULL;
-
-                    /* Compute new pass */
-                    obj->pass = get_current_pass(sat, polv->qth, now);
-
-                    /* Recreate track if needed */
-                    if (obj->showtrack && obj->pass)
-                        gtk_polar_view_create_track(polv, obj, sat);
-                }
-            }
-
-            g_free(losstr);
-            g_free(catnum);     // FIXME: why free here, what about else?
-        }
+    if (!obj->visible)
+    {
+        /* satellite has come into range */
+        obj->visible = TRUE;
+        obj->istarget = FALSE;
+
+        if (g_hash_table_lookup_extended(polv->showtracks_on, &obj->catnum, NULL, NULL))
+            obj->showtrack = TRUE;
+        else if (g_hash_table_lookup_extended(polv->showtracks_off, &obj->catnum, NULL, NULL))
+            obj->showtrack = FALSE;
         else
-        {
-            /* add new satellite */
-            obj = g_try_new0(sat_obj_t, 1);
+            obj->showtrack = polv->showtrack;
 
-            if (obj != NULL)
-            {
-                obj->selected = FALSE;
-                obj->x = x;
-                obj->y = y;
-                obj->catnum = sat->tle.catnr;
-                obj->nickname = g_strdup(sat->nickname);
-                obj->track_points = NULL;
-
-                if (g_hash_table_lookup_extended(polv->showtracks_on, catnum, NULL, NULL))
-                    obj->showtrack = TRUE;
-                else if (g_hash_table_lookup_extended(polv->showtracks_off, catnum, NULL, NULL))
-                    obj->showtrack = FALSE;
-                else
-                    obj->showtrack = polv->showtrack;
+        /* reuse the pass if the satellite only dipped below the horizon */
+        if (obj->pass == NULL || obj->pass->los < now)
+            update_pass(polv, obj, now);
+        else if (obj->showtrack)
+            gtk_polar_view_create_track(polv, obj, sat);
+        else
+            obj->track_count = 0;
 
-                obj->istarget = FALSE;
+        return;
+    }
 
-                /* create tooltip */
-                obj->tooltip = g_markup_printf_escaped("<b>%s</b>\nAz: %5.1f\302\260\nEl: %5.1f\302\260\n",
-                                                       sat->nickname, sat->az, sat->el);
+    /* update selection info with the LOS count down */
+    if (obj->selected)
+    {
+        los_text(polv, sat, losstr, sizeof(losstr));
+        g_snprintf(polv->sel_text, sizeof(polv->sel_text), "%s\n%s",
+                   sat->nickname, losstr);
+    }
 
-                /* get info about the current pass */
-                obj->pass = get_current_pass(sat, polv->qth, now);
+    /* Check if pass needs update */
+    if (obj->pass)
+    {
+        /** FIXME: threshold */
+        qth_upd = qth_small_dist(polv->qth, (obj->pass->qth_comp)) > 1.0;
+        time_upd = !((obj->pass->aos <= now) && (obj->pass->los >= now));
 
-                /* add sat to hash table */
-                g_hash_table_insert(polv->obj, catnum, obj);
+        if (qth_upd || time_upd)
+        {
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s:%s: Updating satellite pass SAT:%d Q:%d T:%d\n"),
+                        __FILE__, __func__, obj->catnum, qth_upd, time_upd);
 
-                /* create the sky track if necessary */
-                if (obj->showtrack)
-                    gtk_polar_view_create_track(polv, obj, sat);
-            }
-            else
-            {
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s: Cannot allocate memory for satellite %d."),
-                            __func__, sat->tle.catnr);
-                g_free(catnum);
-                return;
-            }
+            update_pass(polv, obj, now);
         }
     }
 }
@@ -1172,6 +1258,7 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
 {
     guint           num, i;
     pass_detail_t  *detail;
+    GSList         *node;
     gfloat          x, y;
     gdouble        *point;
     guint           tres, ttidx;
@@ -1191,8 +1278,8 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
     }
 
     /* Clear existing track points */
-    g_slist_free_full(obj->track_points, g_free);
-    obj->track_points = NULL;
+    obj->track_count = 0;
+    memset(obj->trtick, 0, sizeof(obj->trtick));
 
     /* Create points */
     num = g_slist_length(obj->pass->details);
@@ -1202,15 +1289,21 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
         return;
     }
 
+    /* the buffer is kept between passes and only grows */
+    if (num > obj->track_size)
+    {
+        obj->track_points = g_renew(gdouble, obj->track_points, 2 * num);
+        obj->track_size = num;
+    }
+    point = obj->track_points;
+
     /* time resolution for time ticks */
     tres = (num > 2) ? (num - 2) / (TRACK_TICK_NUM - 1) : 1;
 
     /* first point should be (aos_az,0.0) */
     azel_to_xy(pv, obj->pass->aos_az, 0.0, &x, &y);
-    point = g_new(gdouble, 2);
     point[0] = x;
     point[1] = y;
-    obj->track_points = g_slist_append(obj->track_points, point);
 
     /* first time tick */
     obj->trtick[0].x = x;
@@ -1219,16 +1312,15 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
 
     ttidx = 1;
 
-    for (i = 1; i < num - 1; i++)
+    node = obj->pass->details->next;
+    for (i = 1; i < num - 1; i++, node = node->next)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
+        detail = PASS_DETAIL(node->data);
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
 
-        point = g_new(gdouble, 2);
-        point[0] = x;
-        point[1] = y;
-        obj->track_points = g_slist_append(obj->track_points, point);
+        point[2 * i] = x;
+        point[2 * i + 1] = y;
 
         if (tres != 0 && !(i % tres))
         {
@@ -1250,10 +1342,10 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
 
     /* last point should be (los_az, 0.0) */
     azel_to_xy(pv, obj->pass->los_az, 0.0, &x, &y);
-    point = g_new(gdouble, 2);
-    point[0] = x;
-    point[1] = y;
-    obj->track_points = g_slist_append(obj->track_points, point);
+    point[2 * (num - 1)] = x;
+    point[2 * (num - 1) + 1] = y;
+
+    obj->track_count = num;
 }
 
 void gtk_polar_view_delete_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat)
@@ -1263,8 +1355,8 @@ void gtk_polar_view_delete_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
 
     if (obj)
     {
-        g_slist_free_full(obj->track_points, g_free);
-        obj->track_points = NULL;
+        /* the buffer is kept for when the track is shown again */
+        obj->track_count = 0;
 
         /* Clear time ticks */
         memset(obj->trtick, 0, sizeof(obj->trtick));
@@ -1276,19 +1368,58 @@ void gtk_polar_view_reload_sats(GtkWidget * polv, GHashTable * sats)
     GTK_POLAR_VIEW(polv)->sats = sats;
     GTK_POLAR_VIEW(polv)->naos = 0.0;
     GTK_POLAR_VIEW(polv)->ncat = 0;
+
+    create_obj_pool(GTK_POLAR_VIEW(polv));
+}
+
+/**
+ * Invalidate the cached pass of a single satellite.
+ *
+ * @param polv The GtkPolarView widget.
+ * @param catnum The catalog number of the satellite whose data has changed.
+ *
+ * Called when the elements of a satellite have been swapped in place. If the
+ * satellite is currently on the view, its pass and sky track are recalculated
+ * using the new elements; the other objects are left untouched.
+ */
+void gtk_polar_view_reload_sat(GtkWidget * polv, gint catnum)
+{
+    GtkPolarView   *pv = GTK_POLAR_VIEW(polv);
+    sat_obj_t      *obj;
+    sat_t          *sat;
+
+    pv->naos = 0.0;
+    pv->ncat = 0;
+
+    obj = SAT_OBJ(g_hash_table_lookup(pv->obj, &catnum));
+    sat = SAT(g_hash_table_lookup(pv->sats, &catnum));
+    if (obj == NULL || sat == NULL)
+        return;
+
+    obj->sat = sat;
+    obj->nickname = sat->nickname;
+
+    if (obj->visible)
+    {
+        update_pass(pv, obj, pv->tstamp);
+    }
+    else if (obj->pass)
+    {
+        /* recalculated when the satellite rises */
+        free_pass(obj->pass);
+        obj->pass = NULL;
+    }
+
+    gtk_widget_queue_draw(pv->canvas);
 }
 
 void gtk_polar_view_select_sat(GtkWidget * widget, gint catnum)
 {
     GtkPolarView   *polv = GTK_POLAR_VIEW(widget);
-    gint           *catpoint = NULL;
     sat_obj_t      *obj = NULL;
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = catnum;
-
-    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catpoint));
-    if (obj == NULL)
+    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &catnum));
+    if (obj == NULL || !obj->visible)
     {
         sat_log_log(SAT_LOG_LEVEL_DEBUG,
                     _("%s Requested satellite (%d) is not within range"),
@@ -1300,9 +1431,7 @@ void gtk_polar_view_select_sat(GtkWidget * widget, gint catnum)
     }
 
     /* clear previous selection, if any */
-    g_hash_table_foreach(polv->obj, clear_selection, catpoint);
-
-    g_free(catpoint);
+    clear_selection(polv, catnum);
 
     gtk_widget_queue_draw(polv->canvas);
 }
@@ -8,6 +8,7 @@
 
 #include "gtk-sat-data.h"
 #include "predict-tools.h"
+#include "sat-grid.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -18,6 +19,9 @@ extern "C" {
 /** \brief Number of time ticks. */
 #define TRACK_TICK_NUM 4
 
+/** \brief Size of the info text buffers. */
+#define POLV_TEXT_SIZE 256
+
 
 #define GTK_POLAR_VIEW(obj)          G_TYPE_CHECK_INSTANCE_CAST (obj, gtk_polar_view_get_type (), GtkPolarView)
 #define GTK_POLAR_VIEW_CLASS(klass)  G_TYPE_CHECK_CLASS_CAST (klass, gtk_polar_view_get_type (), GtkPolarViewClass)
@@ -35,17 +39,27 @@ typedef struct {
     gchar           text[6];    /*!< Time string */
 } track_tick_t;
 
-/** Satellite object on graph. */
+/**
+ * Satellite object on graph.
+ *
+ * There is one object per satellite in the module, allocated when the
+ * satellites are set. Objects are not freed when the satellite sets; the
+ * visible flag is cleared and the pass and track buffers are reused for
+ * the next pass.
+ */
 typedef struct {
+    gboolean        visible;    /*!< Satellite is above the horizon. */
     gboolean        selected;   /*!< Satellite is selected. */
     gboolean        showtrack;  /*!< Show ground track. */
     gboolean        istarget;   /*!< Is this object the target. */
     pass_t         *pass;       /*!< Details of the current pass. */
     gfloat          x;          /*!< X position of marker */
     gfloat          y;          /*!< Y position of marker */
-    gchar          *nickname;   /*!< Satellite nickname for label */
-    gchar          *tooltip;    /*!< Tooltip text */
-    GSList         *track_points; /*!< List of track points (each point is two gdoubles: x,y) */
+    const gchar    *nickname;   /*!< Satellite nickname for label (owned by the sat_t) */
+    sat_t          *sat;        /*!< The satellite (owned by the module) */
+    gdouble        *track_points; /*!< Track points as x,y pairs */
+    guint           track_count; /*!< Number of points in track_points */
+    guint           track_size; /*!< Number of points allocated in track_points */
     track_tick_t    trtick[TRACK_TICK_NUM]; /*!< Time ticks along the sky track */
     gint            catnum;     /*!< Catalogue number */
 } sat_obj_t;
@@ -88,8 +102,8 @@ struct _GtkPolarView {
 
     /* Text elements */
     gchar          *curs_text;  /*!< Cursor tracking text */
-    gchar          *next_text;  /*!< Next event text */
-    gchar          *sel_text;   /*!< Selected satellite info text */
+    gchar           next_text[POLV_TEXT_SIZE]; /*!< Next event text, empty if none */
+    gchar           sel_text[POLV_TEXT_SIZE]; /*!< Selected satellite info text, empty if none */
 
     GHashTable     *showtracks_on;
     GHashTable     *showtracks_off;
@@ -103,7 +117,9 @@ struct _GtkPolarView {
     GHashTable     *sats;       /*!< Satellites. */
     qth_t          *qth;        /*!< Pointer to current location. */
 
-    GHashTable     *obj;        /*!< Satellite objects (sat_obj_t) for each visible satellite */
+    sat_obj_t      *objs;       /*!< Satellite objects, one per satellite */
+    guint           nobjs;      /*!< Number of satellite objects */
+    GHashTable     *obj;        /*!< Catalogue number -> object in objs */
 
     guint           cx;         /*!< center X */
     guint           cy;         /*!< center Y */
@@ -125,6 +141,9 @@ struct _GtkPolarView {
     gboolean        resize;     /*!< Flag indicating that the view has been resized. */
 
     gchar          *font;       /*!< Default font name */
+
+    sat_grid_t     *markers;    /*!< Marker positions of the last frame (catnum) */
+    sat_grid_t     *labels;     /*!< Labels placed in the current frame */
 };
 
 struct _GtkPolarViewClass {
@@ -140,6 +159,7 @@ void            gtk_polar_view_update(GtkWidget * widget);
 void            gtk_polar_view_reconf(GtkWidget * widget, GKeyFile * cfgdat);
 void            gtk_polar_view_reload_sats(GtkWidget * polv,
                                            GHashTable * sats);
+void            gtk_polar_view_reload_sat(GtkWidget * polv, gint catnum);
 void            gtk_polar_view_select_sat(GtkWidget * widget, gint catnum);
 void            gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj,
                                             sat_t * sat);
@@ -40,16 +40,7 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 #include <math.h>
-
-/* NETWORK */
-#ifndef WIN32
-#include <arpa/inet.h>          /* htons() */
-#include <netdb.h>              /* gethostbyname() */
-#include <netinet/in.h>         /* struct sockaddr_in */
-#include <sys/socket.h>         /* socket(), connect(), send() */
-#else
-#include <winsock2.h>
-#endif
+#include <string.h>
 
 #include "compat.h"
 #include "gpredict-utils.h"
@@ -63,54 +54,51 @@
 
 
 #define AZEL_FMTSTR "%7.2f\302\260"
-#define MAX_ERROR_COUNT 5
-#define WR_DEL 5000             /* delay in usec to wait between write and read commands */
-
-/* radio control functions */
-static void     exec_rx_cycle(GtkRigCtrl * ctrl);
-static void     exec_tx_cycle(GtkRigCtrl * ctrl);
-static void     exec_trx_cycle(GtkRigCtrl * ctrl);
-static void     exec_toggle_cycle(GtkRigCtrl * ctrl);
-static void     exec_toggle_tx_cycle(GtkRigCtrl * ctrl);
-static void     exec_duplex_cycle(GtkRigCtrl * ctrl);
-static void     exec_duplex_tx_cycle(GtkRigCtrl * ctrl);
-static void     exec_dual_rig_cycle(GtkRigCtrl * ctrl);
-static gboolean check_aos_los(GtkRigCtrl * ctrl);
-static gboolean set_freq_simplex(GtkRigCtrl * ctrl, gint sock, gdouble freq);
-static gboolean get_freq_simplex(GtkRigCtrl * ctrl, gint sock, gdouble * freq);
-static gboolean set_freq_toggle(GtkRigCtrl * ctrl, gint sock, gdouble freq);
-static gboolean set_toggle(GtkRigCtrl * ctrl, gint sock);
-static gboolean unset_toggle(GtkRigCtrl * ctrl, gint sock);
-static gboolean get_freq_toggle(GtkRigCtrl * ctrl, gint sock, gdouble * freq);
-static gboolean get_ptt(GtkRigCtrl * ctrl, gint sock);
-static gboolean set_ptt(GtkRigCtrl * ctrl, gint sock, gboolean ptt);
-
-/*  add thread for hamlib communication */
-gpointer        rigctl_run(gpointer data);
-static void     rigctrl_open(GtkRigCtrl * data);
-static void     rigctrl_close(GtkRigCtrl * data);
-static void     setconfig(gpointer data);
-static void     remove_timer(GtkRigCtrl * data);
-static void     start_timer(GtkRigCtrl * data);
+#define DOPPLER_MARGIN 120.0    /* Doppler table before AOS and after LOS [sec] */
+#define DOPPLER_STEP 1.0        /* time between Doppler table samples [sec] */
+#define DOPPLER_MAX_SAMPLES 20000
+
+/** Doppler table computed by the worker thread. */
+typedef struct {
+    GtkRigCtrl     *ctrl;       /*!< The controller; referenced. */
+    guint           seq;        /*!< ctrl->doptab_seq when queued. */
+    sat_t           sat;        /*!< Working copy of the target. */
+    qth_t           qth;        /*!< Copy of the observer location. */
+    gchar          *satname;    /*!< Name of the target. */
+    gdouble         start;      /*!< First sample (Julian date). */
+    gdouble         end;        /*!< Last sample (Julian date). */
+    doppler_table_t *tab;       /*!< The result. */
+} doptab_job_t;
 
 static GtkBoxClass *parent_class = NULL;
+static GThreadPool *doptab_pool = NULL;
+
+/* Free the configuration of a further device */
+static void clear_secondary_conf(GtkRigCtrl * ctrl, guint i)
+{
+    if (ctrl->conf2[i] == NULL)
+        return;
+
+    g_free(ctrl->conf2[i]->name);
+    g_free(ctrl->conf2[i]->host);
+    g_free(ctrl->conf2[i]);
+    ctrl->conf2[i] = NULL;
+}
 
 static void gtk_rig_ctrl_destroy(GtkWidget * widget)
 {
     GtkRigCtrl     *ctrl = GTK_RIG_CTRL(widget);
+    guint           i;
 
-    if (ctrl->rigctl_thread != NULL)
-    {
-        g_mutex_lock(&ctrl->widgetsync);
-
-        ctrl->engaged = 0;
-        setconfig(ctrl);
+    /* stop the controller and release the radio */
+    ctrl->engaged = FALSE;
+    radio_ctrl_free(ctrl->rc);
+    ctrl->rc = NULL;
 
-        /* synchronization */
-        g_cond_wait(&ctrl->widgetready, &ctrl->widgetsync);
-        g_mutex_unlock(&ctrl->widgetsync);
-        ctrl->rigctl_thread = NULL;
-    }
+    /* drop the Doppler table and any table still being computed */
+    ctrl->doptab_seq++;
+    doppler_table_free(ctrl->doptab);
+    ctrl->doptab = NULL;
 
     if (ctrl->conf != NULL)
     {
@@ -120,13 +108,8 @@ static void gtk_rig_ctrl_destroy(GtkWidget * widget)
         g_free(ctrl->conf);
         ctrl->conf = NULL;
     }
-    if (ctrl->conf2 != NULL)
-    {
-        g_free(ctrl->conf2->name);
-        g_free(ctrl->conf2->host);
-        g_free(ctrl->conf2);
-        ctrl->conf2 = NULL;
-    }
+    for (i = 0; i < RIG_CTRL_MAX_RADIOS - 1; i++)
+        clear_secondary_conf(ctrl, i);
 
     if (ctrl->trsplist != NULL)
     {
@@ -157,26 +140,24 @@ static void gtk_rig_ctrl_init(GtkRigCtrl * ctrl,
     ctrl->sats = NULL;
     ctrl->target = NULL;
     ctrl->pass = NULL;
+    ctrl->doptab = NULL;
     ctrl->qth = NULL;
     ctrl->conf = NULL;
-    ctrl->conf2 = NULL;
+    memset(ctrl->conf2, 0, sizeof(ctrl->conf2));
     ctrl->trsp = NULL;
     ctrl->trsplist = NULL;
     ctrl->trsplock = FALSE;
     ctrl->tracking = FALSE;
-    ctrl->prev_ele = 0.0;
-    ctrl->sock = 0;
-    ctrl->sock2 = 0;
-    g_mutex_init(&(ctrl->busy));
+    ctrl->dop_time = 0;
+    ctrl->dop_lead = 0;
+    ctrl->dop_jul = 0.0;
+    ctrl->latency = 0;
+    ctrl->rc = NULL;
+    ctrl->satfreq_seq = 0;
+    ctrl->resync_down = 0;
+    ctrl->resync_up = 0;
     ctrl->engaged = FALSE;
     ctrl->delay = 1000;
-    ctrl->timerid = 0;
-    ctrl->errcnt = 0;
-    ctrl->lastrxptt = FALSE;
-    ctrl->lasttxptt = TRUE;
-    ctrl->lastrxf = 0.0;
-    ctrl->lasttxf = 0.0;
-    ctrl->last_toggle_tx = -1;
 }
 
 GType gtk_rig_ctrl_get_type()
@@ -257,6 +238,270 @@ static void update_count_down(GtkRigCtrl * ctrl, gdouble t)
     g_free(aoslos);
 }
 
+/* Satellite seconds per second of the module clock; 0 when stopped */
+static gdouble time_rate(GtkRigCtrl * ctrl)
+{
+    return ctrl->module->throttle;
+}
+
+/*
+ * Predict the range rate at the time the Doppler shift is applied.
+ *
+ * The range rate is taken for the measured command-to-apply latency later,
+ * i.e. the time the radio needs to acknowledge a new frequency. The
+ * controller brings the Doppler shift forward from this update to the start
+ * of its cycle using rr_dot, so the tuning error does not grow with the
+ * cycle period. Within the Doppler table of the pass, the range rate is
+ * interpolated from the table; otherwise the target is propagated.
+ *
+ * The satellite time runs at the time throttle of the module, so the lead
+ * time and rr_dot are scaled by it; a stopped clock has no Doppler drift.
+ *
+ * rr is the range rate [km/s] and rr_dot its rate of change per second of
+ * the monotonic clock [km/s/s].
+ */
+static void predict_range_rate(GtkRigCtrl * ctrl, gdouble t, gdouble * rr,
+                               gdouble * rr_dot)
+{
+    sat_t           sat;
+    gdouble         rate = time_rate(ctrl);
+    gdouble         tl;
+
+    ctrl->dop_lead = ctrl->tracking ? MIN(ctrl->latency, MAX_DOPPLER_LEAD) : 0;
+    ctrl->dop_time = g_get_monotonic_time();
+    ctrl->dop_jul = t;
+
+    tl = t + ctrl->dop_lead * rate / (86400.0 * G_USEC_PER_SEC);
+    if (ctrl->doptab != NULL && doppler_table_get(ctrl->doptab, tl, rr, rr_dot))
+    {
+        *rr_dot *= rate;
+        return;
+    }
+
+    /* propagate a copy; the target is shared with the rest of the module */
+    memcpy(&sat, ctrl->target, sizeof(sat_t));
+
+    predict_calc(&sat, ctrl->qth, tl);
+    *rr = sat.range_rate;
+    predict_calc(&sat, ctrl->qth, tl + 1.0 / 86400.0);
+    *rr_dot = (sat.range_rate - *rr) * rate;
+}
+
+/* Drop the Doppler table, also in the radio controller */
+static void clear_doppler_table(GtkRigCtrl * ctrl)
+{
+    /* a table still being computed is for the old pass */
+    ctrl->doptab_seq++;
+    ctrl->doptab_busy = FALSE;
+
+    if (ctrl->doptab == NULL)
+        return;
+
+    doppler_table_free(ctrl->doptab);
+    ctrl->doptab = NULL;
+
+    if (ctrl->rc != NULL)
+        radio_ctrl_set_doppler_table(ctrl->rc, NULL);
+}
+
+/* Hand a computed Doppler table to the controller; runs in the main loop */
+static gboolean doppler_table_ready(gpointer data)
+{
+    doptab_job_t   *job = data;
+    GtkRigCtrl     *ctrl = job->ctrl;
+
+    if (job->seq == ctrl->doptab_seq)
+    {
+        ctrl->doptab = job->tab;
+        ctrl->doptab_busy = FALSE;
+        job->tab = NULL;
+
+        if (ctrl->rc != NULL)
+            radio_ctrl_set_doppler_table(ctrl->rc, ctrl->doptab);
+    }
+
+    doppler_table_free(job->tab);
+    g_free(job->satname);
+    g_object_unref(ctrl);
+    g_free(job);
+
+    return FALSE;
+}
+
+/* Sample the range rate of a pass; runs in the worker thread */
+static void doppler_table_worker(gpointer data, gpointer user_data)
+{
+    doptab_job_t   *job = data;
+    gdouble        *rr;
+    gdouble         step;
+    gint64          start;
+    guint           n, i;
+
+    (void)user_data;
+
+    start = g_get_monotonic_time();
+
+    /* long passes are sampled less densely instead of being cut short */
+    n = (guint) ((job->end - job->start) * secday / DOPPLER_STEP) + 1;
+    n = CLAMP(n, 2, DOPPLER_MAX_SAMPLES);
+    step = (job->end - job->start) * secday / (n - 1);
+
+    rr = g_new(gdouble, n);
+    for (i = 0; i < n; i++)
+    {
+        predict_calc(&job->sat, &job->qth, job->start + i * step / secday);
+        rr[i] = job->sat.range_rate;
+    }
+
+    job->tab = doppler_table_new(job->satname, job->start, step, rr, n);
+    g_free(rr);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Doppler table of %s computed in %.1f ms "
+                  "(%u samples)"), __func__, job->satname,
+                (g_get_monotonic_time() - start) / 1000.0, n);
+
+    g_idle_add(doppler_table_ready, job);
+}
+
+/*
+ * Compute the Doppler table of the pass.
+ *
+ * The table covers the pass from DOPPLER_MARGIN before AOS until
+ * DOPPLER_MARGIN after LOS. It is computed once the time is within it and
+ * dropped when the time leaves it, e.g. after LOS or when the time is
+ * changed in the time controller. The samples of the pass details are as
+ * far apart as the prediction resolution, which is too coarse near TCA, so
+ * the range rate is sampled every DOPPLER_STEP like the pointing schedule
+ * of the rotator, or less often if the pass would need more than
+ * DOPPLER_MAX_SAMPLES.
+ *
+ * The table is computed in a worker thread and handed to the radio
+ * controller when it is done; until then the target is propagated.
+ */
+static void update_doppler_table(GtkRigCtrl * ctrl, gdouble t)
+{
+    doptab_job_t   *job;
+    pass_t         *pass = ctrl->pass;
+
+    if (ctrl->doptab != NULL &&
+        (t < ctrl->doptab->start || t > ctrl->doptab->end))
+        clear_doppler_table(ctrl);
+
+    if (ctrl->doptab != NULL || ctrl->doptab_busy || ctrl->target == NULL ||
+        pass == NULL || t < pass->aos - DOPPLER_MARGIN / secday ||
+        t >= pass->los)
+        return;
+
+    if (doptab_pool == NULL)
+        doptab_pool = g_thread_pool_new(doppler_table_worker, NULL, 1, FALSE,
+                                        NULL);
+
+    /* copy the target and the location; both may change meanwhile */
+    job = g_new0(doptab_job_t, 1);
+    job->ctrl = g_object_ref(ctrl);
+    job->seq = ++ctrl->doptab_seq;
+    memcpy(&job->sat, ctrl->target, sizeof(sat_t));
+    memcpy(&job->qth, ctrl->qth, sizeof(qth_t));
+    job->satname = g_strdup(ctrl->target->nickname);
+    job->start = pass->aos - DOPPLER_MARGIN / secday;
+    job->end = pass->los + DOPPLER_MARGIN / secday;
+
+    ctrl->doptab_busy = TRUE;
+    g_thread_pool_push(doptab_pool, job, NULL);
+}
+
+/* Collect the input of the radio controller from the widgets */
+static void get_input(GtkRigCtrl * ctrl, radio_ctrl_input_t * input)
+{
+    memset(input, 0, sizeof(radio_ctrl_input_t));
+
+    input->tracking = ctrl->tracking;
+    input->trsplock = ctrl->trsplock;
+    input->satfreq_down =
+        gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
+    input->satfreq_up = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
+    input->satfreq_seq = ctrl->satfreq_seq;
+    input->dd = ctrl->dd;
+    input->du = ctrl->du;
+    input->dd_dot = ctrl->dd_dot;
+    input->du_dot = ctrl->du_dot;
+    input->dop_time = ctrl->dop_time;
+    input->dop_lead = ctrl->dop_lead;
+    input->jul_time = ctrl->dop_jul;
+    input->time_rate = time_rate(ctrl);
+    input->resync_down = ctrl->resync_down;
+    input->resync_up = ctrl->resync_up;
+
+    if (ctrl->target != NULL)
+    {
+        input->catnum = ctrl->target->tle.catnr;
+        input->el = ctrl->target->el;
+    }
+
+    if (ctrl->trsp != NULL)
+    {
+        input->have_trsp = TRUE;
+        input->downlow = ctrl->trsp->downlow;
+        input->downhigh = ctrl->trsp->downhigh;
+        input->uplow = ctrl->trsp->uplow;
+        input->uphigh = ctrl->trsp->uphigh;
+        input->invert = ctrl->trsp->invert;
+    }
+}
+
+/* Pass the current state of the widgets to the radio controller, if any */
+static void push_input(GtkRigCtrl * ctrl)
+{
+    radio_ctrl_input_t input;
+
+    if (ctrl->rc == NULL)
+        return;
+
+    get_input(ctrl, &input);
+    radio_ctrl_set_input(ctrl->rc, &input);
+}
+
+/* Pass satellite frequencies changed by the user to the radio controller */
+static void push_satfreq(GtkRigCtrl * ctrl)
+{
+    ctrl->satfreq_seq++;
+    push_input(ctrl);
+}
+
+/*
+ * Show the output of the radio controller.
+ *
+ * Called from the main loop after each controller cycle.
+ */
+static void rig_ctrl_notify_cb(radio_ctrl_t * rc, gpointer data)
+{
+    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
+    radio_ctrl_output_t output;
+
+    radio_ctrl_get_output(rc, &output);
+
+    gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
+                            output.rigfreq_down);
+    gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
+                            output.rigfreq_up);
+
+    /* user has changed the frequency on the radio dial */
+    if (output.dial_changed)
+    {
+        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown),
+                                output.satfreq_down);
+        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp),
+                                output.satfreq_up);
+    }
+
+    ctrl->latency = output.latency;
+
+    /* disengage device; this frees the controller */
+    if (output.failed)
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ctrl->LockBut), FALSE);
+}
+
 /*
  * Update rig control state.
  *
@@ -266,11 +511,9 @@ static void update_count_down(GtkRigCtrl * ctrl, gdouble t)
  */
 void gtk_rig_ctrl_update(GtkRigCtrl * ctrl, gdouble t)
 {
-    gdouble         satfreq;
+    gdouble         satfreq, rr, rr_dot;
     gchar          *buff;
 
-    g_mutex_lock(&ctrl->rig_ctrl_updatelock);
-
     if (ctrl->target)
     {
         buff = g_strdup_printf(AZEL_FMTSTR, ctrl->target->az);
@@ -305,16 +548,23 @@ void gtk_rig_ctrl_update(GtkRigCtrl * ctrl, gdouble t)
         gtk_label_set_text(GTK_LABEL(ctrl->SatRngRate), buff);
         g_free(buff);
 
+        /* the frequencies reach the radio some time after this update, so
+           the Doppler shift is computed for the time they are applied */
+        update_doppler_table(ctrl, t);
+        predict_range_rate(ctrl, t, &rr, &rr_dot);
+
         /* Doppler shift down */
         satfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-        ctrl->dd = -satfreq * (ctrl->target->range_rate / 299792.4580); // Hz
+        ctrl->dd = -satfreq * (rr / 299792.4580);       // Hz
+        ctrl->dd_dot = -satfreq * (rr_dot / 299792.4580);
         buff = g_strdup_printf("%.0f Hz", ctrl->dd);
         gtk_label_set_text(GTK_LABEL(ctrl->SatDopDown), buff);
         g_free(buff);
 
         /* Doppler shift up */
         satfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-        ctrl->du = satfreq * (ctrl->target->range_rate / 299792.4580);  // Hz
+        ctrl->du = satfreq * (rr / 299792.4580);        // Hz
+        ctrl->du_dot = satfreq * (rr_dot / 299792.4580);
         buff = g_strdup_printf("%.0f Hz", ctrl->du);
         gtk_label_set_text(GTK_LABEL(ctrl->SatDopUp), buff);
         g_free(buff);
@@ -335,7 +585,7 @@ void gtk_rig_ctrl_update(GtkRigCtrl * ctrl, gdouble t)
         }
     }
 
-    g_mutex_unlock(&ctrl->rig_ctrl_updatelock);
+    push_input(ctrl);
 }
 
 
@@ -421,6 +671,8 @@ static void downlink_changed_cb(GtkFreqKnob * knob, gpointer data)
 
     if (ctrl->trsplock)
         track_downlink(ctrl);
+
+    push_satfreq(ctrl);
 }
 
 static void uplink_changed_cb(GtkFreqKnob * knob, gpointer data)
@@ -431,6 +683,8 @@ static void uplink_changed_cb(GtkFreqKnob * knob, gpointer data)
 
     if (ctrl->trsplock)
         track_uplink(ctrl);
+
+    push_satfreq(ctrl);
 }
 
 /*
@@ -663,8 +917,7 @@ static void sat_selected_cb(GtkComboBox * satsel, gpointer data)
     if (i >= 0)
     {
         ctrl->target = SAT(g_slist_nth_data(ctrl->sats, i));
-
-        ctrl->prev_ele = ctrl->target->el;
+        clear_doppler_table(ctrl);
 
         /* update next pass */
         if (ctrl->pass != NULL)
@@ -673,6 +926,7 @@ static void sat_selected_cb(GtkComboBox * satsel, gpointer data)
 
         /* read transponders for new target */
         load_trsp_list(ctrl);
+        push_input(ctrl);
     }
     else
     {
@@ -686,6 +940,7 @@ static void sat_selected_cb(GtkComboBox * satsel, gpointer data)
             free_pass(ctrl->pass);
             ctrl->pass = NULL;
         }
+        clear_doppler_table(ctrl);
     }
 }
 
@@ -720,7 +975,7 @@ static void trsp_tune_cb(GtkButton * button, gpointer data)
         gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown), freq);
 
         /* invalidate RIG<->GPREDICT sync */
-        ctrl->lastrxf = 0.0;
+        ctrl->resync_down++;
     }
 
     /* tune uplink */
@@ -731,8 +986,10 @@ static void trsp_tune_cb(GtkButton * button, gpointer data)
         gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp), freq);
 
         /* invalidate RIG<->GPREDICT sync */
-        ctrl->lasttxf = 0.0;
+        ctrl->resync_up++;
     }
+
+    push_satfreq(ctrl);
 }
 
 /*
@@ -751,6 +1008,7 @@ static void trsp_selected_cb(GtkComboBox * box, gpointer data)
     {
         /* clear transponder data */
         ctrl->trsp = NULL;
+        push_input(ctrl);
     }
     else if (i < n)
     {
@@ -785,6 +1043,8 @@ static void trsp_lock_cb(GtkToggleButton * button, gpointer data)
     /* set uplink according to downlink */
     if (ctrl->trsplock)
         track_downlink(ctrl);
+
+    push_satfreq(ctrl);
 }
 
 static void track_toggle_cb(GtkToggleButton * button, gpointer data)
@@ -794,8 +1054,9 @@ static void track_toggle_cb(GtkToggleButton * button, gpointer data)
     ctrl->tracking = gtk_toggle_button_get_active(button);
 
     /* invalidate sync with radio */
-    ctrl->lastrxf = 0.0;
-    ctrl->lasttxf = 0.0;
+    ctrl->resync_down++;
+    ctrl->resync_up++;
+    push_input(ctrl);
 }
 
 /* Called when the user changes the value of the cycle delay */
@@ -807,8 +1068,50 @@ static void delay_changed_cb(GtkSpinButton * spin, gpointer data)
     if (ctrl->conf)
         ctrl->conf->cycle = ctrl->delay;
 
-    if (ctrl->engaged)
-        start_timer(ctrl);
+    if (ctrl->rc != NULL)
+        radio_ctrl_set_cycle(ctrl->rc, ctrl->delay);
+}
+
+/* Called when the user changes the Doppler tolerance */
+static void tolerance_changed_cb(GtkSpinButton * spin, gpointer data)
+{
+    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
+    gdouble         tolerance = gtk_spin_button_get_value(spin);
+
+    if (ctrl->conf)
+        ctrl->conf->tolerance = tolerance;
+
+    if (ctrl->rc != NULL)
+        radio_ctrl_set_tolerance(ctrl->rc, tolerance);
+}
+
+/*
+ * Show the uplink LO.
+ *
+ * This is the LO of the first further device that is not a receiver, or
+ * that of the primary device if there is none.
+ */
+static void update_uplink_lo(GtkRigCtrl * ctrl)
+{
+    radio_conf_t   *conf = ctrl->conf;
+    gchar          *buff;
+    guint           i;
+
+    for (i = 0; i < RIG_CTRL_MAX_RADIOS - 1; i++)
+    {
+        if (ctrl->conf2[i] != NULL && ctrl->conf2[i]->type != RIG_TYPE_RX)
+        {
+            conf = ctrl->conf2[i];
+            break;
+        }
+    }
+
+    if (conf == NULL)
+        return;
+
+    buff = g_strdup_printf(_("%.0f MHz"), conf->loup / 1.0e6);
+    gtk_label_set_text(GTK_LABEL(ctrl->LoUp), buff);
+    g_free(buff);
 }
 
 static void primary_rig_selected_cb(GtkComboBox * box, gpointer data)
@@ -846,18 +1149,14 @@ static void primary_rig_selected_cb(GtkComboBox * box, gpointer data)
 
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(ctrl->cycle_spin),
                                   ctrl->conf->cycle);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(ctrl->tol_spin),
+                                  ctrl->conf->tolerance);
 
         /* update LO widgets */
         buff = g_strdup_printf(_("%.0f MHz"), ctrl->conf->lo / 1.0e6);
         gtk_label_set_text(GTK_LABEL(ctrl->LoDown), buff);
         g_free(buff);
-        /* uplink LO only if single device */
-        if (ctrl->conf2 == NULL)
-        {
-            buff = g_strdup_printf(_("%.0f MHz"), ctrl->conf->loup / 1.0e6);
-            gtk_label_set_text(GTK_LABEL(ctrl->LoUp), buff);
-            g_free(buff);
-        }
+        update_uplink_lo(ctrl);
     }
     else
     {
@@ -876,101 +1175,89 @@ static void primary_rig_selected_cb(GtkComboBox * box, gpointer data)
 static void secondary_rig_selected_cb(GtkComboBox * box, gpointer data)
 {
     GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
-    gchar          *buff;
-    gchar          *name1, *name2;
+    radio_conf_t   *conf;
+    gchar          *name, *other;
+    gboolean        dup;
+    guint           i, j;
+
+    for (i = 0; i < RIG_CTRL_MAX_RADIOS - 1; i++)
+        if (GTK_WIDGET(box) == ctrl->DevSel2[i])
+            break;
 
+    if (i == RIG_CTRL_MAX_RADIOS - 1)
+        return;
 
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s:%s: Secondary device selected: %d"),
-                __FILE__, __func__, gtk_combo_box_get_active(box));
+                _("%s:%s: Device %u selected: %d"),
+                __FILE__, __func__, i + 2, gtk_combo_box_get_active(box));
 
-    if (ctrl->conf2 != NULL)
-    {
-        g_free(ctrl->conf2->name);
-        g_free(ctrl->conf2->host);
-        g_free(ctrl->conf2);
-        ctrl->conf2 = NULL;
-    }
+    clear_secondary_conf(ctrl, i);
 
-    if (gtk_combo_box_get_active(box) == 0)
+    if (gtk_combo_box_get_active(box) <= 0)
     {
         /* first entry is "None" */
-
-        /* reset uplink LO to what's in ctrl->conf */
-        if (ctrl->conf != NULL)
-        {
-            buff = g_strdup_printf(_("%.0f MHz"), ctrl->conf->loup / 1.0e6);
-            gtk_label_set_text(GTK_LABEL(ctrl->LoUp), buff);
-            g_free(buff);
-        }
-
+        update_uplink_lo(ctrl);
         return;
     }
 
-    /* ensure that selected secondary rig is not the same as the primary */
-    name1 =
+    /* ensure that the selected rig is not used by another device */
+    name = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(box));
+    other =
         gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(ctrl->DevSel));
-    name2 =
-        gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(ctrl->DevSel2));
-    if (!g_strcmp0(name1, name2))
+    dup = !g_strcmp0(name, other);
+    g_free(other);
+    for (j = 0; j < RIG_CTRL_MAX_RADIOS - 1 && !dup; j++)
+        dup = (j != i && ctrl->conf2[j] != NULL &&
+               !g_strcmp0(name, ctrl->conf2[j]->name));
+
+    if (dup)
     {
-        /* selected conf is the same as the primary one */
-        g_free(name1);
-        g_free(name2);
-        if (ctrl->conf != NULL)
-        {
-            buff = g_strdup_printf(_("%.0f MHz"), ctrl->conf->loup / 1.0e6);
-            gtk_label_set_text(GTK_LABEL(ctrl->LoUp), buff);
-            g_free(buff);
-        }
-        gtk_combo_box_set_active(GTK_COMBO_BOX(ctrl->DevSel2), 0);
+        /* resets this device through the callback */
+        g_free(name);
+        gtk_combo_box_set_active(box, 0);
 
         return;
     }
 
-    g_free(name1);
-    g_free(name2);
-
     /* else load new device */
-    ctrl->conf2 = g_try_new(radio_conf_t, 1);
-    if (ctrl->conf2 == NULL)
+    conf = g_try_new(radio_conf_t, 1);
+    if (conf == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s:%s: Failed to allocate memory for radio config"),
                     __FILE__, __func__);
+        g_free(name);
         return;
     }
 
     /* load new configuration */
-    ctrl->conf2->name =
-        gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(box));
-    if (radio_conf_read(ctrl->conf2))
+    conf->name = name;
+    if (radio_conf_read(conf))
     {
         sat_log_log(SAT_LOG_LEVEL_INFO,
                     _("%s:%s: Loaded new radio configuration %s"),
-                    __FILE__, __func__, ctrl->conf2->name);
+                    __FILE__, __func__, conf->name);
 
-        buff = g_strdup_printf(_("%.0f MHz"), ctrl->conf2->loup / 1.0e6);
-        gtk_label_set_text(GTK_LABEL(ctrl->LoUp), buff);
-        g_free(buff);
+        ctrl->conf2[i] = conf;
+        update_uplink_lo(ctrl);
     }
     else
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s:%s: Failed to load radio configuration %s"),
-                    __FILE__, __func__, ctrl->conf->name);
+                    __FILE__, __func__, conf->name);
 
-        g_free(ctrl->conf2->name);
-        if (ctrl->conf2->host)
-            g_free(ctrl->conf2->host);
-        g_free(ctrl->conf2);
-        ctrl->conf2 = NULL;
+        g_free(conf->name);
+        if (conf->host)
+            g_free(conf->host);
+        g_free(conf);
     }
 }
 
 static void rig_engaged_cb(GtkToggleButton * button, gpointer data)
 {
     GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
+    guint           i;
 
     if (ctrl->conf == NULL)
     {
@@ -983,27 +1270,39 @@ static void rig_engaged_cb(GtkToggleButton * button, gpointer data)
 
     if (!gtk_toggle_button_get_active(button))
     {
-        /* close socket */
         gtk_widget_set_sensitive(ctrl->DevSel, TRUE);
-        gtk_widget_set_sensitive(ctrl->DevSel2, TRUE);
+        for (i = 0; i < RIG_CTRL_MAX_RADIOS - 1; i++)
+            gtk_widget_set_sensitive(ctrl->DevSel2[i], TRUE);
         ctrl->engaged = FALSE;
 
-        /*  stop worker thread... */
-        setconfig(ctrl);
-        ctrl->rigctl_thread = NULL;
+        /* stop the controller and release the radio */
+        radio_ctrl_free(ctrl->rc);
+        ctrl->rc = NULL;
     }
-    else
+    else if (ctrl->rc == NULL)
     {
+        radio_ctrl_input_t input;
+        const radio_conf_t *confs[RIG_CTRL_MAX_RADIOS];
+        guint           n = 0;
+
         gtk_widget_set_sensitive(ctrl->DevSel, FALSE);
-        gtk_widget_set_sensitive(ctrl->DevSel2, FALSE);
+        for (i = 0; i < RIG_CTRL_MAX_RADIOS - 1; i++)
+            gtk_widget_set_sensitive(ctrl->DevSel2[i], FALSE);
         ctrl->engaged = TRUE;
 
-        /*  start worker thread... */
-        ctrl->rigctlq = g_async_queue_new();
-        ctrl->rigctl_thread = g_thread_new("rigctl_run", rigctl_run, ctrl);
-        setconfig(ctrl);
+        /* the primary device comes first */
+        confs[n++] = ctrl->conf;
+        for (i = 0; i < RIG_CTRL_MAX_RADIOS - 1; i++)
+            if (ctrl->conf2[i] != NULL)
+                confs[n++] = ctrl->conf2[i];
+
+        /* start the controller; it runs in its own thread */
+        ctrl->conf->cycle = ctrl->delay;
+        get_input(ctrl, &input);
+        ctrl->rc = radio_ctrl_new(confs, n, &input, rig_ctrl_notify_cb, ctrl);
+        if (ctrl->doptab != NULL)
+            radio_ctrl_set_doppler_table(ctrl->rc, ctrl->doptab);
     }
-    ctrl->conf2 = NULL;
 }
 
 static GtkWidget *create_target_widgets(GtkRigCtrl * ctrl)
@@ -1140,43 +1439,6 @@ static GtkWidget *create_target_widgets(GtkRigCtrl * ctrl)
     return frame;
 }
 
-static gboolean is_rig_tx_capable(const gchar * confname)
-{
-    radio_conf_t   *conf = NULL;
-    gboolean        cantx = FALSE;
-
-    conf = g_try_new(radio_conf_t, 1);
-    if (conf == NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: Failed to allocate memory for radio config"),
-                    __FILE__, __LINE__);
-        return FALSE;
-    }
-
-    /* load new configuration */
-    conf->name = g_strdup(confname);
-    if (radio_conf_read(conf))
-    {
-        cantx = (conf->type == RIG_TYPE_RX) ? FALSE : TRUE;
-    }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: Error reading radio configuration %s"),
-                    __FILE__, __LINE__, confname);
-
-        cantx = FALSE;
-    }
-
-    g_free(conf->name);
-    if (conf->host)
-        g_free(conf->host);
-    g_free(conf);
-
-    return cantx;
-}
-
 /* Sort the list of satellites in the combo box. */
 static gint sat_name_compare(sat_t * a, sat_t * b)
 {
@@ -1197,7 +1459,9 @@ static GtkWidget *create_conf_widgets(GtkRigCtrl * ctrl)
     gchar          *dirname;    /* directory name */
     gchar         **vbuff;
     const gchar    *filename;   /* file name */
-    gchar          *rigname;
+    GSList         *rigs = NULL, *l;
+    gchar          *buff;
+    guint           i;
 
 
     table = gtk_grid_new();
@@ -1214,8 +1478,8 @@ static GtkWidget *create_conf_widgets(GtkRigCtrl * ctrl)
     gtk_widget_set_tooltip_text(ctrl->DevSel,
                                 _("Select primary radio device."
                                   "This device will be used for downlink and "
-                                  "uplink unless you select a secondary device"
-                                  " for uplink"));
+                                  "uplink unless you select further devices "
+                                  "for them"));
 
     /* open configuration directory */
     dirname = get_hwconf_dir();
@@ -1224,10 +1488,6 @@ static GtkWidget *create_conf_widgets(GtkRigCtrl * ctrl)
     if (dir)
     {
         /* read each .rig file */
-        GSList         *rigs = NULL;
-        gint            i;
-        gint            n;
-
         while ((filename = g_dir_read_name(dir)))
         {
             if (g_str_has_suffix(filename, ".rig"))
@@ -1238,18 +1498,9 @@ static GtkWidget *create_conf_widgets(GtkRigCtrl * ctrl)
                 g_strfreev(vbuff);
             }
         }
-        n = g_slist_length(rigs);
-        for (i = 0; i < n; i++)
-        {
-            rigname = g_slist_nth_data(rigs, i);
-            if (rigname)
-            {
-                gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT
-                                               (ctrl->DevSel), rigname);
-                g_free(rigname);
-            }
-        }
-        g_slist_free(rigs);
+        for (l = rigs; l != NULL; l = l->next)
+            gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT
+                                           (ctrl->DevSel), l->data);
     }
     else
     {
@@ -1266,54 +1517,38 @@ static GtkWidget *create_conf_widgets(GtkRigCtrl * ctrl)
                      G_CALLBACK(primary_rig_selected_cb), ctrl);
     gtk_grid_attach(GTK_GRID(table), ctrl->DevSel, 1, 0, 1, 1);
 
-    /* Secondary device */
-    label = gtk_label_new(_("2. Device:"));
-    g_object_set(label, "xalign", 1.0f, "yalign", 0.5f, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 0, 1, 1, 1);
-
-    ctrl->DevSel2 = gtk_combo_box_text_new();
-    gtk_widget_set_tooltip_text(ctrl->DevSel2,
-                                _("Select secondary radio device\n"
-                                  "This device will be used for uplink"));
-
-    /* load config */
-    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(ctrl->DevSel2),
-                                   _("None"));
-    gtk_combo_box_set_active(GTK_COMBO_BOX(ctrl->DevSel2), 0);
-
-    dir = g_dir_open(dirname, 0, &error);
-    if (dir)
-    {
-        /* read each .rig file */
-        while ((filename = g_dir_read_name(dir)))
-        {
-            if (g_str_has_suffix(filename, ".rig"))
-            {
-                /* only add TX capable rigs */
-                vbuff = g_strsplit(filename, ".rig", 0);
-                if (is_rig_tx_capable(vbuff[0]))
-                {
-                    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT
-                                                   (ctrl->DevSel2), vbuff[0]);
-                }
-                g_strfreev(vbuff);
-            }
-        }
-    }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: Failed to open hwconf dir (%s)"),
-                    __FILE__, __LINE__, error->message);
-        g_clear_error(&error);
-    }
-
     g_free(dirname);
-    g_dir_close(dir);
 
-    g_signal_connect(ctrl->DevSel2, "changed",
-                     G_CALLBACK(secondary_rig_selected_cb), ctrl);
-    gtk_grid_attach(GTK_GRID(table), ctrl->DevSel2, 1, 1, 1, 1);
+    /* further devices */
+    for (i = 0; i < RIG_CTRL_MAX_RADIOS - 1; i++)
+    {
+        buff = g_strdup_printf(_("%u. Device:"), i + 2);
+        label = gtk_label_new(buff);
+        g_free(buff);
+        g_object_set(label, "xalign", 1.0f, "yalign", 0.5f, NULL);
+        gtk_grid_attach(GTK_GRID(table), label, 0, i + 1, 1, 1);
+
+        ctrl->DevSel2[i] = gtk_combo_box_text_new();
+        gtk_widget_set_tooltip_text(ctrl->DevSel2[i],
+                                    _("Select a further radio device\n"
+                                      "Receivers are used for the downlink "
+                                      "and transmitters for the uplink. Other "
+                                      "devices take over the link that no "
+                                      "receiver or transmitter is selected "
+                                      "for."));
+
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(ctrl->DevSel2[i]),
+                                       _("None"));
+        for (l = rigs; l != NULL; l = l->next)
+            gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT
+                                           (ctrl->DevSel2[i]), l->data);
+        gtk_combo_box_set_active(GTK_COMBO_BOX(ctrl->DevSel2[i]), 0);
+
+        g_signal_connect(ctrl->DevSel2[i], "changed",
+                         G_CALLBACK(secondary_rig_selected_cb), ctrl);
+        gtk_grid_attach(GTK_GRID(table), ctrl->DevSel2[i], 1, i + 1, 1, 1);
+    }
+    g_slist_free_full(rigs, g_free);
 
     /* Engage button */
     ctrl->LockBut = gtk_toggle_button_new_with_label(_("Engage"));
@@ -1326,7 +1561,8 @@ static GtkWidget *create_conf_widgets(GtkRigCtrl * ctrl)
     /* cycle period */
     label = gtk_label_new(_("Cycle:"));
     g_object_set(label, "xalign", 1.0f, "yalign", 0.5f, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 0, 3, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 0,
+                    RIG_CTRL_MAX_RADIOS, 1, 1);
 
     ctrl->cycle_spin = gtk_spin_button_new_with_range(10, 10000, 10);
     gtk_spin_button_set_digits(GTK_SPIN_BUTTON(ctrl->cycle_spin), 0);
@@ -1335,11 +1571,37 @@ static GtkWidget *create_conf_widgets(GtkRigCtrl * ctrl)
                                   "commands sent to the rig."));
     g_signal_connect(ctrl->cycle_spin, "value-changed",
                      G_CALLBACK(delay_changed_cb), ctrl);
-    gtk_grid_attach(GTK_GRID(table), ctrl->cycle_spin, 1, 3, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), ctrl->cycle_spin, 1,
+                    RIG_CTRL_MAX_RADIOS, 1, 1);
 
     label = gtk_label_new(_("msec"));
     g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 2, 3, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 2,
+                    RIG_CTRL_MAX_RADIOS, 1, 1);
+
+    /* Doppler tolerance */
+    label = gtk_label_new(_("Tolerance:"));
+    g_object_set(label, "xalign", 1.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0,
+                    RIG_CTRL_MAX_RADIOS + 1, 1, 1);
+
+    ctrl->tol_spin = gtk_spin_button_new_with_range(0, 5000, 10);
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(ctrl->tol_spin), 0);
+    gtk_widget_set_tooltip_text(ctrl->tol_spin,
+                                _("Doppler tuning error allowed before a new "
+                                  "frequency is sent to the rig. Commands are "
+                                  "sent when the error reaches it, but never "
+                                  "more often than the cycle. Use 0 to send "
+                                  "every change of 1 Hz."));
+    g_signal_connect(ctrl->tol_spin, "value-changed",
+                     G_CALLBACK(tolerance_changed_cb), ctrl);
+    gtk_grid_attach(GTK_GRID(table), ctrl->tol_spin, 1,
+                    RIG_CTRL_MAX_RADIOS + 1, 1, 1);
+
+    label = gtk_label_new(_("Hz"));
+    g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 2,
+                    RIG_CTRL_MAX_RADIOS + 1, 1, 1);
 
     frame = gtk_frame_new(_("Settings"));
     gtk_container_add(GTK_CONTAINER(frame), table);
@@ -1386,1349 +1648,37 @@ static void store_sats(gpointer key, gpointer value, gpointer user_data)
                                        (GCompareFunc) sat_name_compare);
 }
 
-static gboolean _send_rigctld_command(GtkRigCtrl * ctrl, gint sock,
-                                      gchar * buff, gchar * buffout,
-                                      gint sizeout)
+/*
+ * Catch events when the user presses the SPACE key on the keyboard.
+ * This is used to toggle betweer RX/TX when using FT817/857/897 in manual mode.
+ */
+static gboolean key_press_cb(GtkWidget * widget, GdkEventKey * pKey,
+                             gpointer data)
 {
-    gint            written;
-    gint            size;
+    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(widget);
+    gboolean        event_managed = FALSE;
 
-    size = strlen(buff);
+    (void)data;
 
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s:%s: sending %d bytes to rigctld as \"%s\""),
-                __FILE__, __func__, size, buff);
-    /* send command */
-    written = send(sock, buff, strlen(buff), 0);
-    if (written != size)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: SIZE ERROR %d / %d"), __func__, written, size);
-    }
-    if (written == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: rigctld port closed"), __func__);
-        return FALSE;
-    }
-    /* try to read answer */
-    size = recv(sock, buffout, sizeout - 1, 0);
-    if (size == -1)
+    if (pKey->type == GDK_KEY_PRESS)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: rigctld port closed"), __func__);
-        return FALSE;
-    }
-
-    buffout[size] = '\0';
-    if (size == 0)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%s: Got 0 bytes from rigctld"), __FILE__, __func__);
-    }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                    _("%s:%s: Read %d bytes from rigctld"),
-                    __FILE__, __func__, size);
-    }
-    ctrl->wrops++;
-
-    return TRUE;
-}
-
-static gboolean send_rigctld_command(GtkRigCtrl * ctrl, gint sock,
-                                     gchar * buff, gchar * buffout,
-                                     gint sizeout)
-{
-    gboolean        retval;
-
-    /* Enter critical section! */
-    g_mutex_lock(&ctrl->writelock);
-
-    retval = _send_rigctld_command(ctrl, sock, buff, buffout, sizeout);
-
-    /* Leave critical section! */
-    g_mutex_unlock(&ctrl->writelock);
-    return (retval);
-}
-
-static inline gboolean check_set_response(gchar * buffback, gboolean retcode,
-                                          const gchar * function)
-{
-    if (retcode == TRUE)
-    {
-        if (strncmp(buffback, "RPRT 0", 6) != 0)
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%s: %s rigctld returned error (%s)"),
-                        __FILE__, __func__, function, buffback);
-
-            retcode = FALSE;
-        }
-    }
-
-    return retcode;
-}
-
-static inline gboolean check_get_response(gchar * buffback, gboolean retcode,
-                                          const gchar * function)
-{
-    if (retcode == TRUE)
-    {
-        if (strncmp(buffback, "RPRT", 4) == 0)
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%s: %s rigctld returned error (%s)"),
-                        __FILE__, __func__, function, buffback);
-
-            retcode = FALSE;
-        }
-    }
-
-    return retcode;
-}
-
-static int get_vfos(GtkRigCtrl * ctrl, char *rx, char *tx)
-{
-    // fill rx/tx with vfo name plus space if not empty
-    rx = tx = "";
-    switch (ctrl->conf->vfoUp)
-    {
-    case VFO_A:
-        if (ctrl->conf->vfo_opt)
-            {rx = "VFOB ";tx = "VFOA ";}
-        break;
-
-    case VFO_B:
-        if (ctrl->conf->vfo_opt)
-           {rx = "VFOA ";tx = "VFOB ";}
-        break;
-
-    case VFO_MAIN:
-        if (ctrl->conf->vfo_opt)
-            {rx = "Sub";tx = "Main";}
-        break;
-
-    case VFO_SUB:
-        if (ctrl->conf->vfo_opt)
-            {rx = "Main";tx = "Sub";}
-        break;
-
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s called but TX VFO is %d and we don't know how to handle it."), __func__,
-                    ctrl->conf->vfoUp);
-        return 1;
-    }
-    sat_log_log(SAT_LOG_LEVEL_DEBUG, "rx=%x, tx=%s\n", rx, tx);
-    return 0;
-}
-
-/* Setup VFOs for split operation (simplex or duplex) */
-static gboolean setup_split(GtkRigCtrl * ctrl)
-{
-    gchar          *buff;
-    gchar           buffback[256];
-    gboolean        retcode;
-    gchar          *rx="", *tx="";
-
-    get_vfos(ctrl, rx, tx);
-    switch (ctrl->conf->vfoUp)
-    {
-    case VFO_A:
-        if (ctrl->conf->vfo_opt)
-            buff = g_strdup("S VFOB 1 VFOA\x0a");
-        else
-            buff = g_strdup("S 1 VFOA\x0a");
-        break;
-
-    case VFO_B:
-        if (ctrl->conf->vfo_opt)
-            buff = g_strdup("S VFOA 1 VFOB\x0a");
-        else
-            buff = g_strdup("S 1 VFOB\x0a");
-        break;
-
-    case VFO_MAIN:
-        if (ctrl->conf->vfo_opt)
-            buff = g_strdup("S Sub 1 Main\x0a");
-        else
-            buff = g_strdup("S 1 Main\x0a");
-        break;
-
-    case VFO_SUB:
-        if (ctrl->conf->vfo_opt)
-            buff = g_strdup("S Main 1 Sub\x0a");
-        else
-            buff = g_strdup("S 1 Sub\x0a");
-        break;
-
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s called but TX VFO is %d."), __func__,
-                    ctrl->conf->vfoUp);
-        return FALSE;
-    }
-
-    retcode = send_rigctld_command(ctrl, ctrl->sock, buff, buffback, 128);
-    g_free(buff);
-
-    return (check_set_response(buffback, retcode, __func__));
-}
-
-static gboolean rig_ctrl_timeout_cb(gpointer data)
-{
-    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
-
-    if (ctrl->conf == NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Controller does not have a valid configuration"),
-                    __func__);
-        return FALSE;
-    }
-
-    if (g_mutex_trylock(&(ctrl->busy)) == FALSE)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s missed the deadline"),
-                    __func__);
-        return TRUE;
-    }
-
-    setconfig(ctrl);
-    g_mutex_unlock(&(ctrl->busy));
-
-    return TRUE;
-}
-
-static void exec_rx_cycle(GtkRigCtrl * ctrl)
-{
-    gdouble         readfreq = 0.0, tmpfreq, satfreqd, satfrequ;
-    gboolean        ptt = FALSE;
-
-    /* get PTT status */
-    if (ctrl->engaged && ctrl->conf->ptt)
-        ptt = get_ptt(ctrl, ctrl->sock);
-
-    /* Dial feedback:
-       If radio device is engaged read frequency from radio and compare it to the
-       last set frequency. If different, it means that user has changed frequency
-       on the radio dial => update transponder knob
-
-       Note: If ctrl->lastrxf = 0.0 the sync has been invalidated (e.g. user pressed "tune")
-       and no need to execute the dial feedback.
-     */
-    if ((ctrl->engaged) && (ctrl->lastrxf > 0.0) && (ptt == FALSE))
-    {
-        if (!get_freq_simplex(ctrl, ctrl->sock, &readfreq))
-        {
-            /* error => use a passive value */
-            ctrl->errcnt++;
-        }
-        else if (fabs(readfreq - ctrl->lastrxf) >= 1.0)
-        {
-            /* user might have altered radio frequency => update transponder knob */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                    readfreq);
-            ctrl->lastrxf = readfreq;
-
-            /* doppler shift; only if we are tracking */
-            if (ctrl->tracking)
-            {
-                satfreqd = (readfreq - ctrl->dd + ctrl->conf->lo);
-            }
-            else
-            {
-                satfreqd = readfreq + ctrl->conf->lo;
-            }
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown),
-                                    satfreqd);
-
-            /* Update uplink if locked to downlink */
-            if (ctrl->trsplock)
-            {
-                track_downlink(ctrl);
-            }
-
-            /* no need to forward track */
-            return;
-        }
-    }
-
-    /* now, forward tracking */
-
-    /* If we are tracking, calculate the radio freq by applying both dopper shift
-       and tranverter LO frequency. If we are not tracking, apply only LO frequency.
-     */
-    satfreqd = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-    satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-    if (ctrl->tracking)
-    {
-        /* downlink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd + ctrl->dd - ctrl->conf->lo);
-        /* uplink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ + ctrl->du - ctrl->conf->loup);
-    }
-    else
-    {
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd - ctrl->conf->lo);
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ - ctrl->conf->loup);
-    }
-
-    tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqDown));
-
-    /* if device is engaged, send freq command to radio */
-    if ((ctrl->engaged) && (ptt == FALSE) &&
-        (fabs(ctrl->lastrxf - tmpfreq) >= 1.0))
-    {
-        if (set_freq_simplex(ctrl, ctrl->sock, tmpfreq))
-        {
-            /* reset error counter */
-            ctrl->errcnt = 0;
-
-            /* give radio a chance to set frequency */
-            g_usleep(WR_DEL);
-
-            /* The actual frequency might be different from what we have set because
-               the tuning step is larger than what we work with (e.g. FT-817 has a
-               smallest tuning step of 10 Hz). Therefore we read back the actual
-               frequency from the rig. */
-            get_freq_simplex(ctrl, ctrl->sock, &tmpfreq);
-            ctrl->lastrxf = tmpfreq;
-
-            /* This is only effective in RIG_TYPE_TRX mode.
-               Invalidate ctrl->lasttxf for two reasons.
-
-               1. Prevent dial feedback from changing the uplink frequency.
-               In the first TX cycle get_freq_simplex() returns the downlink
-               frequency instead of uplink. The mismatch would thus trigger
-               an uplink update as long as the VFO has not been updated.
-               2. Force updating the VFO in the first TX cycle.
-             */
-            if (ctrl->lastrxptt != ptt)
-                ctrl->lasttxf = 0.0;
-        }
-        else
-        {
-            ctrl->errcnt++;
-        }
-    }
-
-    /* Remember PTT state, to avoid misinterpreting VFO changes as dial
-       feedback during TX to RX transitions.
-     */
-    ctrl->lastrxptt = ptt;
-}
-
-static void exec_tx_cycle(GtkRigCtrl * ctrl)
-{
-    gdouble         readfreq = 0.0, tmpfreq, satfreqd, satfrequ;
-    gboolean        ptt = TRUE;
-
-    /* get PTT status */
-    if (ctrl->engaged && ctrl->conf->ptt)
-    {
-        ptt = get_ptt(ctrl, ctrl->sock);
-    }
-
-    /* Dial feedback:
-       If radio device is engaged read frequency from radio and compare it to the
-       last set frequency. If different, it means that user has changed frequency
-       on the radio dial => update transponder knob
-
-       Note: If ctrl->lasttxf = 0.0 the sync has been invalidated (e.g. user pressed "tune")
-       and no need to execute the dial feedback.
-     */
-    if ((ctrl->engaged) && (ctrl->lasttxf > 0.0) && (ptt == TRUE))
-    {
-        if (!get_freq_simplex(ctrl, ctrl->sock, &readfreq))
-        {
-            /* error => use a passive value */
-            ctrl->errcnt++;
-        }
-        else if (fabs(readfreq - ctrl->lasttxf) >= 1.0)
-        {
-            /* user might have altered radio frequency => update transponder knob */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp), readfreq);
-            ctrl->lasttxf = readfreq;
-
-            /* doppler shift; only if we are tracking */
-            if (ctrl->tracking)
-            {
-                satfrequ = readfreq - ctrl->du + ctrl->conf->loup;
-            }
-            else
-            {
-                satfrequ = readfreq + ctrl->conf->loup;
-            }
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp), satfrequ);
-
-            /* Follow with downlink if transponder is locked */
-            if (ctrl->trsplock)
-            {
-                track_uplink(ctrl);
-            }
-
-            /* no need to forward track */
-            return;
-        }
-    }
-
-    /* now, forward tracking */
-
-    /* If we are tracking, calculate the radio freq by applying both dopper shift
-       and tranverter LO frequency. If we are not tracking, apply only LO frequency.
-     */
-    satfreqd = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-    satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-    if (ctrl->tracking)
-    {
-        /* downlink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd + ctrl->dd - ctrl->conf->lo);
-        /* uplink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ + ctrl->du - ctrl->conf->loup);
-    }
-    else
-    {
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd - ctrl->conf->lo);
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ - ctrl->conf->loup);
-    }
-
-    tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
-
-    /* if device is engaged, send freq command to radio */
-    if ((ctrl->engaged) && (ptt == TRUE) &&
-        (fabs(ctrl->lasttxf - tmpfreq) >= 1.0))
-    {
-        if (set_freq_simplex(ctrl, ctrl->sock, tmpfreq))
-        {
-            /* reset error counter */
-            ctrl->errcnt = 0;
-
-            /* give radio a chance to set frequency */
-            g_usleep(WR_DEL);
-
-            /* The actual frequency migh be different from what we have set because
-               the tuning step is larger than what we work with (e.g. FT-817 has a
-               smallest tuning step of 10 Hz). Therefore we read back the actual
-               frequency from the rig. */
-            get_freq_simplex(ctrl, ctrl->sock, &tmpfreq);
-            ctrl->lasttxf = tmpfreq;
-
-            /* This is only effective in RIG_TYPE_TRX mode.
-               Invalidate ctrl->lastrxf for two reasons.
-
-               1. Prevent dial feedback from changing the downlink frequency.
-               In the first RX cycle get_freq_simplex() returns the uplink
-               frequency instead of downlink. The mismatch would thus
-               trigger a downlink update as long as the VFO has not been
-               updated.
-               2. Force updating the VFO in the first RX cycle.
-             */
-            if (ctrl->lasttxptt != ptt)
-                ctrl->lastrxf = 0.0;
-        }
-        else
-        {
-            ctrl->errcnt++;
-        }
-    }
-
-    /* Remember PTT state, to avoid misinterpreting VFO changes as dial
-       feedback during RX to TX transitions.
-     */
-    ctrl->lasttxptt = ptt;
-}
-
-static void exec_trx_cycle(GtkRigCtrl * ctrl)
-{
-    exec_rx_cycle(ctrl);
-    exec_tx_cycle(ctrl);
-}
-
-static void exec_toggle_cycle(GtkRigCtrl * ctrl)
-{
-    exec_rx_cycle(ctrl);
-
-    /* TX cycle is executed only if user selected RIG_TYPE_TOGGLE_AUTO
-     * In manual mode the TX freq update is performed only when TX is activated.
-     * Even in auto mode, the toggling is performed only once every 10 seconds.
-     */
-    if (ctrl->conf->type == RIG_TYPE_TOGGLE_AUTO)
-    {
-	gint64          current_time;
-
-        /* get the current time */
-	current_time = g_get_real_time() / G_USEC_PER_SEC;
-
-        if ((ctrl->last_toggle_tx == -1) ||
-            ((current_time - ctrl->last_toggle_tx) >= 10))
-        {
-            /* it's time to update TX freq */
-            exec_toggle_tx_cycle(ctrl);
-
-            /* store current time */
-            ctrl->last_toggle_tx = current_time;
-        }
-    }
-}
-
-/*
- * Execute TX mode cycle.
- *
- * This function executes a transmit cycle when the primary device is of
- * RIG_TYPE_TOGGLE_AUTO. This applies to radios that support split operation
- * (e.g. TX on VHF, RX on UHF) where the frequency can not be set via CAT while
- * PTT is active.
- *
- * If PTT=TRUE we are in TX mode and hence there is nothing to do since the
- * frequency is kept constant.
- *
- * If PTT=FALSE we are in RX mode and we should update the TX frequency by
- * using set_freq_toggle()
- *
- * For these kind of radios there is no dial-feedback for the TX frequency.
- */
-
-static void exec_toggle_tx_cycle(GtkRigCtrl * ctrl)
-{
-    gdouble         tmpfreq;
-    gboolean        ptt = TRUE;
-
-    if (ctrl->engaged && ctrl->conf->ptt)
-    {
-        ptt = get_ptt(ctrl, ctrl->sock);
-    }
-
-    /* if we are in TX mode do nothing */
-    if (ptt == TRUE)
-    {
-        return;
-    }
-
-    /* Get the desired uplink frequency from controller */
-    tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
-
-    /* if device is engaged, send freq command to radio */
-    if ((ctrl->engaged) && (fabs(ctrl->lasttxf - tmpfreq) >= 10.0))
-    {
-        if (set_freq_toggle(ctrl, ctrl->sock, tmpfreq))
-        {
-            /* reset error counter */
-            ctrl->errcnt = 0;
-        }
-        else
-        {
-            ctrl->errcnt++;
-        }
-
-        /* store the last sent frequency even if an error occurred */
-        ctrl->lasttxf = tmpfreq;
-    }
-
-}
-
-static void exec_duplex_tx_cycle(GtkRigCtrl * ctrl)
-{
-    gdouble         readfreq = 0.0, tmpfreq, satfreqd, satfrequ;
-    gboolean        dialchanged = FALSE;
-
-    /* Dial feedback:
-       If radio device is engaged read frequency from radio and compare it to the
-       last set frequency. If different, it means that user has changed frequency
-       on the radio dial => update transponder knob
-
-       Note: If ctrl->lasttxf = 0.0 the sync has been invalidated (e.g. user pressed "tune")
-       and no need to execute the dial feedback.
-     */
-    if ((ctrl->engaged) && (ctrl->lasttxf > 0.0))
-    {
-        if (!get_freq_toggle(ctrl, ctrl->sock, &readfreq))
-        {
-            /* error => use a passive value */
-            readfreq = ctrl->lasttxf;
-            ctrl->errcnt++;
-        }
-
-        if (fabs(readfreq - ctrl->lasttxf) >= 1.0)
-        {
-            dialchanged = TRUE;
-
-            /* user might have altered radio frequency => update transponder knob */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp), readfreq);
-            ctrl->lasttxf = readfreq;
-
-            /* doppler shift; only if we are tracking */
-            if (ctrl->tracking)
-            {
-                satfrequ = readfreq - ctrl->du + ctrl->conf->loup;
-            }
-            else
-            {
-                satfrequ = readfreq + ctrl->conf->loup;
-            }
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp), satfrequ);
-
-            /* Follow with downlink if transponder is locked */
-            if (ctrl->trsplock)
-            {
-                track_uplink(ctrl);
-            }
-        }
-    }
-
-    /* now, forward tracking */
-    if (dialchanged)
-    {
-        /* no need to forward track */
-        return;
-    }
-
-    /* If we are tracking, calculate the radio freq by applying both dopper shift
-       and tranverter LO frequency. If we are not tracking, apply only LO frequency.
-     */
-    satfreqd = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-    satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-    if (ctrl->tracking)
-    {
-        /* downlink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd + ctrl->dd - ctrl->conf->lo);
-        /* uplink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ + ctrl->du - ctrl->conf->loup);
-    }
-    else
-    {
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd - ctrl->conf->lo);
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ - ctrl->conf->loup);
-    }
-
-    tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
-
-    /* if device is engaged, send freq command to radio */
-    if ((ctrl->engaged) && (fabs(ctrl->lasttxf - tmpfreq) >= 1.0))
-    {
-        if (set_freq_toggle(ctrl, ctrl->sock, tmpfreq))
-        {
-            /* reset error counter */
-            ctrl->errcnt = 0;
-
-            /* give radio a chance to set frequency */
-            g_usleep(WR_DEL);
-
-            /* The actual frequency migh be different from what we have set because
-               the tuning step is larger than what we work with (e.g. FT-817 has a
-               smallest tuning step of 10 Hz). Therefore we read back the actual
-               frequency from the rig. */
-            get_freq_toggle(ctrl, ctrl->sock, &tmpfreq);
-            ctrl->lasttxf = tmpfreq;
-        }
-        else
-        {
-            ctrl->errcnt++;
-        }
-    }
-}
-
-static void exec_duplex_cycle(GtkRigCtrl * ctrl)
-{
-    exec_rx_cycle(ctrl);
-    exec_duplex_tx_cycle(ctrl);
-}
-
-static void exec_dual_rig_cycle(GtkRigCtrl * ctrl)
-{
-    gdouble         tmpfreq, readfreq, satfreqd, satfrequ;
-    gboolean        dialchanged = FALSE;
-
-    /* Execute downlink cycle using ctrl->conf */
-    if (ctrl->engaged && (ctrl->lastrxf > 0.0))
-    {
-        /* get frequency from receiver */
-        if (!get_freq_simplex(ctrl, ctrl->sock, &readfreq))
-        {
-            /* error => use a passive value */
-            readfreq = ctrl->lastrxf;
-            ctrl->errcnt++;
-        }
-
-        if (fabs(readfreq - ctrl->lastrxf) >= 1.0)
-        {
-            dialchanged = TRUE;
-
-            /* user might have altered radio frequency => update transponder knob */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                    readfreq);
-            ctrl->lastrxf = readfreq;
-
-            /* doppler shift; only if we are tracking */
-            if (ctrl->tracking)
-            {
-                satfreqd = readfreq - ctrl->dd + ctrl->conf->lo;
-            }
-            else
-            {
-                satfreqd = readfreq + ctrl->conf->lo;
-            }
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown),
-                                    satfreqd);
-
-            /* Update uplink if locked to downlink */
-            if (ctrl->trsplock)
-            {
-                track_downlink(ctrl);
-            }
-        }
-    }
-
-    if (dialchanged)
-    {
-        /* update uplink */
-        satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-        if (ctrl->tracking)
-        {
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                    satfrequ + ctrl->du - ctrl->conf2->loup);
-        }
-        else
-        {
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                    satfrequ - ctrl->conf2->loup);
-        }
-
-        tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
-
-        /* if device is engaged, send freq command to radio */
-        if ((ctrl->engaged) && (fabs(ctrl->lasttxf - tmpfreq) >= 1.0))
-        {
-            if (set_freq_simplex(ctrl, ctrl->sock2, tmpfreq))
-            {
-                /* reset error counter */
-                ctrl->errcnt = 0;
-
-                /* give radio a chance to set frequency */
-                g_usleep(WR_DEL);
-
-                /* The actual frequency migh be different from what we have set */
-                get_freq_simplex(ctrl, ctrl->sock2, &tmpfreq);
-                ctrl->lasttxf = tmpfreq;
-            }
-            else
-            {
-                ctrl->errcnt++;
-            }
-        }
-    }                           /* dialchanged on downlink */
-    else
-    {
-        /* if no dial change on downlink perform forward tracking on downlink
-           and execute uplink controller too */
-        satfreqd = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-        if (ctrl->tracking)
-        {
-            /* downlink */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                    satfreqd + ctrl->dd - ctrl->conf->lo);
-        }
-        else
-        {
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                    satfreqd - ctrl->conf->lo);
-        }
-
-        tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqDown));
-
-        /* if device is engaged, send freq command to radio */
-        if ((ctrl->engaged) && (fabs(ctrl->lastrxf - tmpfreq) >= 1.0))
-        {
-            if (set_freq_simplex(ctrl, ctrl->sock, tmpfreq))
-            {
-                /* reset error counter */
-                ctrl->errcnt = 0;
-
-                /* give radio a chance to set frequency */
-                g_usleep(WR_DEL);
-
-                /* The actual frequency migh be different from what we have set */
-                get_freq_simplex(ctrl, ctrl->sock, &tmpfreq);
-                ctrl->lastrxf = tmpfreq;
-            }
-            else
-            {
-                ctrl->errcnt++;
-            }
-        }
-
-        /* Now execute uplink controller */
-
-        /* check if uplink dial has changed */
-        if ((ctrl->engaged) && (ctrl->lasttxf > 0.0))
-        {
-            if (!get_freq_simplex(ctrl, ctrl->sock2, &readfreq))
-            {
-                /* error => use a passive value */
-                readfreq = ctrl->lasttxf;
-                ctrl->errcnt++;
-            }
-
-            if (fabs(readfreq - ctrl->lasttxf) >= 1.0)
-            {
-                dialchanged = TRUE;
-
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                        readfreq);
-                ctrl->lasttxf = readfreq;
-
-                /* doppler shift; only if we are tracking */
-                if (ctrl->tracking)
-                {
-                    satfrequ = readfreq - ctrl->du + ctrl->conf2->loup;
-                }
-                else
-                {
-                    satfrequ = readfreq + ctrl->conf2->loup;
-                }
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp),
-                                        satfrequ);
-
-                /* Follow with downlink if transponder is locked */
-                if (ctrl->trsplock)
-                {
-                    track_uplink(ctrl);
-                }
-            }
-        }
-
-        if (dialchanged)
-        {                       /* on uplink */
-            /* update downlink */
-            satfreqd =
-                gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-            if (ctrl->tracking)
-            {
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                        satfreqd + ctrl->dd - ctrl->conf->lo);
-            }
-            else
-            {
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                        satfreqd - ctrl->conf->lo);
-            }
-
-            tmpfreq =
-                gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqDown));
-
-            /* if device is engaged, send freq command to radio */
-            if ((ctrl->engaged) && (fabs(ctrl->lastrxf - tmpfreq) >= 1.0))
-            {
-                if (set_freq_simplex(ctrl, ctrl->sock, tmpfreq))
-                {
-                    /* reset error counter */
-                    ctrl->errcnt = 0;
-
-                    /* give radio a chance to set frequency */
-                    g_usleep(WR_DEL);
-
-                    /* The actual frequency migh be different from what we have set */
-                    get_freq_simplex(ctrl, ctrl->sock, &tmpfreq);
-                    ctrl->lastrxf = tmpfreq;
-                }
-                else
-                {
-                    ctrl->errcnt++;
-                }
-            }
-        }                       /* dialchanged on uplink */
-        else
-        {
-            /* perform forward tracking on uplink */
-            satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-            if (ctrl->tracking)
-            {
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                        satfrequ + ctrl->du -
-                                        ctrl->conf2->loup);
-            }
-            else
-            {
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                        satfrequ - ctrl->conf2->loup);
-            }
-
-            tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
-
-            /* if device is engaged, send freq command to radio */
-            if ((ctrl->engaged) && (fabs(ctrl->lasttxf - tmpfreq) >= 1.0))
-            {
-                if (set_freq_simplex(ctrl, ctrl->sock2, tmpfreq))
-                {
-                    /* reset error counter */
-                    ctrl->errcnt = 0;
-
-                    /* give radio a chance to set frequency */
-                    g_usleep(WR_DEL);
-
-                    /* The actual frequency might be different from what we have set. */
-                    get_freq_simplex(ctrl, ctrl->sock2, &tmpfreq);
-                    ctrl->lasttxf = tmpfreq;
-                }
-                else
-                {
-                    ctrl->errcnt++;
-                }
-            }
-        }                       /* else dialchange on uplink */
-    }                           /* else dialchange on downlink */
-}
-
-static gboolean get_ptt(GtkRigCtrl * ctrl, gint sock)
-{
-    gchar          *buff, **vbuff;
-    gchar           buffback[128];
-    gboolean        retcode;
-    guint64         pttstat = 0;
-
-    if (ctrl->conf->ptt == PTT_TYPE_CAT)
-    {
-        /* send command get_ptt (t) */
-        if (ctrl->conf->vfo_opt)
-            buff = g_strdup_printf("t currVFO\x0a");
-        else
-            buff = g_strdup_printf("t\x0a");
-    }
-    else
-    {
-        /* send command \get_dcd */
-        if (ctrl->conf->vfo_opt)
-            buff = g_strdup_printf("%c currVFO\x0a", 0x8b);
-        else
-            buff = g_strdup_printf("%c\x0a", 0x8b);
-    }
-
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    if (retcode)
-    {
-        vbuff = g_strsplit(buffback, "\n", 3);
-        if (vbuff[0])
-            pttstat = g_ascii_strtoull(vbuff[0], NULL, 0);      //FIXME base = 0 ok?
-        g_strfreev(vbuff);
-    }
-
-    g_free(buff);
-
-    return (pttstat == 1) ? TRUE : FALSE;
-}
-
-static gboolean set_ptt(GtkRigCtrl * ctrl, gint sock, gboolean ptt)
-{
-    gchar          *buff;
-    gchar           buffback[128];
-    gboolean        retcode;
-
-    /* send command */
-    if (ptt == TRUE) 
-    {
-        if (ctrl->conf->vfo_opt)
-            buff = g_strdup_printf("T currVFO 1\x0aq\x0a");
-        else
-            buff = g_strdup_printf("T 1\x0aq\x0a");
-    }
-    else
-    {
-        if (ctrl->conf->vfo_opt)
-            buff = g_strdup_printf("T currVFO 0\x0aq\x0a");
-        else
-            buff = g_strdup_printf("T 0\x0aq\x0a");
-    }
-
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    g_free(buff);
-
-    return (check_set_response(buffback, retcode, __func__));
-
-}
-
-/*
- * Check for AOS and LOS and send signal if enabled for rig.
- *
- * @param ctrl Pointer to the GtkRigCtrl handle.
- * @return TRUE if the operation was successful, FALSE if a connection error
- *         occurred.
- *
- * This function checks whether AOS or LOS just happened and sends the
- * appropriate signal to the RIG if this signalling is enabled.
- */
-static gboolean check_aos_los(GtkRigCtrl * ctrl)
-{
-    gboolean        retcode = TRUE;
-    gchar           retbuf[10];
-
-    if (ctrl->engaged && ctrl->tracking)
-    {
-        if (ctrl->prev_ele < 0.0 && ctrl->target->el >= 0.0)
-        {
-            /* AOS has occurred */
-            if (ctrl->conf->signal_aos)
-            {
-                retcode &= send_rigctld_command(ctrl, ctrl->sock, "AOS\n",
-                                                retbuf, 10);
-            }
-            if (ctrl->conf2 != NULL)
-            {
-                if (ctrl->conf2->signal_aos)
-                {
-                    retcode &= send_rigctld_command(ctrl, ctrl->sock2, "AOS\n",
-                                                    retbuf, 10);
-                }
-            }
-        }
-        else if (ctrl->prev_ele >= 0.0 && ctrl->target->el < 0.0)
-        {
-            /* LOS has occurred */
-            if (ctrl->conf->signal_los)
-            {
-                retcode &= send_rigctld_command(ctrl, ctrl->sock, "LOS\n",
-                                                retbuf, 10);
-            }
-            if (ctrl->conf2 != NULL)
-            {
-                if (ctrl->conf2->signal_los)
-                {
-                    retcode &= send_rigctld_command(ctrl, ctrl->sock2, "LOS\n",
-                                                    retbuf, 10);
-                }
-            }
-        }
-    }
-
-    ctrl->prev_ele = ctrl->target->el;
-
-    return retcode;
-}
-
-/*
- * Set frequency in simplex mode
- *
- * Returns TRUE if the operation was successful, FALSE otherwise
- */
-static gboolean set_freq_simplex(GtkRigCtrl * ctrl, gint sock, gdouble freq)
-{
-    gchar          *buff;
-    gchar           buffback[128];
-    gboolean        retcode;
-
-    if (ctrl->conf->vfo_opt)
-        buff = g_strdup_printf("F currVFO %10.0f\x0a", freq);
-    else
-        buff = g_strdup_printf("F %10.0f\x0a", freq);
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    g_free(buff);
-
-    return (check_set_response(buffback, retcode, __func__));
-}
-
-
-/*
- * Set frequency in toggle mode
- *
- * Returns TRUE if the operation was successful, FALSE otherwise
- */
-static gboolean set_freq_toggle(GtkRigCtrl * ctrl, gint sock, gdouble freq)
-{
-    gchar          *buff;
-    gchar           buffback[128];
-    gboolean        retcode;
-
-    /* send command */
-    printf("set_freq_toggle %d\n", ctrl->conf->vfo_opt);
-    if (ctrl->conf->vfo_opt)
-        buff = g_strdup_printf("I VFOA %10.0f\x0a", freq);
-    else
-        buff = g_strdup_printf("I %10.0f\x0a", freq);
-
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    g_free(buff);
-
-    return (check_set_response(buffback, retcode, __func__));
-
-}
-
-/*
- * Turn on the radios toggle mode
- *
- * Returns TRUE if the operation was successful
- */
-static gboolean set_toggle(GtkRigCtrl * ctrl, gint sock)
-{
-    gchar          *buff;
-    gchar           buffback[128];
-    gboolean        retcode;
-
-    if (ctrl->conf->vfo_opt)
-    buff = g_strdup_printf("S %s 1 %d\x0a", ctrl->conf->vfoDown==VFO_A?"VFOA":"VFOB", ctrl->conf->vfoDown);
-    else
-    buff = g_strdup_printf("S 1 %d\x0a", ctrl->conf->vfoDown);
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    g_free(buff);
-
-    return (check_set_response(buffback, retcode, __func__));
-}
-
-/*
- * Turn off the radios toggle mode
- *
- * Returns TRUE if the operation was successful
- */
-static gboolean unset_toggle(GtkRigCtrl * ctrl, gint sock)
-{
-    gchar          *buff;
-    gchar           buffback[128];
-    gboolean        retcode;
-
-    /* send command */
-    if (ctrl->conf->vfo_opt)
-        buff = g_strdup_printf("S VFOA 0 %d\x0a", ctrl->conf->vfoDown);
-    else
-        buff = g_strdup_printf("S 0 %d\x0a", ctrl->conf->vfoDown);
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    g_free(buff);
-
-    return (check_set_response(buffback, retcode, __func__));
-}
-
-/*
- * Get frequency
- *
- * Returns TRUE if the operation was successful, FALSE otherwise
- */
-static gboolean get_freq_simplex(GtkRigCtrl * ctrl, gint sock, gdouble * freq)
-{
-    gchar          *buff, **vbuff;
-    gchar           buffback[128];
-    gboolean        retcode;
-    gboolean        retval = TRUE;
-
-    if (ctrl->conf->vfo_opt)
-        buff = g_strdup_printf("f currVFO\x0a");
-    else
-        buff = g_strdup_printf("f\x0a");
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    retcode = check_get_response(buffback, retcode, __func__);
-    if (retcode)
-    {
-        vbuff = g_strsplit(buffback, "\n", 3);
-        if (vbuff[0])
-            *freq = g_ascii_strtod(vbuff[0], NULL);
-        else
-            retval = FALSE;
-        g_strfreev(vbuff);
-    }
-    else
-    {
-        retval = FALSE;
-    }
-
-    g_free(buff);
-    return retval;
-}
-
-/*
- * Get vfo option
- *
- * Returns TRUE if the vfo option enabled was successful, FALSE otherwise
- */
-static gboolean get_vfo_opt(GtkRigCtrl * ctrl, gint sock)
-{
-    gchar          *buff;
-    gchar           buffback[128];
-    gboolean        retcode;
-    gboolean        retval = TRUE;
-
-    buff = g_strdup_printf("\\set_vfo_opt 1\x0a");
-    send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    // we don't really care about the return from set_vto_opt
-    // we'll check to see if it worked next
-    buff = g_strdup_printf("\\chk_vfo\x0a");
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    retcode = check_get_response(buffback, retcode, __func__);
-    if (retcode)
-    {
-        if (buffback[0]=='1') return TRUE;
-        else return FALSE;
-    }
-    else
-    {
-        retval = FALSE;
-    }
-
-    g_free(buff);
-    return retval;
-}
-
-/*
- * Get frequency when the radio is working toggle
- *
- * Returns TRUE if the operation was successful, FALSE otherwise
- */
-static gboolean get_freq_toggle(GtkRigCtrl * ctrl, gint sock, gdouble * freq)
-{
-    gchar          *buff, **vbuff;
-    gchar           buffback[128];
-    gboolean        retcode;
-    gboolean        retval = TRUE;
-
-    if (freq == NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: NULL storage."), __FILE__, __LINE__);
-        return FALSE;
-    }
-
-    /* send command */
-    if (ctrl->conf->vfo_opt)
-        buff = g_strdup_printf("i currVFO\x0a");
-    else
-        buff = g_strdup_printf("i\x0a");
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    retcode = check_get_response(buffback, retcode, __func__);
-    if (retcode)
-    {
-        vbuff = g_strsplit(buffback, "\n", 3);
-        if (vbuff[0])
-            *freq = g_ascii_strtod(vbuff[0], NULL);
-        else
-            retval = FALSE;
-
-        g_strfreev(vbuff);
-    }
-    else
-    {
-        retval = FALSE;
-    }
-
-    g_free(buff);
-    return retval;
-}
-
-/*
- * This function is used to manage PTT events, e.g. the user presses
- * the spacebar. It is only useful for RIG_TYPE_TOGGLE_MAN and possibly for
- * RIG_TYPE_TOGGLE_AUTO.
- *
- * First, the function will try to lock the controller. If the lock is
- * acquired the function checks the current PTT status.
- * If PTT status is FALSE (off), it will set the TX frequency and set PTT to
- * TRUE (on). If PTT status is TRUE (on) it will simply set the PTT to FALSE
- * (off).
- *
- * This function assumes that the radio support set/get PTT, otherwise it makes
- * no sense to use it!
- */
-static void manage_ptt_event(GtkRigCtrl * ctrl)
-{
-    guint           timeout = 1;
-    gboolean        ptt = FALSE;
-
-    /* wait for controller to be idle or until the timeout triggers */
-    while (timeout < 5)
-    {
-        if (g_mutex_trylock(&(ctrl->busy)) == TRUE)
-        {
-            timeout = 17;       /* use an arbitrary value that is large enough */
-        }
-        else
-        {
-            /* wait for 100 msec */
-            g_usleep(100000);
-            timeout++;
-        }
-    }
-
-    if (timeout == 17)
-    {
-        /* timeout did not expire, we've got the controller lock */
-        sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                    _("%s: Acquired controller lock"), __func__);
-
-        if (ctrl->engaged == FALSE)
-        {
-            sat_log_log(SAT_LOG_LEVEL_INFO,
-                        _("%s: Controller not engaged; PTT event ignored "
-                          "(Hint: Enable the Engage button)"), __func__);
-        }
-        else
-        {
-            ptt = get_ptt(ctrl, ctrl->sock);
-
-            if (ptt == FALSE)
-            {
-                /* PTT is OFF => set TX freq then set PTT to ON */
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s: PTT is OFF => Set TX freq and PTT=ON"),
-                            __func__);
-
-                exec_toggle_tx_cycle(ctrl);
-                set_ptt(ctrl, ctrl->sock, TRUE);
-            }
-            else
-            {
-                /* PTT is ON => set to OFF */
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s: PTT is ON = Set PTT=OFF"), __func__);
-
-                set_ptt(ctrl, ctrl->sock, FALSE);
-            }
-        }
-
-        g_mutex_unlock(&(ctrl->busy));
-    }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Failed to acquire controller lock; PTT event "
-                      "not handled"), __func__);
-    }
-
-}
-
-
-/*
- * Catch events when the user presses the SPACE key on the keyboard.
- * This is used to toggle betweer RX/TX when using FT817/857/897 in manual mode.
- */
-static gboolean key_press_cb(GtkWidget * widget, GdkEventKey * pKey,
-                             gpointer data)
-{
-    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(widget);
-    gboolean        event_managed = FALSE;
-
-    (void)data;
-
-    if (pKey->type == GDK_KEY_PRESS)
-    {
-        switch (pKey->keyval)
-        {
-            /* keyvals not in API docs. See <gdk/gdkkeysyms.h> for a complete list */
-        case GDK_KEY_space:
-            sat_log_log(SAT_LOG_LEVEL_INFO,
-                        _("%s: Detected SPACEBAR pressed event"), __func__);
+        switch (pKey->keyval)
+        {
+            /* keyvals not in API docs. See <gdk/gdkkeysyms.h> for a complete list */
+        case GDK_KEY_space:
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: Detected SPACEBAR pressed event"), __func__);
 
             /* manage PTT event but only if rig is of type TOGGLE_MAN */
             if (ctrl->conf->type == RIG_TYPE_TOGGLE_MAN)
             {
-                manage_ptt_event(ctrl);
+                if (ctrl->rc != NULL)
+                    radio_ctrl_ptt_event(ctrl->rc);
+                else
+                    sat_log_log(SAT_LOG_LEVEL_INFO,
+                                _("%s: Controller not engaged; PTT event "
+                                  "ignored (Hint: Enable the Engage button)"),
+                                __func__);
                 event_managed = TRUE;
             }
             break;
@@ -2745,315 +1695,6 @@ static gboolean key_press_cb(GtkWidget * widget, GdkEventKey * pKey,
     return event_managed;
 }
 
-static gboolean open_rigctld_socket(radio_conf_t * conf, gint * sock)
-{
-    struct sockaddr_in ServAddr;
-    struct hostent *h;
-    gint            status;
-
-    *sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (*sock < 0)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Failed to create socket"), __func__);
-        *sock = 0;
-        return FALSE;
-    }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                    _("%s: Network socket created successfully"), __func__);
-    }
-
-    memset(&ServAddr, 0, sizeof(ServAddr));     /* Zero out structure */
-    ServAddr.sin_family = AF_INET;      /* Internet address family */
-    h = gethostbyname(conf->host);
-    memcpy((char *)&ServAddr.sin_addr.s_addr, h->h_addr_list[0], h->h_length);
-    ServAddr.sin_port = htons(conf->port);      /* Server port */
-
-    /* establish connection */
-    status = connect(*sock, (struct sockaddr *)&ServAddr, sizeof(ServAddr));
-    if (status < 0)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Failed to connect to %s:%d"),
-                    __func__, conf->host, conf->port);
-        *sock = 0;
-        return FALSE;
-    }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                    _("%s: Connection opened to %s:%d"),
-                    __func__, conf->host, conf->port);
-    }
-
-    return TRUE;
-}
-
-static gboolean close_rigctld_socket(gint * sock)
-{
-    gint            written;
-
-    written = send(*sock, "q\x0a", 2, 0);
-    if (written != 2)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%s: Sent 2 bytes but sent %d."),
-                    __FILE__, __func__, written);
-    }
-#ifndef WIN32
-    shutdown(*sock, SHUT_RDWR);
-    close(*sock);
-#else
-    shutdown(*sock, SD_BOTH);
-    closesocket(*sock);
-#endif
-
-    *sock = 0;
-
-    return TRUE;
-}
-
-static void rigctrl_close(GtkRigCtrl * data)
-{
-    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
-
-    ctrl->lastrxptt = FALSE;
-    ctrl->lasttxptt = TRUE;
-    ctrl->lasttxf = 0.0;
-    ctrl->lastrxf = 0.0;
-
-    remove_timer(ctrl);
-
-    if ((ctrl->conf->type == RIG_TYPE_TOGGLE_AUTO) ||
-        (ctrl->conf->type == RIG_TYPE_TOGGLE_MAN))
-    {
-        unset_toggle(ctrl, ctrl->sock);
-    }
-
-    if (ctrl->conf2 != NULL)
-    {
-        close_rigctld_socket(&(ctrl->sock2));
-    }
-    close_rigctld_socket(&(ctrl->sock));
-}
-
-static void rigctrl_open(GtkRigCtrl * data)
-{
-    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
-
-    ctrl->wrops = 0;
-
-    start_timer(ctrl);
-
-    open_rigctld_socket(ctrl->conf, &(ctrl->sock));
-
-    // check to see if vfo option is enabled
-    ctrl->conf->vfo_opt = get_vfo_opt(ctrl, ctrl->sock);
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-            _("%s:%s: VFO opt=%d"), __FILE__,
-            __func__, ctrl->conf->vfo_opt);
-
-    /* set initial frequency */
-    if (ctrl->conf2 != NULL)
-    {
-        open_rigctld_socket(ctrl->conf2, &(ctrl->sock2));
-        /* set initial dual mode */
-        ctrl->conf2->vfo_opt = get_vfo_opt(ctrl, ctrl->sock);
-        sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s:%s: VFO opt2=%d"), __FILE__,
-                __func__, ctrl->conf2->vfo_opt);
-
-        exec_dual_rig_cycle(ctrl);
-    }
-    else
-    {
-        switch (ctrl->conf->type)
-        {
-
-        case RIG_TYPE_RX:
-            exec_rx_cycle(ctrl);
-            break;
-
-        case RIG_TYPE_TX:
-            exec_tx_cycle(ctrl);
-            break;
-
-        case RIG_TYPE_TRX:
-            exec_trx_cycle(ctrl);
-            break;
-
-        case RIG_TYPE_DUPLEX:
-            /* set rig into SAT mode (hamlib needs it even if rig already in SAT) */
-            setup_split(ctrl);
-            exec_duplex_cycle(ctrl);
-            break;
-
-        case RIG_TYPE_TOGGLE_AUTO:
-        case RIG_TYPE_TOGGLE_MAN:
-            set_toggle(ctrl, ctrl->sock);
-            ctrl->last_toggle_tx = -1;
-            exec_toggle_cycle(ctrl);
-            break;
-
-        default:
-            /* this is an error! */
-            ctrl->conf->type = RIG_TYPE_RX;
-            exec_rx_cycle(ctrl);
-            break;
-        }
-    }
-}
-
-/* Communication thread for hamlib rigctld */
-gpointer rigctl_run(gpointer data)
-{
-    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
-    GtkRigCtrl     *t_ctrl = GTK_RIG_CTRL(data);
-
-    while (1)
-    {
-        t_ctrl = GTK_RIG_CTRL(g_async_queue_pop(ctrl->rigctlq));
-        ctrl = t_ctrl;
-        while (g_main_context_iteration(NULL, FALSE));
-
-        if (t_ctrl == NULL)
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%s: ERROR: NO VALID ctrl-struct"), __FILE__,
-                        __func__);
-            continue;
-        }
-
-        if (t_ctrl->engaged)
-        {
-            if (!t_ctrl->sock)
-                rigctrl_open(t_ctrl);
-
-            if (!t_ctrl->timerid)
-                start_timer(t_ctrl);
-        }
-        else
-        {
-            g_mutex_lock(&t_ctrl->widgetsync);
-
-            if (t_ctrl->sock > 0)
-                rigctrl_close(t_ctrl);
-
-            if (t_ctrl->timerid)
-                remove_timer(t_ctrl);
-
-            g_cond_signal(&t_ctrl->widgetready);
-            g_mutex_unlock(&t_ctrl->widgetsync);
-            break;
-        }
-
-        check_aos_los(t_ctrl);
-
-        if (t_ctrl->conf2 != NULL)
-        {
-            exec_dual_rig_cycle(t_ctrl);
-        }
-        else
-        {
-            /* Execute controller cycle depending on primary radio type */
-            switch (t_ctrl->conf->type)
-            {
-
-            case RIG_TYPE_RX:
-                exec_rx_cycle(t_ctrl);
-                break;
-
-            case RIG_TYPE_TX:
-                exec_tx_cycle(t_ctrl);
-                break;
-
-            case RIG_TYPE_TRX:
-                exec_trx_cycle(t_ctrl);
-                break;
-
-            case RIG_TYPE_DUPLEX:
-                exec_duplex_cycle(t_ctrl);
-                break;
-
-            case RIG_TYPE_TOGGLE_AUTO:
-            case RIG_TYPE_TOGGLE_MAN:
-                exec_toggle_cycle(t_ctrl);
-                break;
-
-            default:
-                /* invalid mode */
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s:%s: Invalid radio type %d. Setting type to "
-                              "RIG_TYPE_RX"), __FILE__, __func__,
-                            t_ctrl->conf->type);
-                t_ctrl->conf->type = RIG_TYPE_RX;
-            }
-        }
-
-        /* perform error count checking */
-        if (t_ctrl->errcnt >= MAX_ERROR_COUNT)
-        {
-            /* disengage device */
-            gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(t_ctrl->LockBut),
-                                         FALSE);
-            t_ctrl->engaged = FALSE;
-            t_ctrl->errcnt = 0;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _
-                        ("%s:%s: MAX_ERROR_COUNT (%d) reached. Disengaging device!"),
-                        __FILE__, __func__, MAX_ERROR_COUNT);
-
-            //g_print ("ERROR. WROPS = %d\n", ctrl->wrops);
-        }
-
-        //g_print ("       WROPS = %d\n", ctrl->wrops);
-    }
-
-    if (t_ctrl->sock > 0)
-        rigctrl_close(t_ctrl);
-
-    if (t_ctrl->timerid)
-        remove_timer(t_ctrl);
-
-    return NULL;
-}
-
-void start_timer(GtkRigCtrl * data)
-{
-    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
-
-    /*  start timeout timer here ("Cycle")! */
-    if (ctrl->timerid > 0)
-        g_source_remove(ctrl->timerid);
-
-    ctrl->timerid =
-        gdk_threads_add_timeout(ctrl->delay, rig_ctrl_timeout_cb, ctrl);
-}
-
-void remove_timer(GtkRigCtrl * data)
-{
-    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
-
-    /* stop timer */
-    if (ctrl->timerid > 0)
-        g_source_remove(ctrl->timerid);
-    ctrl->timerid = 0;
-}
-
-void setconfig(gpointer data)
-{
-    /* something has changed... */
-    GtkRigCtrl     *ctrl = GTK_RIG_CTRL(data);
-
-    if (ctrl != NULL)
-    {
-        g_async_queue_push(ctrl->rigctlq, ctrl);
-    }
-}
-
-
 GtkWidget      *gtk_rig_ctrl_new(GtkSatModule * module)
 {
     GtkRigCtrl     *rigctrl;
@@ -3073,6 +1714,7 @@ GtkWidget      *gtk_rig_ctrl_new(GtkSatModule * module)
     GTK_RIG_CTRL(widget)->target = SAT(g_slist_nth_data(rigctrl->sats, 0));
 
     rigctrl->qth = module->qth;
+    rigctrl->module = module;
 
     if (rigctrl->target != NULL)
     {
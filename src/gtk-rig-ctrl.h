@@ -5,9 +5,11 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+#include "doppler-table.h"
 #include "gtk-sat-module.h"
 #include "predict-tools.h"
 #include "radio-conf.h"
+#include "radio-ctrl.h"
 #include "sgpsdp/sgp4sdp4.h"
 #include "trsp-conf.h"
 
@@ -23,6 +25,9 @@
 
 #define IS_GTK_RIG_CTRL(obj)       G_TYPE_CHECK_INSTANCE_TYPE (obj, gtk_rig_ctrl_get_type ())
 
+/** Number of radio devices that can be selected. */
+#define RIG_CTRL_MAX_RADIOS 4
+
 typedef struct _gtk_rig_ctrl GtkRigCtrl;
 typedef struct _GtkRigCtrlClass GtkRigCtrlClass;
 
@@ -46,12 +51,15 @@ struct _gtk_rig_ctrl {
     GtkWidget      *SatSel;     /*!< Satellite selector */
     GtkWidget      *TrspSel;    /*!< Transponder selector */
     GtkWidget      *DevSel;     /*!< Device selector */
-    GtkWidget      *DevSel2;    /*!< Second device selector */
+    GtkWidget      *DevSel2[RIG_CTRL_MAX_RADIOS - 1];       /*!< Selectors of the
+                                                           further devices */
     GtkWidget      *LockBut;
     GtkWidget      *cycle_spin;      /*!< Update timer cycle */
+    GtkWidget      *tol_spin;        /*!< Doppler tolerance */
 
     radio_conf_t   *conf;       /*!< Radio configuration */
-    radio_conf_t   *conf2;      /*!< Secondary radio configuration */
+    radio_conf_t   *conf2[RIG_CTRL_MAX_RADIOS - 1];  /*!< Further radio
+                                                    configurations or NULL */
     GSList         *trsplist;   /*!< List of available transponders */
     trsp_t         *trsp;       /*!< Pointer to the current transponder configuration */
     gboolean        trsplock;   /*!< Flag indicating whether uplink and downlink are lockled */
@@ -59,43 +67,30 @@ struct _gtk_rig_ctrl {
     GSList         *sats;       /*!< List of sats in parent module */
     sat_t          *target;     /*!< Target satellite */
     pass_t         *pass;       /*!< Next pass of target satellite */
+    doppler_table_t *doptab;    /*!< Doppler table of the current pass */
+    guint           doptab_seq; /*!< Incremented to drop a table still being
+                                   computed. */
+    gboolean        doptab_busy;        /*!< A table is being computed. */
     qth_t          *qth;        /*!< The QTH for this module */
+    GtkSatModule   *module;     /*!< The parent module, for the time throttle */
 
-    double          prev_ele;   /*!< Previous elevation (used for AOS/LOS signalling) */
-
-    guint           delay;      /*!< Timeout delay. */
-    guint           timerid;    /*!< Timer ID */
+    guint           delay;      /*!< Cycle period of the controller. */
 
     gboolean        tracking;   /*!< Flag set when we are tracking a target. */
-    GMutex          busy;       /*!< Flag set when control algorithm is busy. */
     gboolean        engaged;    /*!< Flag indicating that rig device is engaged. */
-    gint            errcnt;     /*!< Error counter. */
 
-    gboolean        lastrxptt;  /*!< PTT state of last rx cycle. */
-    gboolean        lasttxptt;  /*!< PTT state of last tx cycle. */
+    radio_ctrl_t   *rc;         /*!< Radio controller, while engaged. */
+    guint           satfreq_seq;        /*!< Incremented when the user changes
+                                           the satellite frequencies. */
+    guint           resync_down, resync_up;     /*!< Incremented to invalidate
+                                                   the sync with the radio. */
 
-    gdouble         lastrxf;    /*!< Last frequency sent to receiver. */
-    gdouble         lasttxf;    /*!< Last frequency sent to tranmitter. */
     gdouble         du, dd;     /*!< Last computed up/down Doppler shift; computed in update() */
-
-    gint64          last_toggle_tx;     /*!< Last time when exec_toggle_tx_cycle() was executed (seconds)
-                                           -1 indicates that an update should be performed ASAP */
-
-    gint            sock, sock2;        /*!< Sockets for controlling the radio(s). */
-
-    /* debug related */
-    guint           wrops;
-    guint           rdops;
-
-    /* DL4PD */
-    /* threads related stuff */
-    /* add mutexes etc, to make threads reentrant! */
-    GMutex          writelock;  /*!< Mutex for blocking write operation */
-    GMutex          rig_ctrl_updatelock;        /*!< Mutex while updating widgets etc */
-    GMutex          widgetsync; /*!< Mutex used while leaving (sync stuff) */
-    GCond           widgetready;        /*!< Condition when work is done (sync stuff) */
-    GAsyncQueue    *rigctlq;    /*!< Message queue to indicate something has changed */
-    GThread        *rigctl_thread;      /*!< Pointer to current rigctl-thread */
+    gdouble         du_dot, dd_dot;     /*!< Rate of change of du and dd [Hz/s] */
+    gint64          dop_time;   /*!< Monotonic time when du and dd were computed [usec] */
+    gint64          dop_lead;   /*!< Lead time du and dd were predicted for [usec] */
+    gdouble         dop_jul;    /*!< Satellite time at dop_time (Julian date) */
+    gint64          latency;    /*!< Smoothed command-to-apply latency [usec] */
 };
 
 struct _GtkRigCtrlClass {
@@ -32,22 +32,11 @@
 #include <build-config.h>
 #endif
 
-/* NETWORK */
-#ifndef WIN32
-#include <arpa/inet.h>          /* htons() */
-#include <netdb.h>              /* gethostbyname() */
-#include <netinet/in.h>         /* struct sockaddr_in */
-#include <sys/socket.h>         /* socket(), connect(), send() */
-#else
-#include <winsock2.h>
-#endif
-
-#include <errno.h>
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 #include <math.h>
-#include <string.h>             /* strerror() */
+#include <string.h>
 
 #include "compat.h"
 #include "gpredict-utils.h"
@@ -64,138 +53,6 @@
 static GtkVBoxClass *parent_class = NULL;
 
 
-/* Open the rotcld socket. Returns file descriptor or -1 if an error occurs */
-static gint rotctld_socket_open(const gchar * host, gint port)
-{
-    struct sockaddr_in ServAddr;
-    struct hostent *h;
-    gint            sock;
-    gint            status;
-
-    sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (sock == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("Failed to create rotctl socket: %s"), strerror(errno));
-        return sock;
-    }
-
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s: Network socket created successfully"), __func__);
-
-    memset(&ServAddr, 0, sizeof(ServAddr));
-    ServAddr.sin_family = AF_INET;      /* Internet address family */
-    h = gethostbyname(host);
-    if (h == NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("Name resolution of rotctld server %s failed."), host);
-#ifdef WIN32
-        closesocket(sock);
-#else
-        close(sock);
-#endif
-        return -1;
-    }
-
-    memcpy((char *)&ServAddr.sin_addr.s_addr, h->h_addr_list[0], h->h_length);
-    ServAddr.sin_port = htons(port);    /* Server port */
-
-    /* establish connection */
-    status = connect(sock, (struct sockaddr *)&ServAddr, sizeof(ServAddr));
-    if (status == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("Connection to rotctld server at %s:%d failed: %s"),
-                    host, port, strerror(errno));
-
-#ifdef WIN32
-        closesocket(sock);
-#else
-        close(sock);
-#endif
-        return -1;
-    }
-
-    sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Connection opened to %s:%d"),
-                __func__, host, port);
-
-    return sock;
-}
-
-/* Close a rotcld socket. First send a q command to cleanly shut down rotctld */
-static void rotctld_socket_close(gint * sock)
-{
-    gint            written;
-
-    /*shutdown the rotctld connect */
-    written = send(*sock, "q\x0a", 2, 0);
-    if (written != 2)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%s: Sent 2 bytes but sent %d."),
-                    __FILE__, __func__, written);
-    }
-
-#ifndef WIN32
-    shutdown(*sock, SHUT_RDWR);
-    close(*sock);
-#else
-    shutdown(*sock, SD_BOTH);
-    closesocket(*sock);
-#endif
-
-    *sock = -1;
-}
-
-/*
- * Send a command to rotctld and read the response.
- *
- * Inputs are the socket, a string command, and a buffer and length for
- * returning the output from rotctld.
- */
-static gboolean rotctld_socket_rw(gint sock, gchar * buff, gchar * buffout,
-                                  gint sizeout)
-{
-    gint            written;
-    gint            size;
-
-    size = strlen(buff);
-
-    /* send command */
-    written = send(sock, buff, size, 0);
-    if (written != size)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: SIZE ERROR %d / %d"), __func__, written, size);
-    }
-    if (written == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: rotctld Socket Down"), __func__);
-        return FALSE;
-    }
-
-    /* try to read answer */
-    size = recv(sock, buffout, sizeout, 0);
-
-    if (size == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: rotctld Socket Down"), __func__);
-        return FALSE;
-    }
-
-    buffout[size] = '\0';
-    if (size == 0)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%s: Got 0 bytes from rotctld"), __FILE__, __func__);
-    }
-
-    return TRUE;
-}
-
 static gint sat_name_compare(sat_t * a, sat_t * b)
 {
     return (gpredict_strcmp(a->nickname, b->nickname));
@@ -278,184 +135,25 @@ static gboolean is_flipped_pass(pass_t * pass, rot_az_type_t type,
     return retval;
 }
 
-static inline void set_flipped_pass(GtkRotCtrl * ctrl)
-{
-    if (ctrl->conf && ctrl->pass)
-        ctrl->flipped = is_flipped_pass(ctrl->pass, ctrl->conf->aztype,
-                                        ctrl->conf->azstoppos);
-}
-
-/**
- * Read rotator position from device.
- *
- * \param ctrl Pointer to the GtkRotCtrl widget.
- * \param az The current Az as read from the device
- * \param el The current El as read from the device
- * \return TRUE if the position was successfully retrieved, FALSE if an
- *         error occurred.
- */
-static gboolean get_pos(GtkRotCtrl * ctrl, gdouble * az, gdouble * el)
-{
-    gchar          *buff, **vbuff;
-    gchar           buffback[128];
-    gboolean        retcode;
-
-    if ((az == NULL) || (el == NULL))
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: NULL storage."), __FILE__, __LINE__);
-        return FALSE;
-    }
-
-    /* send command */
-    buff = g_strdup_printf("p\x0a");
-    retcode = rotctld_socket_rw(ctrl->client.socket, buff, buffback, 128);
-
-    /* try to parse answer */
-    if (retcode)
-    {
-        if (strncmp(buffback, "RPRT", 4) == 0)
-        {
-            g_strstrip(buffback);
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%d: rotctld returned error (%s)"),
-                        __FILE__, __LINE__, buffback);
-            retcode = FALSE;
-        }
-        else
-        {
-            vbuff = g_strsplit(buffback, "\n", 3);
-            if ((vbuff[0] != NULL) && (vbuff[1] != NULL))
-            {
-                *az = g_strtod(vbuff[0], NULL);
-                *el = g_strtod(vbuff[1], NULL);
-            }
-            else
-            {
-                g_strstrip(buffback);
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s:%d: rotctld returned bad response (%s)"),
-                            __FILE__, __LINE__, buffback);
-                retcode = FALSE;
-            }
-
-            g_strfreev(vbuff);
-        }
-    }
-
-    g_free(buff);
-
-    return retcode;
-}
-
-/**
- * Send new position to rotator device
- *
- * \param ctrl Pointer to the GtkRotCtrl widget
- * \param az The new Azimuth
- * \param el The new Elevation
- * \return TRUE if the new position has been sent successfully
- *         FALSE if an error occurred
- * 
- * \note The function does not perform any range check since the GtkRotKnob
- * should always keep its value within range.
+/*
+ * Plan the current pass: decide whether it is flipped and compute the
+ * pointing schedule. Called whenever the pass or the configuration changes.
  */
-static gboolean set_pos(GtkRotCtrl * ctrl, gdouble az, gdouble el)
+static void plan_pass(GtkRotCtrl * ctrl)
 {
-    gchar          *buff;
-    gchar           buffback[128];
-    gboolean        retcode;
-    gint            retval;
-
-    /* send command */
-    buff = g_strdup_printf("P %.2f %.2f\x0a", az, el);
-    retcode = rotctld_socket_rw(ctrl->client.socket, buff, buffback, 128);
-    g_free(buff);
-
-    if (retcode == TRUE)
-    {
-        /* treat errors as soft errors */
-        retval = (gint) g_strtod(buffback + 4, NULL);
-        if (retval != 0)
-        {
-            g_strstrip(buffback);
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _
-                        ("%s:%d: rotctld returned error %d with az %f el %f(%s)"),
-                        __FILE__, __LINE__, retval, az, el, buffback);
-            retcode = FALSE;
-        }
-    }
-
-    return (retcode);
-}
-
-/* Rotctl client thread */
-static gpointer rotctld_client_thread(gpointer data)
-{
-    gdouble         elapsed_time;
-    gdouble         azi = 0.0;
-    gdouble         ele = 0.0;
-    gboolean        new_trg = FALSE;
-    gboolean        io_error = FALSE;
-    GtkRotCtrl     *ctrl = GTK_ROT_CTRL(data);
+    rotor_schedule_free(ctrl->sched);
+    ctrl->sched = NULL;
+    ctrl->sched_sent = NULL;
 
-    g_print("Starting rotctld client thread\n");
-
-    ctrl->client.socket = rotctld_socket_open(ctrl->conf->host,
-                                              ctrl->conf->port);
-    if (ctrl->client.socket == -1)
-        return GINT_TO_POINTER(-1);
-
-    ctrl->client.timer = g_timer_new();
-
-    ctrl->client.new_trg = FALSE;
-    ctrl->client.running = TRUE;
-
-    while (ctrl->client.running)
+    if (ctrl->conf && ctrl->pass)
     {
-        g_timer_start(ctrl->client.timer);
-        io_error = FALSE;
-
-        g_mutex_lock(&ctrl->client.mutex);
-        if (ctrl->client.new_trg)
-        {
-            azi = ctrl->client.azi_out;
-            ele = ctrl->client.ele_out;
-            new_trg = ctrl->client.new_trg;
-        }
-        g_mutex_unlock(&ctrl->client.mutex);
-
-        if (new_trg && !ctrl->monitor)
-        {
-            if (set_pos(ctrl, azi, ele))
-                new_trg = FALSE;
-            else
-                io_error = TRUE;
-        }
-
-        /* wait 100 ms before sending new command */
-        g_usleep(100000);
-        if (!get_pos(ctrl, &azi, &ele))
-            io_error = TRUE;
-
-        g_mutex_lock(&ctrl->client.mutex);
-        ctrl->client.azi_in = azi;
-        ctrl->client.ele_in = ele;
-        ctrl->client.new_trg = new_trg;
-        ctrl->client.io_error = io_error;
-        g_mutex_unlock(&ctrl->client.mutex);
-
-        /* ensure rotctl duty cycle stays below 50%, but wait at least 700 ms (TBC) */
-        elapsed_time = MAX(g_timer_elapsed(ctrl->client.timer, NULL), 0.7);
-        g_usleep(elapsed_time * 1e6);
+        ctrl->flipped = is_flipped_pass(ctrl->pass, ctrl->conf->aztype,
+                                        ctrl->conf->azstoppos);
+        if (ctrl->target)
+            ctrl->sched = rotor_schedule_new(ctrl->target, ctrl->qth,
+                                             ctrl->pass, ctrl->conf,
+                                             ctrl->flipped);
     }
-
-    g_print("Stopping rotctld client thread\n");
-    g_timer_destroy(ctrl->client.timer);
-    rotctld_socket_close(&ctrl->client.socket);
-
-    return GINT_TO_POINTER(0);
 }
 
 /**
@@ -535,9 +233,9 @@ void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
                 free_pass(ctrl->pass);
                 ctrl->pass = NULL;
                 ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
+                plan_pass(ctrl);
                 if (ctrl->pass)
                 {
-                    set_flipped_pass(ctrl);
                     /* update polar plot */
                     gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
                                             ctrl->pass);
@@ -558,7 +256,7 @@ void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
                     free_pass(ctrl->pass);
                     ctrl->pass = NULL;
                     ctrl->pass = get_current_pass(ctrl->target, ctrl->qth, t);
-                    set_flipped_pass(ctrl);
+                    plan_pass(ctrl);
                     gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
                                             ctrl->pass);
                 }
@@ -575,7 +273,7 @@ void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
                     free_pass(ctrl->pass);
                     ctrl->pass = NULL;
                     ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
-                    set_flipped_pass(ctrl);
+                    plan_pass(ctrl);
                     /* update polar plot */
                     gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
                                             ctrl->pass);
@@ -590,7 +288,7 @@ void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
                     free_pass(ctrl->pass);
                     ctrl->pass = NULL;
                     ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
-                    set_flipped_pass(ctrl);
+                    plan_pass(ctrl);
                     /* update polar plot */
                     gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
                                             ctrl->pass);
@@ -605,7 +303,7 @@ void gtk_rot_ctrl_update(GtkRotCtrl * ctrl, gdouble t)
             else
                 ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
 
-            set_flipped_pass(ctrl);
+            plan_pass(ctrl);
             /* update polar plot */
             gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot), ctrl->pass);
         }
@@ -715,6 +413,7 @@ static void track_toggle_cb(GtkToggleButton * button, gpointer data)
 
     locked = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(ctrl->LockBut));
     ctrl->tracking = gtk_toggle_button_get_active(button);
+    ctrl->sched_sent = NULL;
     gtk_widget_set_sensitive(ctrl->MonitorCheckBox,
                              !(ctrl->tracking || locked));
     gtk_widget_set_sensitive(ctrl->AzSet, !ctrl->tracking);
@@ -735,6 +434,8 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
     gchar          *text;
     gboolean        error = FALSE;
     sat_t           sat_working, *sat;
+    rotctld_status_t status;
+    const rotor_setpoint_t *sp = NULL;
 
     /* parameters for path predictions */
     gdouble         time_delta;
@@ -749,7 +450,20 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
        set the rotor controller to 0 deg El and to the Az where the
        target sat is expected to come up or where it last went down
      */
-    if (ctrl->tracking && ctrl->target)
+    if (ctrl->tracking && ctrl->target && ctrl->sched && ctrl->conf)
+    {
+        /* follow the pointing schedule of the pass */
+        sp = rotor_schedule_get(ctrl->sched, ctrl->t, ctrl->conf->lead);
+        setaz = sp->az;
+        setel = sp->el;
+
+        if (!(ctrl->engaged))
+        {
+            gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->AzSet), setaz);
+            gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->ElSet), setel);
+        }
+    }
+    else if (ctrl->tracking && ctrl->target)
     {
         if (ctrl->target->el < 0.0)
         {
@@ -807,13 +521,13 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
 
     if ((ctrl->engaged) && (ctrl->conf != NULL))
     {
-
-        if (g_mutex_trylock(&ctrl->client.mutex))
+        /* nothing to show until the first position has been read */
+        rotctld_get_status(ctrl->client, &status);
+        if (status.valid || status.io_error)
         {
-            error = ctrl->client.io_error;
-            rotaz = ctrl->client.azi_in;
-            rotel = ctrl->client.ele_in;
-            g_mutex_unlock(&ctrl->client.mutex);
+            error = status.io_error;
+            rotaz = status.az;
+            rotel = status.el;
 
             /* ensure Azimuth angle is 0-360 degrees */
             while (rotaz < 0.0)
@@ -851,8 +565,28 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
             }
         }
 
+        if (sp != NULL)
+        {
+            /* setpoints of the schedule are sent once, ahead of time */
+            if (sp != ctrl->sched_sent)
+            {
+                gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->AzSet), setaz);
+                gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->ElSet), setel);
+                if (!ctrl->monitor)
+                {
+                    rotctld_set_target(ctrl->client, setaz, setel);
+                    ctrl->sched->commands++;
+                }
+                ctrl->sched_sent = sp;
+            }
+
+            if (status.valid && !error && ctrl->target->el >= 0.0)
+                rotor_schedule_add_error(ctrl->sched, ctrl->target->az,
+                                         ctrl->target->el, status.az,
+                                         status.el);
+        }
         /* if tolerance exceeded */
-        if ((fabs(setaz - rotaz) > ctrl->threshold) ||
+        else if ((fabs(setaz - rotaz) > ctrl->threshold) ||
             (fabs(setel - rotel) > ctrl->threshold))
         {
             if (ctrl->tracking)
@@ -935,13 +669,8 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
             /* this is the newly computed value which should be ahead of the current position */
             gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->AzSet), setaz);
             gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->ElSet), setel);
-            if (g_mutex_trylock(&ctrl->client.mutex))
-            {
-                ctrl->client.azi_out = setaz;
-                ctrl->client.ele_out = setel;
-                ctrl->client.new_trg = TRUE;
-                g_mutex_unlock(&ctrl->client.mutex);
-            }
+            if (!ctrl->monitor)
+                rotctld_set_target(ctrl->client, setaz, setel);
 
         }
 
@@ -1029,6 +758,9 @@ static void delay_changed_cb(GtkSpinButton * spin, gpointer data)
     if (ctrl->conf)
         ctrl->conf->cycle = ctrl->delay;
 
+    if (ctrl->client)
+        rotctld_set_cadence(ctrl->client, ctrl->delay);
+
     if (ctrl->timerid > 0)
         g_source_remove(ctrl->timerid);
 
@@ -1050,7 +782,27 @@ static void threshold_changed_cb(GtkSpinButton * spin, gpointer data)
 
     ctrl->threshold = gtk_spin_button_get_value(spin);
     if (ctrl->conf)
+    {
         ctrl->conf->threshold = ctrl->threshold;
+        plan_pass(ctrl);
+    }
+}
+
+/**
+ * Manage lead time changes
+ *
+ * \param spin Pointer to the spin button.
+ * \param data Pointer to the GtkRotCtrl widget.
+ *
+ * This function is called when the user changes the value of the
+ * lead time.
+ */
+static void lead_changed_cb(GtkSpinButton * spin, gpointer data)
+{
+    GtkRotCtrl     *ctrl = GTK_ROT_CTRL(data);
+
+    if (ctrl->conf)
+        ctrl->conf->lead = gtk_spin_button_get_value(spin);
 }
 
 /**
@@ -1096,6 +848,8 @@ static void rot_selected_cb(GtkComboBox * box, gpointer data)
                                   ctrl->conf->cycle);
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(ctrl->thld_spin),
                                   ctrl->conf->threshold);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(ctrl->lead_spin),
+                                  ctrl->conf->lead);
 
         /* update new ranges of the Az and El controller widgets */
         gtk_rot_knob_set_range(GTK_ROT_KNOB(ctrl->AzSet), ctrl->conf->minaz,
@@ -1103,8 +857,8 @@ static void rot_selected_cb(GtkComboBox * box, gpointer data)
         gtk_rot_knob_set_range(GTK_ROT_KNOB(ctrl->ElSet), ctrl->conf->minel,
                                ctrl->conf->maxel);
 
-        /* Update flipped when changing rotor if there is a plot */
-        set_flipped_pass(ctrl);
+        /* Plan the pass again for the new rotor if there is one */
+        plan_pass(ctrl);
     }
     else
     {
@@ -1117,6 +871,7 @@ static void rot_selected_cb(GtkComboBox * box, gpointer data)
             g_free(ctrl->conf->host);
         g_free(ctrl->conf);
         ctrl->conf = NULL;
+        plan_pass(ctrl);
     }
 }
 
@@ -1146,10 +901,6 @@ static void rot_monitor_cb(GtkCheckButton * button, gpointer data)
 static void rot_locked_cb(GtkToggleButton * button, gpointer data)
 {
     GtkRotCtrl     *ctrl = GTK_ROT_CTRL(data);
-    gchar          *buff;
-    gchar           buffback[128];
-    gboolean        retcode;
-    gint            retval;
 
     if (!gtk_toggle_button_get_active(button))
     {
@@ -1158,31 +909,9 @@ static void rot_locked_cb(GtkToggleButton * button, gpointer data)
         gtk_label_set_text(GTK_LABEL(ctrl->AzRead), "---");
         gtk_label_set_text(GTK_LABEL(ctrl->ElRead), "---");
 
-        if (!ctrl->client.running)
-            /* client thread is not running; nothing to do */
-            return;
-
-        /* stop moving rotor */
-        /** FIXME: should use high level func */
-        buff = g_strdup_printf("S\x0a");
-        retcode = rotctld_socket_rw(ctrl->client.socket, buff, buffback, 128);
-        g_free(buff);
-        if (retcode == TRUE)
-        {
-            /* treat errors as soft errors */
-            retval = (gint) g_strtod(buffback + 4, NULL);
-            if (retval != 0)
-            {
-                g_strstrip(buffback);
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _
-                            ("%s:%d: rotctld returned error %d with stop-cmd (%s)"),
-                            __FILE__, __LINE__, retval, buffback);
-            }
-        }
-
-        ctrl->client.running = FALSE;
-        g_thread_join(ctrl->client.thread);
+        /* stop moving rotor; the client does not wait for the reply */
+        rotctld_close(ctrl->client, TRUE);
+        ctrl->client = NULL;
     }
     else
     {
@@ -1196,10 +925,10 @@ static void rot_locked_cb(GtkToggleButton * button, gpointer data)
             return;
         }
 
-        ctrl->client.thread =
-            g_thread_new("gpredict_rotctl", rotctld_client_thread, ctrl);
-
+        ctrl->client = rotctld_open(ctrl->conf->host, ctrl->conf->port,
+                                    ctrl->delay, ROTCTLD_TIMEOUT);
         gtk_widget_set_sensitive(ctrl->DevSel, FALSE);
+        ctrl->sched_sent = NULL;
         ctrl->engaged = TRUE;
     }
 }
@@ -1232,7 +961,7 @@ static void sat_selected_cb(GtkComboBox * satsel, gpointer data)
         else
             ctrl->pass = get_pass(ctrl->target, ctrl->qth, ctrl->t, 3.0);
 
-        set_flipped_pass(ctrl);
+        plan_pass(ctrl);
     }
     else
     {
@@ -1246,6 +975,7 @@ static void sat_selected_cb(GtkComboBox * satsel, gpointer data)
             free_pass(ctrl->pass);
             ctrl->pass = NULL;
         }
+        plan_pass(ctrl);
     }
 
     /* in either case, we set the new pass (even if NULL) on the polar plot */
@@ -1459,6 +1189,26 @@ static GtkWidget *create_conf_widgets(GtkRotCtrl * ctrl)
     g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
     gtk_grid_attach(GTK_GRID(table), label, 2, 3, 1, 1);
 
+    /* Lead time */
+    label = gtk_label_new(_("Lead:"));
+    g_object_set(label, "xalign", 1.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 4, 1, 1);
+
+    ctrl->lead_spin = gtk_spin_button_new_with_range(0.0, 30.0, 0.5);
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(ctrl->lead_spin), 1);
+    gtk_widget_set_tooltip_text(ctrl->lead_spin,
+                                _("This parameter sets how long before they "
+                                  "are due the positions of the pass are "
+                                  "sent to the rotator, in addition to the "
+                                  "time the rotator needs to get there."));
+    g_signal_connect(ctrl->lead_spin, "value-changed",
+                     G_CALLBACK(lead_changed_cb), ctrl);
+    gtk_grid_attach(GTK_GRID(table), ctrl->lead_spin, 1, 4, 1, 1);
+
+    label = gtk_label_new(_("sec"));
+    g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 4, 1, 1);
+
     /* load initial rotator configuration */
     rot_selected_cb(GTK_COMBO_BOX(ctrl->DevSel), ctrl);
 
@@ -1551,10 +1301,9 @@ static void gtk_rot_ctrl_init(GtkRotCtrl * ctrl,
     ctrl->threshold = 5.0;
     ctrl->errcnt = 0;
 
-    g_mutex_init(&ctrl->client.mutex);
-    ctrl->client.thread = NULL;
-    ctrl->client.socket = -1;
-    ctrl->client.running = FALSE;
+    ctrl->client = NULL;
+    ctrl->sched = NULL;
+    ctrl->sched_sent = NULL;
 }
 
 static void gtk_rot_ctrl_destroy(GtkWidget * widget)
@@ -1577,14 +1326,12 @@ static void gtk_rot_ctrl_destroy(GtkWidget * widget)
         ctrl->conf = NULL;
     }
 
-    /* stop client thread */
-    if (ctrl->client.running)
-    {
-        ctrl->client.running = FALSE;
-        g_thread_join(ctrl->client.thread);
-    }
+    /* close rotctld connection */
+    rotctld_close(ctrl->client, FALSE);
+    ctrl->client = NULL;
 
-    g_mutex_clear(&ctrl->client.mutex);
+    rotor_schedule_free(ctrl->sched);
+    ctrl->sched = NULL;
 
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
@@ -7,7 +7,9 @@
 
 #include "gtk-sat-module.h"
 #include "predict-tools.h"
+#include "rotctld-client.h"
 #include "rotor-conf.h"
+#include "rotor-schedule.h"
 #include "sgpsdp/sgp4sdp4.h"
 
 #ifdef __cplusplus
@@ -47,6 +49,7 @@ struct _gtk_rot_ctrl {
     GtkWidget      *track;
     GtkWidget      *cycle_spin;      /*!< Update timer cycle */
     GtkWidget      *thld_spin;       /*!< Threshold spin */
+    GtkWidget      *lead_spin;       /*!< Lead time spin */
 
     rotor_conf_t   *conf;
     gdouble         t;          /*!< Time when sat data last has been updated. */
@@ -57,6 +60,8 @@ struct _gtk_rot_ctrl {
     pass_t         *pass;       /*!< Next pass of target satellite */
     qth_t          *qth;        /*!< The QTH for this module */
     gboolean        flipped;    /*!< Whether the current pass loaded is a flip pass or not */
+    rotor_schedule_t *sched;    /*!< Pointing schedule of the current pass */
+    const rotor_setpoint_t *sched_sent; /*!< Setpoint last sent to the rotator */
 
     guint           delay;      /*!< Timeout delay. */
     guint           timerid;    /*!< Timer ID */
@@ -68,20 +73,7 @@ struct _gtk_rot_ctrl {
 
     gint            errcnt;     /*!< Error counter. */
 
-    /* TCP client to rotctld */
-    struct {
-        GThread    *thread;
-        GTimer     *timer;
-        GMutex      mutex;
-        gint        socket;     /* network socket to rotctld */
-        gfloat      azi_in;     /* last AZI angle read from rotctld */
-        gfloat      ele_in;     /* last ELE angle read from rotctld */
-        gfloat      azi_out;    /* AZI target */
-        gfloat      ele_out;    /* ELE target */
-        gboolean    new_trg;    /* new target position set */
-        gboolean    running;
-        gboolean    io_error;
-    } client;
+    rotctld_t      *client;     /*!< Connection to rotctld while engaged. */
 };
 
 struct _GtkRotCtrlClass {
@@ -262,6 +262,60 @@ void gtk_sat_data_init_sat(sat_t * sat, qth_t * qth)
     sat->otype = get_orbit_type(sat);
 }
 
+/**
+ * Reload the data for a satellite in place.
+ *
+ * @param catnum The catalog number of the satellite.
+ * @param sat Pointer to the sat_t structure that should receive the new data.
+ * @param qth Optional QTH info passed on to gtk_sat_data_init_sat().
+ * @return 0 if successful, otherwise the error code of gtk_sat_data_read_sat().
+ *
+ * The .sat file is read into a temporary structure first so that sat is left
+ * untouched if the new data can not be read. On success the names and the
+ * TLE are swapped into sat and the SGP4/SDP4 state is re-initialised. The
+ * sat_t pointer itself remains valid, i.e. views and controllers holding a
+ * reference to it do not need to be rebuilt.
+ */
+gint gtk_sat_data_reload_sat(gint catnum, sat_t * sat, qth_t * qth)
+{
+    sat_t          *tmp;
+    gint            retcode;
+
+    g_return_val_if_fail(sat != NULL, 1);
+
+    tmp = g_new0(sat_t, 1);
+    retcode = gtk_sat_data_read_sat(catnum, tmp);
+
+    if (retcode == 0)
+    {
+        g_free(sat->name);
+        g_free(sat->nickname);
+        g_free(sat->website);
+        sat->name = tmp->name;
+        sat->nickname = tmp->nickname;
+        sat->website = tmp->website;
+        tmp->name = NULL;
+        tmp->nickname = NULL;
+        tmp->website = NULL;
+
+        sat->tle = tmp->tle;
+
+        /* force SGP4/SDP4 re-initialisation with the new elements */
+        sat->flags = 0;
+        select_ephemeris(sat);
+
+        /* AOS/LOS are no longer valid */
+        sat->aos = 0.0;
+        sat->los = 0.0;
+
+        gtk_sat_data_init_sat(sat, qth);
+    }
+
+    gtk_sat_data_free_sat(tmp);
+
+    return retcode;
+}
+
 /**
  * Copy satellite data.
  *
@@ -365,3 +419,157 @@ void gtk_sat_data_free_sat(sat_t * sat)
 
     g_free(sat);
 }
+
+/** A single satellite handled by the loader thread pool. */
+typedef struct {
+    gint            catnum;     /*!< Catalog number of the satellite. */
+    sat_t          *sat;        /*!< The loaded satellite or NULL on error. */
+    gtk_sat_data_loader_t *loader;      /*!< The loader owning this job. */
+} sat_load_job_t;
+
+/** Satellite loader state, see gtk_sat_data_load_sats_start(). */
+struct _gtk_sat_data_loader {
+    sat_load_job_t *jobs;       /*!< One job per requested satellite. */
+    guint           njobs;      /*!< Number of jobs. */
+    guint           pending;    /*!< Jobs not yet finished. */
+    qth_t          *qth;        /*!< Observer used for initialisation. */
+    GMutex          mutex;      /*!< Protects pending. */
+    GCond           cond;       /*!< Signalled when pending drops to 0. */
+};
+
+/** Thread pool shared by all loaders; created on first use. */
+static GThreadPool *load_pool = NULL;
+
+/** Thread pool function reading and initialising one satellite. */
+static void load_sat_worker(gpointer data, gpointer user_data)
+{
+    sat_load_job_t *job = data;
+    gtk_sat_data_loader_t *loader = job->loader;
+    sat_t          *sat;
+
+    (void)user_data;
+
+    sat = g_new0(sat_t, 1);
+    if (gtk_sat_data_read_sat(job->catnum, sat))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Error reading data for #%d"),
+                    __func__, job->catnum);
+        g_free(sat);
+        sat = NULL;
+    }
+    else
+    {
+        gtk_sat_data_init_sat(sat, loader->qth);
+    }
+    job->sat = sat;
+
+    g_mutex_lock(&loader->mutex);
+    if (--loader->pending == 0)
+        g_cond_signal(&loader->cond);
+    g_mutex_unlock(&loader->mutex);
+}
+
+/**
+ * Start loading satellites in the background.
+ *
+ * @param catnums The catalog numbers of the satellites to load.
+ * @param n The number of elements in catnums.
+ * @param qth Observer passed to gtk_sat_data_init_sat(). Must remain valid
+ *            until gtk_sat_data_load_sats_finish() has been called.
+ * @return A loader handle that must be passed to
+ *         gtk_sat_data_load_sats_finish().
+ *
+ * The satellites are read and initialised by a thread pool with one worker
+ * per CPU core, which is shared between all loaders. Several loaders can be
+ * started before the first one is finished, e.g. to restore all modules
+ * concurrently at startup. Must be called from the main thread.
+ */
+gtk_sat_data_loader_t *gtk_sat_data_load_sats_start(const gint * catnums,
+                                                     guint n, qth_t * qth)
+{
+    gtk_sat_data_loader_t *loader;
+    guint           i;
+
+    if (load_pool == NULL)
+        load_pool = g_thread_pool_new(load_sat_worker, NULL,
+                                      (gint) g_get_num_processors(),
+                                      FALSE, NULL);
+
+    loader = g_new0(gtk_sat_data_loader_t, 1);
+    loader->jobs = g_new0(sat_load_job_t, n);
+    loader->njobs = n;
+    loader->pending = n;
+    loader->qth = qth;
+    g_mutex_init(&loader->mutex);
+    g_cond_init(&loader->cond);
+
+    for (i = 0; i < n; i++)
+    {
+        loader->jobs[i].catnum = catnums[i];
+        loader->jobs[i].loader = loader;
+        g_thread_pool_push(load_pool, &loader->jobs[i], NULL);
+    }
+
+    return loader;
+}
+
+/**
+ * Wait for a loader to finish and collect the satellites.
+ *
+ * @param loader The loader returned by gtk_sat_data_load_sats_start().
+ * @param sats Hash table with guint keys (g_int_hash) to insert the
+ *             satellites into. Satellites already in the table are skipped.
+ * @return The number of satellites inserted into sats.
+ *
+ * The satellites are inserted in the order they were requested. The loader
+ * is freed by this function.
+ */
+guint gtk_sat_data_load_sats_finish(gtk_sat_data_loader_t * loader,
+                                    GHashTable * sats)
+{
+    sat_load_job_t *job;
+    guint          *key;
+    guint           succ = 0;
+    guint           i;
+
+    g_mutex_lock(&loader->mutex);
+    while (loader->pending > 0)
+        g_cond_wait(&loader->cond, &loader->mutex);
+    g_mutex_unlock(&loader->mutex);
+
+    for (i = 0; i < loader->njobs; i++)
+    {
+        job = &loader->jobs[i];
+        if (job->sat == NULL)
+            continue;
+
+        /* check whether satellite is already in list
+           in order to avoid duplicates */
+        key = g_new0(guint, 1);
+        *key = job->catnum;
+
+        if (g_hash_table_lookup(sats, key) == NULL)
+        {
+            g_hash_table_insert(sats, key, job->sat);
+            succ++;
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s: Read data for #%d"), __func__, job->catnum);
+        }
+        else
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: Sat #%d already in list"),
+                        __func__, job->catnum);
+            g_free(key);
+            gtk_sat_data_free_sat(job->sat);
+        }
+    }
+
+    g_mutex_clear(&loader->mutex);
+    g_cond_clear(&loader->cond);
+    g_free(loader->jobs);
+    g_free(loader);
+
+    return succ;
+}
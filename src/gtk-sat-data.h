@@ -30,10 +30,21 @@
 #include "qth-data.h"
 
 
+/** Opaque handle for satellites being loaded in the background. */
+typedef struct _gtk_sat_data_loader gtk_sat_data_loader_t;
+
+
 gint            gtk_sat_data_read_sat(gint catnum, sat_t * sat);
 void            gtk_sat_data_init_sat(sat_t * sat, qth_t * qth);
+gint            gtk_sat_data_reload_sat(gint catnum, sat_t * sat,
+                                        qth_t * qth);
 void            gtk_sat_data_copy_sat(const sat_t * source, sat_t * dest,
                                       qth_t * qth);
 void            gtk_sat_data_free_sat(sat_t * sat);
 
+gtk_sat_data_loader_t *gtk_sat_data_load_sats_start(const gint * catnums,
+                                                     guint n, qth_t * qth);
+guint           gtk_sat_data_load_sats_finish(gtk_sat_data_loader_t * loader,
+                                              GHashTable * sats);
+
 #endif
@@ -35,10 +35,12 @@
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
 #include <math.h>
+#include <string.h>
 
 #include "config-keys.h"
 #include "gtk-sat-map.h"
 #include "gtk-sat-map-ground-track.h"
+#include "map-tools.h"
 #include "mod-cfg-get-param.h"
 #include "orbit-tools.h"
 #include "predict-tools.h"
@@ -49,8 +51,19 @@
 static void     create_polylines(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                                  sat_map_obj_t * obj);
 static gboolean ssp_wrap_detected(GtkSatMap * satmap, gdouble x1, gdouble x2);
-static void     free_ssp(gpointer ssp, gpointer data);
 static void     free_line_segment(gpointer data);
+static gdouble  find_orbit_start(sat_t * sat, qth_t * qth, gdouble t);
+static gboolean propagate_orbits(sat_t * sat, qth_t * qth,
+                                 ground_track_t * track, long max_orbit);
+static gboolean ground_track_extend(GtkSatMap * satmap, sat_t * sat,
+                                    qth_t * qth, sat_map_obj_t * obj);
+
+/* Ground track time step: 30 sec. If resolution is too fine, the
+   line drawing routine will filter out unnecessary points. */
+#define TRACK_STEP 0.00035
+
+/* Resolution of the orbit start search: 1 sec */
+#define ORBIT_START_TOL (1.0 / 86400.0)
 
 
 /**
@@ -69,19 +82,15 @@ static void     free_line_segment(gpointer data);
 void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                          sat_map_obj_t * obj)
 {
+    ground_track_t *track = &obj->track_data;
     long            this_orbit; /* current orbit number */
     long            max_orbit;  /* target orbit number, ie. this + num - 1 */
     double          t0;         /* time when this_orbit starts */
-    double          t;
-    ssp_t          *this_ssp;
 
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: Creating ground track for %s"),
                 __func__, sat->nickname);
 
-    /* just to be safe... if empty GSList is not NULL => segfault */
-    obj->track_data.latlon = NULL;
-
     /* get configuration parameters */
     this_orbit = sat->orbit;
     max_orbit = sat->orbit - 1 + mod_cfg_get_int(satmap->cfgdata,
@@ -94,65 +103,29 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: End orbit %d"), __func__, max_orbit);
 
-    /* find the time when the current orbit started */
-
-    /* Iterate backwards in time until we reach sat->orbit < this_orbit.
-       Use predict_calc from predict-tools.c as SGP/SDP driver.
-       As a built-in safety, we stop iteration if the orbit crossing is
-       more than 24 hours back in time.
-     */
-    t0 = satmap->tstamp;        //get_current_daynum ();
-    /* use == instead of >= as it is more robust */
-    for (t = t0; (sat->orbit == this_orbit) && ((t + 1.0) > t0); t -= 0.0007)
-        predict_calc(sat, qth, t);
-
-    /* set it so that we are in the same orbit as this_orbit
-       and not a different one */
-    t += 2 * 0.0007;
-    t0 = t;
-    predict_calc(sat, qth, t0);
+    t0 = find_orbit_start(sat, qth, satmap->tstamp);
 
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: T0: %f (%d)"), __func__, t0, sat->orbit);
 
-    /* calculate (lat,lon) for the required orbits */
-    while ((sat->orbit <= max_orbit) &&
-           (sat->orbit >= this_orbit) && (!decayed(sat)))
+    if (track->latlon == NULL)
     {
-        /* We use 30 sec time steps. If resolution is too fine, the
-           line drawing routine will filter out unnecessary points
-         */
-        t += 0.00035;
-        predict_calc(sat, qth, t);
-
-        /* store this SSP */
-
-        /* Note: g_slist_append() has to traverse the entire list to find the end, which
-           is inefficient when adding multiple elements. Therefore, we use g_slist_prepend()
-           and reverse the entire list when we are done.
-         */
-        this_ssp = g_try_new(ssp_t, 1);
-
-        if (this_ssp == NULL)
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: MAYDAY: Insufficient memory for ground track!"),
-                        __func__);
-            return;
-        }
-
-        this_ssp->lat = sat->ssplat;
-        this_ssp->lon = sat->ssplon;
-        obj->track_data.latlon =
-            g_slist_prepend(obj->track_data.latlon, this_ssp);
-
+        track->latlon = g_array_new(FALSE, FALSE, sizeof(ssp_t));
+        track->orbits = g_array_new(FALSE, TRUE, sizeof(guint));
     }
-    /* log if there is a problem with the orbit calculation */
-    if (sat->orbit != (max_orbit + 1))
+    g_array_set_size(track->latlon, 0);
+    g_array_set_size(track->orbits, 0);
+    track->first_orbit = this_orbit;
+    track->tend = t0 - TRACK_STEP;
+
+    /* calculate (lat,lon) for the required orbits */
+    if (!propagate_orbits(sat, qth, track, max_orbit))
     {
+        /* log if there is a problem with the orbit calculation */
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s: Problem computing ground track for %s"),
                     __func__, sat->nickname);
+        predict_calc(sat, qth, satmap->tstamp);
         return;
     }
 
@@ -160,9 +133,6 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
        view and other places when new ground track is laid out */
     predict_calc(sat, qth, satmap->tstamp);
 
-    /* reverse GSList */
-    obj->track_data.latlon = g_slist_reverse(obj->track_data.latlon);
-
     /* split points into polylines */
     create_polylines(satmap, sat, qth, obj);
 
@@ -170,6 +140,171 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     obj->track_orbit = this_orbit;
 }
 
+/**
+ * Find the time when the current orbit started.
+ *
+ * @param sat Pointer to the satellite object.
+ * @param qth Pointer to the QTH data.
+ * @param t The current time.
+ * @return The start time of the orbit sat is in at time t.
+ *
+ * The orbit counter is a step function of time. The orbit start is bracketed
+ * between t and a time about one orbital period earlier and then located by
+ * bisection. As a built-in safety, the bracket is not searched more than a
+ * few periods back in time.
+ */
+static gdouble find_orbit_start(sat_t * sat, qth_t * qth, gdouble t)
+{
+    long            this_orbit;
+    gdouble         period;
+    gdouble         lo, hi, mid;
+    guint           i;
+
+    predict_calc(sat, qth, t);
+    this_orbit = sat->orbit;
+    period = (sat->meanmo > 0.0) ? 1.0 / sat->meanmo : 1.0;
+
+    hi = t;
+    lo = t - 1.1 * period;
+    predict_calc(sat, qth, lo);
+    for (i = 0; i < 3 && sat->orbit >= this_orbit; i++)
+    {
+        hi = lo;
+        lo -= period;
+        predict_calc(sat, qth, lo);
+    }
+
+    if (sat->orbit >= this_orbit)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not find start of orbit %ld for %s"),
+                    __func__, this_orbit, sat->nickname);
+        predict_calc(sat, qth, hi);
+        return hi;
+    }
+
+    while (hi - lo > ORBIT_START_TOL)
+    {
+        mid = 0.5 * (lo + hi);
+        predict_calc(sat, qth, mid);
+        if (sat->orbit < this_orbit)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    /* leave sat in the same orbit as this_orbit */
+    predict_calc(sat, qth, hi);
+
+    return hi;
+}
+
+/**
+ * Append ground track samples up to and including max_orbit.
+ *
+ * @param sat Pointer to the satellite object.
+ * @param qth Pointer to the QTH data.
+ * @param track The ground track data; sampling continues after track->tend.
+ * @param max_orbit The last orbit to include.
+ * @return TRUE if max_orbit was completed, FALSE if the calculation stopped
+ *         early, e.g. because the satellite decayed.
+ *
+ * Samples are counted against the orbit segment that is last in
+ * track->orbits, so each segment holds one orbit in time order.
+ */
+static gboolean propagate_orbits(sat_t * sat, qth_t * qth,
+                                 ground_track_t * track, long max_orbit)
+{
+    ssp_t           ssp;
+    gdouble         t = track->tend;
+    guint           zero = 0;
+
+    while (TRUE)
+    {
+        t += TRACK_STEP;
+        predict_calc(sat, qth, t);
+
+        if ((sat->orbit > max_orbit) || (sat->orbit < track->first_orbit) ||
+            decayed(sat))
+            break;
+
+        while (sat->orbit >= track->first_orbit + (long)track->orbits->len)
+            g_array_append_val(track->orbits, zero);
+
+        ssp.lat = sat->ssplat;
+        ssp.lon = sat->ssplon;
+        g_array_append_val(track->latlon, ssp);
+        g_array_index(track->orbits, guint, track->orbits->len - 1)++;
+        track->tend = t;
+    }
+
+    return (sat->orbit == max_orbit + 1);
+}
+
+/**
+ * Move the ground track forward to the current orbit.
+ *
+ * @param satmap The satellite map widget.
+ * @param sat Pointer to the satellite object.
+ * @param qth Pointer to the QTH data.
+ * @param obj the satellite object.
+ * @return TRUE if the track was extended, FALSE if it has to be recreated.
+ *
+ * The segments of the orbits that have been completed are removed from the
+ * front of the stored track and the same number of new orbits are appended
+ * at the end, instead of recalculating all orbits. Removing the segments
+ * moves the remaining samples down, which is cheap once per orbit compared
+ * to propagating them again.
+ */
+static gboolean ground_track_extend(GtkSatMap * satmap, sat_t * sat,
+                                    qth_t * qth, sat_map_obj_t * obj)
+{
+    ground_track_t *track = &obj->track_data;
+    long            this_orbit = sat->orbit;
+    long            max_orbit;
+    guint           drop, nsamples, i;
+
+    if (track->latlon == NULL || obj->track_orbit == 0)
+        return FALSE;
+
+    /* only a forward move within the stored orbits can be extended */
+    if ((this_orbit <= track->first_orbit) ||
+        (this_orbit >= track->first_orbit + (long)track->orbits->len))
+        return FALSE;
+
+    max_orbit = this_orbit - 1 + mod_cfg_get_int(satmap->cfgdata,
+                                                 MOD_CFG_MAP_SECTION,
+                                                 MOD_CFG_MAP_TRACK_NUM,
+                                                 SAT_CFG_INT_MAP_TRACK_NUM);
+
+    drop = this_orbit - track->first_orbit;
+    nsamples = 0;
+    for (i = 0; i < drop; i++)
+        nsamples += g_array_index(track->orbits, guint, i);
+
+    g_array_remove_range(track->latlon, 0, nsamples);
+    g_array_remove_range(track->orbits, 0, drop);
+    track->first_orbit = this_orbit;
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Extending ground track for %s to orbit %ld"),
+                __func__, sat->nickname, max_orbit);
+
+    if (!propagate_orbits(sat, qth, track, max_orbit))
+    {
+        predict_calc(sat, qth, satmap->tstamp);
+        return FALSE;
+    }
+
+    predict_calc(sat, qth, satmap->tstamp);
+
+    ground_track_delete(satmap, sat, qth, obj, FALSE);
+    create_polylines(satmap, sat, qth, obj);
+    obj->track_orbit = this_orbit;
+
+    return TRUE;
+}
+
 /**
  * Update the ground track for a satellite.
  *
@@ -180,6 +315,7 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
  * @param recalc Flag indicating whether ground track should be recalculated.
  *
  *    If (recalc=TRUE)
+ *       extend the track to the current orbit if possible, otherwise
  *       call ground_track_delete (clear_ssp=TRUE)
  *       call ground_track_create
  *    Else
@@ -205,8 +341,11 @@ void ground_track_update(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
 
     if (recalc == TRUE)
     {
-        ground_track_delete(satmap, sat, qth, obj, TRUE);
-        ground_track_create(satmap, sat, qth, obj);
+        if (!ground_track_extend(satmap, sat, qth, obj))
+        {
+            ground_track_delete(satmap, sat, qth, obj, TRUE);
+            ground_track_create(satmap, sat, qth, obj);
+        }
     }
     else
     {
@@ -258,168 +397,99 @@ void ground_track_delete(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
     {
         if (obj->track_data.latlon != NULL)
         {
-            /* free allocated ssp_t */
-            g_slist_foreach(obj->track_data.latlon, free_ssp, NULL);
-
-            /* free the SList itself */
-            g_slist_free(obj->track_data.latlon);
+            g_array_free(obj->track_data.latlon, TRUE);
             obj->track_data.latlon = NULL;
-
+            g_array_free(obj->track_data.orbits, TRUE);
+            obj->track_data.orbits = NULL;
         }
 
         obj->track_orbit = 0;
     }
 
-    /* Request redraw */
+    /* Request redraw; ground tracks are cached in the slow layer */
     if (satmap && satmap->canvas)
     {
+        satmap->slow_valid = FALSE;
         gtk_widget_queue_draw(satmap->canvas);
     }
 }
 
 /**
- * Free an ssp_t structure.
+ * Store a polyline as a line segment of the ground track.
  *
- * The ssp_t items in the obj->track_data.latlon GSList are dunamically allocated
- * hence they need to be freed when the cround track is deleted. This function
- * is intended to be called from a g_slist_foreach() iterator.
+ * The points are simplified to within SAT_MAP_LINE_TOLERANCE pixels so that
+ * the number of vertices follows the size of the map.
  */
-static void free_ssp(gpointer ssp, gpointer data)
+static void add_line_segment(sat_map_obj_t * obj, GArray * points)
 {
-    (void)data;
-    g_free(ssp);
+    line_segment_t *segment;
+    guint           n = points->len / 2;
+
+    /* we need at least 2 points to draw a line */
+    if (n < 2)
+        return;
+
+    n = map_tools_simplify_polyline((gdouble *) points->data, n,
+                                    SAT_MAP_LINE_TOLERANCE);
+
+    segment = g_new(line_segment_t, 1);
+    segment->count = n;
+    segment->points = g_new(gdouble, n * 2);
+    memcpy(segment->points, points->data, n * 2 * sizeof(gdouble));
+
+    obj->track_data.lines = g_slist_prepend(obj->track_data.lines, segment);
 }
 
-/** Create polylines (line segments) for Cairo drawing. */
+/**
+ * Create polylines (line segments) for Cairo drawing.
+ *
+ * The SSPs are converted to map coordinates and split into polylines where
+ * the ground track wraps around the map borders. This is done again when the
+ * map is resized, since the simplification depends on the map size.
+ */
 static void create_polylines(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                              sat_map_obj_t * obj)
 {
-    ssp_t          *ssp, *buff; /* map coordinates */
-    double          lastx, lasty;
-    GSList         *points = NULL;
-    guint           start;
-    guint           i, j, n, num_points;
-    line_segment_t *segment;
+    GArray         *points;
+    ssp_t          *ssp;
+    gdouble         x, y;
+    gdouble         lastx = 0.0;
+    guint           i, n;
 
     (void)sat;
     (void)qth;
 
-    /* initialise parameters */
-    lastx = -50.0;
-    lasty = -50.0;
-    start = 0;
-    num_points = 0;
-    n = g_slist_length(obj->track_data.latlon);
+    n = (obj->track_data.latlon != NULL) ? obj->track_data.latlon->len : 0;
+    points = g_array_sized_new(FALSE, FALSE, sizeof(gdouble), 2 * n);
 
     /* loop over each SSP */
     for (i = 0; i < n; i++)
     {
-        buff = (ssp_t *) g_slist_nth_data(obj->track_data.latlon, i);
-        ssp = g_try_new(ssp_t, 1);
-        gtk_sat_map_lonlat_to_xy(satmap, buff->lon, buff->lat, &ssp->lon,
-                                 &ssp->lat);
+        ssp = &g_array_index(obj->track_data.latlon, ssp_t, i);
+        gtk_sat_map_lonlat_to_xy(satmap, ssp->lon, ssp->lat, &x, &y);
 
-        /* if this is the first point, just add it to the list */
-        if (i == start)
-        {
-            points = g_slist_prepend(points, ssp);
-            lastx = ssp->lon;
-            lasty = ssp->lat;
-        }
-        else
+        /* if SSP is on the other side of the map, start a new polyline */
+        if (i > 0 && ssp_wrap_detected(satmap, lastx, x))
         {
-            /* if SSP is on the other side of the map */
-            if (ssp_wrap_detected(satmap, lastx, ssp->lon))
-            {
-                points = g_slist_reverse(points);
-                num_points = g_slist_length(points);
-
-                /* we need at least 2 points to draw a line */
-                if (num_points > 1)
-                {
-                    /* Create a line segment with points array */
-                    segment = g_try_new(line_segment_t, 1);
-                    if (segment)
-                    {
-                        segment->count = num_points;
-                        segment->points = g_new(gdouble, num_points * 2);
-
-                        for (j = 0; j < num_points; j++)
-                        {
-                            buff = (ssp_t *)g_slist_nth_data(points, j);
-                            segment->points[2 * j] = buff->lon;
-                            segment->points[2 * j + 1] = buff->lat;
-                        }
-
-                        /* Store segment in sat object */
-                        obj->track_data.lines =
-                            g_slist_append(obj->track_data.lines, segment);
-                    }
-                }
-
-                /* reset parameters and continue with a new set */
-                g_slist_foreach(points, free_ssp, NULL);
-                g_slist_free(points);
-                points = NULL;
-                start = i;
-                lastx = ssp->lon;
-                lasty = ssp->lat;
-                num_points = 0;
-
-                /* Add current SSP to the new list */
-                points = g_slist_prepend(points, ssp);
-                lastx = ssp->lon;
-                lasty = ssp->lat;
-            }
-
-            /* else if this SSP is separable from the previous */
-            else if ((fabs(lastx - ssp->lon) > 1.0) ||
-                     (fabs(lasty - ssp->lat) > 1.0))
-            {
-
-                /* add SSP to list */
-                points = g_slist_prepend(points, ssp);
-                lastx = ssp->lon;
-                lasty = ssp->lat;
-            }
-            /* else do nothing */
-            else g_free(ssp);
+            add_line_segment(obj, points);
+            g_array_set_size(points, 0);
         }
+
+        g_array_append_val(points, x);
+        g_array_append_val(points, y);
+        lastx = x;
     }
 
-    /* create (last) line if we have at least two points */
-    points = g_slist_reverse(points);
-    num_points = g_slist_length(points);
+    /* create (last) line */
+    add_line_segment(obj, points);
+    obj->track_data.lines = g_slist_reverse(obj->track_data.lines);
 
-    if (num_points > 1)
-    {
-        /* Create a line segment with points array */
-        segment = g_try_new(line_segment_t, 1);
-        if (segment)
-        {
-            segment->count = num_points;
-            segment->points = g_new(gdouble, num_points * 2);
-
-            for (j = 0; j < num_points; j++)
-            {
-                buff = (ssp_t *)g_slist_nth_data(points, j);
-                segment->points[2 * j] = buff->lon;
-                segment->points[2 * j + 1] = buff->lat;
-            }
-
-            /* Store segment in sat object */
-            obj->track_data.lines =
-                g_slist_append(obj->track_data.lines, segment);
-        }
-
-        /* reset parameters and continue with a new set */
-        g_slist_foreach(points, free_ssp, NULL);
-        g_slist_free(points);
-    }
+    g_array_free(points, TRUE);
 
-    /* Request redraw */
+    /* Request redraw; ground tracks are cached in the slow layer */
     if (satmap && satmap->canvas)
     {
+        satmap->slow_valid = FALSE;
         gtk_widget_queue_draw(satmap->canvas);
     }
 }
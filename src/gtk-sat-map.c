@@ -40,6 +40,7 @@
 #include "orbit-tools.h"
 #include "predict-tools.h"
 #include "sat-cfg.h"
+#include "sat-index.h"
 #include "sat-info.h"
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
@@ -50,6 +51,23 @@
 /* Update terminator every 30 seconds */
 #define TERMINATOR_UPDATE_INTERVAL (15.0/86400.0)
 
+/* Coverage heatmap: 1 degree grid, 24 hours in 1 minute steps, updated
+   every hour */
+#define COVERAGE_NLON 360
+#define COVERAGE_NLAT 180
+#define COVERAGE_WINDOW 1.0
+#define COVERAGE_STEP (1.0/1440.0)
+#define COVERAGE_UPDATE_INTERVAL (1.0/24.0)
+
+/** Position and size of the map on the canvas. */
+typedef struct {
+    guint           x0;
+    guint           y0;
+    guint           width;
+    guint           height;
+    gdouble         left_side_lon;      /*!< Longitude at x0. */
+} map_geom_t;
+
 static void     gtk_sat_map_class_init(GtkSatMapClass * class,
                                        gpointer class_data);
 static void     gtk_sat_map_init(GtkSatMap * polview,
@@ -72,29 +90,30 @@ static gboolean on_button_press(GtkWidget * widget, GdkEventButton * event,
 static gboolean on_button_release(GtkWidget * widget, GdkEventButton * event,
                                   gpointer data);
 static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data);
+static gboolean query_tooltip(GtkWidget * widget, gint x, gint y,
+                              gboolean keyboard_mode, GtkTooltip * tooltip,
+                              gpointer data);
 static void     clear_selection(gpointer key, gpointer val, gpointer data);
 static void     load_map_file(GtkSatMap * satmap, float clon);
 static gdouble  arccos(gdouble, gdouble);
-static gboolean pole_is_covered(sat_t * sat);
 static gboolean north_pole_is_covered(sat_t * sat);
 static gboolean south_pole_is_covered(sat_t * sat);
 static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
                            gdouble mapbreak);
-static guint    calculate_footprint(GtkSatMap * satmap, sat_t * sat,
+static guint    calculate_footprint(const map_geom_t * geom, sat_t * sat,
                                     sat_map_obj_t * obj);
-static void     split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
+static void     split_points(const map_geom_t * geom, sat_t * sat,
+                             gdouble sspx, const gdouble * points,
                              gdouble * points1, gint * n1,
                              gdouble * points2, gint * n2);
-static void     sort_points_x(GtkSatMap * satmap, sat_t * sat,
-                              gdouble * points, gint num);
-static void     sort_points_y(GtkSatMap * satmap, sat_t * sat,
-                              gdouble * points, gint num);
-static gint     compare_coordinates_x(gconstpointer a, gconstpointer b,
-                                      gpointer data);
-static gint     compare_coordinates_y(gconstpointer a, gconstpointer b,
-                                      gpointer data);
+static void     sort_points_x(const map_geom_t * geom, sat_t * sat,
+                              const gdouble * points, gdouble * sorted,
+                              gint num);
 static void     update_selected(GtkSatMap * satmap, sat_t * sat);
 static void     redraw_terminator(GtkSatMap * satmap);
+static void     start_coverage(GtkSatMap * satmap);
+static void     discard_coverage(GtkSatMap * satmap);
+static void     draw_coverage(GtkSatMap * satmap, cairo_t * cr);
 static gchar   *aoslos_time_to_str(GtkSatMap * satmap, sat_t * sat);
 static void     gtk_sat_map_load_showtracks(GtkSatMap * map);
 static void     gtk_sat_map_store_showtracks(GtkSatMap * satmap);
@@ -106,9 +125,20 @@ static sat_map_obj_t *find_sat_at_pos(GtkSatMap * satmap, gfloat mx, gfloat my);
 
 static GtkBoxClass *parent_class = NULL;
 
-/* Temporary arrays for footprint calculation */
-static gdouble *temp_points1 = NULL;
-static gdouble *temp_points2 = NULL;
+/* Cell size of the marker and label grids in pixels */
+#define GRID_CELL_SIZE 32.0
+
+/* Radius around a marker that selects the satellite */
+#define HIT_RADIUS 10.0
+
+/* Number of points in a complete footprint polygon */
+#define FOOTPRINT_POINTS (2 * SAT_MAP_RANGE_CIRCLE_POINTS)
+
+/* cos() of the footprint azimuths, filled by init_footprint_cos() */
+static gdouble  footprint_cos[SAT_MAP_RANGE_CIRCLE_POINTS];
+
+/* Scratch polygon for footprint calculation */
+static gdouble  footprint_points[2 * FOOTPRINT_POINTS];
 
 /** Convert rgba color to cairo-friendly format */
 static void rgba_to_cairo(guint32 rgba, gdouble * r, gdouble * g,
@@ -147,6 +177,15 @@ GType gtk_sat_map_get_type()
     return gtk_sat_map_type;
 }
 
+/** Tabulate cos() of the footprint azimuths. */
+static void init_footprint_cos(void)
+{
+    guint           azi;
+
+    for (azi = 0; azi < SAT_MAP_RANGE_CIRCLE_POINTS; azi++)
+        footprint_cos[azi] = cos(de2ra * azi);
+}
+
 static void gtk_sat_map_class_init(GtkSatMapClass * class,
                                    gpointer class_data)
 {
@@ -154,6 +193,8 @@ static void gtk_sat_map_class_init(GtkSatMapClass * class,
 
     (void)class_data;
 
+    init_footprint_cos();
+
     widget_class = (GtkWidgetClass *) class;
     widget_class->destroy = gtk_sat_map_destroy;
     parent_class = g_type_class_peek_parent(class);
@@ -184,6 +225,8 @@ static void gtk_sat_map_init(GtkSatMap * satmap,
     satmap->satfp = FALSE;
     satmap->satmarker = FALSE;
     satmap->show_terminator = FALSE;
+    satmap->show_coverage = FALSE;
+    satmap->show_daynight = FALSE;
     satmap->qthinfo = FALSE;
     satmap->eventinfo = FALSE;
     satmap->cursinfo = FALSE;
@@ -196,9 +239,24 @@ static void gtk_sat_map_init(GtkSatMap * satmap,
     satmap->sel_text = NULL;
     satmap->terminator_points = NULL;
     satmap->terminator_count = 0;
+    satmap->shading = map_shading_new();
+    satmap->coverage = NULL;
+    satmap->coverage_surface = NULL;
+    satmap->coverage_job = NULL;
     satmap->font = NULL;
     satmap->map = NULL;
-    satmap->grid_lines_valid = FALSE;
+    satmap->static_layer = NULL;
+    satmap->slow_layer = NULL;
+    satmap->layer_width = 0;
+    satmap->layer_height = 0;
+    satmap->static_valid = FALSE;
+    satmap->slow_valid = FALSE;
+    satmap->static_time = 0;
+    satmap->slow_time = 0;
+    satmap->dynamic_time = 0;
+    satmap->dynamic_count = 0;
+    satmap->markers = sat_grid_new(GRID_CELL_SIZE);
+    satmap->labels = sat_grid_new(GRID_CELL_SIZE);
 }
 
 static void gtk_sat_map_destroy(GtkWidget * widget)
@@ -217,12 +275,15 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
         g_hash_table_destroy(satmap->obj);
         satmap->obj = NULL;
 
-        /* free the original map pixbuf */
-        if (satmap->origmap)
-        {
-            g_object_unref(satmap->origmap);
-            satmap->origmap = NULL;
-        }
+        map_shading_free(satmap->shading);
+        satmap->shading = NULL;
+
+        /* a running coverage computation frees itself when done */
+        discard_coverage(satmap);
+
+        /* release the shared map pyramid */
+        map_cache_release(satmap->mapcache);
+        satmap->mapcache = NULL;
 
         /* free the scaled map pixbuf */
         if (satmap->map)
@@ -250,17 +311,29 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
         g_free(satmap->infobgd);
         satmap->infobgd = NULL;
 
+        /* free cached layers */
+        if (satmap->static_layer)
+        {
+            cairo_surface_destroy(satmap->static_layer);
+            satmap->static_layer = NULL;
+        }
+        if (satmap->slow_layer)
+        {
+            cairo_surface_destroy(satmap->slow_layer);
+            satmap->slow_layer = NULL;
+        }
+
         /* free terminator points */
         g_free(satmap->terminator_points);
         satmap->terminator_points = NULL;
         satmap->terminator_count = 0;
-
-        /* free temporary point arrays */
-        g_free(temp_points1);
-        temp_points1 = NULL;
-        g_free(temp_points2);
-        temp_points2 = NULL;
     }
+
+    sat_grid_free(satmap->markers);
+    satmap->markers = NULL;
+    sat_grid_free(satmap->labels);
+    satmap->labels = NULL;
+
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
@@ -323,6 +396,16 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
                                                MOD_CFG_MAP_SHOW_TERMINATOR,
                                                SAT_CFG_BOOL_MAP_SHOW_TERMINATOR);
 
+    satmap->show_coverage = mod_cfg_get_bool(cfgdata,
+                                             MOD_CFG_MAP_SECTION,
+                                             MOD_CFG_MAP_SHOW_COVERAGE,
+                                             SAT_CFG_BOOL_MAP_SHOW_COVERAGE);
+
+    satmap->show_daynight = mod_cfg_get_bool(cfgdata,
+                                             MOD_CFG_MAP_SECTION,
+                                             MOD_CFG_MAP_SHOW_DAYNIGHT,
+                                             SAT_CFG_BOOL_MAP_SHOW_DAYNIGHT);
+
     satmap->keepratio = mod_cfg_get_bool(cfgdata,
                                          MOD_CFG_MAP_SECTION,
                                          MOD_CFG_MAP_KEEP_RATIO,
@@ -368,6 +451,14 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
                                              MOD_CFG_MAP_SECTION,
                                              MOD_CFG_MAP_TERMINATOR_COL,
                                              SAT_CFG_INT_MAP_TERMINATOR_COL);
+    satmap->col_global_shadow = mod_cfg_get_int(cfgdata,
+                                                MOD_CFG_MAP_SECTION,
+                                                MOD_CFG_MAP_GLOBAL_SHADOW_COL,
+                                                SAT_CFG_INT_MAP_GLOBAL_SHADOW_COL);
+    satmap->col_sat_cov = mod_cfg_get_int(cfgdata,
+                                          MOD_CFG_MAP_SECTION,
+                                          MOD_CFG_MAP_SAT_COV_COL,
+                                          SAT_CFG_INT_MAP_SAT_COV_COL);
 
     /* Get default font */
     g_value_init(&font_value, G_TYPE_STRING);
@@ -393,15 +484,13 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
     satmap->x0 = 0;
     satmap->y0 = 0;
 
-    /* Allocate temporary point arrays for footprint calculation */
-    temp_points1 = g_new0(gdouble, 720);
-    temp_points2 = g_new0(gdouble, 720);
-
     /* Connect signals */
     gtk_widget_add_events(satmap->canvas, GDK_POINTER_MOTION_MASK |
                           GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK);
 
     g_signal_connect(satmap->canvas, "draw", G_CALLBACK(on_draw), satmap);
+    g_signal_connect(satmap->canvas, "query-tooltip",
+                     G_CALLBACK(query_tooltip), satmap);
     g_signal_connect(satmap->canvas, "motion-notify-event",
                      G_CALLBACK(on_motion_notify), satmap);
     g_signal_connect(satmap->canvas, "button-press-event",
@@ -438,131 +527,204 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
     return GTK_WIDGET(satmap);
 }
 
-/** Draw callback for the canvas */
-static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
+/** Create a Pango layout using the map font */
+static PangoLayout *create_layout(GtkSatMap * satmap, cairo_t * cr)
 {
-    GtkSatMap      *satmap = GTK_SAT_MAP(data);
-    gdouble         r, g, b, a;
     PangoLayout    *layout;
     PangoFontDescription *font_desc;
+
+    layout = pango_cairo_create_layout(cr);
+    font_desc = pango_font_description_from_string(satmap->font ?
+                                                   satmap->font : "Sans 9");
+    pango_layout_set_font_description(layout, font_desc);
+    pango_font_description_free(font_desc);
+
+    return layout;
+}
+
+/**
+ * Mark the cached layers invalid so that they are redrawn in on_draw().
+ *
+ * @param satmap The GtkSatMap widget.
+ * @param all If TRUE the static layer is invalidated too, otherwise only the
+ *            slow layer.
+ */
+static void invalidate_layers(GtkSatMap * satmap, gboolean all)
+{
+    if (all)
+        satmap->static_valid = FALSE;
+    satmap->slow_valid = FALSE;
+}
+
+/** Offset in pixels of the 0 lon centred map at the current map centre. */
+static gint map_shift(GtkSatMap * satmap)
+{
+    return (gint) rint(fmod(satmap->left_side_lon + 540.0, 360.0) *
+                       satmap->width / 360.0) % satmap->width;
+}
+
+/**
+ * Draw the static layer: background map, coverage heatmap, grid lines and
+ * grid labels.
+ *
+ * This layer only changes when the map is resized or reconfigured, or when
+ * a new coverage heatmap is ready.
+ */
+static void draw_static_layer(GtkSatMap * satmap, cairo_t * cr)
+{
+    gdouble         r, g, b, a;
+    PangoLayout    *layout;
     gint            tw, th;
-    GHashTableIter  iter;
-    gpointer        key, value;
-    sat_map_obj_t  *obj;
-    gfloat          x, y;
     gdouble         xstep, ystep;
     guint           i;
     gfloat          lon, lat;
-    gchar          *buf;
+    gchar           buf[16];
     gchar           hmf = ' ';
-    guint32         globe_shadow_col;
-    GSList         *line_node;
-
-    (void)widget;
+    gboolean        use_nsew;
+    gint            shift;
 
     /* Draw background map */
-    if (satmap->map)
-    {
-        gdk_cairo_set_source_pixbuf(cr, satmap->map, satmap->x0, satmap->y0);
+    if (satmap->map && satmap->width > 0)
+    {
+        /* the map is centred on 0 lon; recentre by wrapping it around */
+        shift = map_shift(satmap);
+
+        cairo_save(cr);
+        cairo_rectangle(cr, satmap->x0, satmap->y0,
+                        satmap->width, satmap->height);
+        cairo_clip(cr);
+        gdk_cairo_set_source_pixbuf(cr, satmap->map,
+                                    satmap->x0 - shift, satmap->y0);
+        cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_REPEAT);
         cairo_paint(cr);
+        cairo_restore(cr);
     }
 
-    /* Set up font */
-    layout = pango_cairo_create_layout(cr);
-    font_desc = pango_font_description_from_string(satmap->font ? satmap->font : "Sans 9");
-    pango_layout_set_font_description(layout, font_desc);
+    if (satmap->show_coverage && satmap->coverage_surface)
+        draw_coverage(satmap, cr);
 
     /* Draw grid lines if enabled */
-    if (satmap->showgrid && satmap->width > 0 && satmap->height > 0)
+    if (!satmap->showgrid || satmap->width == 0 || satmap->height == 0)
+        return;
+
+    layout = create_layout(satmap, cr);
+    use_nsew = sat_cfg_get_bool(SAT_CFG_BOOL_USE_NSEW);
+
+    rgba_to_cairo(satmap->col_grid, &r, &g, &b, &a);
+    cairo_set_source_rgba(cr, r, g, b, a);
+    cairo_set_line_width(cr, 0.5);
+
+    xstep = (gdouble)(30.0 * satmap->width / 360.0);
+    ystep = (gdouble)(30.0 * satmap->height / 180.0);
+
+    /* Horizontal grid lines */
+    for (i = 0; i < 5; i++)
     {
-        rgba_to_cairo(satmap->col_grid, &r, &g, &b, &a);
-        cairo_set_source_rgba(cr, r, g, b, a);
-        cairo_set_line_width(cr, 0.5);
+        cairo_move_to(cr, (gdouble)satmap->x0,
+                      (gdouble)(satmap->y0 + (i + 1) * ystep));
+        cairo_line_to(cr, (gdouble)(satmap->x0 + satmap->width),
+                      (gdouble)(satmap->y0 + (i + 1) * ystep));
+    }
 
-        xstep = (gdouble)(30.0 * satmap->width / 360.0);
-        ystep = (gdouble)(30.0 * satmap->height / 180.0);
+    /* Vertical grid lines */
+    for (i = 0; i < 11; i++)
+    {
+        cairo_move_to(cr, (gdouble)(satmap->x0 + (i + 1) * xstep),
+                      (gdouble)satmap->y0);
+        cairo_line_to(cr, (gdouble)(satmap->x0 + (i + 1) * xstep),
+                      (gdouble)(satmap->y0 + satmap->height));
+    }
+    cairo_stroke(cr);
 
-        /* Horizontal grid lines */
-        for (i = 0; i < 5; i++)
+    /* Latitude labels */
+    for (i = 0; i < 5; i++)
+    {
+        xy_to_lonlat(satmap, satmap->x0, satmap->y0 + (i + 1) * ystep,
+                     &lon, &lat);
+        hmf = ' ';
+        if (use_nsew)
         {
-            cairo_move_to(cr, (gdouble)satmap->x0,
-                          (gdouble)(satmap->y0 + (i + 1) * ystep));
-            cairo_line_to(cr, (gdouble)(satmap->x0 + satmap->width),
-                          (gdouble)(satmap->y0 + (i + 1) * ystep));
-            cairo_stroke(cr);
-
-            /* Label */
-            xy_to_lonlat(satmap, satmap->x0, satmap->y0 + (i + 1) * ystep,
-                         &lon, &lat);
-            hmf = ' ';
-            if (sat_cfg_get_bool(SAT_CFG_BOOL_USE_NSEW))
+            if (lat < 0.00)
             {
-                if (lat < 0.00)
-                {
-                    lat = -lat;
-                    hmf = 'S';
-                }
-                else
-                {
-                    hmf = 'N';
-                }
+                lat = -lat;
+                hmf = 'S';
+            }
+            else
+            {
+                hmf = 'N';
             }
-            buf = g_strdup_printf("%.0f\302\260%c", lat, hmf);
-            pango_layout_set_text(layout, buf, -1);
-            pango_layout_get_pixel_size(layout, &tw, &th);
-            cairo_move_to(cr, (gdouble)(satmap->x0 + 15),
-                          (gdouble)(satmap->y0 + (i + 1) * ystep));
-            pango_cairo_show_layout(cr, layout);
-            g_free(buf);
         }
+        g_snprintf(buf, sizeof(buf), "%.0f\302\260%c", lat, hmf);
+        pango_layout_set_text(layout, buf, -1);
+        cairo_move_to(cr, (gdouble)(satmap->x0 + 15),
+                      (gdouble)(satmap->y0 + (i + 1) * ystep));
+        pango_cairo_show_layout(cr, layout);
+    }
 
-        /* Vertical grid lines */
-        for (i = 0; i < 11; i++)
+    /* Longitude labels */
+    for (i = 0; i < 11; i++)
+    {
+        xy_to_lonlat(satmap, satmap->x0 + (i + 1) * xstep, satmap->y0,
+                     &lon, &lat);
+        hmf = ' ';
+        if (use_nsew)
         {
-            cairo_move_to(cr, (gdouble)(satmap->x0 + (i + 1) * xstep),
-                          (gdouble)satmap->y0);
-            cairo_line_to(cr, (gdouble)(satmap->x0 + (i + 1) * xstep),
-                          (gdouble)(satmap->y0 + satmap->height));
-            cairo_stroke(cr);
-
-            /* Label */
-            xy_to_lonlat(satmap, satmap->x0 + (i + 1) * xstep, satmap->y0,
-                         &lon, &lat);
-            hmf = ' ';
-            if (sat_cfg_get_bool(SAT_CFG_BOOL_USE_NSEW))
+            if (lon < 0.00)
             {
-                if (lon < 0.00)
-                {
-                    lon = -lon;
-                    hmf = 'W';
-                }
-                else
-                {
-                    hmf = 'E';
-                }
+                lon = -lon;
+                hmf = 'W';
+            }
+            else
+            {
+                hmf = 'E';
             }
-            buf = g_strdup_printf("%.0f\302\260%c", lon, hmf);
-            pango_layout_set_text(layout, buf, -1);
-            pango_layout_get_pixel_size(layout, &tw, &th);
-            cairo_move_to(cr, (gdouble)(satmap->x0 + (i + 1) * xstep),
-                          (gdouble)(satmap->y0 + satmap->height - 5 - th));
-            pango_cairo_show_layout(cr, layout);
-            g_free(buf);
         }
+        g_snprintf(buf, sizeof(buf), "%.0f\302\260%c", lon, hmf);
+        pango_layout_set_text(layout, buf, -1);
+        pango_layout_get_pixel_size(layout, &tw, &th);
+        cairo_move_to(cr, (gdouble)(satmap->x0 + (i + 1) * xstep),
+                      (gdouble)(satmap->y0 + satmap->height - 5 - th));
+        pango_cairo_show_layout(cr, layout);
+    }
+
+    g_object_unref(layout);
+}
+
+/**
+ * Draw the slow layer: solar terminator, globe shadow and ground tracks.
+ *
+ * This layer is redrawn when the terminator is recalculated or a ground
+ * track is created, updated or deleted.
+ */
+static void draw_slow_layer(GtkSatMap * satmap, cairo_t * cr)
+{
+    gdouble         r, g, b, a;
+    GHashTableIter  iter;
+    gpointer        key, value;
+    sat_map_obj_t  *obj;
+    line_segment_t *seg;
+    GSList         *line_node;
+    cairo_surface_t *shading;
+    guint           i;
+
+    /* start from a transparent surface */
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
+    /* Draw day/night shading if enabled */
+    shading = satmap->show_daynight ?
+        map_shading_get_surface(satmap->shading) : NULL;
+    if (shading)
+    {
+        cairo_set_source_surface(cr, shading, satmap->x0, satmap->y0);
+        cairo_paint(cr);
     }
 
-    /* Draw terminator if enabled */
+    /* Draw terminator if enabled; only the line when shading is shown */
     if (satmap->show_terminator && satmap->terminator_points &&
         satmap->terminator_count > 2)
     {
-        globe_shadow_col = mod_cfg_get_int(satmap->cfgdata,
-                                           MOD_CFG_MAP_SECTION,
-                                           MOD_CFG_MAP_GLOBAL_SHADOW_COL,
-                                           SAT_CFG_INT_MAP_GLOBAL_SHADOW_COL);
-
-        rgba_to_cairo(globe_shadow_col, &r, &g, &b, &a);
-        cairo_set_source_rgba(cr, r, g, b, a);
-
         cairo_move_to(cr, satmap->terminator_points[0],
                       satmap->terminator_points[1]);
         for (i = 1; i < (guint)satmap->terminator_count; i++)
@@ -571,7 +733,12 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
                           satmap->terminator_points[2 * i + 1]);
         }
         cairo_close_path(cr);
-        cairo_fill_preserve(cr);
+        if (shading == NULL)
+        {
+            rgba_to_cairo(satmap->col_global_shadow, &r, &g, &b, &a);
+            cairo_set_source_rgba(cr, r, g, b, a);
+            cairo_fill_preserve(cr);
+        }
 
         rgba_to_cairo(satmap->col_terminator, &r, &g, &b, &a);
         cairo_set_source_rgba(cr, r, g, b, a);
@@ -579,6 +746,163 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
         cairo_stroke(cr);
     }
 
+    if (satmap->obj == NULL)
+        return;
+
+    /* Draw ground tracks */
+    rgba_to_cairo(satmap->col_track, &r, &g, &b, &a);
+    cairo_set_source_rgba(cr, r, g, b, a);
+    cairo_set_line_width(cr, 1.0);
+
+    g_hash_table_iter_init(&iter, satmap->obj);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+    {
+        obj = SAT_MAP_OBJ(value);
+        if (!obj->showtrack)
+            continue;
+
+        for (line_node = obj->track_data.lines; line_node != NULL;
+             line_node = line_node->next)
+        {
+            seg = (line_segment_t *) line_node->data;
+            if (seg == NULL || seg->points == NULL || seg->count < 2)
+                continue;
+
+            cairo_move_to(cr, seg->points[0], seg->points[1]);
+            for (i = 1; i < (guint)seg->count; i++)
+            {
+                cairo_line_to(cr, seg->points[2 * i],
+                              seg->points[2 * i + 1]);
+            }
+        }
+    }
+    cairo_stroke(cr);
+}
+
+/** Draw a closed footprint polygon */
+static void draw_footprint(GtkSatMap * satmap, cairo_t * cr,
+                           sat_map_obj_t * obj, gdouble * points, gint count)
+{
+    gdouble         r, g, b, a;
+    gint            i;
+
+    rgba_to_cairo(satmap->col_sat_cov, &r, &g, &b, &a);
+    cairo_set_source_rgba(cr, r, g, b, a);
+
+    cairo_move_to(cr, points[0], points[1]);
+    for (i = 1; i < count; i++)
+        cairo_line_to(cr, points[2 * i], points[2 * i + 1]);
+    cairo_close_path(cr);
+    cairo_fill_preserve(cr);
+
+    if (obj->selected)
+        rgba_to_cairo(satmap->col_sat_sel, &r, &g, &b, &a);
+    else
+        rgba_to_cairo(satmap->col_sat, &r, &g, &b, &a);
+    cairo_set_source_rgba(cr, r, g, b, a);
+    cairo_set_line_width(cr, 1.0);
+    cairo_stroke(cr);
+}
+
+/**
+ * Place and draw the label of a satellite.
+ *
+ * The preferred position depends on where the satellite is on the map. If
+ * the label would overlap a label that has already been drawn, the other
+ * positions around the marker are tried. When all of them are taken the
+ * label is skipped, except for the selected satellite.
+ */
+static void draw_sat_label(GtkSatMap * satmap, cairo_t * cr,
+                           PangoLayout * layout, sat_map_obj_t * obj)
+{
+    gdouble         r, g, b, a;
+    gdouble         lx[4], ly[4];
+    gint            tw, th;
+    gint            first, i, k;
+
+    pango_layout_set_text(layout, obj->nickname, -1);
+    pango_layout_get_pixel_size(layout, &tw, &th);
+
+    /* below, above, right and left of the marker */
+    lx[0] = obj->x - tw / 2;
+    ly[0] = obj->y + 2;
+    lx[1] = obj->x - tw / 2;
+    ly[1] = obj->y - 2 - th;
+    lx[2] = obj->x + 3;
+    ly[2] = obj->y;
+    lx[3] = obj->x - 3 - tw;
+    ly[3] = obj->y;
+
+    if (obj->x < 50)
+        first = 2;
+    else if ((satmap->width - obj->x) < 50)
+        first = 3;
+    else if ((satmap->height - obj->y) < 25)
+        first = 1;
+    else
+        first = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        k = (first + i) % 4;
+
+        /* alternatives must stay on the map */
+        if (k != first &&
+            (lx[k] < satmap->x0 || ly[k] < satmap->y0 ||
+             lx[k] + tw > satmap->x0 + satmap->width ||
+             ly[k] + th > satmap->y0 + satmap->height))
+            continue;
+
+        if (!sat_grid_overlaps(satmap->labels, lx[k], ly[k],
+                               lx[k] + tw + 1, ly[k] + th + 1))
+            break;
+    }
+
+    if (i == 4)
+    {
+        if (!obj->selected)
+            return;
+        k = first;
+    }
+
+    sat_grid_add(satmap->labels, lx[k], ly[k], lx[k] + tw + 1,
+                 ly[k] + th + 1, NULL);
+
+    /* shadow */
+    rgba_to_cairo(satmap->col_shadow, &r, &g, &b, &a);
+    cairo_set_source_rgba(cr, 0, 0, 0, a);
+    cairo_move_to(cr, lx[k] + 1, ly[k] + 1);
+    pango_cairo_show_layout(cr, layout);
+
+    if (obj->selected)
+        rgba_to_cairo(satmap->col_sat_sel, &r, &g, &b, &a);
+    else
+        rgba_to_cairo(satmap->col_sat, &r, &g, &b, &a);
+    cairo_set_source_rgba(cr, r, g, b, a);
+    cairo_move_to(cr, lx[k], ly[k]);
+    pango_cairo_show_layout(cr, layout);
+}
+
+/**
+ * Draw the dynamic layer: QTH, satellite markers, footprints, labels and
+ * info texts.
+ *
+ * This layer is drawn directly on the widget on every frame.
+ */
+static void draw_dynamic_layer(GtkSatMap * satmap, cairo_t * cr)
+{
+    gdouble         r, g, b, a;
+    PangoLayout    *layout;
+    gint            tw, th;
+    GHashTableIter  iter;
+    gpointer        key, value;
+    sat_map_obj_t  *obj;
+    gfloat          x, y;
+    gboolean        show_fp;
+    gboolean        show_marker;
+
+    layout = create_layout(satmap, cr);
+
     /* Draw QTH marker */
     lonlat_to_xy(satmap, satmap->qth->lon, satmap->qth->lat, &x, &y);
     rgba_to_cairo(satmap->col_qth, &r, &g, &b, &a);
@@ -593,103 +917,31 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
     cairo_move_to(cr, x - tw / 2, y + 2);
     pango_cairo_show_layout(cr, layout);
 
-    /* Draw satellite objects */
+    /* Draw satellite objects and index the markers for hit testing */
     if (satmap->obj)
     {
+        sat_grid_reset(satmap->markers, satmap->x0 + satmap->width,
+                       satmap->y0 + satmap->height);
+
         g_hash_table_iter_init(&iter, satmap->obj);
         while (g_hash_table_iter_next(&iter, &key, &value))
         {
             obj = SAT_MAP_OBJ(value);
 
-            /* Draw ground track if enabled */
-            if (obj->showtrack && obj->track_data.lines)
-            {
-                rgba_to_cairo(satmap->col_track, &r, &g, &b, &a);
-                cairo_set_source_rgba(cr, r, g, b, a);
-                cairo_set_line_width(cr, 1.0);
-
-                line_node = obj->track_data.lines;
-                while (line_node)
-                {
-                    line_segment_t *seg = (line_segment_t *)line_node->data;
-
-                    if (seg && seg->points && seg->count > 1)
-                    {
-                        cairo_move_to(cr, seg->points[0], seg->points[1]);
-
-                        for (i = 1; i < (guint)seg->count; i++)
-                        {
-                            cairo_line_to(cr, seg->points[2 * i], 
-                                              seg->points[2 * i + 1]);
-                        }
-                        cairo_stroke(cr);
-                    }
-                    line_node = line_node->next;
-                }
-            }
-
             /* Check visibility conditions */
-            gboolean show_fp = satmap->satfp || obj->selected;
-            gboolean show_marker = satmap->satmarker || obj->selected;
-            gboolean show_label = satmap->satname || obj->selected;
+            show_fp = satmap->satfp || obj->selected;
+            show_marker = satmap->satmarker || obj->selected;
 
             /* Draw range circle(s) / footprint */
             if (show_fp && obj->showcov)
             {
-                guint32 covcol = mod_cfg_get_int(satmap->cfgdata,
-                                                 MOD_CFG_MAP_SECTION,
-                                                 MOD_CFG_MAP_SAT_COV_COL,
-                                                 SAT_CFG_INT_MAP_SAT_COV_COL);
-
-                /* Draw first range circle */
                 if (obj->range1_points && obj->range1_count > 2)
-                {
-                    rgba_to_cairo(covcol, &r, &g, &b, &a);
-                    cairo_set_source_rgba(cr, r, g, b, a);
-
-                    cairo_move_to(cr, obj->range1_points[0],
-                                  obj->range1_points[1]);
-                    for (i = 1; i < (guint)obj->range1_count; i++)
-                    {
-                        cairo_line_to(cr, obj->range1_points[2 * i],
-                                      obj->range1_points[2 * i + 1]);
-                    }
-                    cairo_close_path(cr);
-                    cairo_fill_preserve(cr);
-
-                    if (obj->selected)
-                        rgba_to_cairo(satmap->col_sat_sel, &r, &g, &b, &a);
-                    else
-                        rgba_to_cairo(satmap->col_sat, &r, &g, &b, &a);
-                    cairo_set_source_rgba(cr, r, g, b, a);
-                    cairo_set_line_width(cr, 1.0);
-                    cairo_stroke(cr);
-                }
+                    draw_footprint(satmap, cr, obj, obj->range1_points,
+                                   obj->range1_count);
 
-                /* Draw second range circle if present */
                 if (obj->range2_points && obj->range2_count > 2)
-                {
-                    rgba_to_cairo(covcol, &r, &g, &b, &a);
-                    cairo_set_source_rgba(cr, r, g, b, a);
-
-                    cairo_move_to(cr, obj->range2_points[0],
-                                  obj->range2_points[1]);
-                    for (i = 1; i < (guint)obj->range2_count; i++)
-                    {
-                        cairo_line_to(cr, obj->range2_points[2 * i],
-                                      obj->range2_points[2 * i + 1]);
-                    }
-                    cairo_close_path(cr);
-                    cairo_fill_preserve(cr);
-
-                    if (obj->selected)
-                        rgba_to_cairo(satmap->col_sat_sel, &r, &g, &b, &a);
-                    else
-                        rgba_to_cairo(satmap->col_sat, &r, &g, &b, &a);
-                    cairo_set_source_rgba(cr, r, g, b, a);
-                    cairo_set_line_width(cr, 1.0);
-                    cairo_stroke(cr);
-                }
+                    draw_footprint(satmap, cr, obj, obj->range2_points,
+                                   obj->range2_count);
             }
 
             /* Draw satellite marker shadow */
@@ -717,45 +969,31 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
                 cairo_fill(cr);
             }
 
-            /* Draw satellite label shadow */
-            if (show_label && obj->nickname)
-            {
-                rgba_to_cairo(satmap->col_shadow, &r, &g, &b, &a);
-                cairo_set_source_rgba(cr, 0, 0, 0, a);
-                pango_layout_set_text(layout, obj->nickname, -1);
-                pango_layout_get_pixel_size(layout, &tw, &th);
-
-                if (obj->x < 50)
-                    cairo_move_to(cr, obj->x + 3 + 1, obj->y + 1);
-                else if ((satmap->width - obj->x) < 50)
-                    cairo_move_to(cr, obj->x - 3 - tw + 1, obj->y + 1);
-                else if ((satmap->height - obj->y) < 25)
-                    cairo_move_to(cr, obj->x - tw / 2 + 1, obj->y - 2 - th + 1);
-                else
-                    cairo_move_to(cr, obj->x - tw / 2 + 1, obj->y + 2 + 1);
-                pango_cairo_show_layout(cr, layout);
-            }
+            sat_grid_add(satmap->markers, obj->x, obj->y, obj->x, obj->y,
+                         GINT_TO_POINTER(obj->catnum));
+        }
+
+        /* Place the labels greedily, selected satellite first, so that
+           labels do not overlap */
+        sat_grid_reset(satmap->labels, satmap->x0 + satmap->width,
+                       satmap->y0 + satmap->height);
+
+        g_hash_table_iter_init(&iter, satmap->obj);
+        while (g_hash_table_iter_next(&iter, &key, &value))
+        {
+            obj = SAT_MAP_OBJ(value);
+            if (obj->selected && obj->nickname)
+                draw_sat_label(satmap, cr, layout, obj);
+        }
 
-            /* Draw satellite label */
-            if (show_label && obj->nickname)
+        if (satmap->satname)
+        {
+            g_hash_table_iter_init(&iter, satmap->obj);
+            while (g_hash_table_iter_next(&iter, &key, &value))
             {
-                if (obj->selected)
-                    rgba_to_cairo(satmap->col_sat_sel, &r, &g, &b, &a);
-                else
-                    rgba_to_cairo(satmap->col_sat, &r, &g, &b, &a);
-                cairo_set_source_rgba(cr, r, g, b, a);
-                pango_layout_set_text(layout, obj->nickname, -1);
-                pango_layout_get_pixel_size(layout, &tw, &th);
-
-                if (obj->x < 50)
-                    cairo_move_to(cr, obj->x + 3, obj->y);
-                else if ((satmap->width - obj->x) < 50)
-                    cairo_move_to(cr, obj->x - 3 - tw, obj->y);
-                else if ((satmap->height - obj->y) < 25)
-                    cairo_move_to(cr, obj->x - tw / 2, obj->y - 2 - th);
-                else
-                    cairo_move_to(cr, obj->x - tw / 2, obj->y + 2);
-                pango_cairo_show_layout(cr, layout);
+                obj = SAT_MAP_OBJ(value);
+                if (!obj->selected && obj->nickname)
+                    draw_sat_label(satmap, cr, layout, obj);
             }
         }
     }
@@ -802,34 +1040,123 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
         pango_cairo_show_layout(cr, layout);
     }
 
-    pango_font_description_free(font_desc);
     g_object_unref(layout);
+}
+
+/**
+ * Draw callback for the canvas.
+ *
+ * The map is composed of three layers. The static and slow layers are kept
+ * in offscreen surfaces and only redrawn when they have been invalidated,
+ * while the dynamic layer is drawn on top of them on every frame. The time
+ * spent on each layer is logged at debug level.
+ */
+static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    cairo_t        *lcr;
+    gint            width, height;
+    gint64          t0;
+
+    width = gtk_widget_get_allocated_width(widget);
+    height = gtk_widget_get_allocated_height(widget);
+
+    /* (re)create layer surfaces when the canvas size changes */
+    if (satmap->static_layer == NULL || satmap->layer_width != width ||
+        satmap->layer_height != height)
+    {
+        if (satmap->static_layer)
+            cairo_surface_destroy(satmap->static_layer);
+        if (satmap->slow_layer)
+            cairo_surface_destroy(satmap->slow_layer);
+
+        satmap->static_layer =
+            gdk_window_create_similar_surface(gtk_widget_get_window(widget),
+                                              CAIRO_CONTENT_COLOR_ALPHA,
+                                              width, height);
+        satmap->slow_layer =
+            gdk_window_create_similar_surface(gtk_widget_get_window(widget),
+                                              CAIRO_CONTENT_COLOR_ALPHA,
+                                              width, height);
+        satmap->layer_width = width;
+        satmap->layer_height = height;
+        invalidate_layers(satmap, TRUE);
+    }
+
+    if (!satmap->static_valid)
+    {
+        t0 = g_get_monotonic_time();
+        lcr = cairo_create(satmap->static_layer);
+        cairo_set_operator(lcr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(lcr);
+        cairo_set_operator(lcr, CAIRO_OPERATOR_OVER);
+        draw_static_layer(satmap, lcr);
+        cairo_destroy(lcr);
+        satmap->static_valid = TRUE;
+        satmap->static_time = g_get_monotonic_time() - t0;
+
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Static layer redrawn in %" G_GINT64_FORMAT " us"),
+                    __func__, satmap->static_time);
+    }
+
+    if (!satmap->slow_valid)
+    {
+        t0 = g_get_monotonic_time();
+        lcr = cairo_create(satmap->slow_layer);
+        draw_slow_layer(satmap, lcr);
+        cairo_destroy(lcr);
+        satmap->slow_valid = TRUE;
+        satmap->slow_time = g_get_monotonic_time() - t0;
+
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Slow layer redrawn in %" G_GINT64_FORMAT " us"),
+                    __func__, satmap->slow_time);
+    }
+
+    cairo_set_source_surface(cr, satmap->static_layer, 0, 0);
+    cairo_paint(cr);
+    cairo_set_source_surface(cr, satmap->slow_layer, 0, 0);
+    cairo_paint(cr);
+
+    t0 = g_get_monotonic_time();
+    draw_dynamic_layer(satmap, cr);
+    satmap->dynamic_time += g_get_monotonic_time() - t0;
+    satmap->dynamic_count++;
+
+    if (satmap->dynamic_count == 100)
+    {
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Dynamic layer average %" G_GINT64_FORMAT
+                      " us over %d frames"), __func__,
+                    satmap->dynamic_time / satmap->dynamic_count,
+                    satmap->dynamic_count);
+        satmap->dynamic_time = 0;
+        satmap->dynamic_count = 0;
+    }
 
     return FALSE;
 }
 
-/** Find satellite object at given position */
+/**
+ * Find satellite object at given position.
+ *
+ * Uses the marker grid built when the map was last drawn, i.e. the positions
+ * the user sees.
+ */
 static sat_map_obj_t *find_sat_at_pos(GtkSatMap * satmap, gfloat mx, gfloat my)
 {
-    GHashTableIter  iter;
-    gpointer        key, value;
-    sat_map_obj_t  *obj;
-    gfloat          dx, dy;
-    const gfloat    hit_radius = 10.0;
+    gint            catnum;
 
     if (satmap->obj == NULL)
         return NULL;
 
-    g_hash_table_iter_init(&iter, satmap->obj);
-    while (g_hash_table_iter_next(&iter, &key, &value))
-    {
-        obj = SAT_MAP_OBJ(value);
-        dx = mx - obj->x;
-        dy = my - obj->y;
-        if (dx * dx + dy * dy < hit_radius * hit_radius)
-            return obj;
-    }
-    return NULL;
+    catnum = GPOINTER_TO_INT(sat_grid_find(satmap->markers, mx, my,
+                                           HIT_RADIUS));
+    if (catnum == 0)
+        return NULL;
+
+    return SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &catnum));
 }
 
 static void size_allocate_cb(GtkWidget * widget, GtkAllocation * allocation,
@@ -852,8 +1179,8 @@ static void update_map_size(GtkSatMap * satmap)
 
         if (satmap->keepratio)
         {
-            ratio = (gfloat)gdk_pixbuf_get_width(satmap->origmap) /
-                (gfloat)gdk_pixbuf_get_height(satmap->origmap);
+            ratio = (gfloat)map_cache_get_width(satmap->mapcache) /
+                (gfloat)map_cache_get_height(satmap->mapcache);
 
             gfloat size = MIN(allocation.width, ratio * allocation.height);
 
@@ -863,10 +1190,8 @@ static void update_map_size(GtkSatMap * satmap)
             satmap->x0 = (allocation.width - satmap->width) / 2;
             satmap->y0 = (allocation.height - satmap->height) / 2;
 
-            pbuf = gdk_pixbuf_scale_simple(satmap->origmap,
-                                           satmap->width,
-                                           satmap->height,
-                                           GDK_INTERP_BILINEAR);
+            pbuf = map_cache_scale(satmap->mapcache,
+                                   satmap->width, satmap->height);
         }
         else
         {
@@ -875,19 +1200,23 @@ static void update_map_size(GtkSatMap * satmap)
             satmap->width = allocation.width;
             satmap->height = allocation.height;
 
-            pbuf = gdk_pixbuf_scale_simple(satmap->origmap,
-                                           satmap->width,
-                                           satmap->height,
-                                           GDK_INTERP_BILINEAR);
+            pbuf = map_cache_scale(satmap->mapcache,
+                                   satmap->width, satmap->height);
         }
 
         if (satmap->map)
             g_object_unref(satmap->map);
         satmap->map = pbuf;
+        invalidate_layers(satmap, TRUE);
 
         if (satmap->show_terminator)
             redraw_terminator(satmap);
 
+        if (satmap->show_daynight)
+            map_shading_update(satmap->shading, satmap->width,
+                               satmap->height, satmap->left_side_lon,
+                               satmap->tstamp, satmap->col_global_shadow);
+
         g_hash_table_foreach(satmap->sats, update_sat, satmap);
         satmap->resize = FALSE;
 
@@ -933,6 +1262,20 @@ void gtk_sat_map_update(GtkWidget * widget)
             redraw_terminator(satmap);
         }
 
+        /* Update day/night shading; only redrawn when the sun has moved */
+        if (satmap->show_daynight &&
+            map_shading_update(satmap->shading, satmap->width,
+                               satmap->height, satmap->left_side_lon,
+                               satmap->tstamp, satmap->col_global_shadow))
+            invalidate_layers(satmap, FALSE);
+
+        /* Start a new coverage computation if the window has moved */
+        if (satmap->show_coverage && satmap->coverage_job == NULL &&
+            (satmap->coverage == NULL ||
+             fabs(satmap->tstamp - satmap->coverage->t0) >
+             COVERAGE_UPDATE_INTERVAL))
+            start_coverage(satmap);
+
         if (satmap->eventinfo)
         {
             if (satmap->ncat > 0)
@@ -1022,8 +1365,17 @@ void gtk_sat_map_update(GtkWidget * widget)
     }
 }
 
-static void lonlat_to_xy(GtkSatMap * p, gdouble lon, gdouble lat, gfloat * x,
-                         gfloat * y)
+static void map_geom(GtkSatMap * satmap, map_geom_t * geom)
+{
+    geom->x0 = satmap->x0;
+    geom->y0 = satmap->y0;
+    geom->width = satmap->width;
+    geom->height = satmap->height;
+    geom->left_side_lon = satmap->left_side_lon;
+}
+
+static void geom_lonlat_to_xy(const map_geom_t * p, gdouble lon, gdouble lat,
+                              gfloat * x, gfloat * y)
 {
     *x = p->x0 + (lon - p->left_side_lon) * p->width / 360.0;
     *y = p->y0 + (90.0 - lat) * p->height / 180.0;
@@ -1033,6 +1385,15 @@ static void lonlat_to_xy(GtkSatMap * p, gdouble lon, gdouble lat, gfloat * x,
         *x -= p->width;
 }
 
+static void lonlat_to_xy(GtkSatMap * p, gdouble lon, gdouble lat, gfloat * x,
+                         gfloat * y)
+{
+    map_geom_t      geom;
+
+    map_geom(p, &geom);
+    geom_lonlat_to_xy(&geom, lon, lat, x, y);
+}
+
 static void xy_to_lonlat(GtkSatMap * p, gfloat x, gfloat y, gfloat * lon,
                          gfloat * lat)
 {
@@ -1044,6 +1405,60 @@ static void xy_to_lonlat(GtkSatMap * p, gfloat x, gfloat y, gfloat * lon,
         *lon += 360;
 }
 
+/**
+ * Show the tooltip of the satellite under the pointer.
+ *
+ * Tooltip texts are only generated here, when GTK asks for them, instead of
+ * for every satellite on every update.
+ */
+static gboolean query_tooltip(GtkWidget * widget, gint x, gint y,
+                              gboolean keyboard_mode, GtkTooltip * tooltip,
+                              gpointer data)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    sat_map_obj_t  *obj;
+    sat_t          *sat;
+    GdkRectangle    area;
+    gchar          *aosstr;
+    gchar          *text;
+
+    (void)widget;
+
+    if (keyboard_mode)
+        return FALSE;
+
+    obj = find_sat_at_pos(satmap, x, y);
+    if (obj == NULL)
+        return FALSE;
+
+    sat = SAT(g_hash_table_lookup(satmap->sats, &obj->catnum));
+    if (sat == NULL)
+        return FALSE;
+
+    aosstr = aoslos_time_to_str(satmap, sat);
+    text = g_markup_printf_escaped("<b>%s</b>\n"
+                                   "Lon: %5.1f\302\260\n"
+                                   "Lat: %5.1f\302\260\n"
+                                   " Az: %5.1f\302\260\n"
+                                   " El: %5.1f\302\260\n"
+                                   "%s",
+                                   sat->nickname,
+                                   sat->ssplon, sat->ssplat,
+                                   sat->az, sat->el, aosstr);
+    gtk_tooltip_set_markup(tooltip, text);
+    g_free(text);
+    g_free(aosstr);
+
+    /* ask again when the pointer leaves the marker */
+    area.x = obj->x - HIT_RADIUS;
+    area.y = obj->y - HIT_RADIUS;
+    area.width = 2 * HIT_RADIUS;
+    area.height = 2 * HIT_RADIUS;
+    gtk_tooltip_set_tip_area(tooltip, &area);
+
+    return TRUE;
+}
+
 static gboolean on_motion_notify(GtkWidget * widget, GdkEventMotion * event,
                                  gpointer data)
 {
@@ -1198,16 +1613,19 @@ void gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum)
 
 void gtk_sat_map_reconf(GtkWidget * widget, GKeyFile * cfgdat)
 {
-    (void)widget;
+    GtkSatMap      *satmap = GTK_SAT_MAP(widget);
+
     (void)cfgdat;
+
+    /* global settings like NSEW may have changed */
+    invalidate_layers(satmap, TRUE);
+    gtk_widget_queue_draw(satmap->canvas);
 }
 
 static void load_map_file(GtkSatMap * satmap, float clon)
 {
     gchar          *buff;
     gchar          *mapfile;
-    GError         *error = NULL;
-    GdkPixbuf      *tmpbuf;
 
     buff = mod_cfg_get_str(satmap->cfgdata,
                            MOD_CFG_MAP_SECTION,
@@ -1245,29 +1663,15 @@ static void load_map_file(GtkSatMap * satmap, float clon)
                     __FILE__, __LINE__, mapfile);
     }
 
-    tmpbuf = gdk_pixbuf_new_from_file(mapfile, &error);
-
-    if (error != NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: Error loading map file (%s)"),
-                    __FILE__, __LINE__, error->message);
-        g_clear_error(&error);
-
-        tmpbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 400, 200);
-        gdk_pixbuf_fill(tmpbuf, 0x0F0F0F0F);
-    }
-
-    satmap->origmap = gdk_pixbuf_new(GDK_COLORSPACE_RGB,
-                                     FALSE,
-                                     gdk_pixbuf_get_bits_per_sample(tmpbuf),
-                                     gdk_pixbuf_get_width(tmpbuf),
-                                     gdk_pixbuf_get_height(tmpbuf));
-
-    map_tools_shift_center(tmpbuf, satmap->origmap, clon);
-    g_object_unref(tmpbuf);
+    /* shared with other maps; recentring is done when drawing */
+    satmap->mapcache = map_cache_get(mapfile);
     g_free(mapfile);
 
+    if (clon > 180.0)
+        clon = 180.0;
+    else if (clon < -180.0)
+        clon = -180.0;
+
     satmap->left_side_lon = -180.0;
     if (clon > 0.0)
         satmap->left_side_lon += clon;
@@ -1288,14 +1692,6 @@ static gdouble arccos(gdouble x, gdouble y)
     return 0.0;
 }
 
-static gboolean pole_is_covered(sat_t * sat)
-{
-    if (north_pole_is_covered(sat) || south_pole_is_covered(sat))
-        return TRUE;
-    else
-        return FALSE;
-}
-
 static gboolean north_pole_is_covered(sat_t * sat)
 {
     int             ret1;
@@ -1376,40 +1772,44 @@ static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
     return warped;
 }
 
-static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat,
+static guint calculate_footprint(const map_geom_t * geom, sat_t * sat,
                                  sat_map_obj_t * obj)
 {
+    gdouble        *points = footprint_points;
     guint           azi;
     gfloat          sx, sy, msx, msy, ssx, ssy;
-    gdouble         ssplat, ssplon, beta, azimuth, num, dem;
-    gdouble         rangelon, rangelat, mlon;
+    gdouble         ssplon, sinlat, coslat, beta, sinbeta, cosbeta;
+    gdouble         rangelon, rangelat, sinrlat, cosrlat, num, dem, mlon;
+    gboolean        npole;
     gboolean        warped = FALSE;
     guint           numrc = 1;
     gint            n1, n2;
 
-    ssplat = sat->ssplat * de2ra;
     ssplon = sat->ssplon * de2ra;
+    sinlat = sin(sat->ssplat * de2ra);
+    coslat = cos(sat->ssplat * de2ra);
     beta = (0.5 * sat->footprint) / xkmper;
-
-    for (azi = 0; azi < 180; azi++)
-    {
-        azimuth = de2ra * (double)azi;
-        rangelat = asin(sin(ssplat) * cos(beta) + cos(azimuth) *
-                        sin(beta) * cos(ssplat));
-        num = cos(beta) - (sin(ssplat) * sin(rangelat));
-        dem = cos(ssplat) * cos(rangelat);
-
-        if (azi == 0 && north_pole_is_covered(sat))
+    sinbeta = sin(beta);
+    cosbeta = cos(beta);
+    npole = north_pole_is_covered(sat);
+
+    for (azi = 0; azi < SAT_MAP_RANGE_CIRCLE_POINTS; azi++)
+    {
+        /* sin(rangelat) is the asin() argument and cos(rangelat) follows
+           from it, so only asin() and acos() remain per point */
+        sinrlat = sinlat * cosbeta + footprint_cos[azi] * sinbeta * coslat;
+        sinrlat = CLAMP(sinrlat, -1.0, 1.0);
+        cosrlat = sqrt(1.0 - sinrlat * sinrlat);
+        rangelat = asin(sinrlat);
+        num = cosbeta - sinlat * sinrlat;
+        dem = coslat * cosrlat;
+
+        if (azi == 0 && npole)
             rangelon = ssplon + pi;
         else if (fabs(num / dem) > 1.0)
             rangelon = ssplon;
         else
-        {
-            if ((180.0 - azi) >= 0)
-                rangelon = ssplon - arccos(num, dem);
-            else
-                rangelon = ssplon + arccos(num, dem);
-        }
+            rangelon = ssplon - arccos(num, dem);
 
         while (rangelon < -pi)
             rangelon += twopi;
@@ -1420,298 +1820,276 @@ static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat,
         rangelat = rangelat / de2ra;
         rangelon = rangelon / de2ra;
 
-        if (mirror_lon(sat, rangelon, &mlon, satmap->left_side_lon))
+        if (mirror_lon(sat, rangelon, &mlon, geom->left_side_lon))
             warped = TRUE;
 
-        lonlat_to_xy(satmap, rangelon, rangelat, &sx, &sy);
-        lonlat_to_xy(satmap, mlon, rangelat, &msx, &msy);
+        geom_lonlat_to_xy(geom, rangelon, rangelat, &sx, &sy);
+        geom_lonlat_to_xy(geom, mlon, rangelat, &msx, &msy);
 
-        temp_points1[2 * azi] = sx;
-        temp_points1[2 * azi + 1] = sy;
+        points[2 * azi] = sx;
+        points[2 * azi + 1] = sy;
 
-        temp_points1[718 - 2 * azi] = msx;
-        temp_points1[719 - 2 * azi] = msy;
+        points[2 * FOOTPRINT_POINTS - 2 - 2 * azi] = msx;
+        points[2 * FOOTPRINT_POINTS - 1 - 2 * azi] = msy;
     }
 
-    if (pole_is_covered(sat))
+    /* the buffers have a fixed size and are reused for the life of obj */
+    if (obj->range1_points == NULL)
+        obj->range1_points = g_new(gdouble, 2 * FOOTPRINT_POINTS);
+    if (obj->range2_points == NULL)
+        obj->range2_points = g_new(gdouble, 2 * FOOTPRINT_POINTS);
+
+    if (npole || south_pole_is_covered(sat))
     {
-        sort_points_x(satmap, sat, temp_points1, 360);
+        sort_points_x(geom, sat, points, obj->range1_points, FOOTPRINT_POINTS);
         numrc = 1;
-        n1 = 360;
+        n1 = FOOTPRINT_POINTS;
         n2 = 0;
     }
     else if (warped == TRUE)
     {
-        lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &ssx, &ssy);
-        n1 = 360;
-        n2 = 360;
-        split_points(satmap, sat, ssx, temp_points1, &n1, temp_points2, &n2);
+        geom_lonlat_to_xy(geom, sat->ssplon, sat->ssplat, &ssx, &ssy);
+        split_points(geom, sat, ssx, points, obj->range1_points, &n1,
+                     obj->range2_points, &n2);
         numrc = 2;
     }
     else
     {
+        memcpy(obj->range1_points, points,
+               2 * FOOTPRINT_POINTS * sizeof(gdouble));
         numrc = 1;
-        n1 = 360;
+        n1 = FOOTPRINT_POINTS;
         n2 = 0;
     }
 
-    g_free(obj->range1_points);
-    obj->range1_points = g_new(gdouble, n1 * 2);
-    memcpy(obj->range1_points, temp_points1, n1 * 2 * sizeof(gdouble));
     obj->range1_count = n1;
+    obj->range2_count = n2;
+
+    return numrc;
+}
 
-    if (numrc == 2 && n2 > 0)
+/** Append footprint point i to the side of the map it is on. */
+static void split_point(const gdouble * points, gint i, gdouble mid,
+                        gdouble * points1, gint * np1,
+                        gdouble * points2, gint * np2)
+{
+    if (points[2 * i] > mid)
     {
-        g_free(obj->range2_points);
-        obj->range2_points = g_new(gdouble, n2 * 2);
-        memcpy(obj->range2_points, temp_points2, n2 * 2 * sizeof(gdouble));
-        obj->range2_count = n2;
+        points1[2 * *np1] = points[2 * i];
+        points1[2 * *np1 + 1] = points[2 * i + 1];
+        (*np1)++;
     }
     else
     {
-        g_free(obj->range2_points);
-        obj->range2_points = NULL;
-        obj->range2_count = 0;
+        points2[2 * *np2] = points[2 * i];
+        points2[2 * *np2 + 1] = points[2 * i + 1];
+        (*np2)++;
     }
-
-    return numrc;
 }
 
-static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
+/**
+ * Split a footprint crossing the edge of the map into two polygons.
+ *
+ * @param geom The map geometry.
+ * @param sat The satellite.
+ * @param sspx X coordinate of the sub-satellite point.
+ * @param points The FOOTPRINT_POINTS points of the footprint.
+ * @param points1 Buffer for the first polygon.
+ * @param n1 Number of points in the first polygon.
+ * @param points2 Buffer for the second polygon.
+ * @param n2 Number of points in the second polygon.
+ */
+static void split_points(const map_geom_t * geom, sat_t * sat, gdouble sspx,
+                         const gdouble * points,
                          gdouble * points1, gint * n1,
                          gdouble * points2, gint * n2)
 {
-    gdouble        *tps1, *tps2;
-    gint            n, np1, np2, ns, i, j, k;
+    gdouble         mid = geom->x0 + geom->width / 2;
+    gint            n, np1, np2, ns, i;
 
-    n = 360;
+    n = FOOTPRINT_POINTS;
     np1 = 0;
     np2 = 0;
     i = 0;
-    j = 0;
-    k = 0;
     ns = 0;
-    tps1 = g_new0(gdouble, n * 2);
-    tps2 = g_new0(gdouble, n * 2);
 
     if ((sat->ssplon >= 179.4) || (sat->ssplon <= -179.4))
     {
-        for (i = 0; i < n; i++)
+        /* Both halves of the footprint have the same latitude at a given
+           azimuth and the latitude decreases with the azimuth, so visiting
+           the azimuths in order fills each side already sorted by y. */
+        for (i = 0; i < n / 2; i++)
         {
-            if (points1[2 * i] > (satmap->x0 + satmap->width / 2))
-            {
-                tps1[2 * np1] = points1[2 * i];
-                tps1[2 * np1 + 1] = points1[2 * i + 1];
-                np1++;
-            }
-            else
-            {
-                tps2[2 * np2] = points1[2 * i];
-                tps2[2 * np2 + 1] = points1[2 * i + 1];
-                np2++;
-            }
+            split_point(points, i, mid, points1, &np1, points2, &np2);
+            split_point(points, n - 1 - i, mid, points1, &np1, points2,
+                        &np2);
         }
-
-        sort_points_y(satmap, sat, tps1, np1);
-        sort_points_y(satmap, sat, tps2, np2);
     }
-    else if (sspx < (satmap->x0 + satmap->width / 2))
+    else if (sspx < mid)
     {
-        while (points1[2 * i] <= sspx)
+        while (i < n && points[2 * i] <= sspx)
         {
             i++;
         }
         ns = i - 1;
 
-        while (points1[2 * i] > (satmap->x0 + satmap->width / 2))
+        while (i < n && points[2 * i] > mid)
         {
-            tps2[2 * j] = points1[2 * i];
-            tps2[2 * j + 1] = points1[2 * i + 1];
+            points2[2 * np2] = points[2 * i];
+            points2[2 * np2 + 1] = points[2 * i + 1];
             i++;
-            j++;
             np2++;
         }
 
         while (i < n)
         {
-            tps1[2 * k] = points1[2 * i];
-            tps1[2 * k + 1] = points1[2 * i + 1];
+            points1[2 * np1] = points[2 * i];
+            points1[2 * np1 + 1] = points[2 * i + 1];
             i++;
-            k++;
             np1++;
         }
 
         for (i = 0; i <= ns; i++)
         {
-            tps1[2 * k] = points1[2 * i];
-            tps1[2 * k + 1] = points1[2 * i + 1];
-            k++;
+            points1[2 * np1] = points[2 * i];
+            points1[2 * np1 + 1] = points[2 * i + 1];
             np1++;
         }
     }
     else
     {
         i = n - 1;
-        while (points1[2 * i] >= sspx)
+        while (i >= 0 && points[2 * i] >= sspx)
         {
             i--;
         }
         ns = i + 1;
 
-        while (points1[2 * i] < (satmap->x0 + satmap->width / 2))
+        while (i >= 0 && points[2 * i] < mid)
         {
-            tps2[2 * j] = points1[2 * i];
-            tps2[2 * j + 1] = points1[2 * i + 1];
+            points2[2 * np2] = points[2 * i];
+            points2[2 * np2 + 1] = points[2 * i + 1];
             i--;
-            j++;
             np2++;
         }
 
         while (i >= 0)
         {
-            tps1[2 * k] = points1[2 * i];
-            tps1[2 * k + 1] = points1[2 * i + 1];
+            points1[2 * np1] = points[2 * i];
+            points1[2 * np1 + 1] = points[2 * i + 1];
             i--;
-            k++;
             np1++;
         }
 
         for (i = n - 1; i >= ns; i--)
         {
-            tps1[2 * k] = points1[2 * i];
-            tps1[2 * k + 1] = points1[2 * i + 1];
-            k++;
+            points1[2 * np1] = points[2 * i];
+            points1[2 * np1 + 1] = points[2 * i + 1];
             np1++;
         }
     }
 
-    for (i = 0; i < np1; i++)
-    {
-        points1[2 * i] = tps1[2 * i];
-        points1[2 * i + 1] = tps1[2 * i + 1];
-    }
     *n1 = np1;
-
-    for (i = 0; i < np2; i++)
-    {
-        points2[2 * i] = tps2[2 * i];
-        points2[2 * i + 1] = tps2[2 * i + 1];
-    }
     *n2 = np2;
 
-    g_free(tps1);
-    g_free(tps2);
-
     if (np1 > 0 && np2 > 0)
     {
-        if (points1[0] > (satmap->x0 + satmap->width / 2))
+        if (points1[0] > mid)
         {
-            points1[0] = satmap->x0 + satmap->width;
-            points1[2 * (np1 - 1)] = satmap->x0 + satmap->width;
-            points2[0] = satmap->x0;
-            points2[2 * (np2 - 1)] = satmap->x0;
+            points1[0] = geom->x0 + geom->width;
+            points1[2 * (np1 - 1)] = geom->x0 + geom->width;
+            points2[0] = geom->x0;
+            points2[2 * (np2 - 1)] = geom->x0;
         }
         else
         {
-            points2[0] = satmap->x0 + satmap->width;
-            points2[2 * (np2 - 1)] = satmap->x0 + satmap->width;
-            points1[0] = satmap->x0;
-            points1[2 * (np1 - 1)] = satmap->x0;
+            points2[0] = geom->x0 + geom->width;
+            points2[2 * (np2 - 1)] = geom->x0 + geom->width;
+            points1[0] = geom->x0;
+            points1[2 * (np1 - 1)] = geom->x0;
         }
     }
 }
 
-static void sort_points_x(GtkSatMap * satmap, sat_t * sat,
-                          gdouble * points, gint num)
+/**
+ * Sort the points of a footprint covering a pole by x and close the
+ * polygon along the top or bottom edge of the map.
+ *
+ * @param geom The map geometry.
+ * @param sat The satellite.
+ * @param points The footprint points.
+ * @param sorted Buffer for the sorted points.
+ * @param num The number of points (FOOTPRINT_POINTS).
+ *
+ * When a pole is covered the footprint crosses each meridian once and the
+ * longitude grows monotonically around the polygon, so the points are
+ * already sorted except for a single wrap at the map edge. Starting at the
+ * smallest x gives the sorted order; the insertion pass only moves the odd
+ * point that rounding has put out of place.
+ */
+static void sort_points_x(const map_geom_t * geom, sat_t * sat,
+                          const gdouble * points, gdouble * sorted, gint num)
 {
-    gsize           size = 2 * sizeof(double);
+    gdouble         x, y;
+    gint            first = 0;
+    gint            i, j;
 
-#if GLIB_CHECK_VERSION(2, 82, 0)
-    g_sort_array(points, num, size, compare_coordinates_x, NULL);
-#else
-    g_qsort_with_data(points, num, size, compare_coordinates_x, NULL);
-#endif
+    for (i = 1; i < num; i++)
+        if (points[2 * i] < points[2 * first])
+            first = i;
+
+    for (i = 0; i < num; i++)
+    {
+        j = (first + i) % num;
+        sorted[2 * i] = points[2 * j];
+        sorted[2 * i + 1] = points[2 * j + 1];
+    }
+
+    for (i = 1; i < num; i++)
+    {
+        x = sorted[2 * i];
+        y = sorted[2 * i + 1];
+        for (j = i; j > 0 && sorted[2 * (j - 1)] > x; j--)
+        {
+            sorted[2 * j] = sorted[2 * (j - 1)];
+            sorted[2 * j + 1] = sorted[2 * (j - 1) + 1];
+        }
+        sorted[2 * j] = x;
+        sorted[2 * j + 1] = y;
+    }
 
-    points[2] = satmap->x0;
-    points[3] = points[1];
+    sorted[2] = geom->x0;
+    sorted[3] = sorted[1];
 
-    points[716] = satmap->x0 + satmap->width;
-    points[717] = points[719];
+    sorted[2 * num - 4] = geom->x0 + geom->width;
+    sorted[2 * num - 3] = sorted[2 * num - 1];
 
     if (sat->ssplat > 0.0)
     {
-        points[0] = satmap->x0;
-        points[1] = satmap->y0;
+        sorted[0] = geom->x0;
+        sorted[1] = geom->y0;
 
-        points[718] = satmap->x0 + satmap->width;
-        points[719] = satmap->y0;
+        sorted[2 * num - 2] = geom->x0 + geom->width;
+        sorted[2 * num - 1] = geom->y0;
     }
     else
     {
-        points[0] = satmap->x0;
-        points[1] = satmap->y0 + satmap->height;
+        sorted[0] = geom->x0;
+        sorted[1] = geom->y0 + geom->height;
 
-        points[718] = satmap->x0 + satmap->width;
-        points[719] = satmap->y0 + satmap->height;
+        sorted[2 * num - 2] = geom->x0 + geom->width;
+        sorted[2 * num - 1] = geom->y0 + geom->height;
     }
 }
 
-static void sort_points_y(GtkSatMap * satmap, sat_t * sat,
-                          gdouble * points, gint num)
-{
-    gsize           size;
-
-    (void)satmap;
-    (void)sat;
-    size = 2 * sizeof(double);
-
-#if GLIB_CHECK_VERSION(2, 82, 0)
-    g_sort_array(points, num, size, compare_coordinates_y, NULL);
-#else
-    g_qsort_with_data(points, num, size, compare_coordinates_y, NULL);
-#endif
-}
-
-static gint compare_coordinates_x(gconstpointer a, gconstpointer b,
-                                  gpointer data)
-{
-    double         *ea = (double *)a;
-    double         *eb = (double *)b;
-
-    (void)data;
-
-    if (ea[0] < eb[0])
-        return -1;
-    else if (ea[0] > eb[0])
-        return 1;
-
-    return 0;
-}
-
-static gint compare_coordinates_y(gconstpointer a, gconstpointer b,
-                                  gpointer data)
-{
-    double         *ea = (double *)a;
-    double         *eb = (double *)b;
-
-    (void)data;
-
-    if (ea[1] < eb[1])
-        return -1;
-    else if (ea[1] > eb[1])
-        return 1;
-
-    return 0;
-}
-
 static void plot_sat(gpointer key, gpointer value, gpointer data)
 {
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
     sat_map_obj_t  *obj = NULL;
     sat_t          *sat = SAT(value);
+    map_geom_t      geom;
     gint           *catnum;
     gfloat          x, y;
-    gchar          *tooltip;
 
     (void)key;
 
@@ -1760,30 +2138,22 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
     obj->newrcnum = 0;
     obj->catnum = sat->tle.catnr;
     obj->track_data.latlon = NULL;
+    obj->track_data.orbits = NULL;
     obj->track_data.lines = NULL;
     obj->track_orbit = 0;
 
     obj->x = x;
     obj->y = y;
 
-    obj->nickname = g_strdup(sat->nickname);
-
-    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                      "Lon: %5.1f\302\260\n"
-                                      "Lat: %5.1f\302\260\n"
-                                      " Az: %5.1f\302\260\n"
-                                      " El: %5.1f\302\260",
-                                      sat->nickname,
-                                      sat->ssplon, sat->ssplat,
-                                      sat->az, sat->el);
-    obj->tooltip = tooltip;
+    obj->nickname = sat->nickname;
 
     obj->range1_points = NULL;
     obj->range1_count = 0;
     obj->range2_points = NULL;
     obj->range2_count = 0;
 
-    obj->newrcnum = calculate_footprint(satmap, sat, obj);
+    map_geom(satmap, &geom);
+    obj->newrcnum = calculate_footprint(&geom, sat, obj);
     obj->oldrcnum = obj->newrcnum;
 
     g_hash_table_insert(satmap->obj, catnum, obj);
@@ -1803,10 +2173,7 @@ static void free_sat_obj(gpointer key, gpointer value, gpointer data)
         ground_track_delete(satmap, sat, satmap->qth, obj, TRUE);
     }
 
-    g_free(obj->nickname);
     obj->nickname = NULL;
-    g_free(obj->tooltip);
-    obj->tooltip = NULL;
     g_free(obj->range1_points);
     obj->range1_points = NULL;
     g_free(obj->range2_points);
@@ -1815,18 +2182,16 @@ static void free_sat_obj(gpointer key, gpointer value, gpointer data)
 
 static void update_sat(gpointer key, gpointer value, gpointer data)
 {
-    gint           *catnum;
+    gint            catnum;
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
     sat_map_obj_t  *obj = NULL;
     sat_t          *sat = SAT(value);
+    map_geom_t      geom;
     gfloat          x, y;
     gfloat          oldx, oldy;
     gdouble         now;
-    gchar          *tooltip;
-    gchar          *aosstr;
 
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
+    catnum = sat->tle.catnr;
 
     now = satmap->tstamp;
 
@@ -1839,29 +2204,20 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         }
     }
 
-    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, catnum));
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &catnum));
 
     if (decayed(sat) && obj != NULL)
     {
         free_sat_obj(NULL, obj, satmap);
-        g_hash_table_remove(satmap->obj, catnum);
-        g_free(catnum);
+        g_hash_table_remove(satmap->obj, &catnum);
         return;
     }
 
     if (obj == NULL)
     {
-        if (decayed(sat))
-        {
-            g_free(catnum);
-            return;
-        }
-        else
-        {
+        if (!decayed(sat))
             plot_sat(key, value, data);
-            g_free(catnum);
-            return;
-        }
+        return;
     }
 
     if (obj->selected)
@@ -1869,22 +2225,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         update_selected(satmap, sat);
     }
 
-    g_free(obj->nickname);
-    obj->nickname = g_strdup(sat->nickname);
-
-    aosstr = aoslos_time_to_str(satmap, sat);
-    g_free(obj->tooltip);
-    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                      "Lon: %5.1f\302\260\n"
-                                      "Lat: %5.1f\302\260\n"
-                                      " Az: %5.1f\302\260\n"
-                                      " El: %5.1f\302\260\n"
-                                      "%s",
-                                      sat->nickname,
-                                      sat->ssplon, sat->ssplat,
-                                      sat->az, sat->el, aosstr);
-    obj->tooltip = tooltip;
-    g_free(aosstr);
+    /* the nickname is shared with sat; tooltips are made in query_tooltip */
+    obj->nickname = sat->nickname;
 
     lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &x, &y);
 
@@ -1897,7 +2239,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         obj->x = x;
         obj->y = y;
 
-        obj->newrcnum = calculate_footprint(satmap, sat, obj);
+        map_geom(satmap, &geom);
+        obj->newrcnum = calculate_footprint(&geom, sat, obj);
         obj->oldrcnum = obj->newrcnum;
     }
 
@@ -1912,8 +2255,6 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             ground_track_update(satmap, sat, satmap->qth, obj, FALSE);
         }
     }
-
-    g_free(catnum);
 }
 
 static void update_selected(GtkSatMap * satmap, sat_t * sat)
@@ -2021,20 +2362,30 @@ static inline gdouble sgn(gdouble const t)
     return t < 0.0 ? -1.0 : 1.0;
 }
 
+/**
+ * Recalculate the solar terminator polygon.
+ *
+ * The terminator is sampled about once per pixel column, but at least once
+ * per degree, and then simplified to within SAT_MAP_LINE_TOLERANCE pixels.
+ * The number of points thus follows the map size and is recalculated when
+ * the map is resized.
+ */
 static void redraw_terminator(GtkSatMap * satmap)
 {
-    int             longitude;
+    gdouble        *points;
+    gint            nsteps, k;
     gfloat          x, y;
     gdouble         lx, ly;
     geodetic_t      geodetic;
     vector_t        sun_;
     gdouble         sx, sy, sz;
     gdouble         rx, ry, rz;
+    gdouble         length, centered_longitude;
 
-    if (satmap->terminator_points == NULL)
-    {
-        satmap->terminator_points = g_new(gdouble, 363 * 2);
-    }
+    nsteps = MAX(360, (gint) satmap->width);
+    satmap->terminator_points = g_renew(gdouble, satmap->terminator_points,
+                                        2 * (nsteps + 3));
+    points = satmap->terminator_points;
 
     Calculate_Solar_Position(satmap->tstamp, &sun_);
     Calculate_LatLonAlt(satmap->tstamp, &sun_, &geodetic);
@@ -2043,9 +2394,10 @@ static void redraw_terminator(GtkSatMap * satmap)
     sy = cos(geodetic.lat) * sin(-geodetic.lon);
     sz = sin(geodetic.lat);
 
-    for (longitude = -180; longitude <= 180; ++longitude)
+    for (k = 0; k <= nsteps; k++)
     {
-        int centered_longitude = longitude + (satmap->left_side_lon - 180.0);
+        centered_longitude = -180.0 + 360.0 * k / nsteps +
+            (satmap->left_side_lon - 180.0);
         lx = cos(de2ra * (centered_longitude + sgn(sz) * 90));
         ly = sin(de2ra * (centered_longitude + sgn(sz) * 90));
 
@@ -2053,30 +2405,184 @@ static void redraw_terminator(GtkSatMap * satmap)
         ry = -lx * sz;
         rz = -lx * sy - ly * sx;
 
-        gdouble length = sqrt(rx * rx + ry * ry + rz * rz);
+        length = sqrt(rx * rx + ry * ry + rz * rz);
 
         lonlat_to_xy(satmap,
                      centered_longitude, asin(rz / length) * (1.0 / de2ra),
                      &x, &y);
 
-        if (180 == longitude)
+        if (k == nsteps)
         {
             x = satmap->x0 + satmap->width;
         }
 
-        satmap->terminator_points[2 * (longitude + 181)] = x;
-        satmap->terminator_points[2 * (longitude + 181) + 1] = y;
+        points[2 * (k + 1)] = x;
+        points[2 * (k + 1) + 1] = y;
     }
 
-    satmap->terminator_points[0] = satmap->x0;
-    satmap->terminator_points[1] = sz < 0.0 ? satmap->y0 :
-        (satmap->y0 + satmap->height);
+    points[0] = satmap->x0;
+    points[1] = sz < 0.0 ? satmap->y0 : (satmap->y0 + satmap->height);
 
-    satmap->terminator_points[724] = satmap->x0 + satmap->width;
-    satmap->terminator_points[725] = sz < 0.0 ? satmap->y0 :
+    points[2 * (nsteps + 2)] = satmap->x0 + satmap->width;
+    points[2 * (nsteps + 2) + 1] = sz < 0.0 ? satmap->y0 :
         (satmap->y0 + satmap->height);
 
-    satmap->terminator_count = 363;
+    satmap->terminator_count =
+        map_tools_simplify_polyline(points, nsteps + 3,
+                                    SAT_MAP_LINE_TOLERANCE);
+    invalidate_layers(satmap, FALSE);
+}
+
+/** Coverage computation running in a background thread. */
+typedef struct {
+    GtkSatMap      *satmap;     /*!< Map holding a reference while running. */
+    coverage_map_t *cov;        /*!< The coverage being computed. */
+} coverage_job_t;
+
+/** Convert the coverage density to a colour mapped image surface. */
+static cairo_surface_t *coverage_to_surface(const coverage_map_t * cov)
+{
+    cairo_surface_t *surface;
+    guchar         *data;
+    guint32        *row;
+    gint            stride;
+    gdouble         v, r, g, b, a;
+    guint32         count;
+    guint           i, j;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                         cov->nlon, cov->nlat);
+    cairo_surface_flush(surface);
+    data = cairo_image_surface_get_data(surface);
+    stride = cairo_image_surface_get_stride(surface);
+
+    for (j = 0; j < cov->nlat; j++)
+    {
+        row = (guint32 *) (data + j * stride);
+        for (i = 0; i < cov->nlon; i++)
+        {
+            count = cov->counts[j * cov->nlon + i];
+            if (count == 0 || cov->maxcount == 0)
+            {
+                row[i] = 0;
+                continue;
+            }
+
+            /* blue - cyan - green - yellow - red */
+            v = (gdouble) count / cov->maxcount;
+            r = CLAMP(4.0 * v - 2.0, 0.0, 1.0);
+            g = CLAMP(v < 0.5 ? 4.0 * v : 4.0 - 4.0 * v, 0.0, 1.0);
+            b = CLAMP(2.0 - 4.0 * v, 0.0, 1.0);
+            a = 0.25 + 0.35 * v;
+
+            /* cairo expects premultiplied alpha */
+            row[i] = ((guint32) (a * 255.0) << 24) |
+                ((guint32) (r * a * 255.0) << 16) |
+                ((guint32) (g * a * 255.0) << 8) | (guint32) (b * a * 255.0);
+        }
+    }
+    cairo_surface_mark_dirty(surface);
+
+    return surface;
+}
+
+/** Deliver a finished coverage computation in the main loop. */
+static gboolean coverage_done(gpointer data)
+{
+    coverage_job_t *job = data;
+    GtkSatMap      *satmap = job->satmap;
+
+    /* the map may have been destroyed or the result been discarded */
+    if (satmap->coverage_job == job)
+    {
+        satmap->coverage_job = NULL;
+
+        coverage_map_free(satmap->coverage);
+        satmap->coverage = job->cov;
+        job->cov = NULL;
+
+        if (satmap->coverage_surface)
+            cairo_surface_destroy(satmap->coverage_surface);
+        satmap->coverage_surface = coverage_to_surface(satmap->coverage);
+
+        invalidate_layers(satmap, TRUE);
+        gtk_widget_queue_draw(satmap->canvas);
+    }
+
+    coverage_map_free(job->cov);
+    g_object_unref(satmap);
+    g_free(job);
+
+    return FALSE;
+}
+
+static gpointer coverage_thread(gpointer data)
+{
+    coverage_job_t *job = data;
+
+    coverage_map_compute(job->cov, job->cov->t0,
+                         job->cov->t0 + COVERAGE_WINDOW, COVERAGE_STEP);
+    g_idle_add(coverage_done, job);
+
+    return NULL;
+}
+
+/**
+ * Start computing the coverage density in the background.
+ *
+ * The satellites are copied here so that the computation does not touch
+ * data owned by the module. The previous result is shown until the new one
+ * is ready.
+ */
+static void start_coverage(GtkSatMap * satmap)
+{
+    coverage_job_t *job;
+
+    job = g_new0(coverage_job_t, 1);
+    job->satmap = g_object_ref(satmap);
+    job->cov = coverage_map_new(COVERAGE_NLON, COVERAGE_NLAT);
+    job->cov->t0 = satmap->tstamp;
+    coverage_map_add_sats(job->cov, satmap->sats);
+
+    satmap->coverage_job = job;
+    g_thread_unref(g_thread_new("coverage", coverage_thread, job));
+}
+
+/** Drop the coverage result and abandon any computation in progress. */
+static void discard_coverage(GtkSatMap * satmap)
+{
+    satmap->coverage_job = NULL;
+
+    coverage_map_free(satmap->coverage);
+    satmap->coverage = NULL;
+
+    if (satmap->coverage_surface)
+    {
+        cairo_surface_destroy(satmap->coverage_surface);
+        satmap->coverage_surface = NULL;
+    }
+}
+
+/** Draw the coverage heatmap over the background map. */
+static void draw_coverage(GtkSatMap * satmap, cairo_t * cr)
+{
+    gdouble         sx = (gdouble) satmap->width / COVERAGE_NLON;
+    gdouble         sy = (gdouble) satmap->height / COVERAGE_NLAT;
+    gint            shift = map_shift(satmap);
+
+    cairo_save(cr);
+    cairo_rectangle(cr, satmap->x0, satmap->y0,
+                    satmap->width, satmap->height);
+    cairo_clip(cr);
+
+    /* the grid starts at -180 lon like the unshifted background */
+    cairo_translate(cr, satmap->x0 - shift, satmap->y0);
+    cairo_scale(cr, sx, sy);
+    cairo_set_source_surface(cr, satmap->coverage_surface, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BILINEAR);
+    cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_REPEAT);
+    cairo_paint(cr);
+    cairo_restore(cr);
 }
 
 void gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
@@ -2100,16 +2606,64 @@ void gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats)
     GTK_SAT_MAP(satmap)->naos = 0.0;
     GTK_SAT_MAP(satmap)->ncat = 0;
 
-    g_hash_table_foreach(GTK_SAT_MAP(satmap)->obj, reset_ground_track, NULL);
+    g_hash_table_foreach(GTK_SAT_MAP(satmap)->obj, reset_ground_track, sats);
+
+    /* recomputed with the new satellites in the next cycle */
+    discard_coverage(GTK_SAT_MAP(satmap));
+    invalidate_layers(GTK_SAT_MAP(satmap), TRUE);
 }
 
+/**
+ * Invalidate the cached data of a single satellite.
+ *
+ * @param satmap The GtkSatMap widget.
+ * @param catnum The catalog number of the satellite whose data has changed.
+ *
+ * This function is called when the elements of a satellite have been
+ * swapped in place, e.g. after a TLE update. The footprint is recalculated
+ * immediately while the ground track is regenerated in the next cycle. The
+ * objects of the other satellites are left untouched.
+ */
+void gtk_sat_map_reload_sat(GtkWidget * satmap, gint catnum)
+{
+    GtkSatMap      *smap = GTK_SAT_MAP(satmap);
+    sat_map_obj_t  *obj;
+    sat_t          *sat;
+
+    smap->naos = 0.0;
+    smap->ncat = 0;
+
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(smap->obj, &catnum));
+    sat = SAT(g_hash_table_lookup(smap->sats, &catnum));
+    if (obj == NULL || sat == NULL)
+        return;
+
+    /* force new ground track in the next update cycle */
+    obj->track_orbit = 0;
+    obj->nickname = sat->nickname;
+
+    lonlat_to_xy(smap, sat->ssplon, sat->ssplat, &obj->x, &obj->y);
+    obj->newrcnum = calculate_footprint(smap, sat, obj);
+    obj->oldrcnum = obj->newrcnum;
+
+    gtk_widget_queue_draw(smap->canvas);
+}
+
+/**
+ * Reset the ground track of a satellite object after the satellites have
+ * been reloaded. The nickname is shared with the old sat_t, so it is
+ * relinked to the new one (user_data is the new satellite hash table).
+ */
 static void reset_ground_track(gpointer key, gpointer value,
                                gpointer user_data)
 {
     sat_map_obj_t  *obj = (sat_map_obj_t *)value;
+    sat_t          *sat;
+
     (void)key;
-    (void)user_data;
 
+    sat = SAT(g_hash_table_lookup((GHashTable *) user_data, &obj->catnum));
+    obj->nickname = (sat != NULL) ? sat->nickname : NULL;
     obj->track_orbit = 0;
 }
 
@@ -2175,3 +2729,93 @@ static void gtk_sat_map_load_hide_coverages(GtkSatMap * satmap)
                                      MOD_CFG_MAP_SECTION,
                                      MOD_CFG_MAP_HIDECOVS, satmap->hidecovs);
 }
+
+/**
+ * Benchmark the footprint computation.
+ *
+ * @param nsats The number of satellites to use.
+ * @return The number of footprints computed per second, or a negative value
+ *         if no satellites could be loaded.
+ *
+ * The footprints of the first nsats satellites of the satellite database
+ * are computed for a 1440x720 map over one day in 1 minute steps, starting
+ * now. Only the footprints are timed, not the propagation.
+ */
+gdouble gtk_sat_map_benchmark_footprints(guint nsats)
+{
+    sat_index_t    *index;
+    gtk_sat_data_loader_t *loader;
+    GHashTable     *sats;
+    map_geom_t      geom;
+    sat_map_obj_t  *objs;
+    sat_t         **list;
+    GHashTableIter  iter;
+    gpointer        value;
+    qth_t           qth;
+    gint           *catnums;
+    gint64          start, elapsed = 0;
+    gdouble         t0;
+    guint           n, i, step;
+
+    index = sat_index_load();
+    n = MIN(nsats, index->sats->len);
+    catnums = g_new(gint, n);
+    for (i = 0; i < n; i++)
+        catnums[i] = g_array_index(index->sats, sat_index_entry_t, i).catnum;
+    sat_index_free(index);
+
+    sats = g_hash_table_new_full(g_int_hash, g_int_equal, g_free,
+                                 (GDestroyNotify) gtk_sat_data_free_sat);
+    loader = gtk_sat_data_load_sats_start(catnums, n, NULL);
+    gtk_sat_data_load_sats_finish(loader, sats);
+    g_free(catnums);
+
+    if (g_hash_table_size(sats) == 0)
+    {
+        g_hash_table_destroy(sats);
+        return -1.0;
+    }
+
+    init_footprint_cos();
+
+    geom.x0 = 0;
+    geom.y0 = 0;
+    geom.width = 1440;
+    geom.height = 720;
+    geom.left_side_lon = -180.0;
+
+    memset(&qth, 0, sizeof(qth));
+    n = g_hash_table_size(sats);
+    list = g_new(sat_t *, n);
+    g_hash_table_iter_init(&iter, sats);
+    for (i = 0; g_hash_table_iter_next(&iter, NULL, &value); i++)
+        list[i] = SAT(value);
+    objs = g_new0(sat_map_obj_t, n);
+
+    t0 = get_current_daynum();
+    for (step = 0; step < 1440; step++)
+    {
+        for (i = 0; i < n; i++)
+            predict_calc(list[i], &qth, t0 + step / 1440.0);
+
+        start = g_get_monotonic_time();
+        for (i = 0; i < n; i++)
+            calculate_footprint(&geom, list[i], &objs[i]);
+        elapsed += g_get_monotonic_time() - start;
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: %u satellites x %u steps in %" G_GINT64_FORMAT " us"),
+                __func__, n, step, elapsed);
+
+    for (i = 0; i < n; i++)
+    {
+        g_free(objs[i].range1_points);
+        g_free(objs[i].range2_points);
+    }
+    g_free(objs);
+    g_free(list);
+    g_hash_table_destroy(sats);
+
+    return 1.0e6 * n * step / MAX(elapsed, 1);
+}
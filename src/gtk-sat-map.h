@@ -6,7 +6,11 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+#include "coverage-map.h"
 #include "gtk-sat-data.h"
+#include "map-cache.h"
+#include "map-shading.h"
+#include "sat-grid.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -15,6 +19,7 @@ extern "C" {
 /* *INDENT-ON* */
 
 #define SAT_MAP_RANGE_CIRCLE_POINTS    180      /*!< Number of points used to plot a satellite range half circle. */
+#define SAT_MAP_LINE_TOLERANCE         0.5      /*!< Max. deviation in pixels when simplifying tracks and terminator. */
 
 #define GTK_SAT_MAP(obj)          G_TYPE_CHECK_INSTANCE_CAST (obj, gtk_sat_map_get_type (), GtkSatMap)
 #define GTK_SAT_MAP_CLASS(klass)  G_TYPE_CHECK_CLASS_CAST (klass, gtk_sat_map_get_type (), GtkSatMapClass)
@@ -30,9 +35,18 @@ typedef struct {
     double          lon;        /*!< Longitude in decimal degrees West. */
 } ssp_t;
 
-/** Data storage for ground tracks */
+/**
+ * Data storage for ground tracks.
+ *
+ * The samples are kept as orbit segments in one contiguous array, oldest
+ * first: orbits[i] samples of orbit first_orbit + i follow each other in
+ * latlon.
+ */
 typedef struct {
-    GSList         *latlon;     /*!< List of ssp_t */
+    GArray         *latlon;     /*!< Samples (ssp_t) of all orbits, oldest first */
+    GArray         *orbits;     /*!< Number of samples (guint) in each orbit */
+    long            first_orbit;        /*!< Orbit number of the first segment */
+    gdouble         tend;       /*!< Time of the last sample */
     GSList         *lines;      /*!< List of line segments (stored as point arrays) */
 } ground_track_t;
 
@@ -56,10 +70,9 @@ typedef struct {
     /* graphical elements - stored as coordinates for Cairo drawing */
     gfloat          x;          /*!< X position of marker */
     gfloat          y;          /*!< Y position of marker */
-    gchar          *nickname;   /*!< Satellite nickname for label */
-    gchar          *tooltip;    /*!< Tooltip text */
+    const gchar    *nickname;   /*!< Satellite nickname for label (owned by the sat_t) */
 
-    /* Range circle points */
+    /* Range circle points (buffers of 2 * SAT_MAP_RANGE_CIRCLE_POINTS points, reused) */
     gdouble        *range1_points;  /*!< First part of the range circle points. */
     gint            range1_count;   /*!< Number of points in range1. */
     gdouble        *range2_points;  /*!< Second part of the range circle points. */
@@ -91,14 +104,30 @@ typedef struct {
     gchar          *next_text;   /*!< Next event text. */
     gchar          *sel_text;    /*!< Text showing info about the selected satellite. */
 
-    /* Grid line positions (calculated during draw) */
-    gboolean        grid_lines_valid;  /*!< Whether grid lines need recalculation */
+    /* Cached render layers (see on_draw) */
+    cairo_surface_t *static_layer;      /*!< Map, coverage, grid and labels. */
+    cairo_surface_t *slow_layer;        /*!< Day/night, terminator and ground tracks. */
+    gint            layer_width;        /*!< Width of the layer surfaces. */
+    gint            layer_height;       /*!< Height of the layer surfaces. */
+    gboolean        static_valid;       /*!< Static layer is up to date. */
+    gboolean        slow_valid;         /*!< Slow layer is up to date. */
+    gint64          static_time;        /*!< Last static layer redraw time [us]. */
+    gint64          slow_time;          /*!< Last slow layer redraw time [us]. */
+    gint64          dynamic_time;       /*!< Accumulated dynamic layer time [us]. */
+    guint           dynamic_count;      /*!< Frames accumulated in dynamic_time. */
 
     /* Terminator points */
     gdouble        *terminator_points;  /*!< Terminator polyline points. */
     gint            terminator_count;   /*!< Number of terminator points. */
     gdouble         terminator_last_tstamp;     /*!< Timestamp of the last terminator drawn. */
 
+    map_shading_t  *shading;    /*!< Day/night shading. */
+
+    /* Coverage heatmap */
+    coverage_map_t *coverage;   /*!< Latest coverage density or NULL. */
+    cairo_surface_t *coverage_surface;  /*!< Colour mapped coverage density. */
+    gpointer        coverage_job;       /*!< Coverage computation in progress. */
+
     gdouble         naos;       /*!< Next event time. */
     gint            ncat;       /*!< Next event catnum. */
 
@@ -112,6 +141,9 @@ typedef struct {
     GHashTable     *showtracks; /*!< A hash of satellites to show tracks for. */
     GHashTable     *hidecovs;   /*!< A hash of satellites to hide coverage for. */
 
+    sat_grid_t     *markers;    /*!< Marker positions of the last frame (catnum). */
+    sat_grid_t     *labels;     /*!< Labels placed in the current frame. */
+
     guint           x0;         /*!< X0 of the canvas map. */
     guint           y0;         /*!< Y0 of the canvas map. */
     guint           width;      /*!< Map width. */
@@ -124,6 +156,8 @@ typedef struct {
     gboolean        satfp;      /*!< Show the satellite footprint. */
     gboolean        satmarker;  /*!< Show the satellite marker. */
     gboolean        show_terminator;    /*!< show solar terminator. */
+    gboolean        show_coverage;      /*!< Show coverage heatmap. */
+    gboolean        show_daynight;      /*!< Show day/night shading. */
     gboolean        qthinfo;    /*!< Show the QTH info. */
     gboolean        eventinfo;  /*!< Show info about the next event. */
     gboolean        cursinfo;   /*!< Track the mouse cursor. */
@@ -141,9 +175,11 @@ typedef struct {
     guint32         col_shadow; /*!< Shadow color. */
     guint32         col_track;  /*!< Track color. */
     guint32         col_terminator; /*!< Terminator color. */
+    guint32         col_global_shadow;  /*!< Globe shadow color. */
+    guint32         col_sat_cov;        /*!< Satellite coverage color. */
 
-    GdkPixbuf      *origmap;    /*!< Original map kept here for high quality scaling. */
-    GdkPixbuf      *map;        /*!< Scaled map for current size. */
+    map_cache_t    *mapcache;   /*!< Shared map pyramid for high quality scaling. */
+    GdkPixbuf      *map;        /*!< Scaled map for current size, centred on 0 lon. */
 
     gchar          *font;       /*!< Default font name */
 
@@ -163,7 +199,9 @@ void            gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
                                          gdouble * x, gdouble * y);
 
 void            gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats);
+void            gtk_sat_map_reload_sat(GtkWidget * satmap, gint catnum);
 void            gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum);
+gdouble         gtk_sat_map_benchmark_footprints(guint nsats);
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -63,6 +63,7 @@
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
 #include "time-tools.h"
+#include "tle-update.h"
 
 
 static GtkVBoxClass *parent_class = NULL;
@@ -175,7 +176,10 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
     for (i = 0; i < module->nviews; i++)
     {
         view = GTK_WIDGET(g_slist_nth_data(module->views, i));
-        gtk_widget_destroy(view);
+
+        /* views are not created until the module is shown */
+        if (view != NULL)
+            gtk_widget_destroy(view);
     }
     module->nviews = 0;
 
@@ -247,6 +251,7 @@ static void gtk_sat_module_init(GtkSatModule * module,
     module->grid = NULL;
     module->views = NULL;
     module->nviews = 0;
+    module->placeholder = NULL;
 
     module->timerid = 0;
 
@@ -408,22 +413,52 @@ static void create_module_layout(GtkSatModule * module)
     gtk_box_pack_start(GTK_BOX(module), table, TRUE, TRUE, 0);
 }
 
+/**
+ * Create the views when the module is mapped for the first time.
+ *
+ * Docked modules on hidden notebook pages are not mapped, so their views are
+ * only created when the user switches to them. Until then the module only
+ * holds its satellites and a placeholder label.
+ */
+static void gtk_sat_module_map_cb(GtkWidget * widget, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(widget);
+
+    (void)data;
+
+    if (module->placeholder == NULL)
+        return;
+
+    gtk_widget_destroy(module->placeholder);
+    module->placeholder = NULL;
+
+    create_module_layout(module);
+    gtk_widget_show_all(widget);
+
+    /* apply selection made before the views existed */
+    if (module->target > 0)
+        gtk_sat_module_select_sat(module, module->target);
+}
+
 
 /**
- * Read satellites into memory.
+ * Start loading the satellites of a module.
+ *
+ * @param module Pointer to the GtkSatModule widget.
+ * @return The loader handle or NULL if the list of satellites could not be
+ *         read from the module configuration.
  *
- * This function reads the list of satellites from the configfile and
- * and then adds each satellite to the hash table.
+ * The satellites are read and initialised in the background by the thread
+ * pool in gtk-sat-data.c. Call gtk_sat_module_load_sats_finish() to wait for
+ * them and insert them into module->satellites.
  */
-static void gtk_sat_module_load_sats(GtkSatModule * module)
+static gtk_sat_data_loader_t *gtk_sat_module_load_sats_start(GtkSatModule *
+                                                             module)
 {
+    gtk_sat_data_loader_t *loader;
     gint           *sats = NULL;
     gsize           length;
     GError         *error = NULL;
-    guint           i;
-    sat_t          *sat;
-    guint          *key = NULL;
-    guint           succ = 0;
 
     /* get list of satellites from config file; abort in case of error */
     sats = g_key_file_get_integer_list(module->cfgdata,
@@ -444,56 +479,34 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
             g_free(sats);
         }
 
-        return;
+        return NULL;
     }
 
-    /* read each satellite into hash table */
-    for (i = 0; i < length; i++)
-    {
-        sat = g_new(sat_t, 1);
-
-        if (gtk_sat_data_read_sat(sats[i], sat))
-        {
-            /* the satellite could not be read */
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Error reading data for #%d"),
-                        __func__, sats[i]);
+    loader = gtk_sat_data_load_sats_start(sats, length, module->qth);
+    g_free(sats);
 
-            g_free(sat);
-        }
-        else
-        {
-            /* check whether satellite is already in list
-               in order to avoid duplicates
-             */
-            key = g_new0(guint, 1);
-            *key = sats[i];
+    return loader;
+}
 
-            if (g_hash_table_lookup(module->satellites, key) == NULL)
-            {
-                gtk_sat_data_init_sat(sat, module->qth);
-                g_hash_table_insert(module->satellites, key, sat);
-                succ++;
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s: Read data for #%d"), __func__, sats[i]);
-            }
-            else
-            {
-                sat_log_log(SAT_LOG_LEVEL_WARN,
-                            _("%s: Sat #%d already in list"),
-                            __func__, sats[i]);
+/**
+ * Finish loading the satellites of a module.
+ *
+ * @param module Pointer to the GtkSatModule widget.
+ * @param loader The loader returned by gtk_sat_module_load_sats_start().
+ */
+static void gtk_sat_module_load_sats_finish(GtkSatModule * module,
+                                            gtk_sat_data_loader_t * loader)
+{
+    guint           succ;
 
-                /* it is not needed in this case */
-                g_free(sat);
-            }
+    if (loader == NULL)
+        return;
 
-        }
-    }
+    succ = gtk_sat_data_load_sats_finish(loader, module->satellites);
 
     sat_log_log(SAT_LOG_LEVEL_INFO,
-                _("%s: Read %d out of %d satellites"), __func__, succ, length);
-
-    g_free(sats);
+                _("%s: Read %d satellites for %s"), __func__, succ,
+                module->name);
 }
 
 /**
@@ -578,6 +591,10 @@ static void update_header(GtkSatModule * module)
  */
 static void update_child(GtkWidget * child, gdouble tstamp)
 {
+    /* views are not created until the module is shown */
+    if (child == NULL)
+        return;
+
     if (IS_GTK_SAT_LIST(child))
     {
         GTK_SAT_LIST(child)->tstamp = tstamp;
@@ -992,17 +1009,18 @@ static void gtk_sat_module_read_cfg_data(GtkSatModule * module,
 }
 
 /**
- * Create a new GtkSatModule widget.
+ * Create a GtkSatModule object and read its configuration.
  *
  * @param cfgfile The name of the configuration file (.mod)
+ * @return The new module or NULL if the configuration is not valid.
  *
- * @bug Program goes into infinite loop when there is something
- *      wrong with cfg file.
+ * This is the first stage of creating a module. The satellites are loaded
+ * afterwards and the child widgets are created by gtk_sat_module_build()
+ * once the satellite data is ready.
  */
-GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
+static GtkSatModule *gtk_sat_module_prepare(const gchar * cfgfile)
 {
     GtkSatModule   *module;
-    GtkWidget      *butbox;
 
     /* Read configuration data.
      * If cfgfile is not existing or is NULL, start the wizard
@@ -1053,7 +1071,21 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
     module->tmgPdnum = get_current_daynum();
     module->tmgCdnum = get_current_daynum();
 
-    gtk_sat_module_load_sats(module);
+    return module;
+}
+
+/**
+ * Create the child widgets of a module and start the timeout.
+ *
+ * @param module The module returned by gtk_sat_module_prepare() whose
+ *               satellites have been loaded.
+ *
+ * The views are not created here but in gtk_sat_module_map_cb() when the
+ * module is shown for the first time.
+ */
+static void gtk_sat_module_build(GtkSatModule * module)
+{
+    GtkWidget      *butbox;
 
     /* menu */
     GtkWidget * image = gtk_image_new_from_icon_name("open-menu-symbolic",
@@ -1090,16 +1122,87 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
                        gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
                        FALSE, FALSE, 0);
 
-    create_module_layout(module);
+    /* the views are created when the module is shown for the first time */
+    module->placeholder = gtk_label_new(_("Loading..."));
+    gtk_box_pack_start(GTK_BOX(module), module->placeholder, TRUE, TRUE, 0);
+    g_signal_connect(module, "map", G_CALLBACK(gtk_sat_module_map_cb), NULL);
     gtk_widget_show_all(GTK_WIDGET(module));
 
     /* start timeout */
     module->timerid = g_timeout_add(module->timeout, gtk_sat_module_timeout_cb,
                                     module);
+}
+
+/**
+ * Create a new GtkSatModule widget.
+ *
+ * @param cfgfile The name of the configuration file (.mod)
+ *
+ * @bug Program goes into infinite loop when there is something
+ *      wrong with cfg file.
+ */
+GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
+{
+    GtkSatModule   *module;
+
+    module = gtk_sat_module_prepare(cfgfile);
+    if (module == NULL)
+        return NULL;
+
+    gtk_sat_module_load_sats_finish(module,
+                                    gtk_sat_module_load_sats_start(module));
+    gtk_sat_module_build(module);
 
     return GTK_WIDGET(module);
 }
 
+/**
+ * Create several GtkSatModule widgets concurrently.
+ *
+ * @param cfgfiles NULL terminated array of configuration file names (.mod)
+ * @return Array with one GtkSatModule widget per configuration file, in the
+ *         same order. Entries for invalid modules are NULL.
+ *
+ * The configuration of every module is read first and the satellites of all
+ * modules are then loaded by the shared thread pool at the same time. The
+ * widgets of each module are only created once its satellites are ready.
+ * Used by mod-mgr to restore the open modules at startup.
+ */
+GPtrArray *gtk_sat_module_new_all(gchar ** cfgfiles)
+{
+    GtkSatModule   *module;
+    GPtrArray      *modules;
+    GPtrArray      *loaders;
+    guint           i, n;
+
+    n = g_strv_length(cfgfiles);
+    modules = g_ptr_array_sized_new(n);
+    loaders = g_ptr_array_sized_new(n);
+
+    for (i = 0; i < n; i++)
+    {
+        module = gtk_sat_module_prepare(cfgfiles[i]);
+        g_ptr_array_add(modules, module);
+        g_ptr_array_add(loaders, module ?
+                        gtk_sat_module_load_sats_start(module) : NULL);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        module = g_ptr_array_index(modules, i);
+        if (module == NULL)
+            continue;
+
+        gtk_sat_module_load_sats_finish(module,
+                                        g_ptr_array_index(loaders, i));
+        gtk_sat_module_build(module);
+    }
+
+    g_ptr_array_free(loaders, TRUE);
+
+    return modules;
+}
+
 /**
  * Close module.
  *
@@ -1387,6 +1490,10 @@ void gtk_sat_module_config_cb(GtkWidget * button, gpointer data)
 /** Reload satellites in view */
 static void reload_sats_in_child(GtkWidget * widget, GtkSatModule * module)
 {
+    /* views are not created until the module is shown */
+    if (widget == NULL)
+        return;
+
     if (IS_GTK_SINGLE_SAT(G_OBJECT(widget)))
     {
         gtk_single_sat_reload_sats(widget, module->satellites);
@@ -1450,7 +1557,8 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
     module->event_count = 0;
 
     /* load satellites */
-    gtk_sat_module_load_sats(module);
+    gtk_sat_module_load_sats_finish(module,
+                                    gtk_sat_module_load_sats_start(module));
 
     /* update children */
     for (i = 0; i < module->nviews; i++)
@@ -1465,6 +1573,98 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
     g_mutex_unlock(&module->busy);
 }
 
+/** Invalidate cached data for a single satellite in a view */
+static void reload_sat_in_child(GtkWidget * widget, gint catnum)
+{
+    if (IS_GTK_POLAR_VIEW(widget))
+    {
+        gtk_polar_view_reload_sat(widget, catnum);
+    }
+    else if (IS_GTK_SAT_MAP(widget))
+    {
+        gtk_sat_map_reload_sat(widget, catnum);
+    }
+    /* the other views read the sat_t data directly in each cycle */
+}
+
+/**
+ * Apply TLE changes.
+ *
+ * @param module Pointer to a GtkSatModule widget.
+ * @param changes GArray of tle_change_t produced by the TLE updater.
+ *
+ * Unlike gtk_sat_module_reload_sats() this function keeps the existing
+ * satellite objects and only swaps the elements of the satellites listed in
+ * the change set. The views are notified about each changed satellite so that
+ * they can invalidate the data depending on it, e.g. footprint, ground track
+ * and current pass. Satellites that are not part of this module are ignored.
+ */
+void gtk_sat_module_apply_tle_changes(GtkSatModule * module, GArray * changes)
+{
+    GtkWidget      *child;
+    tle_change_t   *change;
+    sat_t          *sat;
+    gdouble         maxdt;
+    guint           i, j;
+    guint           num = 0;
+
+    g_return_if_fail(IS_GTK_SAT_MODULE(module));
+    g_return_if_fail(changes != NULL);
+
+    /* lock module */
+    g_mutex_lock(&module->busy);
+
+    maxdt = (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+
+    for (i = 0; i < changes->len; i++)
+    {
+        change = &g_array_index(changes, tle_change_t, i);
+
+        sat = SAT(g_hash_table_lookup(module->satellites, &change->catnum));
+        if (sat == NULL)
+            continue;
+
+        if (gtk_sat_data_reload_sat(change->catnum, sat, module->qth))
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Error reloading data for #%d"),
+                        __func__, change->catnum);
+            continue;
+        }
+
+        /* bring the satellite up to date with the module time */
+        if (has_aos(sat, module->qth))
+        {
+            sat->aos = find_aos(sat, module->qth, module->tmgCdnum, maxdt);
+            sat->los = find_los(sat, module->qth, module->tmgCdnum, maxdt);
+        }
+        predict_calc(sat, module->qth, module->tmgCdnum);
+
+        for (j = 0; j < module->nviews; j++)
+        {
+            child = GTK_WIDGET(g_slist_nth_data(module->views, j));
+            reload_sat_in_child(child, change->catnum);
+        }
+
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Swapped elements for #%d (epoch %.8f -> %.8f)"),
+                    __func__, change->catnum,
+                    change->old_epoch, change->new_epoch);
+        num++;
+    }
+
+    /* sky at glance shows passes for all sats; regenerate in next cycle */
+    if (num > 0)
+        module->lastSkgUpd = 0.0;
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Updated %d satellites in module %s"),
+                __func__, num, module->name);
+
+    /* unlock module */
+    g_mutex_unlock(&module->busy);
+}
+
 /** Select a new satellite */
 void gtk_sat_module_select_sat(GtkSatModule * module, gint catnum)
 {
@@ -1478,6 +1678,10 @@ void gtk_sat_module_select_sat(GtkSatModule * module, gint catnum)
     {
         child = GTK_WIDGET(g_slist_nth_data(module->views, i));
 
+        /* views are not created until the module is shown */
+        if (child == NULL)
+            continue;
+
         if (IS_GTK_SINGLE_SAT(G_OBJECT(child)))
         {
             gtk_single_sat_select_sat(child, catnum);
@@ -73,6 +73,7 @@ struct _gtk_sat_module {
     guint          *grid;       /*!< The grid layout array [(type,left,right,top,bottom),...] */
     guint           nviews;     /*!< The number of views */
     GSList         *views;      /*!< Pointers to the views */
+    GtkWidget      *placeholder;        /*!< Shown until the views are created */
 
     GKeyFile       *cfgdata;    /*!< Configuration data. */
     qth_t          *qth;        /*!< QTH information. */
@@ -126,11 +127,14 @@ struct _GtkSatModuleClass {
 
 GType           gtk_sat_module_get_type(void);
 GtkWidget      *gtk_sat_module_new(const gchar * cfgfile);
+GPtrArray      *gtk_sat_module_new_all(gchar ** cfgfiles);
 
 void            gtk_sat_module_close_cb(GtkWidget * button, gpointer data);
 void            gtk_sat_module_config_cb(GtkWidget * button, gpointer data);
 
 void            gtk_sat_module_reload_sats(GtkSatModule * module);
+void            gtk_sat_module_apply_tle_changes(GtkSatModule * module,
+                                                 GArray * changes);
 void            gtk_sat_module_reconf(GtkSatModule * module, gboolean local);
 void            gtk_sat_module_select_sat(GtkSatModule * module, gint catnum);
 
@@ -34,6 +34,7 @@
 #include "gtk-sat-data.h"
 #include "gtk-sat-selector.h"
 #include "sat-cfg.h"
+#include "sat-index.h"
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
 #include "time-tools.h"
@@ -73,6 +74,14 @@ static void gtk_sat_selector_destroy(GtkWidget * widget)
         selector->models = g_slist_remove(selector->models, data);
     }
 
+    sat_search_free(selector->index);
+    selector->index = NULL;
+    if (selector->matches != NULL)
+    {
+        g_hash_table_destroy(selector->matches);
+        selector->matches = NULL;
+    }
+
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
@@ -236,44 +245,40 @@ static gint row_compare_func(GtkTreeModel * model, GtkTreeIter * a,
     return ret;
 }
 
-/** Selects unselected satellites whose name contains the substring in entry. */
+/**
+ * Selects unselected satellites matching the text in the search entry.
+ *
+ * The matching satellites are computed by entry_changed_cb() using the search
+ * index, so this function only needs a hash table lookup per row.
+ */
 static gboolean sat_filter_func(GtkTreeModel * model,
-                                GtkTreeIter * iter, GtkEntry * entry)
+                                GtkTreeIter * iter, GtkSatSelector * selector)
 {
-    const gchar    *searchstring;
-    gchar          *satname;
     gint            catnr;
-    gchar          *catnrstr;
     gboolean        selected;
-    gboolean        retval = FALSE;
 
-    gtk_tree_model_get(model, iter, GTK_SAT_SELECTOR_COL_NAME, &satname, -1);
-    gtk_tree_model_get(model, iter, GTK_SAT_SELECTOR_COL_CATNUM, &catnr, -1);
-    gtk_tree_model_get(model, iter, GTK_SAT_SELECTOR_COL_SELECTED, &selected,
-                       -1);
-    searchstring = gtk_entry_get_text(entry);
-    catnrstr = g_strdup_printf("%d", catnr);
+    gtk_tree_model_get(model, iter,
+                       GTK_SAT_SELECTOR_COL_CATNUM, &catnr,
+                       GTK_SAT_SELECTOR_COL_SELECTED, &selected, -1);
 
     /* if it is already selected then remove it from the available list */
     if (selected)
-        retval = FALSE;
-    else if (gpredict_strcasestr(satname, searchstring) != (char *)NULL)
-        retval = TRUE;
-    else if (gpredict_strcasestr(catnrstr, searchstring) != (char *)NULL)
-        retval = TRUE;
-
-    g_free(catnrstr);
-    return (retval);
+        return FALSE;
+
+    return g_hash_table_contains(selector->matches, GINT_TO_POINTER(catnr));
 }
 
 /** Make the tree refilter after something entered in the search box */
-static gboolean entry_changed_cb(GtkEditable * entry, GtkTreeView * treeview)
+static gboolean entry_changed_cb(GtkEditable * entry, gpointer data)
 {
+    GtkSatSelector *selector = GTK_SAT_SELECTOR(data);
     GtkTreeModelFilter *filter;
 
-    (void)entry;
+    sat_search_find(selector->index, gtk_entry_get_text(GTK_ENTRY(entry)),
+                    selector->matches);
 
-    filter = GTK_TREE_MODEL_FILTER(gtk_tree_view_get_model(treeview));
+    filter = GTK_TREE_MODEL_FILTER(gtk_tree_view_get_model
+                                   (GTK_TREE_VIEW(selector->tree)));
     gtk_tree_model_filter_refilter(filter);
 
     return (FALSE);
@@ -353,15 +358,11 @@ static void group_selected_cb(GtkComboBox * combobox, gpointer data)
     filter = gtk_tree_model_filter_new(newmodel, NULL);
     gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER(filter),
                                            (GtkTreeModelFilterVisibleFunc)
-                                           sat_filter_func,
-                                           GTK_SAT_SELECTOR(selector)->search,
+                                           sat_filter_func, selector,
                                            NULL);
 
-    /*install the filter tree and hookup callbacks */
+    /* install the filter tree */
     gtk_tree_view_set_model(GTK_TREE_VIEW(selector->tree), filter);
-    g_signal_connect(G_OBJECT(GTK_SAT_SELECTOR(selector)->search), "changed",
-                     G_CALLBACK(entry_changed_cb),
-                     GTK_TREE_VIEW(selector->tree));
     g_object_unref(newmodel);
     g_object_unref(filter);
 }
@@ -425,8 +426,11 @@ GtkWidget      *gtk_sat_selector_new(guint flags)
     g_signal_connect(G_OBJECT(GTK_SAT_SELECTOR(widget)->search), "icon-release",
                      G_CALLBACK(search_icon_clicked), NULL);
 
-    /* create list and model */
+    /* create list, model and search index */
+    selector->index = sat_search_new();
+    selector->matches = g_hash_table_new(g_direct_hash, g_direct_equal);
     create_and_fill_models(selector);
+    sat_search_find(selector->index, "", selector->matches);
     model = GTK_TREE_MODEL(g_slist_nth_data(selector->models, 0));
 
     /* sort the tree by name */
@@ -441,14 +445,12 @@ GtkWidget      *gtk_sat_selector_new(guint flags)
     filter = gtk_tree_model_filter_new(model, NULL);
     gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER(filter),
                                            (GtkTreeModelFilterVisibleFunc)
-                                           sat_filter_func,
-                                           GTK_SAT_SELECTOR(widget)->search,
+                                           sat_filter_func, selector,
                                            NULL);
 
     selector->tree = gtk_tree_view_new_with_model(filter);
     g_signal_connect(G_OBJECT(GTK_SAT_SELECTOR(widget)->search), "changed",
-                     G_CALLBACK(entry_changed_cb),
-                     GTK_TREE_VIEW(selector->tree));
+                     G_CALLBACK(entry_changed_cb), selector);
     g_object_unref(model);
 
     /* we can now connect combobox signal handler */
@@ -523,173 +525,30 @@ GtkWidget      *gtk_sat_selector_new(guint flags)
     return widget;
 }
 
-/**
- * Load satellites from a .cat file
- *
- * @param selector Pointer to the GtkSatSelector
- * @param fname The name of the .cat file (name only, no path)
- *
- * This function is used to encapsulate reading the clear text name and the contents
- * of a .cat file. It is used for building the satellite tree store models
- */
-static void load_cat_file(GtkSatSelector * selector, const gchar * fname)
-{
-    GIOChannel     *catfile;
-    GError         *error = NULL;
-    GtkListStore   *store;      /* the list store data structure */
-    GtkTreeIter     node;       /* new top level node added to the tree store */
-    gchar          *path;
-    gchar          *buff;
-    sat_t           sat;
-    gint            catnum;
-    guint           num = 0;
-
-    /* .cat files contains clear text category name in the first line
-       then one satellite catalog number per line */
-    path = sat_file_name(fname);
-    catfile = g_io_channel_new_file(path, "r", &error);
-    if (error != NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%s: Failed to open %s: %s"),
-                    __FILE__, __func__, fname, error->message);
-        g_clear_error(&error);
-    }
-    else
-    {
-        /* read first line => category name */
-        if (g_io_channel_read_line(catfile, &buff, NULL, NULL, NULL) ==
-            G_IO_STATUS_NORMAL)
-        {
-            g_strstrip(buff);   /* removes trailing newline */
-            gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT
-                                           (selector->groups), buff);
-            g_free(buff);
-
-            /* we can safely create the liststore for this category */
-            store = gtk_list_store_new(GTK_SAT_SELECTOR_COL_NUM, G_TYPE_STRING, // name
-                                       G_TYPE_INT,      // catnum
-                                       G_TYPE_DOUBLE,   // epoch
-                                       G_TYPE_BOOLEAN   // selected
-                );
-            selector->models = g_slist_append(selector->models, store);
-
-            /* Remaining lines are catalog numbers for satellites.
-               Read line by line until the first error, which hopefully is G_IO_STATUS_EOF
-             */
-            while (g_io_channel_read_line(catfile, &buff, NULL, NULL, NULL) ==
-                   G_IO_STATUS_NORMAL)
-            {
-                /* stip trailing EOL */
-                g_strstrip(buff);
-
-                /* catalog number to integer */
-                catnum = (gint) g_ascii_strtoll(buff, NULL, 0);
-
-                /* try to read satellite data */
-                if (gtk_sat_data_read_sat(catnum, &sat))
-                {
-                    /* error */
-                    sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                _("%s:%s: Error reading satellite %d (%s)"),
-                                __FILE__, __func__, catnum, fname);
-                }
-                else
-                {
-                    /* insert satellite into liststore */
-                    gtk_list_store_append(store, &node);
-                    gtk_list_store_set(store, &node,
-                                       GTK_SAT_SELECTOR_COL_NAME, sat.nickname,
-                                       GTK_SAT_SELECTOR_COL_CATNUM, catnum,
-                                       GTK_SAT_SELECTOR_COL_EPOCH,
-                                       sat.jul_epoch,
-                                       GTK_SAT_SELECTOR_COL_SELECTED, FALSE,
-                                       -1);
-                    g_free(sat.name);
-                    g_free(sat.nickname);
-                    num++;
-                }
-
-                g_free(buff);
-            }
-            sat_log_log(SAT_LOG_LEVEL_INFO,
-                        _("%s:%s: Read %d satellites from %s"),
-                        __FILE__, __func__, num, fname);
-        }
-        else
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%s: Failed to read %s"),
-                        __FILE__, __func__, fname);
-        }
-
-    }
-
-    g_free(path);
-    g_io_channel_shutdown(catfile, TRUE, NULL);
-}
-
-/**
- * Load category name from a .cat file
- *
- * @param fname The name of the .cat file (name only, no path)
- *
- *  This function is a stripped down version of load_cat_file.  It 
- *  is needed to load the category name to created a sorted list 
- *  of category names. With the existing user base already having 
- *  .cat files in their directories, use of the file name directly 
- *  for sorting will have problems.
- */
-static gchar   *load_cat_file_cat(const gchar * fname)
+/** Create an empty list store for a satellite group */
+static GtkListStore *create_store(void)
 {
-    GIOChannel     *catfile;
-    GError         *error = NULL;
-
-    gchar          *path = NULL;
-    gchar          *buff = NULL;
-
-    /* .cat files contains clear text category name in the first line
-       then one satellite catalog number per line */
-    path = sat_file_name(fname);
-    catfile = g_io_channel_new_file(path, "r", &error);
-    if (error != NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%s: Failed to open %s: %s"),
-                    __FILE__, __func__, fname, error->message);
-        g_clear_error(&error);
-    }
-    else
-    {
-        /* read first line => category name */
-
-        if (g_io_channel_read_line(catfile, &buff, NULL, NULL, NULL) ==
-            G_IO_STATUS_NORMAL)
-        {
-            g_strstrip(buff);   /* removes trailing newline */
-        }
-    }
-
-    g_free(path);
-    g_io_channel_shutdown(catfile, TRUE, NULL);
-    return buff;
+    return gtk_list_store_new(GTK_SAT_SELECTOR_COL_NUM, G_TYPE_STRING,  // name
+                              G_TYPE_INT,       // catnum
+                              G_TYPE_DOUBLE,    // epoch
+                              G_TYPE_BOOLEAN    // selected
+        );
 }
 
-/* this is a quick function that loads the category name from two cat 
-   files and compares them. 
-*/
-static gint cat_file_compare(const gchar * a, const gchar * b)
+/** Append a satellite from the satellite index to a list store */
+static void append_sat(GtkListStore * store, const sat_index_entry_t * entry)
 {
-    gchar          *cat_a, *cat_b;
-    gint            temp;
-
-    cat_a = load_cat_file_cat(a);
-    cat_b = load_cat_file_cat(b);
-    temp = gpredict_strcmp(cat_a, cat_b);
-    g_free(cat_a);
-    g_free(cat_b);
-
-    return (temp);
+    GtkTreeIter     node;
+
+    gtk_list_store_insert_with_values(store, &node, -1,
+                                      GTK_SAT_SELECTOR_COL_NAME,
+                                      entry->nickname,
+                                      GTK_SAT_SELECTOR_COL_CATNUM,
+                                      entry->catnum,
+                                      GTK_SAT_SELECTOR_COL_EPOCH,
+                                      entry->epoch,
+                                      GTK_SAT_SELECTOR_COL_SELECTED, FALSE,
+                                      -1);
 }
 
 /**
@@ -697,13 +556,13 @@ static gint cat_file_compare(const gchar * a, const gchar * b)
  *
  * @param selector Pointer to the GtkSatSelector widget
  *
- * this fuinction scan for satellite data and stores them in tree models
- * that can be displayed in a tree view. The scan is performed in two iterations:
+ * This function loads the satellite index (see sat-index.c) and stores the
+ * satellites in tree models that can be displayed in a tree view:
  *
- * (1) First, all .sat files are scanned, read and added to a pseudo-group called
- *     "all" satellites.
- * (2) After the first scane, the function scans and reads .cat files and creates
- *     the groups accordingly.
+ * (1) All satellites are added to a pseudo-group called "all" satellites
+ *     and to the search index.
+ * (2) One group is created for each category in the index; the categories
+ *     are already sorted by name.
  *
  * For each group (including the "all" group) and entry is added to the
  * selector->groups GtkComboBox, where the index of the entry corresponds to
@@ -712,108 +571,50 @@ static gint cat_file_compare(const gchar * a, const gchar * b)
 static void create_and_fill_models(GtkSatSelector * selector)
 {
     GtkListStore   *store;      /* the list store data structure */
-    GtkTreeIter     node;       /* new top level node added to the tree store */
-    GDir           *dir;
-    gchar          *dirname;
-    sat_t           sat;
-    gint            catnum;
-    gchar         **buffv;
-    const gchar    *fname;
-    gchar          *nfname;
-    guint           num = 0;
-    gint            i, n;
-    GSList         *cats = NULL;
+    sat_index_t    *index;
+    sat_index_entry_t *entry;
+    sat_index_cat_t *cat;
+    guint           i, j;
 
 
+    index = sat_index_load();
+
     /* load all satellites into selector->models[0] */
-    store = gtk_list_store_new(GTK_SAT_SELECTOR_COL_NUM, G_TYPE_STRING, // name
-                               G_TYPE_INT,      // catnum
-                               G_TYPE_DOUBLE,   // epoch
-                               G_TYPE_BOOLEAN   // selected
-        );
+    store = create_store();
     selector->models = g_slist_append(selector->models, store);
     gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(selector->groups),
                                    _("All satellites"));
     gtk_combo_box_set_active(GTK_COMBO_BOX(selector->groups), 0);
 
-    dirname = get_satdata_dir();
-    dir = g_dir_open(dirname, 0, NULL);
-    if (!dir)
+    for (i = 0; i < index->sats->len; i++)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%s: Failed to open satdata directory %s."),
-                    __FILE__, __func__, dirname);
-
-        g_free(dirname);
-
-        return;
+        entry = &g_array_index(index->sats, sat_index_entry_t, i);
+        append_sat(store, entry);
+        sat_search_add(selector->index, entry->catnum, entry->name,
+                       entry->nickname);
     }
 
-    /* Scan data directory for .sat files.
-       For each file scan through the file and
-       add entry to the tree.
-     */
-    while ((fname = g_dir_read_name(dir)))
-    {
-        if (g_str_has_suffix(fname, ".sat"))
-        {
-            buffv = g_strsplit(fname, ".", 0);
-            catnum = (gint) g_ascii_strtoll(buffv[0], NULL, 0);
-
-            if (gtk_sat_data_read_sat(catnum, &sat))
-            {
-                /* error */
-            }
-            else
-            {
-                /* read satellite */
-
-                gtk_list_store_append(store, &node);
-                gtk_list_store_set(store, &node,
-                                   GTK_SAT_SELECTOR_COL_NAME, sat.nickname,
-                                   GTK_SAT_SELECTOR_COL_CATNUM, catnum,
-                                   GTK_SAT_SELECTOR_COL_EPOCH, sat.jul_epoch,
-                                   GTK_SAT_SELECTOR_COL_SELECTED, FALSE, -1);
-
-                g_free(sat.name);
-                g_free(sat.nickname);
-                num++;
-            }
-
-            g_strfreev(buffv);
-        }
-    }
     sat_log_log(SAT_LOG_LEVEL_INFO,
                 _("%s:%s: Read %d satellites into MAIN group."),
-                __FILE__, __func__, num);
+                __FILE__, __func__, index->sats->len);
 
-    /* load satellites from each .cat file into selector->models[i] */
-    g_dir_rewind(dir);
-    while ((fname = g_dir_read_name(dir)))
+    /* load satellites from each category into selector->models[i] */
+    for (i = 0; i < index->cats->len; i++)
     {
-        if (g_str_has_suffix(fname, ".cat"))
-        {
-            cats =
-                g_slist_insert_sorted(cats, g_strdup(fname),
-                                      (GCompareFunc) cat_file_compare);
-        }
-    }
+        cat = g_ptr_array_index(index->cats, i);
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(selector->groups),
+                                       cat->name);
 
-    /*now load them into the combo box */
-    n = g_slist_length(cats);
-    for (i = 0; i < n; i++)
-    {
-        nfname = g_slist_nth_data(cats, i);
-        if (nfname)
-        {
-            load_cat_file(selector, nfname);
-        }
-        g_free(nfname);
+        store = create_store();
+        selector->models = g_slist_append(selector->models, store);
+
+        for (j = 0; j < cat->members->len; j++)
+            append_sat(store, &g_array_index(index->sats, sat_index_entry_t,
+                                             g_array_index(cat->members,
+                                                           guint, j)));
     }
-    g_slist_free(cats);
 
-    g_dir_close(dir);
-    g_free(dirname);
+    sat_index_free(index);
 }
 
 /**
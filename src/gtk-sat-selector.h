@@ -3,6 +3,8 @@
 
 #include <gtk/gtk.h>
 
+#include "sat-search.h"
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
 extern "C" {
@@ -53,6 +55,8 @@ struct _gtk_sat_selector {
     GtkWidget      *groups;     /*!< Combo box for selecting satellite group. */
     GtkWidget      *search;     /*!< Text entry for searching. */
     GSList         *models;     /*!< List of models with index corresponding to groups. */
+    sat_search_t   *index;      /*!< Search index over all satellites. */
+    GHashTable     *matches;    /*!< Catnums matching the current search text. */
 };
 
 struct _GtkSatSelectorClass {
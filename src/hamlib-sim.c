@@ -0,0 +1,1337 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Simulator of the hamlib rigctld and rotctld network protocols.
+ *
+ * hamlib-sim serves a simulated radio and a simulated rotator on two TCP
+ * ports, so that the radio and rotator controllers can be developed and
+ * measured without hardware. Every command is executed and answered after
+ * a configurable latency with random jitter, the radio tunes in steps like
+ * a real radio, and the rotator moves with limited slew rates. Both the
+ * default and the extended ('+') response protocols are supported.
+ *
+ * With --bench the controllers of gpredict are run against the simulator
+ * through a pass, and the command rate, the achieved update frequency and
+ * the Doppler and pointing errors are reported, e.g.
+ *
+ *   hamlib-sim --bench --latency 50 --jitter 20 --speed 10
+ *
+ * A recorded pass can be given with --pass. It has one sample per line:
+ * the time in seconds, the azimuth and elevation in degrees and the range
+ * rate in km/s; lines starting with '#' are ignored. Without a recording
+ * a high pass of a satellite in a 500 km orbit is simulated.
+ *
+ * With --radios several radios are simulated on consecutive ports from
+ * --rig-port on. The benchmark then tunes all of them with one controller:
+ * the first radio is a receiver, the second a transmitter for the uplink
+ * and the others further receivers.
+ *
+ * With --table the radio controller gets a Doppler table of the pass, as
+ * the radio controls compute it before AOS, and takes the Doppler shift of
+ * each cycle from it instead of the input of the benchmark.
+ *
+ * The pass time runs --speed times faster than the wall clock. Slewing of
+ * the rotator follows the pass time, while the command latency does not.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <errno.h>
+#include <glib.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <arpa/inet.h>          /* htonl() */
+#include <netinet/in.h>         /* struct sockaddr_in */
+#include <sys/socket.h>         /* socket(), bind(), accept() */
+#include <unistd.h>             /* close() */
+#else
+#include <winsock2.h>
+#endif
+
+#include "doppler-table.h"
+#include "radio-ctrl.h"
+#include "rotctld-client.h"
+#include "rotor-schedule.h"
+#include "sat-log.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+
+/* hamlib error codes */
+#define SIM_EINVAL  -1          /* invalid parameter */
+#define SIM_ENAVAIL -11         /* function not available */
+
+#define LINE_SIZE 256
+#define SIM_MAX_RADIOS 8
+
+/* Benchmark parameters */
+#define BENCH_TICK      20              /* msec between error samples */
+#define BENCH_LEADIN    60.0            /* pass time before AOS [sec] */
+#define BENCH_FREQ      435000000.0     /* satellite downlink [Hz] */
+#define BENCH_UPFREQ    145900000.0     /* satellite uplink [Hz] */
+#define BENCH_T0        2451545.0       /* Julian date of AOS; any date will do */
+#define BENCH_STEP      1.0             /* schedule sample step [sec] */
+
+/* Orbit of the built-in pass */
+#define SIM_RE          6378.135        /* earth radius [km] */
+#define SIM_ALT         500.0           /* altitude [km] */
+#define SIM_GM          398600.8        /* gravitational parameter [km^3/s^2] */
+#define SIM_OFFSET      1.0             /* ground track offset [deg] */
+
+/** One sample of a pass. */
+typedef struct {
+    gdouble         t;          /*!< Seconds from AOS. */
+    gdouble         az;         /*!< Azimuth [deg]. */
+    gdouble         el;         /*!< Elevation [deg]. */
+    gdouble         rr;         /*!< Range rate [km/s]. */
+} sample_t;
+
+/** State of a simulated radio. */
+typedef struct {
+    gdouble         freq;       /*!< Main VFO [Hz]. */
+    gdouble         txfreq;     /*!< Split TX VFO [Hz]. */
+    gint            ptt;
+    gint            split;
+    guint           commands;
+    guint           freq_changes;
+} sim_radio_t;
+
+/** A client connection. */
+typedef struct {
+    gint            sock;
+    gboolean        rotator;    /*!< Speaks the rotctld protocol. */
+    sim_radio_t    *radio;      /*!< The radio, unless rotator. */
+    gboolean        vfo_opt;    /*!< The VFO is given with every command. */
+} conn_t;
+
+/** A reply under construction. */
+typedef struct {
+    gboolean        extended;   /*!< Use the extended response protocol. */
+    GString        *values;     /*!< Value lines. */
+} reply_t;
+
+typedef gint    (*sim_cmd_fn) (conn_t * conn, gchar ** argv, gint argc,
+                               reply_t * reply);
+
+/** A command of the protocol. */
+typedef struct {
+    gchar           cmd;        /*!< Short command. */
+    const gchar    *name;       /*!< Long command, also used in extended replies. */
+    sim_cmd_fn      fn;
+} sim_cmd_t;
+
+/** State of the simulated radios and rotator. */
+static struct {
+    GMutex          lock;
+
+    sim_radio_t     radios[SIM_MAX_RADIOS];
+
+    /* rotator */
+    gdouble         az, el;
+    gdouble         trg_az, trg_el;
+    gdouble         moved;      /*!< Pass time the position was updated. */
+    guint           rot_commands;
+    guint           setpoints;
+} sim;
+
+/* Monotonic time of pass time 0 */
+static gint64   sim_start;
+
+/* Command line options */
+static gint     rig_port = 4532;
+static gint     rot_port = 4533;
+static gint     nradios = 1;
+static gint     latency = 10;
+static gint     jitter = 0;
+static gdouble  tuning_step = 10.0;
+static gdouble  azrate = 5.0;
+static gdouble  elrate = 2.5;
+static gdouble  speed = 1.0;
+static gboolean bench = FALSE;
+static gchar   *passfile = NULL;
+static gint     rig_cycle = 500;
+static gdouble  tolerance = 0.0;
+static gboolean use_table = FALSE;
+static gint     rot_cycle = 1000;
+static gdouble  threshold = 5.0;
+static gdouble  max_doppler_error = 0.0;
+static gdouble  max_pointing_error = 0.0;
+static gboolean verbose = FALSE;
+
+static GOptionEntry entries[] = {
+    {"rig-port", 'r', 0, G_OPTION_ARG_INT, &rig_port,
+     "Port of the simulated rigctld, 0 to disable (4532)", "PORT"},
+    {"rot-port", 'R', 0, G_OPTION_ARG_INT, &rot_port,
+     "Port of the simulated rotctld, 0 to disable (4533)", "PORT"},
+    {"radios", 0, 0, G_OPTION_ARG_INT, &nradios,
+     "Number of radios, on consecutive ports (1)", "N"},
+    {"latency", 'l', 0, G_OPTION_ARG_INT, &latency,
+     "Time to execute a command (10)", "MSEC"},
+    {"jitter", 'j', 0, G_OPTION_ARG_INT, &jitter,
+     "Random extra time to execute a command (0)", "MSEC"},
+    {"step", 's', 0, G_OPTION_ARG_DOUBLE, &tuning_step,
+     "Tuning step of the radio (10)", "HZ"},
+    {"az-rate", 0, 0, G_OPTION_ARG_DOUBLE, &azrate,
+     "Azimuth slew rate, 0 for no limit (5.0)", "DEG/S"},
+    {"el-rate", 0, 0, G_OPTION_ARG_DOUBLE, &elrate,
+     "Elevation slew rate, 0 for no limit (2.5)", "DEG/S"},
+    {"speed", 0, 0, G_OPTION_ARG_DOUBLE, &speed,
+     "Run the pass time faster than real time (1.0)", "FACTOR"},
+    {"bench", 'b', 0, G_OPTION_ARG_NONE, &bench,
+     "Run the radio and rotator controllers through a pass and exit", NULL},
+    {"pass", 'p', 0, G_OPTION_ARG_FILENAME, &passfile,
+     "Recorded pass for the benchmark", "FILE"},
+    {"rig-cycle", 0, 0, G_OPTION_ARG_INT, &rig_cycle,
+     "Cycle of the radio controller in the benchmark (500)", "MSEC"},
+    {"tolerance", 0, 0, G_OPTION_ARG_DOUBLE, &tolerance,
+     "Doppler tolerance of the radio controller in the benchmark (0)", "HZ"},
+    {"table", 0, 0, G_OPTION_ARG_NONE, &use_table,
+     "Give the radio controller a Doppler table of the pass", NULL},
+    {"rot-cycle", 0, 0, G_OPTION_ARG_INT, &rot_cycle,
+     "Cycle of the rotator controller in the benchmark (1000)", "MSEC"},
+    {"threshold", 0, 0, G_OPTION_ARG_DOUBLE, &threshold,
+     "Rotator threshold in the benchmark (5.0)", "DEG"},
+    {"max-doppler-error", 0, 0, G_OPTION_ARG_DOUBLE, &max_doppler_error,
+     "Fail the benchmark if the rms Doppler error is larger", "HZ"},
+    {"max-pointing-error", 0, 0, G_OPTION_ARG_DOUBLE, &max_pointing_error,
+     "Fail the benchmark if the rms pointing error is larger", "DEG"},
+    {"verbose", 'v', 0, G_OPTION_ARG_NONE, &verbose,
+     "Show the debug messages of the controllers", NULL},
+    {NULL}
+};
+
+
+/*
+ * The controllers log through sat_log_log(); the simulator has no log
+ * window, so the messages are written to stderr.
+ */
+void sat_log_log(sat_log_level_t level, const char *fmt, ...)
+{
+    static const gchar *names[] = { "", "ERROR", "WARN", "INFO", "DEBUG" };
+    va_list         args;
+
+    if (level > (verbose ? SAT_LOG_LEVEL_DEBUG : SAT_LOG_LEVEL_WARN))
+        return;
+
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", names[CLAMP(level, 0, 4)]);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+/** The simulated pass time [sec]. */
+static gdouble sim_time(void)
+{
+    return (g_get_monotonic_time() - sim_start) * speed / G_USEC_PER_SEC;
+}
+
+static void close_socket(gint sock)
+{
+#ifndef WIN32
+    shutdown(sock, SHUT_RDWR);
+    close(sock);
+#else
+    shutdown(sock, SD_BOTH);
+    closesocket(sock);
+#endif
+}
+
+/** Move x towards target by at most step; no limit if step is negative. */
+static gdouble approach(gdouble x, gdouble target, gdouble step)
+{
+    if (step < 0.0 || fabs(target - x) <= step)
+        return target;
+
+    return target > x ? x + step : x - step;
+}
+
+/** Update the rotator position to the pass time t. Call with the lock held. */
+static void move_rotator(gdouble t)
+{
+    gdouble         dt = MAX(t - sim.moved, 0.0);
+
+    sim.az = approach(sim.az, sim.trg_az, azrate > 0.0 ? azrate * dt : -1.0);
+    sim.el = approach(sim.el, sim.trg_el, elrate > 0.0 ? elrate * dt : -1.0);
+    sim.moved = t;
+}
+
+static void add_value(reply_t * reply, const gchar * label,
+                      const gchar * fmt, ...)
+{
+    va_list         args;
+
+    if (reply->extended)
+        g_string_append_printf(reply->values, "%s: ", label);
+
+    va_start(args, fmt);
+    g_string_append_vprintf(reply->values, fmt, args);
+    va_end(args);
+    g_string_append_c(reply->values, '\n');
+}
+
+static void add_double(reply_t * reply, const gchar * label, gdouble value)
+{
+    gchar           buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    add_value(reply, label, "%s",
+              g_ascii_formatd(buf, sizeof(buf), "%.6f", value));
+}
+
+/** Split the arguments of a command, ignoring repeated blanks. */
+static gchar  **split_args(gchar * args, gint * argc)
+{
+    gchar         **argv;
+    gint            i, n = 0;
+
+    argv = g_strsplit_set(g_strstrip(args), " \t", -1);
+    for (i = 0; argv[i] != NULL; i++)
+    {
+        if (argv[i][0] == '\0')
+            g_free(argv[i]);
+        else
+            argv[n++] = argv[i];
+    }
+    argv[n] = NULL;
+    *argc = n;
+
+    return argv;
+}
+
+/** Parse a number; hamlib always uses a decimal point. */
+static gboolean parse_double(const gchar * arg, gdouble * value)
+{
+    gchar          *end;
+
+    *value = g_ascii_strtod(arg, &end);
+
+    return end != arg && *end == '\0';
+}
+
+/**
+ * Skip the VFO argument of a radio command.
+ *
+ * The VFO is only given when the client enabled the VFO option, but some
+ * clients always send it; a VFO is recognised by not being a number.
+ */
+static gint skip_vfo(gchar *** argv, gint argc)
+{
+    if (argc > 0 && g_ascii_isalpha((*argv)[0][0]))
+    {
+        (*argv)++;
+        argc--;
+    }
+
+    return argc;
+}
+
+static gint get_freq(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)argv;
+    (void)argc;
+
+    add_value(reply, "Frequency", "%.0f", conn->radio->freq);
+
+    return 0;
+}
+
+/** Tune a VFO to the nearest tuning step. */
+static gint tune(sim_radio_t * radio, gdouble * vfo, gchar ** argv,
+                 gint argc)
+{
+    gdouble         freq;
+
+    argc = skip_vfo(&argv, argc);
+    if (argc < 1 || !parse_double(argv[0], &freq) || freq <= 0.0)
+        return SIM_EINVAL;
+
+    if (tuning_step > 0.0)
+        freq = rint(freq / tuning_step) * tuning_step;
+
+    if (freq != *vfo)
+        radio->freq_changes++;
+    *vfo = freq;
+
+    return 0;
+}
+
+static gint set_freq(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)reply;
+
+    return tune(conn->radio, &conn->radio->freq, argv, argc);
+}
+
+static gint get_split_freq(conn_t * conn, gchar ** argv, gint argc,
+                           reply_t * reply)
+{
+    (void)argv;
+    (void)argc;
+
+    add_value(reply, "TX Frequency", "%.0f", conn->radio->txfreq);
+
+    return 0;
+}
+
+static gint set_split_freq(conn_t * conn, gchar ** argv, gint argc,
+                           reply_t * reply)
+{
+    (void)reply;
+
+    return tune(conn->radio, &conn->radio->txfreq, argv, argc);
+}
+
+static gint get_ptt(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)argv;
+    (void)argc;
+
+    add_value(reply, "PTT", "%d", conn->radio->ptt);
+
+    return 0;
+}
+
+static gint set_ptt(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)reply;
+
+    argc = skip_vfo(&argv, argc);
+    if (argc < 1)
+        return SIM_EINVAL;
+
+    conn->radio->ptt = atoi(argv[0]) ? 1 : 0;
+
+    return 0;
+}
+
+static gint get_dcd(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)conn;
+    (void)argv;
+    (void)argc;
+
+    add_value(reply, "DCD", "%d", 0);
+
+    return 0;
+}
+
+static gint get_split_vfo(conn_t * conn, gchar ** argv, gint argc,
+                          reply_t * reply)
+{
+    (void)argv;
+    (void)argc;
+
+    add_value(reply, "Split", "%d", conn->radio->split);
+    add_value(reply, "TX VFO", "%s", "VFOB");
+
+    return 0;
+}
+
+static gint set_split_vfo(conn_t * conn, gchar ** argv, gint argc,
+                          reply_t * reply)
+{
+    (void)reply;
+
+    argc = skip_vfo(&argv, argc);
+    if (argc < 1)
+        return SIM_EINVAL;
+
+    conn->radio->split = atoi(argv[0]) ? 1 : 0;
+
+    return 0;
+}
+
+static gint chk_vfo(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)argv;
+    (void)argc;
+
+    add_value(reply, "ChkVFO", "%d", conn->vfo_opt ? 1 : 0);
+
+    return 0;
+}
+
+static gint set_vfo_opt(conn_t * conn, gchar ** argv, gint argc,
+                        reply_t * reply)
+{
+    (void)reply;
+
+    if (argc < 1)
+        return SIM_EINVAL;
+
+    conn->vfo_opt = atoi(argv[0]) ? TRUE : FALSE;
+
+    return 0;
+}
+
+static gint get_info(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)argv;
+    (void)argc;
+
+    add_value(reply, "Info", "gpredict %s simulator",
+              conn->rotator ? "rotator" : "radio");
+
+    return 0;
+}
+
+static gint get_pos(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)conn;
+    (void)argv;
+    (void)argc;
+
+    move_rotator(sim_time());
+    add_double(reply, "Azimuth", sim.az);
+    add_double(reply, "Elevation", sim.el);
+
+    return 0;
+}
+
+static gint set_pos(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    gdouble         az, el;
+
+    (void)conn;
+    (void)reply;
+
+    if (argc < 2 || !parse_double(argv[0], &az) ||
+        !parse_double(argv[1], &el) ||
+        az < -180.0 || az > 540.0 || el < -90.0 || el > 180.0)
+        return SIM_EINVAL;
+
+    move_rotator(sim_time());
+    sim.trg_az = az;
+    sim.trg_el = el;
+    sim.setpoints++;
+
+    return 0;
+}
+
+static gint stop(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)conn;
+    (void)argv;
+    (void)argc;
+    (void)reply;
+
+    move_rotator(sim_time());
+    sim.trg_az = sim.az;
+    sim.trg_el = sim.el;
+
+    return 0;
+}
+
+static gint park(conn_t * conn, gchar ** argv, gint argc, reply_t * reply)
+{
+    (void)conn;
+    (void)argv;
+    (void)argc;
+    (void)reply;
+
+    move_rotator(sim_time());
+    sim.trg_az = 0.0;
+    sim.trg_el = 0.0;
+
+    return 0;
+}
+
+static const sim_cmd_t rig_cmds[] = {
+    {'f', "get_freq", get_freq},
+    {'F', "set_freq", set_freq},
+    {'i', "get_split_freq", get_split_freq},
+    {'I', "set_split_freq", set_split_freq},
+    {'t', "get_ptt", get_ptt},
+    {'T', "set_ptt", set_ptt},
+    {'s', "get_split_vfo", get_split_vfo},
+    {'S', "set_split_vfo", set_split_vfo},
+    {'\x8b', "get_dcd", get_dcd},
+    {'_', "get_info", get_info},
+    {0, "chk_vfo", chk_vfo},
+    {0, "set_vfo_opt", set_vfo_opt},
+    {0, NULL, NULL}
+};
+
+static const sim_cmd_t rot_cmds[] = {
+    {'p', "get_pos", get_pos},
+    {'P', "set_pos", set_pos},
+    {'S', "stop", stop},
+    {'K', "park", park},
+    {'_', "get_info", get_info},
+    {0, NULL, NULL}
+};
+
+/** Wait the time the simulated device takes to execute a command. */
+static void command_delay(void)
+{
+    gint            delay = latency;
+
+    if (jitter > 0)
+        delay += g_random_int_range(0, jitter + 1);
+
+    if (delay > 0)
+        g_usleep(delay * 1000);
+}
+
+/**
+ * Execute a command line and send the reply.
+ *
+ * @return FALSE if the connection should be closed.
+ */
+static gboolean execute(conn_t * conn, gchar * line)
+{
+    const sim_cmd_t *cmds = conn->rotator ? rot_cmds : rig_cmds;
+    const sim_cmd_t *cmd = NULL;
+    reply_t         reply;
+    GString        *out;
+    gchar         **argv;
+    gchar          *args;
+    gint            argc, i, status;
+    gssize          sent;
+    gboolean        ok;
+
+    reply.extended = (line[0] == '+');
+    if (reply.extended)
+        line++;
+
+    if (line[0] == '\0')
+        return TRUE;
+    if (line[0] == 'q' || line[0] == 'Q')
+        return FALSE;
+
+    /* long commands start with a backslash, short ones are one character */
+    if (line[0] == '\\')
+    {
+        args = line + 1;
+        while (*args != '\0' && *args != ' ')
+            args++;
+        if (*args != '\0')
+            *args++ = '\0';
+        for (i = 0; cmds[i].name != NULL; i++)
+            if (strcmp(cmds[i].name, line + 1) == 0)
+                cmd = &cmds[i];
+    }
+    else
+    {
+        args = line + 1;
+        for (i = 0; cmds[i].name != NULL; i++)
+            if (cmds[i].cmd != 0 && cmds[i].cmd == line[0])
+                cmd = &cmds[i];
+    }
+
+    argv = split_args(args, &argc);
+
+    command_delay();
+
+    reply.values = g_string_new(NULL);
+    g_mutex_lock(&sim.lock);
+    if (conn->rotator)
+        sim.rot_commands++;
+    else
+        conn->radio->commands++;
+    status = cmd ? cmd->fn(conn, argv, argc, &reply) : SIM_ENAVAIL;
+    g_mutex_unlock(&sim.lock);
+
+    out = g_string_new(NULL);
+    if (reply.extended)
+    {
+        g_string_append_printf(out, "%s:", cmd ? cmd->name : line);
+        for (i = 0; i < argc; i++)
+            g_string_append_printf(out, " %s", argv[i]);
+        g_string_append_printf(out, "\n%sRPRT %d\n",
+                               status == 0 ? reply.values->str : "", status);
+    }
+    else if (status == 0 && reply.values->len > 0)
+    {
+        g_string_append(out, reply.values->str);
+    }
+    else
+    {
+        g_string_append_printf(out, "RPRT %d\n", status);
+    }
+
+    /* the client may have given up and closed the connection */
+    sent = send(conn->sock, out->str, out->len, MSG_NOSIGNAL);
+    ok = (sent == (gssize) out->len);
+
+    g_string_free(out, TRUE);
+    g_string_free(reply.values, TRUE);
+    g_strfreev(argv);
+
+    return ok;
+}
+
+/** Serve one client connection. */
+static gpointer conn_thread(gpointer data)
+{
+    conn_t         *conn = data;
+    gchar           buf[LINE_SIZE];
+    gchar          *line, *nl;
+    gsize           len = 0;
+    gssize          n;
+    gboolean        open = TRUE;
+
+    while (open)
+    {
+        n = recv(conn->sock, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n <= 0)
+            break;
+        len += n;
+        buf[len] = '\0';
+
+        /* execute the complete lines; a batch is executed in order */
+        line = buf;
+        while (open && (nl = strchr(line, '\n')) != NULL)
+        {
+            *nl = '\0';
+            if (nl > line && nl[-1] == '\r')
+                nl[-1] = '\0';
+            open = execute(conn, line);
+            line = nl + 1;
+        }
+
+        len -= line - buf;
+        memmove(buf, line, len);
+
+        /* a line that does not fit is garbage */
+        if (len == sizeof(buf) - 1)
+            len = 0;
+    }
+
+    close_socket(conn->sock);
+    g_free(conn);
+
+    return NULL;
+}
+
+/** Accept connections on a listening socket. */
+static gpointer listen_thread(gpointer data)
+{
+    conn_t         *server = data;
+    conn_t         *conn;
+    GThread        *thread;
+    gint            sock;
+
+    while ((sock = accept(server->sock, NULL, NULL)) >= 0)
+    {
+        conn = g_new0(conn_t, 1);
+        conn->sock = sock;
+        conn->rotator = server->rotator;
+        conn->radio = server->radio;
+        thread = g_thread_new(conn->rotator ? "rotctld-conn" : "rigctld-conn",
+                              conn_thread, conn);
+        g_thread_unref(thread);
+    }
+
+    g_printerr("Could not accept connections: %s\n", g_strerror(errno));
+
+    return NULL;
+}
+
+/**
+ * Listen on a local port and serve the clients in the background.
+ *
+ * @param radio The simulated radio, or NULL for the rotator.
+ */
+static gboolean start_server(gint port, sim_radio_t * radio)
+{
+    struct sockaddr_in addr;
+    conn_t         *server;
+    GThread        *thread;
+    gboolean        rotator = (radio == NULL);
+    gint            sock;
+    gint            on = 1;
+
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0)
+    {
+        g_printerr("Could not create socket: %s\n", g_strerror(errno));
+        return FALSE;
+    }
+
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&on, sizeof(on));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(sock, 4) != 0)
+    {
+        g_printerr("Could not listen on port %d: %s\n", port,
+                   g_strerror(errno));
+        close_socket(sock);
+        return FALSE;
+    }
+
+    server = g_new0(conn_t, 1);
+    server->sock = sock;
+    server->rotator = rotator;
+    server->radio = radio;
+    thread = g_thread_new(rotator ? "rotctld-listen" : "rigctld-listen",
+                          listen_thread, server);
+    g_thread_unref(thread);
+
+    g_print("Simulated %s listening on localhost:%d\n",
+            rotator ? "rotctld" : "rigctld", port);
+
+    return TRUE;
+}
+
+/** Load a recorded pass. */
+static GArray  *load_pass(const gchar * file)
+{
+    GArray         *pass;
+    GError         *err = NULL;
+    sample_t        s;
+    gchar          *contents;
+    gchar         **lines, **tok;
+    guint           i;
+    gboolean        ok = TRUE;
+
+    if (!g_file_get_contents(file, &contents, NULL, &err))
+    {
+        g_printerr("Could not read %s: %s\n", file, err->message);
+        g_clear_error(&err);
+        return NULL;
+    }
+
+    pass = g_array_new(FALSE, FALSE, sizeof(sample_t));
+    lines = g_strsplit(contents, "\n", -1);
+    for (i = 0; ok && lines[i] != NULL; i++)
+    {
+        g_strstrip(lines[i]);
+        if (lines[i][0] == '\0' || lines[i][0] == '#')
+            continue;
+
+        tok = g_strsplit_set(lines[i], " \t,", -1);
+        ok = g_strv_length(tok) >= 4 &&
+            parse_double(tok[0], &s.t) && parse_double(tok[1], &s.az) &&
+            parse_double(tok[2], &s.el) && parse_double(tok[3], &s.rr) &&
+            (pass->len == 0 || s.t > g_array_index(pass, sample_t,
+                                                   pass->len - 1).t);
+        g_strfreev(tok);
+
+        if (ok)
+            g_array_append_val(pass, s);
+        else
+            g_printerr("%s:%u: Expected increasing time, azimuth, "
+                       "elevation and range rate\n", file, i + 1);
+    }
+
+    g_strfreev(lines);
+    g_free(contents);
+
+    if (ok && pass->len < 2)
+    {
+        g_printerr("%s: The pass needs at least two samples\n", file);
+        ok = FALSE;
+    }
+
+    if (!ok)
+    {
+        g_array_free(pass, TRUE);
+        return NULL;
+    }
+
+    return pass;
+}
+
+/**
+ * Simulate a pass of a satellite in a circular orbit.
+ *
+ * The orbit crosses the meridian of the observer with the ground track
+ * SIM_OFFSET degrees east of it, so the pass is high; the rotation of the
+ * earth is ignored.
+ */
+static GArray  *synthetic_pass(void)
+{
+    GArray         *pass;
+    sample_t        s;
+    gdouble         r = SIM_RE + SIM_ALT;
+    gdouble         w = sqrt(SIM_GM / r) / r;   /* angular rate [rad/s] */
+    gdouble         b = SIM_OFFSET * G_PI / 180.0;
+    gdouble         t, a, d[3], v[3], range;
+    gdouble         aos = 0.0;
+
+    pass = g_array_new(FALSE, FALSE, sizeof(sample_t));
+
+    for (t = -1200.0; t <= 1200.0; t += 1.0)
+    {
+        /* position and velocity relative to the observer at (0, 0, RE);
+           x is east, y is north and z is up */
+        a = w * t;
+        d[0] = r * cos(a) * sin(b);
+        d[1] = r * sin(a);
+        d[2] = r * cos(a) * cos(b) - SIM_RE;
+        v[0] = -r * w * sin(a) * sin(b);
+        v[1] = r * w * cos(a);
+        v[2] = -r * w * sin(a) * cos(b);
+
+        range = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        s.el = asin(d[2] / range) * 180.0 / G_PI;
+        if (s.el < 0.0)
+            continue;
+
+        if (pass->len == 0)
+            aos = t;
+        s.t = t - aos;
+        s.az = atan2(d[0], d[1]) * 180.0 / G_PI;
+        if (s.az < 0.0)
+            s.az += 360.0;
+        s.rr = (d[0] * v[0] + d[1] * v[1] + d[2] * v[2]) / range;
+
+        g_array_append_val(pass, s);
+    }
+
+    return pass;
+}
+
+/** Interpolate a pass at time t, limited to the first and last sample. */
+static void interpolate(GArray * pass, gdouble t, sample_t * s)
+{
+    const sample_t *a, *b;
+    gdouble         f, daz;
+    guint           lo = 0, hi = pass->len - 1, mid;
+
+    a = &g_array_index(pass, sample_t, 0);
+    b = &g_array_index(pass, sample_t, hi);
+    if (t <= a->t || t >= b->t)
+    {
+        *s = t <= a->t ? *a : *b;
+        s->t = t;
+        return;
+    }
+
+    while (hi - lo > 1)
+    {
+        mid = (lo + hi) / 2;
+        if (g_array_index(pass, sample_t, mid).t <= t)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    a = &g_array_index(pass, sample_t, lo);
+    b = &g_array_index(pass, sample_t, hi);
+    f = (t - a->t) / (b->t - a->t);
+
+    /* the azimuth takes the short way across north */
+    daz = fmod(b->az - a->az + 540.0, 360.0) - 180.0;
+
+    s->t = t;
+    s->az = fmod(a->az + f * daz + 360.0, 360.0);
+    s->el = a->el + f * (b->el - a->el);
+    s->rr = a->rr + f * (b->rr - a->rr);
+}
+
+/** Downlink Doppler shift at the pass time t [Hz]. */
+static gdouble doppler(GArray * pass, gdouble t)
+{
+    sample_t        s;
+
+    interpolate(pass, t, &s);
+
+    return -BENCH_FREQ * s.rr / SPEED_OF_LIGHT;
+}
+
+/** Compute the pointing schedule of the pass. */
+static rotor_schedule_t *plan_pass(GArray * pass, rotor_conf_t * conf)
+{
+    rotor_schedule_t *sched;
+    sample_t        s;
+    gdouble        *az, *el;
+    gdouble         end = g_array_index(pass, sample_t, pass->len - 1).t;
+    guint           n, i;
+
+    n = (guint) (end / BENCH_STEP) + 1;
+    az = g_new(gdouble, n);
+    el = g_new(gdouble, n);
+    for (i = 0; i < n; i++)
+    {
+        interpolate(pass, i * BENCH_STEP, &s);
+        az[i] = s.az;
+        el[i] = s.el;
+    }
+
+    sched = rotor_schedule_new_from_track("benchmark", BENCH_T0, BENCH_STEP,
+                                          az, el, n, conf, FALSE);
+    g_free(az);
+    g_free(el);
+
+    return sched;
+}
+
+/** Compute the Doppler table of the pass, including the lead-in. */
+static doppler_table_t *plan_doppler(GArray * pass)
+{
+    doppler_table_t *tab;
+    sample_t        s;
+    gdouble        *rr;
+    gdouble         end = g_array_index(pass, sample_t, pass->len - 1).t;
+    guint           n, i;
+
+    n = (guint) ((end + BENCH_LEADIN) / BENCH_STEP) + 1;
+    rr = g_new(gdouble, n);
+    for (i = 0; i < n; i++)
+    {
+        interpolate(pass, i * BENCH_STEP - BENCH_LEADIN, &s);
+        rr[i] = s.rr;
+    }
+
+    tab = doppler_table_new("benchmark", BENCH_T0 - BENCH_LEADIN / secday,
+                            BENCH_STEP, rr, n);
+    g_free(rr);
+
+    return tab;
+}
+
+/**
+ * Run the controllers through a pass against the simulator.
+ *
+ * @return 0 if the errors are within the limits given on the command line.
+ */
+static gint run_bench(GArray * pass)
+{
+    radio_conf_t    rigconfs[SIM_MAX_RADIOS];
+    const radio_conf_t *confs[SIM_MAX_RADIOS];
+    radio_ctrl_input_t input;
+    radio_ctrl_output_t output;
+    radio_ctrl_t   *rc = NULL;
+    doppler_table_t *tab = NULL;
+    rotor_conf_t    rotconf;
+    rotor_schedule_t *sched = NULL;
+    const rotor_setpoint_t *sp, *sent = NULL;
+    rotctld_t      *rot = NULL;
+    rotctld_status_t status;
+    sample_t        s;
+    gdouble         end = g_array_index(pass, sample_t, pass->len - 1).t;
+    gdouble         maxel = 0.0;
+    gdouble         t, ahead, az, el, err, elapsed, shift;
+    gdouble         freqs[SIM_MAX_RADIOS];
+    gdouble         dop_sum2[SIM_MAX_RADIOS], dop_max[SIM_MAX_RADIOS];
+    gdouble         dop_rms = 0.0, rms, cycle_sum = 0.0;
+    gdouble         rot_rms = 0.0;
+    guint           ndop = 0, ncycles = 0, ncycle_samples = 0, i;
+    guint           commands = 0, changes = 0;
+    gint64          lead = 0;
+    gint            retcode = 0;
+
+    for (i = 0; i < pass->len; i++)
+        maxel = MAX(maxel, g_array_index(pass, sample_t, i).el);
+
+    g_print("Pass of %.0f s with max elevation %.1f deg at %.1fx speed\n",
+            end, maxel, speed);
+
+    memset(&input, 0, sizeof(input));
+    memset(&output, 0, sizeof(output));
+    memset(&status, 0, sizeof(status));
+    memset(dop_sum2, 0, sizeof(dop_sum2));
+    memset(dop_max, 0, sizeof(dop_max));
+
+    if (rig_port > 0)
+    {
+        /* a receiver, a transmitter and further receivers */
+        for (i = 0; i < (guint) nradios; i++)
+        {
+            memset(&rigconfs[i], 0, sizeof(rigconfs[i]));
+            rigconfs[i].name = g_strdup_printf("hamlib-sim-%u", i + 1);
+            rigconfs[i].host = "localhost";
+            rigconfs[i].port = rig_port + i;
+            rigconfs[i].cycle = rig_cycle;
+            rigconfs[i].tolerance = tolerance;
+            rigconfs[i].type = (i == 1) ? RIG_TYPE_TX : RIG_TYPE_RX;
+            rigconfs[i].ptt = PTT_TYPE_NONE;
+            confs[i] = &rigconfs[i];
+        }
+
+        input.tracking = TRUE;
+        input.satfreq_down = BENCH_FREQ;
+        input.satfreq_up = BENCH_UPFREQ;
+        input.satfreq_seq = 1;
+        input.catnum = 1;
+        input.time_rate = speed;
+        rc = radio_ctrl_new(confs, nradios, &input, NULL, NULL);
+
+        if (use_table)
+        {
+            tab = plan_doppler(pass);
+            radio_ctrl_set_doppler_table(rc, tab);
+        }
+    }
+
+    if (rot_port > 0)
+    {
+        memset(&rotconf, 0, sizeof(rotconf));
+        rotconf.name = "hamlib-sim";
+        rotconf.host = "localhost";
+        rotconf.port = rot_port;
+        rotconf.cycle = rot_cycle;
+        rotconf.aztype = ROT_AZ_TYPE_360;
+        rotconf.maxaz = 360.0;
+        rotconf.maxel = 90.0;
+        rotconf.threshold = threshold;
+        rotconf.azrate = azrate;
+        rotconf.elrate = elrate;
+        rotconf.lead = 2.0;
+
+        rot = rotctld_open("localhost", rot_port, rot_cycle, ROTCTLD_TIMEOUT);
+        sched = plan_pass(pass, &rotconf);
+    }
+
+    /* pass time 0 is AOS */
+    sim_start = g_get_monotonic_time() +
+        (gint64) (BENCH_LEADIN / speed * G_USEC_PER_SEC);
+
+    while ((t = sim_time()) < end)
+    {
+        if (rc != NULL)
+        {
+            /* predict the Doppler shift for when it is applied, as the
+               radio controls do */
+            radio_ctrl_get_output(rc, &output);
+            lead = MIN(output.latency, MAX_DOPPLER_LEAD);
+            ahead = t + lead * speed / G_USEC_PER_SEC;
+
+            interpolate(pass, ahead, &s);
+            input.el = s.el;
+            input.dd = doppler(pass, ahead);
+            input.dd_dot = (doppler(pass, ahead + 1.0) - input.dd) * speed;
+            input.du = -input.dd * BENCH_UPFREQ / BENCH_FREQ;
+            input.du_dot = -input.dd_dot * BENCH_UPFREQ / BENCH_FREQ;
+            input.dop_time = g_get_monotonic_time();
+            input.dop_lead = lead;
+            input.jul_time = BENCH_T0 + t / secday;
+            radio_ctrl_set_input(rc, &input);
+        }
+
+        if (sched != NULL)
+        {
+            sp = rotor_schedule_get(sched, BENCH_T0 + t / secday,
+                                    rotconf.lead);
+            if (sp != sent)
+            {
+                rotctld_set_target(rot, sp->az, sp->el);
+                sent = sp;
+                sched->commands++;
+            }
+        }
+
+        /* sample the simulated devices against the pass */
+        g_mutex_lock(&sim.lock);
+        move_rotator(t);
+        for (i = 0; i < (guint) nradios; i++)
+            freqs[i] = sim.radios[i].freq;
+        az = sim.az;
+        el = sim.el;
+        g_mutex_unlock(&sim.lock);
+
+        if (t >= 0.0)
+        {
+            if (rc != NULL && output.cycles > 0)
+            {
+                shift = doppler(pass, t);
+                for (i = 0; i < (guint) nradios; i++)
+                {
+                    if (i == 1)
+                        err = fabs(freqs[i] - BENCH_UPFREQ +
+                                   shift * BENCH_UPFREQ / BENCH_FREQ);
+                    else
+                        err = fabs(freqs[i] - BENCH_FREQ - shift);
+                    dop_sum2[i] += err * err;
+                    dop_max[i] = MAX(dop_max[i], err);
+                }
+                ndop++;
+
+                /* cycles are sampled about once each, as they are longer
+                   than the tick */
+                if (output.cycles != ncycles)
+                {
+                    ncycles = output.cycles;
+                    cycle_sum += output.cycle_time;
+                    ncycle_samples++;
+                }
+            }
+
+            if (sched != NULL)
+            {
+                interpolate(pass, t, &s);
+                rotor_schedule_add_error(sched, s.az, s.el, az, el);
+            }
+        }
+
+        g_usleep(BENCH_TICK * 1000);
+    }
+
+    elapsed = (g_get_monotonic_time() - sim_start) / (gdouble) G_USEC_PER_SEC +
+        BENCH_LEADIN / speed;
+
+    g_mutex_lock(&sim.lock);
+    if (rc != NULL)
+    {
+        radio_ctrl_get_output(rc, &output);
+        for (i = 0; i < (guint) nradios; i++)
+        {
+            commands += sim.radios[i].commands;
+            changes += sim.radios[i].freq_changes;
+        }
+
+        g_print("Radio:    %.1f commands/s, %.1f cycles/s, "
+                "%.1f frequency changes/s\n",
+                commands / elapsed, output.cycles / elapsed,
+                changes / elapsed);
+        g_print("          latency %.1f ms, cycle time %.1f ms\n",
+                output.latency / 1000.0,
+                ncycle_samples ? cycle_sum / ncycle_samples / 1000.0 : 0.0);
+
+        /* the worst radio decides */
+        for (i = 0; i < (guint) nradios; i++)
+        {
+            rms = ndop ? sqrt(dop_sum2[i] / ndop) : 0.0;
+            dop_rms = MAX(dop_rms, rms);
+            g_print("          %s %u: Doppler error rms %.1f Hz, "
+                    "max %.1f Hz\n", i == 1 ? "TX" : "RX", i + 1, rms,
+                    dop_max[i]);
+        }
+        g_print("          %u tuning commands, largest error seen by the "
+                "controller %.1f Hz\n", output.tunes, output.tune_error);
+        if (tab != NULL)
+            g_print("          %u of %u cycles from the Doppler table\n",
+                    output.table_cycles, output.cycles);
+    }
+
+    if (rot != NULL)
+    {
+        rotctld_get_status(rot, &status);
+        rot_rms = sched->nerr ? sqrt(sched->err_sum2 / sched->nerr) : 0.0;
+
+        g_print("Rotator:  %.1f commands/s, %.1f cycles/s, "
+                "%.2f setpoints/s (%u of %u late)\n",
+                sim.rot_commands / elapsed, status.cycles / elapsed,
+                sim.setpoints / elapsed, sched->late, sched->npoints);
+        g_print("          round trip %.1f ms, max %.1f ms, "
+                "pointing error rms %.2f deg, max %.2f deg\n",
+                status.commands ?
+                status.rtt_total / 1000.0 / status.commands : 0.0,
+                status.rtt_max / 1000.0, rot_rms, sched->err_max);
+    }
+    g_mutex_unlock(&sim.lock);
+
+    if (max_doppler_error > 0.0 && dop_rms > max_doppler_error)
+    {
+        g_print("FAIL: Doppler error above %.1f Hz\n", max_doppler_error);
+        retcode = 1;
+    }
+    if (max_pointing_error > 0.0 && rot_rms > max_pointing_error)
+    {
+        g_print("FAIL: pointing error above %.2f deg\n", max_pointing_error);
+        retcode = 1;
+    }
+
+    radio_ctrl_free(rc);
+    for (i = 0; rig_port > 0 && i < (guint) nradios; i++)
+        g_free(rigconfs[i].name);
+    doppler_table_free(tab);
+    if (rot != NULL)
+        rotctld_close(rot, FALSE);
+    rotor_schedule_free(sched);
+
+    return retcode;
+}
+
+int main(int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError         *err = NULL;
+    GArray         *pass = NULL;
+    gint            retcode, i;
+
+    context = g_option_context_new("- simulated rigctld and rotctld");
+    g_option_context_add_main_entries(context, entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &err))
+    {
+        g_printerr("%s\n", err->message);
+        g_clear_error(&err);
+        g_option_context_free(context);
+        return 1;
+    }
+    g_option_context_free(context);
+
+    if (speed <= 0.0 || latency < 0 || jitter < 0)
+    {
+        g_printerr("The speed must be positive and the latency and "
+                   "jitter not negative\n");
+        return 1;
+    }
+
+    if (nradios < 1 || nradios > SIM_MAX_RADIOS)
+    {
+        g_printerr("The number of radios must be 1 to %d\n", SIM_MAX_RADIOS);
+        return 1;
+    }
+
+#ifdef WIN32
+    {
+        WSADATA         wsadata;
+
+        WSAStartup(MAKEWORD(2, 2), &wsadata);
+    }
+#endif
+
+    if (bench)
+    {
+        pass = passfile ? load_pass(passfile) : synthetic_pass();
+        if (pass == NULL)
+            return 1;
+    }
+
+    sim_start = g_get_monotonic_time();
+
+    for (i = 0; rig_port > 0 && i < nradios; i++)
+    {
+        sim.radios[i].freq = BENCH_FREQ;
+        if (!start_server(rig_port + i, &sim.radios[i]))
+            return 1;
+    }
+
+    if (rot_port > 0 && !start_server(rot_port, NULL))
+        return 1;
+
+    if (!bench)
+    {
+        /* serve until killed */
+        g_main_loop_run(g_main_loop_new(NULL, FALSE));
+        return 0;
+    }
+
+    retcode = run_bench(pass);
+    g_array_free(pass, TRUE);
+
+    return retcode;
+}
@@ -30,6 +30,8 @@
 #endif
 
 #include "compat.h"
+#include "coverage-map.h"
+#include "gtk-sat-map.h"
 #include "gtk-sat-selector.h"
 #include "gui.h"
 #include "first-time.h"
@@ -51,6 +53,12 @@ static gboolean cleantrsp = FALSE;
 /* Start application in fullscreen mode */
 static gboolean fullscreen = FALSE;
 
+/* Run the coverage map benchmark and exit */
+static gboolean benchcov = FALSE;
+
+/* Run the map footprint benchmark and exit */
+static gboolean benchfoot = FALSE;
+
 /* Command line options. */
 static GOptionEntry entries[] = {
     {"clean-tle", 0, 0, G_OPTION_ARG_NONE, &cleantle,
@@ -59,6 +67,12 @@ static GOptionEntry entries[] = {
      "Clean the transponder data in user's configuration directory", NULL},
     {"fullscreen", 0, 0, G_OPTION_ARG_NONE, &fullscreen,
      "Start gpredict in fullscreen mode.", NULL},
+    {"benchmark-coverage", 0, 0, G_OPTION_ARG_NONE, &benchcov,
+     "Benchmark the coverage map with 100 satellites over one day and exit.",
+     NULL},
+    {"benchmark-footprints", 0, 0, G_OPTION_ARG_NONE, &benchfoot,
+     "Benchmark the map footprints of 100 satellites over one day and exit.",
+     NULL},
     {NULL}
 };
 
@@ -150,6 +164,28 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (benchcov || benchfoot)
+    {
+        gdouble         res;
+
+        if (benchcov)
+            res = coverage_map_benchmark(100);
+        else
+            res = gtk_sat_map_benchmark_footprints(100);
+
+        if (res < 0.0)
+            g_print(_("No satellites available for the benchmark\n"));
+        else if (benchcov)
+            g_print(_("Coverage map computed in %.3f s\n"), res);
+        else
+            g_print(_("%.0f footprints/s\n"), res);
+
+        g_option_context_free(context);
+        sat_log_close();
+        sat_cfg_close();
+        return res < 0.0 ? 1 : 0;
+    }
+
     /* create application */
     gpredict_app_create();
     gtk_widget_show_all(app);
@@ -561,14 +597,33 @@ static void tle_mon_stop()
     }
 }
 
+/*
+ * Apply the changes of a TLE update to the open modules.
+ *
+ * Runs in the main loop, since the modules and their views are only touched
+ * by the GTK thread.
+ */
+static gboolean apply_tle_changes(gpointer data)
+{
+    GArray         *changes = data;
+
+    mod_mgr_apply_tle_changes(changes);
+    g_array_free(changes, TRUE);
+
+    return FALSE;
+}
+
 /* Thread function which invokes TLE update */
 static          gpointer update_tle_thread(gpointer data)
 {
+    GArray         *changes;
+
     (void)data;
 
     tle_upd_running = TRUE;
-    tle_update_from_network(TRUE, NULL, NULL, NULL);
-    mod_mgr_reload_sats();
+    changes = g_array_new(FALSE, FALSE, sizeof(tle_change_t));
+    tle_update_from_network(TRUE, NULL, NULL, NULL, changes);
+    g_idle_add(apply_tle_changes, changes);
     tle_upd_running = FALSE;
 
     return NULL;
@@ -0,0 +1,379 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Shared map background cache.
+ *
+ * Every map file in use is kept once per process as a pyramid of
+ * successively halved images. Level 0 is the decoded file, level k is
+ * 1/2^k of its size. A map view asks for the background at its own size
+ * and gets it scaled from the smallest level that is still at least as
+ * large, so resizing never touches the full resolution image once a
+ * smaller level exists.
+ *
+ * Levels are generated on demand and written to the user cache directory
+ * as PNG files by a background thread, since encoding a large level would
+ * stall the main loop. A later session can therefore load the level it needs
+ * without decoding a large source image at all. Cached levels older than
+ * the source file are ignored.
+ *
+ * The pyramid is stored centred on 0 longitude; the map views recentre it
+ * when drawing.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "map-cache.h"
+#include "sat-log.h"
+
+
+/** Levels smaller than this are not worth generating. */
+#define MIN_LEVEL_SIZE 64
+
+struct _map_cache {
+    gchar          *file;       /*!< Map file name, key in the cache table. */
+    guint           refcount;   /*!< Number of users. */
+    gint            width;      /*!< Width of the full resolution image. */
+    gint            height;     /*!< Height of the full resolution image. */
+    GPtrArray      *levels;     /*!< GdkPixbuf per level; NULL if not loaded. */
+    gchar          *diskbase;   /*!< Path prefix of the cached levels on disk. */
+    gint64          mtime;      /*!< Modification time of the map file. */
+};
+
+/** A level to be written to the disk cache. */
+typedef struct {
+    gchar          *path;       /*!< File name of the level. */
+    GdkPixbuf      *pbuf;       /*!< The level; a reference is held. */
+} save_job_t;
+
+/** Map file name -> map_cache_t */
+static GHashTable *caches = NULL;
+
+/** Thread writing levels to the disk cache. */
+static GThreadPool *save_pool = NULL;
+
+
+/** Return the path prefix for disk cached levels of a map file. */
+static gchar   *disk_base(const gchar * file)
+{
+    gchar          *dir;
+    gchar          *sum;
+    gchar          *base;
+
+    dir = g_build_filename(g_get_user_cache_dir(), "gpredict", "maps", NULL);
+    if (g_mkdir_with_parents(dir, 0755) != 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Could not create map cache directory %s"),
+                    __func__, dir);
+        g_free(dir);
+        return NULL;
+    }
+
+    sum = g_compute_checksum_for_string(G_CHECKSUM_MD5, file, -1);
+    base = g_build_filename(dir, sum, NULL);
+    g_free(sum);
+    g_free(dir);
+
+    return base;
+}
+
+/** Width or height of a pyramid level. */
+static gint level_size(gint size, guint level)
+{
+    return MAX(1, size >> level);
+}
+
+/** Decode the full resolution map, falling back to a blank image. */
+static GdkPixbuf *load_source(map_cache_t * cache)
+{
+    GError         *error = NULL;
+    GdkPixbuf      *pbuf;
+
+    pbuf = gdk_pixbuf_new_from_file(cache->file, &error);
+    if (error != NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Error loading map file (%s)"),
+                    __func__, error->message);
+        g_clear_error(&error);
+
+        pbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 400, 200);
+        gdk_pixbuf_fill(pbuf, 0x0F0F0F0F);
+
+        /* never use cached levels of a file we could not read */
+        g_free(cache->diskbase);
+        cache->diskbase = NULL;
+    }
+
+    cache->width = gdk_pixbuf_get_width(pbuf);
+    cache->height = gdk_pixbuf_get_height(pbuf);
+
+    return pbuf;
+}
+
+/** Try to load a level from the disk cache. */
+static GdkPixbuf *load_level_from_disk(map_cache_t * cache, guint level)
+{
+    GStatBuf        st;
+    GdkPixbuf      *pbuf;
+    gchar          *path;
+
+    if (cache->diskbase == NULL)
+        return NULL;
+
+    path = g_strdup_printf("%s-%u.png", cache->diskbase, level);
+    if (g_stat(path, &st) != 0 || (gint64) st.st_mtime < cache->mtime)
+    {
+        g_free(path);
+        return NULL;
+    }
+
+    pbuf = gdk_pixbuf_new_from_file(path, NULL);
+    if (pbuf != NULL &&
+        (gdk_pixbuf_get_width(pbuf) != level_size(cache->width, level) ||
+         gdk_pixbuf_get_height(pbuf) != level_size(cache->height, level)))
+    {
+        g_object_unref(pbuf);
+        pbuf = NULL;
+    }
+
+    if (pbuf != NULL)
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Loaded map level %u from %s"),
+                    __func__, level, path);
+    g_free(path);
+
+    return pbuf;
+}
+
+/*
+ * Write a level to the disk cache.
+ *
+ * The level is written to a temporary file that is renamed when complete,
+ * so that a partially written level is never loaded.
+ */
+static void save_level_worker(gpointer data, gpointer user_data)
+{
+    save_job_t     *job = data;
+    GError         *error = NULL;
+    gchar          *tmp;
+
+    (void)user_data;
+
+    tmp = g_strconcat(job->path, ".tmp", NULL);
+    if (!gdk_pixbuf_save(job->pbuf, tmp, "png", &error, NULL))
+    {
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Could not save map level to %s (%s)"),
+                    __func__, tmp, error->message);
+        g_clear_error(&error);
+        g_unlink(tmp);
+    }
+    else if (g_rename(tmp, job->path) != 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Could not rename %s"), __func__, tmp);
+        g_unlink(tmp);
+    }
+
+    g_free(tmp);
+    g_free(job->path);
+    g_object_unref(job->pbuf);
+    g_free(job);
+}
+
+/** Queue a level to be written to the disk cache in the background. */
+static void save_level_to_disk(map_cache_t * cache, guint level,
+                               GdkPixbuf * pbuf)
+{
+    save_job_t     *job;
+
+    if (cache->diskbase == NULL)
+        return;
+
+    if (save_pool == NULL)
+        save_pool = g_thread_pool_new(save_level_worker, NULL, 1, FALSE,
+                                      NULL);
+
+    job = g_new(save_job_t, 1);
+    job->path = g_strdup_printf("%s-%u.png", cache->diskbase, level);
+    job->pbuf = g_object_ref(pbuf);
+    g_thread_pool_push(save_pool, job, NULL);
+}
+
+/** Get a pyramid level, generating it from the level above if necessary. */
+static GdkPixbuf *get_level(map_cache_t * cache, guint level)
+{
+    GdkPixbuf      *pbuf;
+    GdkPixbuf      *parent;
+
+    if (level < cache->levels->len &&
+        g_ptr_array_index(cache->levels, level) != NULL)
+        return g_ptr_array_index(cache->levels, level);
+
+    if (level == 0)
+    {
+        pbuf = load_source(cache);
+    }
+    else if ((pbuf = load_level_from_disk(cache, level)) == NULL)
+    {
+        parent = get_level(cache, level - 1);
+        pbuf = gdk_pixbuf_scale_simple(parent,
+                                       level_size(cache->width, level),
+                                       level_size(cache->height, level),
+                                       GDK_INTERP_BILINEAR);
+        save_level_to_disk(cache, level, pbuf);
+    }
+
+    if (level >= cache->levels->len)
+        g_ptr_array_set_size(cache->levels, level + 1);
+    g_ptr_array_index(cache->levels, level) = pbuf;
+
+    return pbuf;
+}
+
+static void level_free(gpointer data)
+{
+    if (data != NULL)
+        g_object_unref(G_OBJECT(data));
+}
+
+static void cache_free(gpointer data)
+{
+    map_cache_t    *cache = data;
+
+    g_ptr_array_free(cache->levels, TRUE);
+    g_free(cache->diskbase);
+    g_free(cache->file);
+    g_free(cache);
+}
+
+/**
+ * Get the shared background pyramid of a map file.
+ *
+ * @param mapfile The map file name.
+ * @return The cache entry. Release it with map_cache_release().
+ *
+ * The image itself is not decoded until a scaled copy is requested.
+ */
+map_cache_t    *map_cache_get(const gchar * mapfile)
+{
+    map_cache_t    *cache;
+    GStatBuf        st;
+
+    if (caches == NULL)
+        caches = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+                                       cache_free);
+
+    cache = g_hash_table_lookup(caches, mapfile);
+    if (cache != NULL)
+    {
+        cache->refcount++;
+        return cache;
+    }
+
+    cache = g_new0(map_cache_t, 1);
+    cache->file = g_strdup(mapfile);
+    cache->refcount = 1;
+    cache->levels = g_ptr_array_new_with_free_func(level_free);
+
+    /* the disk cache needs the dimensions without decoding the image */
+    if (g_stat(mapfile, &st) == 0 &&
+        gdk_pixbuf_get_file_info(mapfile, &cache->width, &cache->height))
+    {
+        cache->mtime = (gint64) st.st_mtime;
+        cache->diskbase = disk_base(mapfile);
+    }
+    else
+    {
+        get_level(cache, 0);
+    }
+
+    g_hash_table_insert(caches, cache->file, cache);
+
+    return cache;
+}
+
+/**
+ * Release a map cache entry.
+ *
+ * @param cache The cache entry obtained from map_cache_get().
+ *
+ * The images are freed when the last user releases the entry.
+ */
+void map_cache_release(map_cache_t * cache)
+{
+    if (cache == NULL)
+        return;
+
+    if (--cache->refcount == 0)
+        g_hash_table_remove(caches, cache->file);
+}
+
+/** Get the width of the full resolution map image. */
+gint map_cache_get_width(map_cache_t * cache)
+{
+    return cache->width;
+}
+
+/** Get the height of the full resolution map image. */
+gint map_cache_get_height(map_cache_t * cache)
+{
+    return cache->height;
+}
+
+/**
+ * Get the map scaled to a given size.
+ *
+ * @param cache The cache entry.
+ * @param width The requested width.
+ * @param height The requested height.
+ * @return A new reference to the scaled map centred on 0 longitude.
+ *
+ * The map is scaled from the smallest pyramid level that is at least as
+ * large as the requested size.
+ */
+GdkPixbuf      *map_cache_scale(map_cache_t * cache, gint width, gint height)
+{
+    GdkPixbuf      *pbuf;
+    guint           level = 0;
+
+    width = MAX(1, width);
+    height = MAX(1, height);
+
+    while (level_size(cache->width, level + 1) >= MAX(width, MIN_LEVEL_SIZE)
+           && level_size(cache->height, level + 1) >= MAX(height,
+                                                          MIN_LEVEL_SIZE))
+        level++;
+
+    pbuf = get_level(cache, level);
+
+    if (gdk_pixbuf_get_width(pbuf) == width &&
+        gdk_pixbuf_get_height(pbuf) == height)
+        return g_object_ref(pbuf);
+
+    return gdk_pixbuf_scale_simple(pbuf, width, height, GDK_INTERP_BILINEAR);
+}
@@ -0,0 +1,36 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H 1
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib.h>
+
+
+/** Opaque, shared map background pyramid. */
+typedef struct _map_cache map_cache_t;
+
+
+map_cache_t    *map_cache_get(const gchar * mapfile);
+void            map_cache_release(map_cache_t * cache);
+gint            map_cache_get_width(map_cache_t * cache);
+gint            map_cache_get_height(map_cache_t * cache);
+GdkPixbuf      *map_cache_scale(map_cache_t * cache, gint width, gint height);
+
+#endif
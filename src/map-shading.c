@@ -0,0 +1,271 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Day/night shading of the map.
+ *
+ * Each map pixel is shaded according to the elevation of the sun seen from
+ * that location, in five steps: day, civil, nautical and astronomical
+ * twilight, and night. With the subsolar point at latitude d and longitude
+ * l0, the sine of the solar elevation at latitude f and longitude l is
+ *
+ *   sin(f) sin(d) + cos(f) cos(d) cos(l - l0)
+ *
+ * which is a + b * c with a and b depending only on the row and c only on
+ * the column. The trigonometric functions are therefore evaluated once per
+ * row and column, and each pixel takes a multiply-add and four compares
+ * that the compiler can vectorise.
+ *
+ * The shading is cached in an image surface that is recomputed only when
+ * the subsolar point has moved by a pixel, i.e. every minute or two.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <cairo.h>
+#include <glib.h>
+#include <math.h>
+
+#include "map-shading.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/* Sine of the solar elevation at the start of each twilight step: sunset
+   (-0.833 deg), civil (-6 deg), nautical (-12 deg) and astronomical
+   (-18 deg) twilight. */
+static const gdouble limits[4] = {
+    -0.0145380, -0.1045285, -0.2079117, -0.3090170
+};
+
+/* Fraction of the shadow colour used for each step */
+static const gdouble step_alpha[5] = { 0.0, 0.25, 0.5, 0.75, 1.0 };
+
+struct _map_shading {
+    cairo_surface_t *surface;   /*!< Cached shading, NULL until computed. */
+    gint            width;      /*!< Size of the surface. */
+    gint            height;
+    gdouble         left_lon;   /*!< Longitude of the left map edge. */
+    guint32         colour;     /*!< Shadow colour (RGBA). */
+    gdouble         sun_lat;    /*!< Subsolar point of the surface [deg]. */
+    gdouble         sun_lon;
+    gdouble        *col_cos;    /*!< cos(lon) of each column. */
+    gdouble        *col_sin;    /*!< sin(lon) of each column. */
+    gdouble        *col_c;      /*!< cos(lon - l0) of each column. */
+    gdouble        *row_sin;    /*!< sin(lat) of each row. */
+    gdouble        *row_cos;    /*!< cos(lat) of each row. */
+};
+
+
+map_shading_t  *map_shading_new(void)
+{
+    return g_new0(map_shading_t, 1);
+}
+
+static void free_tables(map_shading_t * shading)
+{
+    g_free(shading->col_cos);
+    g_free(shading->col_sin);
+    g_free(shading->col_c);
+    g_free(shading->row_sin);
+    g_free(shading->row_cos);
+    shading->col_cos = NULL;
+    shading->col_sin = NULL;
+    shading->col_c = NULL;
+    shading->row_sin = NULL;
+    shading->row_cos = NULL;
+}
+
+void map_shading_free(map_shading_t * shading)
+{
+    if (shading == NULL)
+        return;
+
+    if (shading->surface)
+        cairo_surface_destroy(shading->surface);
+    free_tables(shading);
+    g_free(shading);
+}
+
+/** Rebuild the surface and the per row and column tables for a new size. */
+static void resize(map_shading_t * shading, gint width, gint height,
+                   gdouble left_lon)
+{
+    gdouble         lon, lat;
+    gint            i, j;
+
+    if (shading->surface)
+        cairo_surface_destroy(shading->surface);
+    free_tables(shading);
+
+    shading->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                                  width, height);
+    shading->width = width;
+    shading->height = height;
+    shading->left_lon = left_lon;
+
+    shading->col_cos = g_new(gdouble, width);
+    shading->col_sin = g_new(gdouble, width);
+    shading->col_c = g_new(gdouble, width);
+    for (i = 0; i < width; i++)
+    {
+        lon = (left_lon + (i + 0.5) * 360.0 / width) * de2ra;
+        shading->col_cos[i] = cos(lon);
+        shading->col_sin[i] = sin(lon);
+    }
+
+    shading->row_sin = g_new(gdouble, height);
+    shading->row_cos = g_new(gdouble, height);
+    for (j = 0; j < height; j++)
+    {
+        lat = (90.0 - (j + 0.5) * 180.0 / height) * de2ra;
+        shading->row_sin[j] = sin(lat);
+        shading->row_cos[j] = cos(lat);
+    }
+}
+
+/** Shade every pixel of the surface for the given subsolar point. */
+static void render(map_shading_t * shading, gdouble sun_lat, gdouble sun_lon)
+{
+    guint32         lut[5];
+    guint32        *row;
+    guchar         *data;
+    gint            stride;
+    gdouble         sd, cd, sl, cl;
+    gdouble         a, b, s;
+    gdouble         r, g, bl, al;
+    const gdouble  *c = shading->col_c;
+    gint            level;
+    gint            i, j;
+
+    /* premultiplied ARGB value of each step */
+    r = ((shading->colour >> 24) & 0xFF) / 255.0;
+    g = ((shading->colour >> 16) & 0xFF) / 255.0;
+    bl = ((shading->colour >> 8) & 0xFF) / 255.0;
+    for (i = 0; i < 5; i++)
+    {
+        al = step_alpha[i] * (shading->colour & 0xFF) / 255.0;
+        lut[i] = ((guint32) (al * 255.0) << 24) |
+            ((guint32) (r * al * 255.0) << 16) |
+            ((guint32) (g * al * 255.0) << 8) | (guint32) (bl * al * 255.0);
+    }
+
+    sd = sin(sun_lat * de2ra);
+    cd = cos(sun_lat * de2ra);
+    sl = sin(sun_lon * de2ra);
+    cl = cos(sun_lon * de2ra);
+
+    /* cos(lon - l0) by the angle difference identity */
+    for (i = 0; i < shading->width; i++)
+        shading->col_c[i] = shading->col_cos[i] * cl +
+            shading->col_sin[i] * sl;
+
+    cairo_surface_flush(shading->surface);
+    data = cairo_image_surface_get_data(shading->surface);
+    stride = cairo_image_surface_get_stride(shading->surface);
+
+    for (j = 0; j < shading->height; j++)
+    {
+        row = (guint32 *) (data + j * stride);
+        a = shading->row_sin[j] * sd;
+        b = shading->row_cos[j] * cd;
+
+        /* rows entirely in day or night, e.g. near the poles */
+        if (a - fabs(b) > limits[0] || a + fabs(b) <= limits[3])
+        {
+            level = (a > limits[0]) ? 0 : 4;
+            for (i = 0; i < shading->width; i++)
+                row[i] = lut[level];
+            continue;
+        }
+
+        for (i = 0; i < shading->width; i++)
+        {
+            s = a + b * c[i];
+            level = (s <= limits[0]) + (s <= limits[1]) +
+                (s <= limits[2]) + (s <= limits[3]);
+            row[i] = lut[level];
+        }
+    }
+
+    cairo_surface_mark_dirty(shading->surface);
+    shading->sun_lat = sun_lat;
+    shading->sun_lon = sun_lon;
+}
+
+/**
+ * Update the day/night shading.
+ *
+ * @param shading The shading renderer.
+ * @param width The map width in pixels.
+ * @param height The map height in pixels.
+ * @param left_lon The longitude at the left edge of the map.
+ * @param t The time (Julian date).
+ * @param colour The shadow colour used for night (RGBA).
+ * @return TRUE if the surface has changed and needs to be redrawn.
+ *
+ * The shading is only recomputed when the map has changed or when the
+ * subsolar point has moved by at least one pixel since the last time.
+ */
+gboolean map_shading_update(map_shading_t * shading, gint width, gint height,
+                            gdouble left_lon, gdouble t, guint32 colour)
+{
+    vector_t        sun;
+    geodetic_t      geodetic;
+    gdouble         sun_lat, sun_lon;
+    gdouble         dlon;
+    gboolean        changed = FALSE;
+
+    if (width <= 0 || height <= 0)
+        return FALSE;
+
+    if (shading->surface == NULL || width != shading->width ||
+        height != shading->height || left_lon != shading->left_lon)
+    {
+        resize(shading, width, height, left_lon);
+        changed = TRUE;
+    }
+
+    if (colour != shading->colour)
+    {
+        shading->colour = colour;
+        changed = TRUE;
+    }
+
+    Calculate_Solar_Position(t, &sun);
+    Calculate_LatLonAlt(t, &sun, &geodetic);
+    sun_lat = geodetic.lat / de2ra;
+    sun_lon = geodetic.lon / de2ra;
+
+    dlon = fabs(remainder(sun_lon - shading->sun_lon, 360.0));
+    if (dlon * width / 360.0 >= 1.0 ||
+        fabs(sun_lat - shading->sun_lat) * height / 180.0 >= 1.0)
+        changed = TRUE;
+
+    if (changed)
+        render(shading, sun_lat, sun_lon);
+
+    return changed;
+}
+
+/** Get the shading surface covering the map, or NULL if not computed. */
+cairo_surface_t *map_shading_get_surface(map_shading_t * shading)
+{
+    return shading->surface;
+}
@@ -0,0 +1,37 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef MAP_SHADING_H
+#define MAP_SHADING_H 1
+
+#include <cairo.h>
+#include <glib.h>
+
+
+/** Opaque day/night shading renderer. */
+typedef struct _map_shading map_shading_t;
+
+
+map_shading_t  *map_shading_new(void);
+void            map_shading_free(map_shading_t * shading);
+gboolean        map_shading_update(map_shading_t * shading, gint width,
+                                   gint height, gdouble left_lon,
+                                   gdouble t, guint32 colour);
+cairo_surface_t *map_shading_get_surface(map_shading_t * shading);
+
+#endif
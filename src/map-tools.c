@@ -32,78 +32,85 @@
 #endif
 
 
-/*! \brief Rotate map to be centered around a specific longitude.
- *  \param in Input map centered around 0 degrees longitude.
- *  \param out Output map that will be centered around clon. Must have the same
- *             dimension and color space as the input map.
- *  \param clon The longitude that should be at center between -180 and 180 degrees (East positive).
- * 
- * This function will rotate the input map to be centered around the specified longitude.
- * The output map must be pre-allocated and have the sae width, height and colorspace as the input
- * map. The longitude parameter must be between -180 and 180 degrees with negative values meaning
- * West of Greenwich,positive values meaning East of Greenwich.
+/*! \brief Simplify a polyline in place.
+ *  \param points The polyline as x,y coordinate pairs.
+ *  \param n The number of points.
+ *  \param tol The largest allowed distance between a removed point and the
+ *             simplified polyline, in the same unit as the points.
+ *  \return The number of points kept.
+ *
+ * This function implements the Douglas-Peucker algorithm: a point is kept if
+ * it is further than tol away from the line between the neighbouring kept
+ * points. The first and the last points are always kept, and the kept points
+ * are moved to the beginning of the array in their original order.
  */
-void map_tools_shift_center(GdkPixbuf *in, GdkPixbuf *out, float clon)
+guint map_tools_simplify_polyline(gdouble *points, guint n, gdouble tol)
 {
-    if (clon > 180.0)
-        clon = 180.0;
-    else if (clon < -180.0)
-        clon = -180.0;
-
-    int lon_x = round((clon+180.0) * gdk_pixbuf_get_width(in)/360.0);
-    int img_w = gdk_pixbuf_get_width(in);
-    int img_h = gdk_pixbuf_get_height(in);
-    
-    if (clon < 0.0) {
-        /* copy left side to right */
-        gdk_pixbuf_copy_area(in,
-                             0,
-                             0,
-                             lon_x + img_w/2,
-                             img_h,
-                             out,
-                             img_w - (lon_x + img_w/2),
-                             0);
-        /* copy right side to left */
-        gdk_pixbuf_copy_area(in,
-                             lon_x + img_w/2,
-                             0,
-                             img_w - (lon_x + img_w/2),
-                             img_h,
-                             out,
-                             0,
-                             0);
+    GArray  *stack;
+    guint8  *keep;
+    guint    first, last, imax, i, m;
+    gdouble  dx, dy, ex, ey, len2, d2, dmax;
+
+    if (n < 3)
+        return n;
+
+    keep = g_new0(guint8, n);
+    keep[0] = 1;
+    keep[n - 1] = 1;
+
+    /* ranges still to be examined, as (first, last) pairs */
+    stack = g_array_new(FALSE, FALSE, sizeof(guint));
+    first = 0;
+    last = n - 1;
+    g_array_append_val(stack, first);
+    g_array_append_val(stack, last);
+
+    while (stack->len > 0) {
+        last = g_array_index(stack, guint, stack->len - 1);
+        first = g_array_index(stack, guint, stack->len - 2);
+        g_array_set_size(stack, stack->len - 2);
+
+        dx = points[2 * last] - points[2 * first];
+        dy = points[2 * last + 1] - points[2 * first + 1];
+        len2 = dx * dx + dy * dy;
+        dmax = 0.0;
+        imax = first;
+
+        for (i = first + 1; i < last; i++) {
+            ex = points[2 * i] - points[2 * first];
+            ey = points[2 * i + 1] - points[2 * first + 1];
+
+            /* squared distance to the line, or to the point if degenerate */
+            if (len2 > 0.0)
+                d2 = (dx * ey - dy * ex) * (dx * ey - dy * ex) / len2;
+            else
+                d2 = ex * ex + ey * ey;
+
+            if (d2 > dmax) {
+                dmax = d2;
+                imax = i;
+            }
+        }
+
+        if (dmax > tol * tol) {
+            keep[imax] = 1;
+            g_array_append_val(stack, first);
+            g_array_append_val(stack, imax);
+            g_array_append_val(stack, imax);
+            g_array_append_val(stack, last);
+        }
     }
-    else if (clon > 0.0) {
-        /* copy left side to right */
-        gdk_pixbuf_copy_area(in,
-                             0,
-                             0,
-                             lon_x - img_w/2,
-                             img_h,
-                             out,
-                             img_w - (lon_x - img_w/2),
-                             0);
-        /* copy right side to left */
-        gdk_pixbuf_copy_area(in,
-                             lon_x - img_w/2,
-                             0,
-                             img_w - (lon_x - img_w/2),
-                             img_h,
-                             out,
-                             0,
-                             0);
+
+    for (i = 0, m = 0; i < n; i++) {
+        if (keep[i]) {
+            points[2 * m] = points[2 * i];
+            points[2 * m + 1] = points[2 * i + 1];
+            m++;
+        }
     }
-    else {
-        /* no shifting of center */
-        gdk_pixbuf_copy_area(in,
-                             0,
-                             0,
-                             img_w,
-                             img_h,
-                             out,
-                             0,
-                             0);
-    }   
-}
 
+    g_array_free(stack, TRUE);
+    g_free(keep);
+
+    return m;
+}
@@ -31,4 +31,4 @@
 #endif
 
 
-void map_tools_shift_center(GdkPixbuf *in, GdkPixbuf *out, float clon);
+guint map_tools_simplify_polyline(gdouble *points, guint n, gdouble tol);
@@ -569,6 +569,7 @@ static void menubar_tle_net_cb(GtkWidget * widget, gpointer data)
     GtkWidget      *progress;
     GtkWidget      *label1, *label2;
     GtkWidget      *box;
+    GArray         *changes;
 
     (void)widget;
     (void)data;
@@ -624,7 +625,8 @@ static void menubar_tle_net_cb(GtkWidget * widget, gpointer data)
     while (g_main_context_iteration(NULL, FALSE));
 
     /* update TLE */
-    tle_update_from_network(FALSE, progress, label1, label2);
+    changes = g_array_new(FALSE, FALSE, sizeof(tle_change_t));
+    tle_update_from_network(FALSE, progress, label1, label2, changes);
 
     /* set progress bar to 100% */
     gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress), 1.0);
@@ -635,8 +637,9 @@ static void menubar_tle_net_cb(GtkWidget * widget, gpointer data)
     gtk_dialog_set_response_sensitive(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT,
                                       TRUE);
 
-    /* reload satellites */
-    mod_mgr_reload_sats();
+    /* reload the satellites that have been updated */
+    mod_mgr_apply_tle_changes(changes);
+    g_array_free(changes, TRUE);
 }
 
 /* Update TLE from local files */
@@ -651,6 +654,7 @@ static void menubar_tle_local_cb(GtkWidget * widget, gpointer data)
     GtkWidget      *box;
     gint            response;   /* dialog response */
     gboolean        doupdate = FALSE;
+    GArray         *changes;    /* satellites updated by the TLE update */
 
     (void)widget;
     (void)data;
@@ -765,7 +769,9 @@ static void menubar_tle_local_cb(GtkWidget * widget, gpointer data)
         while (g_main_context_iteration(NULL, FALSE));
 
         /* update TLE */
-        tle_update_from_files(dir, NULL, FALSE, progress, label1, label2);
+        changes = g_array_new(FALSE, FALSE, sizeof(tle_change_t));
+        tle_update_from_files(dir, NULL, FALSE, progress, label1, label2,
+                              changes);
 
         /* set progress bar to 100% */
         gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress), 1.0);
@@ -775,13 +781,14 @@ static void menubar_tle_local_cb(GtkWidget * widget, gpointer data)
         /* enable close button */
         gtk_dialog_set_response_sensitive(GTK_DIALOG(dialog),
                                           GTK_RESPONSE_ACCEPT, TRUE);
+
+        /* reload the satellites that have been updated */
+        mod_mgr_apply_tle_changes(changes);
+        g_array_free(changes, TRUE);
     }
 
     if (dir)
         g_free(dir);
-
-    /* reload satellites */
-    mod_mgr_reload_sats();
 }
 
 static void menubar_help_cb(GtkWidget * widget, gpointer data)
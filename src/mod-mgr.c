@@ -88,7 +88,8 @@ GtkWidget      *mod_mgr_create(void)
     gchar         **mods;
     gint            count, i;
     GtkWidget      *module;
-    gchar          *modfile;
+    GPtrArray      *modules;
+    gchar         **modfiles;
     gchar          *confdir;
     gint            page;
 
@@ -106,14 +107,21 @@ GtkWidget      *mod_mgr_create(void)
         mods = g_strsplit(openmods, ";", 0);
         count = g_strv_length(mods);
 
+        /* restore all modules at once so that their satellites are
+           loaded concurrently */
+        modfiles = g_new0(gchar *, count + 1);
+        confdir = get_modules_dir();
         for (i = 0; i < count; i++)
-        {
+            modfiles[i] = g_strconcat(confdir, G_DIR_SEPARATOR_S,
+                                      mods[i], ".mod", NULL);
+        g_free(confdir);
 
-            confdir = get_modules_dir();
-            modfile = g_strconcat(confdir, G_DIR_SEPARATOR_S,
-                                  mods[i], ".mod", NULL);
-            g_free(confdir);
-            module = gtk_sat_module_new(modfile);
+        modules = gtk_sat_module_new_all(modfiles);
+        g_strfreev(modfiles);
+
+        for (i = 0; i < count; i++)
+        {
+            module = g_ptr_array_index(modules, i);
 
             if (IS_GTK_SAT_MODULE(module))
             {
@@ -139,10 +147,8 @@ GtkWidget      *mod_mgr_create(void)
                 /* try to smartly handle disappearing modules */
                 page--;
             }
-
-            g_free(modfile);
-
         }
+        g_ptr_array_free(modules, TRUE);
 
         /* set to the page open when gpredict was closed */
         if (page >= 0)
@@ -597,6 +603,43 @@ void mod_mgr_reload_sats()
     }
 }
 
+/**
+ * Apply TLE changes to all open modules.
+ *
+ * @param changes GArray of tle_change_t produced by the TLE updater.
+ *
+ * Only the satellites listed in changes are reloaded; modules that do not
+ * track any of them are left untouched.
+ */
+void mod_mgr_apply_tle_changes(GArray * changes)
+{
+    guint           num;
+    guint           i;
+    GtkSatModule   *mod;
+
+    if (!nbook)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Attempt to reload sats but mod-mgr is NULL?"),
+                    __func__);
+        return;
+    }
+
+    if (changes == NULL || changes->len == 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: No satellites have been updated."), __func__);
+        return;
+    }
+
+    num = g_slist_length(modules);
+    for (i = 0; i < num; i++)
+    {
+        mod = GTK_SAT_MODULE(g_slist_nth_data(modules, i));
+        gtk_sat_module_apply_tle_changes(mod, changes);
+    }
+}
+
 static void create_module_window(GtkWidget * module)
 {
     gint            w, h;
@@ -22,15 +22,12 @@
 #include <build-config.h>
 #endif
 
-#ifdef HAS_LIBGPS
-#include <gps.h>
-#endif
-
 #include <glib.h>
 #include <glib/gi18n.h>
 
 #include "config-keys.h"
 #include "gpredict-utils.h"
+#include "gpsd-reader.h"
 #include "locator.h"
 #include "orbit-tools.h"
 #include "qth-data.h"
@@ -373,265 +370,31 @@ void qth_data_free(qth_t * qth)
  * Update the qth data by whatever method is appropriate.
  *
  * \param qth the qth data structure to update
- * \param qth the time at which the qth is to be computed. this may be ignored by gps updates.
+ * \param t the time at which the qth is to be computed. this may be ignored by gps updates.
+ *
+ * The gpsd position is taken from the latest fix of the gpsd reader, so this
+ * never waits for gpsd.
  */
 gboolean qth_data_update(qth_t * qth, gdouble t)
 {
-#ifndef HAS_LIBGPS
-    (void)qth;
-    (void)t;
-    return FALSE;
-#else
-    gboolean        retval = FALSE;
-    guint           num_loops = 0;
+    gpsd_fix_t      fix;
 
-    if (qth->type != QTH_GPSD_TYPE)
+    if (qth->type != QTH_GPSD_TYPE || qth->gpsd == NULL)
         return FALSE;
 
-    if (((t - qth->gpsd_update) > 30.0 / 86400.0) &&
-        (t - qth->gpsd_connected > 30.0 / 86400.0))
-    {
-        /* if needed restart the gpsd interface */
-        qth_data_update_stop(qth);
-        qth_data_update_init(qth);
-        qth->gpsd_connected = t;
-    }
+    gpsd_reader_get_fix(qth->gpsd, &fix);
+    if (fix.count == qth->gpsd_fixes)
+        return FALSE;
 
-    if (qth->gps_data != NULL)
-    {
-        switch (GPSD_API_MAJOR_VERSION)
-        {
-        case 4:
-#if GPSD_API_MAJOR_VERSION==4
-            while (gps_waiting(qth->gps_data) == TRUE)
-            {
-                /* this is a watchdog in case there is a problem with the gpsd code. */
-                /* if the server was up and has failed then gps_waiting in 2.92 confirmed */
-                /* will return 1 (supposedly fixed in later versions.) */
-                /* if we do not do this as a while loop, the gpsd packets can backup  */
-                /*   and no longer be in sync with the gps receiver */
-                num_loops++;
-                if (num_loops > 1000)
-                {
-                    retval = FALSE;
-                    break;
-                }
-                if (gps_poll(qth->gps_data) == 0)
-                {
-                    /* handling packet_set inline with 
-                       http://gpsd.berlios.de/client-howto.html
-                     */
-                    if (qth->gps_data->set & PACKET_SET)
-                    {
-                        if (qth->gps_data->fix.mode >= MODE_2D)
-                        {
-                            if (qth->lat != qth->gps_data->fix.latitude)
-                            {
-                                qth->lat = qth->gps_data->fix.latitude;
-                                retval = TRUE;
-                            }
-                            if (qth->lon != qth->gps_data->fix.longitude)
-                            {
-                                qth->lon = qth->gps_data->fix.longitude;
-                                retval = TRUE;
-                            }
-                        }
-
-                        if (qth->gps_data->fix.mode == MODE_3D)
-                        {
-                            if (qth->alt != qth->gps_data->fix.altitude)
-                            {
-                                qth->alt = qth->gps_data->fix.altitude;
-                                retval = TRUE;
-                            }
-                        }
-                        else
-                        {
-                            if (qth->alt != 0)
-                            {
-                                qth->alt = 0;
-                                retval = TRUE;
-                            }
-                        }
-                    }
-                }
-            }
-#endif
-            break;
-        case 5:
-#if GPSD_API_MAJOR_VERSION==5
-            while (gps_waiting(qth->gps_data, 0) == 1)
-            {
-                /* see comment from above */
-                /* hopefully not needed but does not hurt anything. */
-                num_loops++;
-                if (num_loops > 1000)
-                {
-                    retval = FALSE;
-                    break;
-                }
-                if (gps_read(qth->gps_data) == 0)
-                {
-                    /* handling packet_set inline with
-                       http://gpsd.berlios.de/client-howto.html
-                     */
-                    if (qth->gps_data->set & PACKET_SET)
-                    {
-                        if (qth->gps_data->fix.mode >= MODE_2D)
-                        {
-                            if (qth->lat != qth->gps_data->fix.latitude)
-                            {
-                                qth->lat = qth->gps_data->fix.latitude;
-                                retval = TRUE;
-                            }
-                            if (qth->lon != qth->gps_data->fix.longitude)
-                            {
-                                qth->lon = qth->gps_data->fix.longitude;
-                                retval = TRUE;
-                            }
-                        }
-
-                        if (qth->gps_data->fix.mode == MODE_3D)
-                        {
-                            if (qth->alt != qth->gps_data->fix.altitude)
-                            {
-                                qth->alt = qth->gps_data->fix.altitude;
-                                retval = TRUE;
-                            }
-                        }
-                        else
-                        {
-                            if (qth->alt != 0)
-                            {
-                                qth->alt = 0;
-                                retval = TRUE;
-                            }
-                        }
-                    }
-                }
-            }
-#endif
-            break;
-
-	case 6:		/* for libgps 3.17 */
-#if GPSD_API_MAJOR_VERSION==6
-            while (gps_waiting(qth->gps_data, 0) == 1)
-            {
-                /* see comment from above */
-                /* hopefully not needed but does not hurt anything. */
-                num_loops++;
-                if (num_loops > 1000)
-                {
-                    retval = FALSE;
-                    break;
-                }
-                if (gps_read(qth->gps_data) > 0)
-                {
-                    /* handling packet_set inline with 
-                       http://gpsd.berlios.de/client-howto.html
-                     */
-                    if (qth->gps_data->set & PACKET_SET)
-                    {
-                        if (qth->gps_data->fix.mode >= MODE_2D)
-                        {
-                            if (qth->lat != qth->gps_data->fix.latitude)
-                            {
-                                qth->lat = qth->gps_data->fix.latitude;
-                                retval = TRUE;
-                            }
-                            if (qth->lon != qth->gps_data->fix.longitude)
-                            {
-                                qth->lon = qth->gps_data->fix.longitude;
-                                retval = TRUE;
-                            }
-                        }
-
-                        if (qth->gps_data->fix.mode == MODE_3D)
-                        {
-                            if (qth->alt != qth->gps_data->fix.altitude)
-                            {
-                                qth->alt = qth->gps_data->fix.altitude;
-                                retval = TRUE;
-                            }
-                        }
-                        else
-                        {
-                            if (qth->alt != 0)
-                            {
-                                qth->alt = 0;
-                                retval = TRUE;
-                            }
-                        }
-                    }
-                }
-            }
-#endif
-            break;
-	case 11:
-	case 12:
-	case 13:
-	case 14:
-#if GPSD_API_MAJOR_VERSION>=11          /* for libgps 3.22 or later */
-            while (gps_waiting(qth->gps_data, 0) == 1)
-            {
-                /* see comment from above */
-                /* hopefully not needed but does not hurt anything. */
-                num_loops++;
-                if (num_loops > 1000)
-                {
-                    retval = FALSE;
-                    break;
-                }
-                if (gps_read(qth->gps_data, NULL, 0) > 0)
-                {
-                    /* handling packet_set inline with
-                       http://gpsd.berlios.de/client-howto.html
-                     */
-                    if (qth->gps_data->set & PACKET_SET)
-                    {
-                        if (qth->gps_data->fix.mode >= MODE_2D)
-                        {
-                            if (qth->lat != qth->gps_data->fix.latitude)
-                            {
-                                qth->lat = qth->gps_data->fix.latitude;
-                                retval = TRUE;
-                            }
-                            if (qth->lon != qth->gps_data->fix.longitude)
-                            {
-                                qth->lon = qth->gps_data->fix.longitude;
-                                retval = TRUE;
-                            }
-                        }
-
-                        if (qth->gps_data->fix.mode == MODE_3D)
-                        {
-                            if (qth->alt != qth->gps_data->fix.altitude)
-                            {
-                                qth->alt = qth->gps_data->fix.altitude;
-                                retval = TRUE;
-                            }
-                        }
-                        else
-                        {
-                            if (qth->alt != 0)
-                            {
-                                qth->alt = 0;
-                                retval = TRUE;
-                            }
-                        }
-                    }
-                }
-            }
-#endif
-            break;
-        default:
-            break;
-        }
-        if (retval == TRUE)
-        {
-            qth->gpsd_update = t;
-        }
-    }
+    qth->gpsd_fixes = fix.count;
+    qth->gpsd_update = t;
+
+    if (qth->lat == fix.lat && qth->lon == fix.lon && qth->alt == fix.alt)
+        return FALSE;
+
+    qth->lat = fix.lat;
+    qth->lon = fix.lon;
+    qth->alt = fix.alt;
 
     qth_validate(qth);
     if (longlat2locator(qth->lon, qth->lat, qth->qra, 2) != RIG_OK)
@@ -641,8 +404,7 @@ gboolean qth_data_update(qth_t * qth, gdouble t)
                     __func__, qth->name, qth->lon, qth->lat);
     }
 
-    return retval;
-#endif  // HAS_LIBGPS
+    return TRUE;
 }
 
 /**
@@ -650,134 +412,18 @@ gboolean qth_data_update(qth_t * qth, gdouble t)
  *
  * \param qth the qth data structure to update
  * 
- * Initial intention of this is to open sockets and ports to gpsd 
- * and other like services to update the qth position.
+ * This starts the gpsd reader, which connects to gpsd in its own thread and
+ * keeps reconnecting as needed.
  */
 gboolean qth_data_update_init(qth_t * qth)
 {
-#ifdef HAS_LIBGPS
-    char           *port;
-#endif
-    gboolean        retval = FALSE;
-
-
     if (qth->type != QTH_GPSD_TYPE)
         return FALSE;
 
-    /** FIXME: refactor */
-
-#ifdef HAS_LIBGPS
-    switch (GPSD_API_MAJOR_VERSION)
-    {
-    case 4:
-#if GPSD_API_MAJOR_VERSION==4
-        /* open the connection to gpsd and start the stream */
-        qth->gps_data = g_try_new0(struct gps_data_t, 1);
-
-        port = g_strdup_printf("%d", qth->gpsd_port);
-        if (gps_open_r(qth->gpsd_server, port, qth->gps_data) == -1)
-        {
-            free(qth->gps_data);
-            qth->gps_data = NULL;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Could not open gpsd at  %s:%d"),
-                        __func__, qth->gpsd_server, qth->gpsd_port);
-            retval = FALSE;
-        }
-        else
-        {
-            (void)gps_stream(qth->gps_data, WATCH_ENABLE, NULL);
-            retval = TRUE;
-        }
-        g_free(port);
-#endif
-        break;
-    case 5:
-#if GPSD_API_MAJOR_VERSION==5
-        /* open the connection to gpsd and start the stream */
-        qth->gps_data = g_try_new0(struct gps_data_t, 1);
-
-        port = g_strdup_printf("%d", qth->gpsd_port);
-        if (gps_open(qth->gpsd_server, port, qth->gps_data) == -1)
-        {
-            free(qth->gps_data);
-            qth->gps_data = NULL;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Could not open gpsd at  %s:%d"),
-                        __func__, qth->gpsd_server, qth->gpsd_port);
-            retval = FALSE;
-        }
-        else
-        {
-            (void)gps_stream(qth->gps_data, WATCH_ENABLE, NULL);
-            retval = TRUE;
-        }
-        g_free(port);
-#endif
-        break;
-    case 6:	/* for libgps 3.17 */
-#if GPSD_API_MAJOR_VERSION==6
-        /* open the connection to gpsd and start the stream */
-        qth->gps_data = g_try_new0(struct gps_data_t, 1);
-
-        port = g_strdup_printf("%d", qth->gpsd_port);
-        if (gps_open(qth->gpsd_server, port, qth->gps_data) == -1)
-        {
-            free(qth->gps_data);
-            qth->gps_data = NULL;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Could not open gpsd at  %s:%d"),
-                        __func__, qth->gpsd_server, qth->gpsd_port);
-            retval = FALSE;
-        }
-        else
-        {
-            (void)gps_stream(qth->gps_data, WATCH_ENABLE, NULL);
-            retval = TRUE;
-        }
-        g_free(port);
-#endif
-        break;
-	case 11:
-	case 12:
-	case 13:
-	case 14:
-#if GPSD_API_MAJOR_VERSION>=11  /* for libgps 3.22 or later */
-        /* open the connection to gpsd and start the stream */
-        qth->gps_data = g_try_new0(struct gps_data_t, 1);
-
-        port = g_strdup_printf("%d", qth->gpsd_port);
-        if (gps_open(qth->gpsd_server, port, qth->gps_data) == -1)
-        {
-            free(qth->gps_data);
-            qth->gps_data = NULL;
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: Could not open gpsd at  %s:%d"),
-                        __func__, qth->gpsd_server, qth->gpsd_port);
-            retval = FALSE;
-        }
-        else
-        {
-            (void)gps_stream(qth->gps_data, WATCH_ENABLE, NULL);
-            retval = TRUE;
-        }
-        g_free(port);
-#endif
-	break;
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Unsupported gpsd api major version (%d)"),
-                    __func__, GPSD_API_MAJOR_VERSION);
-
-
-        return FALSE;
-        break;
-    }
-#else
-    return FALSE;
-#endif
+    if (qth->gpsd == NULL)
+        qth->gpsd = gpsd_reader_new(qth->gpsd_server, qth->gpsd_port);
 
-    return retval;
+    return qth->gpsd != NULL;
 }
 
 /**
@@ -785,49 +431,14 @@ gboolean qth_data_update_init(qth_t * qth)
  *
  * \param qth the qth data structure to update
  * 
- * Initial intention of this is to open sockets and ports to gpsd 
- * and other like services to update the qth position.
+ * This stops the gpsd reader without waiting for it; the reader thread
+ * closes its connection to gpsd when it exits.
  */
 void qth_data_update_stop(qth_t * qth)
 {
-    if (qth->type != QTH_GPSD_TYPE)
-        return;
-
-    /* close gpsd socket */
-    if (qth->gps_data != NULL)
-    {
-#ifdef HAS_LIBGPS
-        switch (GPSD_API_MAJOR_VERSION)
-        {
-        case 4:
-#if GPSD_API_MAJOR_VERSION==4
-	    gps_close(qth->gps_data);
-#endif
-	    break;
-        case 5:
-#if GPSD_API_MAJOR_VERSION==5
-	    gps_close(qth->gps_data);
-#endif
-	    break;
-	case 6:		/* for libgps 3.17 */
-#if GPSD_API_MAJOR_VERSION==6
-            gps_close(qth->gps_data);
-#endif
-            break;
-	case 11:	/* for libgps 3.22 or later */
-	case 12:
-	case 13:
-	case 14:
-#if GPSD_API_MAJOR_VERSION==11
-	   gps_close(qth->gps_data);
-#endif
-	   break;
-        default:
-            break;
-        }
-#endif
-        qth->gps_data = NULL;
-    }
+    gpsd_reader_free(qth->gpsd);
+    qth->gpsd = NULL;
+    qth->gpsd_fixes = 0;
 }
 
 /**
@@ -841,13 +452,13 @@ void qth_init(qth_t * qth)
     qth->lon = 0;
     qth->alt = 0;
     qth->type = QTH_STATIC_TYPE;
-    qth->gps_data = NULL;
+    qth->gpsd = NULL;
     qth->name = NULL;
     qth->loc = NULL;
     qth->gpsd_port = 0;
     qth->gpsd_server = NULL;
     qth->gpsd_update = 0.0;
-    qth->gpsd_connected = 0.0;
+    qth->gpsd_fixes = 0;
     qth->qra = g_strdup("AA00");
 }
 
@@ -868,7 +479,7 @@ void qth_safe(qth_t * qth)
     qth->lat = 0;
     qth->lon = 0;
     qth->alt = 0;
-    qth->gps_data = NULL;
+    qth->gpsd = NULL;
 }
 
 /**
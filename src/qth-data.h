@@ -2,6 +2,7 @@
 #define __QTH_DATA_H__ 1
 
 #include <glib.h>
+#include "gpsd-reader.h"
 #include "sgpsdp/sgp4sdp4.h"
 
 /** QTH data structure in human readable form. */
@@ -18,8 +19,8 @@ typedef struct {
     gchar          *gpsd_server;        /*!< GPSD Server name. */
     gint            gpsd_port;  /*!< GPSD Server port. */
     gdouble         gpsd_update;        /*!< Time last GPSD update was received. */
-    gdouble         gpsd_connected;     /*!< Time last GPSD update was last attempted to connect. */
-    struct gps_data_t *gps_data;        /*!< gpsd data structure. */
+    gpsd_reader_t  *gpsd;       /*!< Reader of the gpsd position. */
+    guint           gpsd_fixes; /*!< Fix count of the last fix taken. */
     GKeyFile       *data;       /*!< Raw data from cfg file. */
 } qth_t;
 
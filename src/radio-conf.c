@@ -45,8 +45,7 @@
 #define KEY_VFO_UP      "VFO_UP"
 #define KEY_SIG_AOS     "SIGNAL_AOS"
 #define KEY_SIG_LOS     "SIGNAL_LOS"
-
-#define DEFAULT_CYCLE_MS    1000
+#define KEY_TOLERANCE   "Tolerance"
 
 /**
  * \brief Read radio configuration.
@@ -137,6 +136,23 @@ gboolean radio_conf_read(radio_conf_t * conf)
         conf->cycle = DEFAULT_CYCLE_MS;
     }
 
+    /* Doppler tolerance is optional; an invalid value turns it off */
+    conf->tolerance = 0.0;
+    if (g_key_file_has_key(cfg, GROUP, KEY_TOLERANCE, NULL))
+    {
+        conf->tolerance = g_key_file_get_double(cfg, GROUP, KEY_TOLERANCE,
+                                                &error);
+        if (error != NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Error reading radio conf from %s (%s)."),
+                        __func__, conf->name, error->message);
+            g_clear_error(&error);
+            conf->tolerance = 0.0;
+        }
+        conf->tolerance = MAX(conf->tolerance, 0.0);
+    }
+
     /* KEY_LO is optional */
     if (g_key_file_has_key(cfg, GROUP, KEY_LO, NULL))
     {
@@ -280,6 +296,11 @@ void radio_conf_save(radio_conf_t * conf)
     else
         g_key_file_set_integer(cfg, GROUP, KEY_CYCLE, conf->cycle);
 
+    if (conf->tolerance > 0.0)
+        g_key_file_set_double(cfg, GROUP, KEY_TOLERANCE, conf->tolerance);
+    else
+        g_key_file_remove_key(cfg, GROUP, KEY_TOLERANCE, NULL);
+
     if (conf->type == RIG_TYPE_DUPLEX)
     {
         g_key_file_set_integer(cfg, GROUP, KEY_VFO_UP, conf->vfoUp);
@@ -32,6 +32,8 @@
 #include <glib.h>
 
 
+#define DEFAULT_CYCLE_MS    1000 /*!< Default cycle period in msec */
+
 /** \brief Radio types. */
 typedef enum {
     RIG_TYPE_RX = 0,            /*!< Rig can only be used as receiver */
@@ -62,6 +64,8 @@ typedef struct {
     gchar          *host;       /*!< hostname or IP */
     gint            port;       /*!< port number */
     gint            cycle;      /*!< cycle period in msec */
+    gdouble         tolerance;  /*!< Doppler tuning error allowed in Hz;
+                                   0 sends every change of 1 Hz. */
     gdouble         lo;         /*!< local oscillator freq in Hz (using double for
                                    compatibility with rest of code). Downlink. */
     gdouble         loup;       /*!< local oscillator freq in Hz for uplink. */
@@ -0,0 +1,2078 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+  Copyright (C)       2017  Patrick Dohmen, DL4PD
+  Copyright (C)       2018  Mario Haustein, DM5AHA
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Radio controller.
+ *
+ * The Doppler and transponder tracking of one radio or a group of radios,
+ * without any user interface. The controller runs in its own thread at the configured
+ * cycle period. The user interface passes the satellite frequencies and the
+ * Doppler shift in a radio_ctrl_input_t and shows the radio_ctrl_output_t
+ * of the controller, which it is notified about from an idle callback.
+ *
+ * The satellite frequencies are owned by the controller once it runs: they
+ * change when the user turns the dial of the radio, and the input only
+ * replaces them when the user has changed them in the user interface, as
+ * indicated by satfreq_seq.
+ *
+ * Without a Doppler tolerance, a new frequency is sent in every cycle in
+ * which it changed by 1 Hz or more. With a tolerance, a Doppler change is
+ * only sent once the frequency on the radio is off by the tolerance. The
+ * time until that happens is estimated from the rate of the Doppler shift,
+ * and the next cycle is scheduled for then: far from TCA the radio is left
+ * alone for up to MAX_IDLE_CYCLE, while near TCA the commands are never
+ * sent more often than the cycle period. The number of frequency commands
+ * and the largest tuning error are reported in the output.
+ *
+ * With a Doppler table of the pass, the controller does not depend on the
+ * updates of the user interface for the Doppler shift: each cycle looks up
+ * the range rate for the time the frequencies will be applied, using the
+ * satellite time of the input, and computes the shift from the satellite
+ * frequencies in use. Outside of the table the shift of the input is
+ * brought forward as before.
+ *
+ * A group of radios, e.g. separate receivers and transmitters, is tuned
+ * together. The role of each radio follows from its type: receivers tune
+ * the downlink and transmitters the uplink, while the other types cover
+ * whichever of the two no dedicated radio does. The commands of a cycle go
+ * out to all radios at once and the replies are collected as they arrive,
+ * so a cycle takes one round trip of the slowest radio however many radios
+ * there are.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <string.h>
+
+#include "radio-ctrl.h"
+#include "rigctld-client.h"
+#include "sat-log.h"
+
+
+#define MAX_ERROR_COUNT 5
+#define MAX_IDLE_CYCLE 1000     /* longest cycle while within the tolerance [msec] */
+#define RADIO_MAX_CMDS 4        /* commands per radio and transaction */
+
+#define ROLE_DOWN 1
+#define ROLE_UP   2
+
+/** A radio of the controller. */
+typedef struct {
+    radio_conf_t   *conf;       /*!< Radio configuration (own copy). */
+    rigctld_t      *rig;        /*!< Connection to the radio. */
+    guint           role;       /*!< ROLE_DOWN and/or ROLE_UP. */
+    gboolean        ptt;        /*!< PTT state of the current cycle. */
+    gboolean        lastptt;    /*!< PTT state of the previous cycle. */
+    gdouble         lastrxf;    /*!< Last downlink frequency sent. */
+    gdouble         lasttxf;    /*!< Last uplink frequency sent. */
+    gdouble         rxf, txf;   /*!< Frequencies being set. */
+    rigctld_cmd_t   cmds[RADIO_MAX_CMDS];
+    gint            ptt_cmd, down_cmd, up_cmd;  /*!< Index of the reads in
+                                                   cmds, -1 if not sent. */
+} radio_t;
+
+struct _radio_ctrl {
+    radio_t        *radios;     /*!< The radios; the first one is the primary. */
+    guint           nradios;
+    rigctld_batch_t *batches;   /*!< One transaction per radio. */
+    radio_conf_t   *conf;       /*!< Configuration of the primary radio. */
+    rigctld_t      *rig;        /*!< Connection to the primary radio. */
+
+    GThread        *thread;     /*!< Controller thread. */
+    GMutex          lock;       /*!< Protects the fields up to notify. */
+    GCond           cond;       /*!< Signalled to wake up the thread. */
+    gboolean        running;    /*!< Cleared to stop the thread. */
+    gboolean        ptt_event;  /*!< A PTT event is pending. */
+    guint           cycle;      /*!< Cycle period [msec]. */
+    gdouble         tolerance;  /*!< Doppler tuning error allowed [Hz]. */
+    radio_ctrl_input_t in;      /*!< Latest input. */
+    radio_ctrl_output_t out;    /*!< Output of the last cycle. */
+    doppler_table_t *table_in;  /*!< New Doppler table for the thread. */
+    gboolean        table_changed;      /*!< table_in is to be taken. */
+    guint           idle_id;    /*!< Pending notification. */
+
+    radio_ctrl_notify_t notify;
+    gpointer        data;
+
+    /* state of the controller; only used by the thread */
+    radio_ctrl_input_t cur;     /*!< Input of the current cycle. */
+    gdouble         satfreq_down, satfreq_up;
+    gdouble         rigfreq_down, rigfreq_up;
+    gboolean        dial_changed;
+    guint           satfreq_seq;
+    guint           resync_down, resync_up;
+    gint            catnum;
+    gdouble         prev_ele;   /*!< Previous elevation (used for AOS/LOS signalling) */
+    gboolean        engaged;    /*!< Cleared when too many errors occurred. */
+    gint            errcnt;     /*!< Error counter. */
+    gboolean        lastrxptt;  /*!< PTT state of last rx cycle. */
+    gboolean        lasttxptt;  /*!< PTT state of last tx cycle. */
+    gdouble         lastrxf;    /*!< Last frequency sent to receiver. */
+    gdouble         lasttxf;    /*!< Last frequency sent to tranmitter. */
+    gint64          last_toggle_tx;     /*!< Last time when exec_toggle_tx_cycle() was executed (seconds)
+                                           -1 indicates that an update should be performed ASAP */
+    gint64          latency;    /*!< Smoothed command-to-apply latency [usec] */
+    guint           wrops;
+    gdouble         cur_tolerance;      /*!< Tolerance of the current cycle. */
+    gint64          tune_due;   /*!< When the tuning error reaches the tolerance. */
+    gint64          started;    /*!< When the controller started [usec]. */
+    guint           tunes;      /*!< Frequency commands sent while tracking. */
+    gdouble         tune_error; /*!< Largest tuning error while tracking [Hz]. */
+    doppler_table_t *table;     /*!< Doppler table of the pass or NULL. */
+    guint           table_cycles;       /*!< Cycles that used the table. */
+};
+
+static void     exec_rx_cycle(radio_ctrl_t * rc);
+static void     exec_tx_cycle(radio_ctrl_t * rc);
+static void     exec_trx_cycle(radio_ctrl_t * rc);
+static void     exec_toggle_cycle(radio_ctrl_t * rc);
+static void     exec_toggle_tx_cycle(radio_ctrl_t * rc);
+static void     exec_duplex_cycle(radio_ctrl_t * rc);
+static void     exec_duplex_tx_cycle(radio_ctrl_t * rc);
+static void     exec_group_cycle(radio_ctrl_t * rc);
+static gboolean set_freq_toggle(radio_ctrl_t * rc, rigctld_t * rig,
+                                gdouble freq);
+static gboolean set_toggle(radio_ctrl_t * rc, const radio_conf_t * conf,
+                           rigctld_t * rig);
+static gboolean unset_toggle(radio_ctrl_t * rc, const radio_conf_t * conf,
+                             rigctld_t * rig);
+static gboolean get_freq_toggle(radio_ctrl_t * rc, rigctld_t * rig,
+                                gdouble * freq);
+static gboolean get_ptt(radio_ctrl_t * rc, rigctld_t * rig);
+static gboolean set_ptt(radio_ctrl_t * rc, rigctld_t * rig, gboolean ptt);
+static gboolean get_ptt_freq(radio_ctrl_t * rc, rigctld_t * rig,
+                             gboolean * ptt, gdouble * freq);
+static gboolean set_and_get_freq(radio_ctrl_t * rc, rigctld_t * rig,
+                                 gboolean toggle, gdouble * freq);
+static void     update_latency(radio_ctrl_t * rc, gint64 applied);
+
+
+/* Count the commands of a transaction and log the error replies */
+static void check_replies(radio_ctrl_t * rc, const rigctld_cmd_t * cmds,
+                          guint n)
+{
+    guint           i;
+
+    rc->wrops += n;
+
+    for (i = 0; i < n; i++)
+    {
+        if (cmds[i].status != 0 && cmds[i].status != RIGCTLD_NO_REPLY)
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s:%s: %s rigctld returned error (RPRT %d)"),
+                        __FILE__, __func__, cmds[i].cmd, cmds[i].status);
+    }
+}
+
+/*
+ * Send a batch of commands to rigctld.
+ *
+ * The commands are written at once and the replies are read back in order,
+ * so the batch costs a single round trip. Error replies are logged; the
+ * caller checks the status of the individual commands.
+ *
+ * Returns FALSE if the connection failed.
+ */
+static gboolean send_rigctld_commands(radio_ctrl_t * rc, rigctld_t * rig,
+                                      rigctld_cmd_t * cmds, guint n)
+{
+    gboolean        retval;
+
+    /* only the controller thread talks to the radios, no locking needed */
+    retval = rigctld_transact(rig, cmds, n);
+    check_replies(rc, cmds, n);
+
+    return retval;
+}
+
+/* Prepare the command reading the PTT status (or DCD status) */
+static void get_ptt_cmd(const radio_conf_t * conf, rigctld_cmd_t * cmd)
+{
+    if (conf->ptt == PTT_TYPE_CAT)
+    {
+        /* get_ptt (t) */
+        if (conf->vfo_opt)
+            rigctld_cmd_init(cmd, 1, "t currVFO");
+        else
+            rigctld_cmd_init(cmd, 1, "t");
+    }
+    else
+    {
+        /* \get_dcd */
+        if (conf->vfo_opt)
+            rigctld_cmd_init(cmd, 1, "%c currVFO", 0x8b);
+        else
+            rigctld_cmd_init(cmd, 1, "%c", 0x8b);
+    }
+}
+
+/* Prepare the command reading the frequency (toggle: the TX frequency) */
+static void get_freq_cmd(const radio_conf_t * conf, rigctld_cmd_t * cmd,
+                         gboolean toggle)
+{
+    if (toggle)
+    {
+        if (conf->vfo_opt)
+            rigctld_cmd_init(cmd, 1, "i currVFO");
+        else
+            rigctld_cmd_init(cmd, 1, "i");
+    }
+    else
+    {
+        if (conf->vfo_opt)
+            rigctld_cmd_init(cmd, 1, "f currVFO");
+        else
+            rigctld_cmd_init(cmd, 1, "f");
+    }
+}
+
+/* Prepare the command setting the frequency (toggle: the TX frequency) */
+static void set_freq_cmd(const radio_conf_t * conf, rigctld_cmd_t * cmd,
+                         gboolean toggle, gdouble freq)
+{
+    if (toggle)
+    {
+        if (conf->vfo_opt)
+            rigctld_cmd_init(cmd, 0, "I VFOA %10.0f", freq);
+        else
+            rigctld_cmd_init(cmd, 0, "I %10.0f", freq);
+    }
+    else
+    {
+        if (conf->vfo_opt)
+            rigctld_cmd_init(cmd, 0, "F currVFO %10.0f", freq);
+        else
+            rigctld_cmd_init(cmd, 0, "F %10.0f", freq);
+    }
+}
+
+static int get_vfos(const radio_conf_t * conf, char *rx, char *tx)
+{
+    // fill rx/tx with vfo name plus space if not empty
+    rx = tx = "";
+    switch (conf->vfoUp)
+    {
+    case VFO_A:
+        if (conf->vfo_opt)
+            {rx = "VFOB ";tx = "VFOA ";}
+        break;
+
+    case VFO_B:
+        if (conf->vfo_opt)
+           {rx = "VFOA ";tx = "VFOB ";}
+        break;
+
+    case VFO_MAIN:
+        if (conf->vfo_opt)
+            {rx = "Sub";tx = "Main";}
+        break;
+
+    case VFO_SUB:
+        if (conf->vfo_opt)
+            {rx = "Main";tx = "Sub";}
+        break;
+
+    default:
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s called but TX VFO is %d and we don't know how to handle it."), __func__,
+                    conf->vfoUp);
+        return 1;
+    }
+    sat_log_log(SAT_LOG_LEVEL_DEBUG, "rx=%x, tx=%s\n", rx, tx);
+    return 0;
+}
+
+/* Setup VFOs for split operation (simplex or duplex) */
+static gboolean setup_split(radio_ctrl_t * rc, const radio_conf_t * conf,
+                            rigctld_t * rig)
+{
+    rigctld_cmd_t   cmd;
+    gchar          *rx="", *tx="";
+
+    get_vfos(conf, rx, tx);
+    switch (conf->vfoUp)
+    {
+    case VFO_A:
+        if (conf->vfo_opt)
+            rigctld_cmd_init(&cmd, 0, "S VFOB 1 VFOA");
+        else
+            rigctld_cmd_init(&cmd, 0, "S 1 VFOA");
+        break;
+
+    case VFO_B:
+        if (conf->vfo_opt)
+            rigctld_cmd_init(&cmd, 0, "S VFOA 1 VFOB");
+        else
+            rigctld_cmd_init(&cmd, 0, "S 1 VFOB");
+        break;
+
+    case VFO_MAIN:
+        if (conf->vfo_opt)
+            rigctld_cmd_init(&cmd, 0, "S Sub 1 Main");
+        else
+            rigctld_cmd_init(&cmd, 0, "S 1 Main");
+        break;
+
+    case VFO_SUB:
+        if (conf->vfo_opt)
+            rigctld_cmd_init(&cmd, 0, "S Main 1 Sub");
+        else
+            rigctld_cmd_init(&cmd, 0, "S 1 Sub");
+        break;
+
+    default:
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s called but TX VFO is %d."), __func__,
+                    conf->vfoUp);
+        return FALSE;
+    }
+
+    send_rigctld_commands(rc, rig, &cmd, 1);
+
+    return (cmd.status == 0);
+}
+
+/*
+ * Track the downlink frequency by setting the uplink frequency
+ * according to the lower limit of the downlink passband.
+ */
+static void track_downlink(radio_ctrl_t * rc)
+{
+    gdouble         delta;
+
+    /* ensure that we have a usable transponder config */
+    if (rc->cur.have_trsp && (rc->cur.downlow > 0) && (rc->cur.uplow > 0))
+    {
+        delta = rc->satfreq_down - rc->cur.downlow;
+
+        if (rc->cur.invert)
+            rc->satfreq_up = rc->cur.uphigh - delta;
+        else
+            rc->satfreq_up = rc->cur.uplow + delta;
+    }
+}
+
+/*
+ * Track the uplink frequency by setting the downlink frequency
+ * according to the offset from the lower limit on the uplink passband.
+ */
+static void track_uplink(radio_ctrl_t * rc)
+{
+    gdouble         delta;
+
+    /* ensure that we have a usable transponder config */
+    if (rc->cur.have_trsp && (rc->cur.downlow > 0) && (rc->cur.uplow > 0))
+    {
+        delta = rc->satfreq_up - rc->cur.uplow;
+
+        if (rc->cur.invert)
+            rc->satfreq_down = rc->cur.downhigh - delta;
+        else
+            rc->satfreq_down = rc->cur.downlow + delta;
+    }
+}
+
+/*
+ * Decide whether a new frequency must be sent to the radio.
+ *
+ * last is the frequency on the radio, freq the one it should be on and rate
+ * the rate of change of the Doppler shift [Hz/s]. Every change of 1 Hz or
+ * more is sent, unless we are tracking with a tolerance; then the frequency
+ * is only sent once the error reaches the tolerance, and rc->tune_due is
+ * brought forward to the time this is expected to happen.
+ */
+static gboolean need_tune(radio_ctrl_t * rc, gdouble last, gdouble freq,
+                          gdouble rate)
+{
+    gdouble         err = fabs(freq - last);
+    gdouble         tol = rc->cur_tolerance;
+    gboolean        tune;
+    gint64          due;
+
+    /* a frequency of 0 means the sync with the radio was invalidated */
+    if (!rc->cur.tracking || last == 0.0)
+        return err >= 1.0;
+
+    rc->tune_error = MAX(rc->tune_error, err);
+
+    if (tol <= 0.0)
+    {
+        tune = (err >= 1.0);
+    }
+    else
+    {
+        tune = (err >= tol);
+
+        /* after a command the error starts again from zero */
+        if (fabs(rate) > 0.0)
+        {
+            due = g_get_monotonic_time() +
+                (gint64) ((tune ? tol : tol - err) / fabs(rate) *
+                          G_USEC_PER_SEC);
+            rc->tune_due = MIN(rc->tune_due, due);
+        }
+    }
+
+    if (tune)
+        rc->tunes++;
+
+    return tune;
+}
+
+static void exec_rx_cycle(radio_ctrl_t * rc)
+{
+    gdouble         readfreq = 0.0, tmpfreq, satfreqd, satfrequ;
+    gboolean        ptt = FALSE;
+    gboolean        freqok = FALSE;
+
+    /* get PTT status, together with the frequency for the dial feedback */
+    if (rc->engaged && (rc->lastrxf > 0.0))
+        freqok = get_ptt_freq(rc, rc->rig,
+                              rc->conf->ptt ? &ptt : NULL, &readfreq);
+    else if (rc->engaged && rc->conf->ptt)
+        ptt = get_ptt(rc, rc->rig);
+
+    /* Dial feedback:
+       If radio device is engaged read frequency from radio and compare it to the
+       last set frequency. If different, it means that user has changed frequency
+       on the radio dial => update transponder knob
+
+       Note: If rc->lastrxf = 0.0 the sync has been invalidated (e.g. user pressed "tune")
+       and no need to execute the dial feedback.
+     */
+    if ((rc->engaged) && (rc->lastrxf > 0.0) && (ptt == FALSE))
+    {
+        if (!freqok)
+        {
+            /* error => use a passive value */
+            rc->errcnt++;
+        }
+        else if (fabs(readfreq - rc->lastrxf) >= 1.0)
+        {
+            /* user might have altered radio frequency => update transponder knob */
+            rc->rigfreq_down = readfreq;
+            rc->lastrxf = readfreq;
+
+            /* doppler shift; only if we are tracking */
+            if (rc->cur.tracking)
+            {
+                satfreqd = (readfreq - rc->cur.dd + rc->conf->lo);
+            }
+            else
+            {
+                satfreqd = readfreq + rc->conf->lo;
+            }
+            rc->satfreq_down = satfreqd;
+            rc->dial_changed = TRUE;
+
+            /* Update uplink if locked to downlink */
+            if (rc->cur.trsplock)
+            {
+                track_downlink(rc);
+            }
+
+            /* no need to forward track */
+            return;
+        }
+    }
+
+    /* now, forward tracking */
+
+    /* If we are tracking, calculate the radio freq by applying both dopper shift
+       and tranverter LO frequency. If we are not tracking, apply only LO frequency.
+     */
+    satfreqd = rc->satfreq_down;
+    satfrequ = rc->satfreq_up;
+    if (rc->cur.tracking)
+    {
+        /* downlink */
+        rc->rigfreq_down = satfreqd + rc->cur.dd - rc->conf->lo;
+        /* uplink */
+        rc->rigfreq_up = satfrequ + rc->cur.du - rc->conf->loup;
+    }
+    else
+    {
+        rc->rigfreq_down = satfreqd - rc->conf->lo;
+        rc->rigfreq_up = satfrequ - rc->conf->loup;
+    }
+
+    tmpfreq = rc->rigfreq_down;
+
+    /* if device is engaged, send freq command to radio */
+    if ((rc->engaged) && (ptt == FALSE) &&
+        need_tune(rc, rc->lastrxf, tmpfreq, rc->cur.dd_dot))
+    {
+        if (set_and_get_freq(rc, rc->rig, FALSE, &tmpfreq))
+        {
+            /* reset error counter */
+            rc->errcnt = 0;
+
+            rc->lastrxf = tmpfreq;
+
+            /* This is only effective in RIG_TYPE_TRX mode.
+               Invalidate rc->lasttxf for two reasons.
+
+               1. Prevent dial feedback from changing the uplink frequency.
+               In the first TX cycle get_ptt_freq() returns the downlink
+               frequency instead of uplink. The mismatch would thus trigger
+               an uplink update as long as the VFO has not been updated.
+               2. Force updating the VFO in the first TX cycle.
+             */
+            if (rc->lastrxptt != ptt)
+                rc->lasttxf = 0.0;
+        }
+        else
+        {
+            rc->errcnt++;
+        }
+    }
+
+    /* Remember PTT state, to avoid misinterpreting VFO changes as dial
+       feedback during TX to RX transitions.
+     */
+    rc->lastrxptt = ptt;
+}
+
+static void exec_tx_cycle(radio_ctrl_t * rc)
+{
+    gdouble         readfreq = 0.0, tmpfreq, satfreqd, satfrequ;
+    gboolean        ptt = TRUE;
+    gboolean        freqok = FALSE;
+
+    /* get PTT status, together with the frequency for the dial feedback */
+    if (rc->engaged && (rc->lasttxf > 0.0))
+    {
+        freqok = get_ptt_freq(rc, rc->rig,
+                              rc->conf->ptt ? &ptt : NULL, &readfreq);
+    }
+    else if (rc->engaged && rc->conf->ptt)
+    {
+        ptt = get_ptt(rc, rc->rig);
+    }
+
+    /* Dial feedback:
+       If radio device is engaged read frequency from radio and compare it to the
+       last set frequency. If different, it means that user has changed frequency
+       on the radio dial => update transponder knob
+
+       Note: If rc->lasttxf = 0.0 the sync has been invalidated (e.g. user pressed "tune")
+       and no need to execute the dial feedback.
+     */
+    if ((rc->engaged) && (rc->lasttxf > 0.0) && (ptt == TRUE))
+    {
+        if (!freqok)
+        {
+            /* error => use a passive value */
+            rc->errcnt++;
+        }
+        else if (fabs(readfreq - rc->lasttxf) >= 1.0)
+        {
+            /* user might have altered radio frequency => update transponder knob */
+            rc->rigfreq_up = readfreq;
+            rc->lasttxf = readfreq;
+
+            /* doppler shift; only if we are tracking */
+            if (rc->cur.tracking)
+            {
+                satfrequ = readfreq - rc->cur.du + rc->conf->loup;
+            }
+            else
+            {
+                satfrequ = readfreq + rc->conf->loup;
+            }
+            rc->satfreq_up = satfrequ;
+            rc->dial_changed = TRUE;
+
+            /* Follow with downlink if transponder is locked */
+            if (rc->cur.trsplock)
+            {
+                track_uplink(rc);
+            }
+
+            /* no need to forward track */
+            return;
+        }
+    }
+
+    /* now, forward tracking */
+
+    /* If we are tracking, calculate the radio freq by applying both dopper shift
+       and tranverter LO frequency. If we are not tracking, apply only LO frequency.
+     */
+    satfreqd = rc->satfreq_down;
+    satfrequ = rc->satfreq_up;
+    if (rc->cur.tracking)
+    {
+        /* downlink */
+        rc->rigfreq_down = satfreqd + rc->cur.dd - rc->conf->lo;
+        /* uplink */
+        rc->rigfreq_up = satfrequ + rc->cur.du - rc->conf->loup;
+    }
+    else
+    {
+        rc->rigfreq_down = satfreqd - rc->conf->lo;
+        rc->rigfreq_up = satfrequ - rc->conf->loup;
+    }
+
+    tmpfreq = rc->rigfreq_up;
+
+    /* if device is engaged, send freq command to radio */
+    if ((rc->engaged) && (ptt == TRUE) &&
+        need_tune(rc, rc->lasttxf, tmpfreq, rc->cur.du_dot))
+    {
+        if (set_and_get_freq(rc, rc->rig, FALSE, &tmpfreq))
+        {
+            /* reset error counter */
+            rc->errcnt = 0;
+
+            rc->lasttxf = tmpfreq;
+
+            /* This is only effective in RIG_TYPE_TRX mode.
+               Invalidate rc->lastrxf for two reasons.
+
+               1. Prevent dial feedback from changing the downlink frequency.
+               In the first RX cycle get_ptt_freq() returns the uplink
+               frequency instead of downlink. The mismatch would thus
+               trigger a downlink update as long as the VFO has not been
+               updated.
+               2. Force updating the VFO in the first RX cycle.
+             */
+            if (rc->lasttxptt != ptt)
+                rc->lastrxf = 0.0;
+        }
+        else
+        {
+            rc->errcnt++;
+        }
+    }
+
+    /* Remember PTT state, to avoid misinterpreting VFO changes as dial
+       feedback during RX to TX transitions.
+     */
+    rc->lasttxptt = ptt;
+}
+
+static void exec_trx_cycle(radio_ctrl_t * rc)
+{
+    exec_rx_cycle(rc);
+    exec_tx_cycle(rc);
+}
+
+static void exec_toggle_cycle(radio_ctrl_t * rc)
+{
+    exec_rx_cycle(rc);
+
+    /* TX cycle is executed only if user selected RIG_TYPE_TOGGLE_AUTO
+     * In manual mode the TX freq update is performed only when TX is activated.
+     * Even in auto mode, the toggling is performed only once every 10 seconds.
+     */
+    if (rc->conf->type == RIG_TYPE_TOGGLE_AUTO)
+    {
+	gint64          current_time;
+
+        /* get the current time */
+	current_time = g_get_real_time() / G_USEC_PER_SEC;
+
+        if ((rc->last_toggle_tx == -1) ||
+            ((current_time - rc->last_toggle_tx) >= 10))
+        {
+            /* it's time to update TX freq */
+            exec_toggle_tx_cycle(rc);
+
+            /* store current time */
+            rc->last_toggle_tx = current_time;
+        }
+    }
+}
+
+/*
+ * Execute TX mode cycle.
+ *
+ * This function executes a transmit cycle when the primary device is of
+ * RIG_TYPE_TOGGLE_AUTO. This applies to radios that support split operation
+ * (e.g. TX on VHF, RX on UHF) where the frequency can not be set via CAT while
+ * PTT is active.
+ *
+ * If PTT=TRUE we are in TX mode and hence there is nothing to do since the
+ * frequency is kept constant.
+ *
+ * If PTT=FALSE we are in RX mode and we should update the TX frequency by
+ * using set_freq_toggle()
+ *
+ * For these kind of radios there is no dial-feedback for the TX frequency.
+ */
+
+static void exec_toggle_tx_cycle(radio_ctrl_t * rc)
+{
+    gdouble         tmpfreq;
+    gboolean        ptt = TRUE;
+
+    if (rc->engaged && rc->conf->ptt)
+    {
+        ptt = get_ptt(rc, rc->rig);
+    }
+
+    /* if we are in TX mode do nothing */
+    if (ptt == TRUE)
+    {
+        return;
+    }
+
+    /* Get the desired uplink frequency from controller */
+    tmpfreq = rc->rigfreq_up;
+
+    /* if device is engaged, send freq command to radio */
+    if ((rc->engaged) && (fabs(rc->lasttxf - tmpfreq) >= 10.0))
+    {
+        if (set_freq_toggle(rc, rc->rig, tmpfreq))
+        {
+            /* reset error counter */
+            rc->errcnt = 0;
+        }
+        else
+        {
+            rc->errcnt++;
+        }
+
+        /* store the last sent frequency even if an error occurred */
+        rc->lasttxf = tmpfreq;
+    }
+
+}
+
+static void exec_duplex_tx_cycle(radio_ctrl_t * rc)
+{
+    gdouble         readfreq = 0.0, tmpfreq, satfreqd, satfrequ;
+    gboolean        dialchanged = FALSE;
+
+    /* Dial feedback:
+       If radio device is engaged read frequency from radio and compare it to the
+       last set frequency. If different, it means that user has changed frequency
+       on the radio dial => update transponder knob
+
+       Note: If rc->lasttxf = 0.0 the sync has been invalidated (e.g. user pressed "tune")
+       and no need to execute the dial feedback.
+     */
+    if ((rc->engaged) && (rc->lasttxf > 0.0))
+    {
+        if (!get_freq_toggle(rc, rc->rig, &readfreq))
+        {
+            /* error => use a passive value */
+            readfreq = rc->lasttxf;
+            rc->errcnt++;
+        }
+
+        if (fabs(readfreq - rc->lasttxf) >= 1.0)
+        {
+            dialchanged = TRUE;
+
+            /* user might have altered radio frequency => update transponder knob */
+            rc->rigfreq_up = readfreq;
+            rc->lasttxf = readfreq;
+
+            /* doppler shift; only if we are tracking */
+            if (rc->cur.tracking)
+            {
+                satfrequ = readfreq - rc->cur.du + rc->conf->loup;
+            }
+            else
+            {
+                satfrequ = readfreq + rc->conf->loup;
+            }
+            rc->satfreq_up = satfrequ;
+            rc->dial_changed = TRUE;
+
+            /* Follow with downlink if transponder is locked */
+            if (rc->cur.trsplock)
+            {
+                track_uplink(rc);
+            }
+        }
+    }
+
+    /* now, forward tracking */
+    if (dialchanged)
+    {
+        /* no need to forward track */
+        return;
+    }
+
+    /* If we are tracking, calculate the radio freq by applying both dopper shift
+       and tranverter LO frequency. If we are not tracking, apply only LO frequency.
+     */
+    satfreqd = rc->satfreq_down;
+    satfrequ = rc->satfreq_up;
+    if (rc->cur.tracking)
+    {
+        /* downlink */
+        rc->rigfreq_down = satfreqd + rc->cur.dd - rc->conf->lo;
+        /* uplink */
+        rc->rigfreq_up = satfrequ + rc->cur.du - rc->conf->loup;
+    }
+    else
+    {
+        rc->rigfreq_down = satfreqd - rc->conf->lo;
+        rc->rigfreq_up = satfrequ - rc->conf->loup;
+    }
+
+    tmpfreq = rc->rigfreq_up;
+
+    /* if device is engaged, send freq command to radio */
+    if ((rc->engaged) &&
+        need_tune(rc, rc->lasttxf, tmpfreq, rc->cur.du_dot))
+    {
+        if (set_and_get_freq(rc, rc->rig, TRUE, &tmpfreq))
+        {
+            /* reset error counter */
+            rc->errcnt = 0;
+
+            rc->lasttxf = tmpfreq;
+        }
+        else
+        {
+            rc->errcnt++;
+        }
+    }
+}
+
+static void exec_duplex_cycle(radio_ctrl_t * rc)
+{
+    exec_rx_cycle(rc);
+    exec_duplex_tx_cycle(rc);
+}
+
+/* Whether a radio of a group has the uplink on its split VFO */
+static gboolean radio_split(const radio_t * r)
+{
+    /* full duplex and toggle radios with both roles */
+    return (r->role == (ROLE_DOWN | ROLE_UP)) &&
+        (r->conf->type != RIG_TYPE_TRX);
+}
+
+/*
+ * Decide what a radio of a group tunes in the current cycle.
+ *
+ * Radios without a split VFO tune their VFO for the downlink while
+ * receiving and for the uplink while transmitting. Toggle radios can not
+ * change the split VFO while transmitting.
+ */
+static void radio_sides(const radio_t * r, gboolean * down, gboolean * up)
+{
+    *down = (r->role & ROLE_DOWN) && !r->ptt;
+
+    if (radio_split(r))
+        *up = (r->conf->type == RIG_TYPE_DUPLEX) || !r->ptt;
+    else
+        *up = (r->role & ROLE_UP) && r->ptt;
+}
+
+/* Get a frequency read by a transaction; FALSE if it was not read */
+static gboolean cmd_freq(const radio_t * r, gint idx, gdouble * freq)
+{
+    if (idx < 0 || r->cmds[idx].status != 0)
+        return FALSE;
+
+    *freq = g_ascii_strtod(r->cmds[idx].value, NULL);
+
+    return TRUE;
+}
+
+/* Run one transaction with the commands prepared in r->cmds of each radio */
+static void transact_group(radio_ctrl_t * rc, const guint * ncmds)
+{
+    rigctld_batch_t *b;
+    guint           i, n = 0;
+
+    for (i = 0; i < rc->nradios; i++)
+    {
+        if (ncmds[i] == 0)
+            continue;
+
+        b = &rc->batches[n++];
+        b->rig = rc->radios[i].rig;
+        b->cmds = rc->radios[i].cmds;
+        b->n = ncmds[i];
+    }
+
+    if (n == 0)
+        return;
+
+    /* only the controller thread talks to the radios, no locking needed */
+    rigctld_transact_all(rc->batches, n);
+
+    for (i = 0; i < n; i++)
+        check_replies(rc, rc->batches[i].cmds, rc->batches[i].n);
+}
+
+/*
+ * Take a dial change on a radio of the group.
+ *
+ * Only the first change of a cycle is taken; the other radios follow it in
+ * the same cycle.
+ */
+static void group_dial_feedback(radio_ctrl_t * rc, radio_t * r,
+                                gboolean uplink, gdouble readfreq)
+{
+    if (uplink)
+    {
+        r->lasttxf = readfreq;
+        if (rc->dial_changed)
+            return;
+
+        rc->satfreq_up = readfreq + r->conf->loup;
+        if (rc->cur.tracking)
+            rc->satfreq_up -= rc->cur.du;
+
+        /* Follow with downlink if transponder is locked */
+        if (rc->cur.trsplock)
+            track_uplink(rc);
+    }
+    else
+    {
+        r->lastrxf = readfreq;
+        if (rc->dial_changed)
+            return;
+
+        rc->satfreq_down = readfreq + r->conf->lo;
+        if (rc->cur.tracking)
+            rc->satfreq_down -= rc->cur.dd;
+
+        /* Update uplink if locked to downlink */
+        if (rc->cur.trsplock)
+            track_downlink(rc);
+    }
+
+    rc->dial_changed = TRUE;
+}
+
+/* Read the PTT states and the frequencies for the dial feedback */
+static void read_group(radio_ctrl_t * rc)
+{
+    radio_t        *r;
+    gboolean        down, up;
+    gdouble         readfreq;
+    guint           ncmds[rc->nradios];
+    guint           i, n;
+
+    for (i = 0; i < rc->nradios; i++)
+    {
+        r = &rc->radios[i];
+        n = 0;
+        r->ptt_cmd = r->down_cmd = r->up_cmd = -1;
+
+        if (r->conf->ptt)
+        {
+            r->ptt_cmd = n;
+            get_ptt_cmd(r->conf, &r->cmds[n++]);
+        }
+
+        /* the main VFO has the downlink or, without split, the uplink */
+        if (((r->role & ROLE_DOWN) && r->lastrxf > 0.0) ||
+            ((r->role & ROLE_UP) && !radio_split(r) && r->lasttxf > 0.0))
+        {
+            r->down_cmd = n;
+            get_freq_cmd(r->conf, &r->cmds[n++], FALSE);
+        }
+
+        /* toggle radios have no dial feedback for the uplink */
+        if (radio_split(r) && r->conf->type == RIG_TYPE_DUPLEX &&
+            r->lasttxf > 0.0)
+        {
+            r->up_cmd = n;
+            get_freq_cmd(r->conf, &r->cmds[n++], TRUE);
+        }
+        else if (!radio_split(r))
+        {
+            r->up_cmd = r->down_cmd;
+        }
+
+        ncmds[i] = n;
+    }
+
+    transact_group(rc, ncmds);
+
+    for (i = 0; i < rc->nradios; i++)
+    {
+        r = &rc->radios[i];
+
+        /* a dedicated transmitter without PTT status is always on the air */
+        if (r->ptt_cmd >= 0)
+            r->ptt = (r->cmds[r->ptt_cmd].status == 0 &&
+                      g_ascii_strtoull(r->cmds[r->ptt_cmd].value, NULL,
+                                       0) == 1);
+        else
+            r->ptt = (r->role == ROLE_UP);
+
+        /* a radio switching between the links still has the frequency of
+           the other one, which is not a dial change */
+        if (!radio_split(r) && r->role == (ROLE_DOWN | ROLE_UP) &&
+            r->ptt != r->lastptt)
+        {
+            r->lastrxf = 0.0;
+            r->lasttxf = 0.0;
+        }
+        r->lastptt = r->ptt;
+
+        radio_sides(r, &down, &up);
+
+        if (down && r->lastrxf > 0.0)
+        {
+            if (!cmd_freq(r, r->down_cmd, &readfreq))
+                rc->errcnt++;
+            else if (fabs(readfreq - r->lastrxf) >= 1.0)
+                group_dial_feedback(rc, r, FALSE, readfreq);
+        }
+
+        if (up && r->lasttxf > 0.0 && r->up_cmd >= 0)
+        {
+            if (!cmd_freq(r, r->up_cmd, &readfreq))
+                rc->errcnt++;
+            else if (fabs(readfreq - r->lasttxf) >= 1.0)
+                group_dial_feedback(rc, r, TRUE, readfreq);
+        }
+    }
+}
+
+/*
+ * Take the reply to a set and read-back pair of exec_group_cycle().
+ *
+ * The frequency actually used is read back, since the tuning step of the
+ * radio may be larger than 1 Hz; if that failed, the frequency sent is
+ * assumed. start is the time the transaction was sent.
+ */
+static void take_tune(radio_ctrl_t * rc, radio_t * r, gint set, gdouble freq,
+                      gdouble * last, gint64 start)
+{
+    if (set < 0)
+        return;
+
+    if (r->cmds[set].status != 0)
+    {
+        rc->errcnt++;
+        return;
+    }
+
+    /* reset error counter */
+    rc->errcnt = 0;
+
+    *last = freq;
+    cmd_freq(r, set + 1, last);
+    update_latency(rc, start + r->cmds[set].latency);
+}
+
+/*
+ * Execute a cycle for a group of radios.
+ *
+ * The cycle takes two transactions with all radios at once: one reading
+ * the PTT states and the frequencies for the dial feedback, and one setting
+ * and reading back the new frequencies. Each radio is tuned with its own LO;
+ * the radio frequencies shown are those of the first radio of each link.
+ */
+static void exec_group_cycle(radio_ctrl_t * rc)
+{
+    radio_t        *r;
+    gboolean        down, up, split;
+    gboolean        have_down = FALSE, have_up = FALSE;
+    gdouble         freq;
+    gint64          start;
+    guint           ncmds[rc->nradios];
+    guint           i, n;
+
+    if (!rc->engaged)
+        return;
+
+    read_group(rc);
+
+    /* forward tracking */
+    for (i = 0; i < rc->nradios; i++)
+    {
+        r = &rc->radios[i];
+        n = 0;
+        r->down_cmd = r->up_cmd = -1;
+        split = radio_split(r);
+        radio_sides(r, &down, &up);
+
+        if (r->role & ROLE_DOWN)
+        {
+            freq = rc->satfreq_down - r->conf->lo;
+            if (rc->cur.tracking)
+                freq += rc->cur.dd;
+            if (!have_down)
+                rc->rigfreq_down = freq;
+            have_down = TRUE;
+
+            if (down && need_tune(rc, r->lastrxf, freq, rc->cur.dd_dot))
+            {
+                r->down_cmd = n;
+                r->rxf = freq;
+                set_freq_cmd(r->conf, &r->cmds[n++], FALSE, freq);
+                get_freq_cmd(r->conf, &r->cmds[n++], FALSE);
+            }
+        }
+
+        if (r->role & ROLE_UP)
+        {
+            freq = rc->satfreq_up - r->conf->loup;
+            if (rc->cur.tracking)
+                freq += rc->cur.du;
+            if (!have_up)
+                rc->rigfreq_up = freq;
+            have_up = TRUE;
+
+            if (up && need_tune(rc, r->lasttxf, freq, rc->cur.du_dot))
+            {
+                r->up_cmd = n;
+                r->txf = freq;
+                set_freq_cmd(r->conf, &r->cmds[n++], split, freq);
+                get_freq_cmd(r->conf, &r->cmds[n++], split);
+            }
+        }
+
+        ncmds[i] = n;
+    }
+
+    start = g_get_monotonic_time();
+    transact_group(rc, ncmds);
+
+    for (i = 0; i < rc->nradios; i++)
+    {
+        r = &rc->radios[i];
+        take_tune(rc, r, r->down_cmd, r->rxf, &r->lastrxf, start);
+        take_tune(rc, r, r->up_cmd, r->txf, &r->lasttxf, start);
+    }
+}
+
+static gboolean get_ptt(radio_ctrl_t * rc, rigctld_t * rig)
+{
+    rigctld_cmd_t   cmd;
+
+    get_ptt_cmd(rc->conf, &cmd);
+    send_rigctld_commands(rc, rig, &cmd, 1);
+
+    return (cmd.status == 0 && g_ascii_strtoull(cmd.value, NULL, 0) == 1);
+}
+
+static gboolean set_ptt(radio_ctrl_t * rc, rigctld_t * rig, gboolean ptt)
+{
+    rigctld_cmd_t   cmd;
+
+    if (rc->conf->vfo_opt)
+        rigctld_cmd_init(&cmd, 0, "T currVFO %d", ptt ? 1 : 0);
+    else
+        rigctld_cmd_init(&cmd, 0, "T %d", ptt ? 1 : 0);
+
+    send_rigctld_commands(rc, rig, &cmd, 1);
+
+    return (cmd.status == 0);
+}
+
+/*
+ * Get the PTT status and the frequency in a single round trip.
+ *
+ * @param ptt Location for the PTT status or NULL if it is not needed.
+ * @param freq Location for the frequency.
+ * @return TRUE if the frequency was read.
+ *
+ * On error the PTT status is FALSE, as with get_ptt().
+ */
+static gboolean get_ptt_freq(radio_ctrl_t * rc, rigctld_t * rig,
+                             gboolean * ptt, gdouble * freq)
+{
+    rigctld_cmd_t   cmds[2];
+    guint           n = 0;
+
+    if (ptt != NULL)
+        get_ptt_cmd(rc->conf, &cmds[n++]);
+    get_freq_cmd(rc->conf, &cmds[n++], FALSE);
+
+    send_rigctld_commands(rc, rig, cmds, n);
+
+    if (ptt != NULL)
+        *ptt = (cmds[0].status == 0 &&
+                g_ascii_strtoull(cmds[0].value, NULL, 0) == 1);
+
+    if (cmds[n - 1].status != 0)
+        return FALSE;
+
+    *freq = g_ascii_strtod(cmds[n - 1].value, NULL);
+
+    return TRUE;
+}
+
+/*
+ * Check for AOS and LOS and send signal if enabled for rig.
+ *
+ * @param rc The radio controller.
+ * @return TRUE if the operation was successful, FALSE if a connection error
+ *         occurred.
+ *
+ * This function checks whether AOS or LOS just happened and sends the
+ * appropriate signal to the RIG if this signalling is enabled.
+ */
+static gboolean check_aos_los(radio_ctrl_t * rc)
+{
+    rigctld_cmd_t   cmds[rc->nradios];
+    const radio_conf_t *conf;
+    const gchar    *signal = NULL;
+    gboolean        retcode;
+    guint           i, n = 0;
+
+    if (rc->engaged && rc->cur.tracking)
+    {
+        if (rc->prev_ele < 0.0 && rc->cur.el >= 0.0)
+        {
+            /* AOS has occurred */
+            signal = "AOS";
+        }
+        else if (rc->prev_ele >= 0.0 && rc->cur.el < 0.0)
+        {
+            /* LOS has occurred */
+            signal = "LOS";
+        }
+    }
+
+    rc->prev_ele = rc->cur.el;
+
+    if (signal == NULL)
+        return TRUE;
+
+    /* all radios are signalled at once */
+    for (i = 0; i < rc->nradios; i++)
+    {
+        conf = rc->radios[i].conf;
+        if (signal[0] == 'A' ? !conf->signal_aos : !conf->signal_los)
+            continue;
+
+        rigctld_cmd_init(&cmds[n], 0, "%s", signal);
+        rc->batches[n].rig = rc->radios[i].rig;
+        rc->batches[n].cmds = &cmds[n];
+        rc->batches[n].n = 1;
+        n++;
+    }
+
+    if (n == 0)
+        return TRUE;
+
+    retcode = rigctld_transact_all(rc->batches, n);
+    for (i = 0; i < n; i++)
+        check_replies(rc, rc->batches[i].cmds, 1);
+
+    return retcode;
+}
+
+/*
+ * Set frequency in toggle mode
+ *
+ * Returns TRUE if the operation was successful, FALSE otherwise
+ */
+static gboolean set_freq_toggle(radio_ctrl_t * rc, rigctld_t * rig,
+                                gdouble freq)
+{
+    rigctld_cmd_t   cmd;
+
+    set_freq_cmd(rc->conf, &cmd, TRUE, freq);
+    send_rigctld_commands(rc, rig, &cmd, 1);
+
+    return (cmd.status == 0);
+}
+
+/*
+ * Update the command-to-apply latency with a new frequency command.
+ *
+ * The latency is the time from the Doppler shift the cycle started with,
+ * brought forward to the start of the cycle by take_input(), until the
+ * radio acknowledged the frequency; it is smoothed over several commands. The
+ * residual is the Doppler error left at the time the frequency was applied,
+ * i.e. the drift during the difference between the measured latency and the
+ * lead time the Doppler shift was predicted for.
+ */
+static void update_latency(radio_ctrl_t * rc, gint64 applied)
+{
+    gint64          sample;
+    gdouble         dt;
+
+    if (!rc->cur.tracking || rc->cur.dop_time == 0)
+        return;
+
+    /* ignore samples from a stopped or jumping time controller */
+    sample = applied - rc->cur.dop_time;
+    if (sample < 0 || sample > MAX_DOPPLER_LEAD)
+        return;
+
+    if (rc->latency == 0)
+        rc->latency = sample;
+    else
+        rc->latency += (sample - rc->latency) / 8;
+
+    dt = (sample - rc->cur.dop_lead) / (gdouble) G_USEC_PER_SEC;
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Doppler residual %.1f Hz down, %.1f Hz up "
+                  "(latency %.0f ms, lead %.0f ms)"), __func__,
+                rc->cur.dd_dot * dt, rc->cur.du_dot * dt, sample / 1000.0,
+                rc->cur.dop_lead / 1000.0);
+}
+
+/*
+ * Set the frequency and read back the frequency actually used.
+ *
+ * The actual frequency might be different from what we have set because
+ * the tuning step is larger than what we work with (e.g. FT-817 has a
+ * smallest tuning step of 10 Hz). Both commands are sent at once; rigctld
+ * executes them in order, so the radio does not need extra time to settle
+ * before the frequency is read.
+ *
+ * Returns TRUE if the frequency was set. freq is replaced with the frequency
+ * read back from the radio, if that succeeded.
+ */
+static gboolean set_and_get_freq(radio_ctrl_t * rc, rigctld_t * rig,
+                                 gboolean toggle, gdouble * freq)
+{
+    rigctld_cmd_t   cmds[2];
+
+    set_freq_cmd(rc->conf, &cmds[0], toggle, *freq);
+    get_freq_cmd(rc->conf, &cmds[1], toggle);
+
+    send_rigctld_commands(rc, rig, cmds, 2);
+
+    if (cmds[0].status != 0)
+        return FALSE;
+
+    /* the set was acknowledged before the read-back was executed */
+    update_latency(rc, g_get_monotonic_time() -
+                   (cmds[1].latency - cmds[0].latency));
+
+    if (cmds[1].status == 0)
+        *freq = g_ascii_strtod(cmds[1].value, NULL);
+
+    return TRUE;
+}
+
+/*
+ * Turn on the radios toggle mode
+ *
+ * Returns TRUE if the operation was successful
+ */
+static gboolean set_toggle(radio_ctrl_t * rc, const radio_conf_t * conf,
+                           rigctld_t * rig)
+{
+    rigctld_cmd_t   cmd;
+
+    if (conf->vfo_opt)
+        rigctld_cmd_init(&cmd, 0, "S %s 1 %d",
+                         conf->vfoDown == VFO_A ? "VFOA" : "VFOB",
+                         conf->vfoDown);
+    else
+        rigctld_cmd_init(&cmd, 0, "S 1 %d", conf->vfoDown);
+    send_rigctld_commands(rc, rig, &cmd, 1);
+
+    return (cmd.status == 0);
+}
+
+/*
+ * Turn off the radios toggle mode
+ *
+ * Returns TRUE if the operation was successful
+ */
+static gboolean unset_toggle(radio_ctrl_t * rc, const radio_conf_t * conf,
+                             rigctld_t * rig)
+{
+    rigctld_cmd_t   cmd;
+
+    if (conf->vfo_opt)
+        rigctld_cmd_init(&cmd, 0, "S VFOA 0 %d", conf->vfoDown);
+    else
+        rigctld_cmd_init(&cmd, 0, "S 0 %d", conf->vfoDown);
+    send_rigctld_commands(rc, rig, &cmd, 1);
+
+    return (cmd.status == 0);
+}
+
+/*
+ * Get vfo option
+ *
+ * Returns TRUE if the vfo option enabled was successful, FALSE otherwise
+ */
+static gboolean get_vfo_opt(radio_ctrl_t * rc, rigctld_t * rig)
+{
+    rigctld_cmd_t   cmds[2];
+
+    /* we don't really care about the return from set_vfo_opt,
+       we'll check to see if it worked next */
+    rigctld_cmd_init(&cmds[0], 0, "\\set_vfo_opt 1");
+    rigctld_cmd_init(&cmds[1], 1, "\\chk_vfo");
+    send_rigctld_commands(rc, rig, cmds, 2);
+
+    return (cmds[1].status == 0 && cmds[1].value[0] == '1');
+}
+
+/*
+ * Get frequency when the radio is working toggle
+ *
+ * Returns TRUE if the operation was successful, FALSE otherwise
+ */
+static gboolean get_freq_toggle(radio_ctrl_t * rc, rigctld_t * rig,
+                                gdouble * freq)
+{
+    rigctld_cmd_t   cmd;
+
+    if (freq == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s:%d: NULL storage."), __FILE__, __LINE__);
+        return FALSE;
+    }
+
+    get_freq_cmd(rc->conf, &cmd, TRUE);
+    send_rigctld_commands(rc, rig, &cmd, 1);
+    if (cmd.status != 0)
+        return FALSE;
+
+    *freq = g_ascii_strtod(cmd.value, NULL);
+
+    return TRUE;
+}
+
+/*
+ * This function is used to manage PTT events, e.g. the user presses
+ * the spacebar. It is only useful for RIG_TYPE_TOGGLE_MAN and possibly for
+ * RIG_TYPE_TOGGLE_AUTO.
+ *
+ * The function is executed by the controller thread instead of a cycle.
+ * It checks the current PTT status. If PTT status is FALSE (off), it will
+ * set the TX frequency and set PTT to TRUE (on). If PTT status is TRUE (on)
+ * it will simply set the PTT to FALSE (off).
+ *
+ * This function assumes that the radio support set/get PTT, otherwise it makes
+ * no sense to use it!
+ */
+static void manage_ptt_event(radio_ctrl_t * rc)
+{
+    gboolean        ptt;
+
+    ptt = get_ptt(rc, rc->rig);
+
+    if (ptt == FALSE)
+    {
+        /* PTT is OFF => set TX freq then set PTT to ON */
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: PTT is OFF => Set TX freq and PTT=ON"), __func__);
+
+        exec_toggle_tx_cycle(rc);
+        set_ptt(rc, rc->rig, TRUE);
+    }
+    else
+    {
+        /* PTT is ON => set to OFF */
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: PTT is ON = Set PTT=OFF"), __func__);
+
+        set_ptt(rc, rc->rig, FALSE);
+    }
+}
+
+/* Execute one controller cycle depending on the radio type */
+static void exec_cycle(radio_ctrl_t * rc)
+{
+    check_aos_los(rc);
+
+    if (rc->nradios > 1)
+    {
+        exec_group_cycle(rc);
+    }
+    else
+    {
+        switch (rc->conf->type)
+        {
+
+        case RIG_TYPE_RX:
+            exec_rx_cycle(rc);
+            break;
+
+        case RIG_TYPE_TX:
+            exec_tx_cycle(rc);
+            break;
+
+        case RIG_TYPE_TRX:
+            exec_trx_cycle(rc);
+            break;
+
+        case RIG_TYPE_DUPLEX:
+            exec_duplex_cycle(rc);
+            break;
+
+        case RIG_TYPE_TOGGLE_AUTO:
+        case RIG_TYPE_TOGGLE_MAN:
+            exec_toggle_cycle(rc);
+            break;
+
+        default:
+            /* invalid mode */
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s:%s: Invalid radio type %d. Setting type to "
+                          "RIG_TYPE_RX"), __FILE__, __func__, rc->conf->type);
+            rc->conf->type = RIG_TYPE_RX;
+        }
+    }
+
+    /* perform error count checking */
+    if (rc->errcnt >= MAX_ERROR_COUNT)
+    {
+        /* disengage device */
+        rc->engaged = FALSE;
+        rc->errcnt = 0;
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _
+                    ("%s:%s: MAX_ERROR_COUNT (%d) reached. Disengaging device!"),
+                    __FILE__, __func__, MAX_ERROR_COUNT);
+    }
+}
+
+static void rigctrl_close(radio_ctrl_t * rc)
+{
+    radio_t        *r;
+    guint           i;
+
+    for (i = 0; i < rc->nradios; i++)
+    {
+        r = &rc->radios[i];
+        if ((rc->nradios == 1 || radio_split(r)) &&
+            ((r->conf->type == RIG_TYPE_TOGGLE_AUTO) ||
+             (r->conf->type == RIG_TYPE_TOGGLE_MAN)))
+        {
+            unset_toggle(rc, r->conf, r->rig);
+        }
+
+        rigctld_close(r->rig);
+        r->rig = NULL;
+    }
+    rc->rig = NULL;
+}
+
+static void rigctrl_open(radio_ctrl_t * rc)
+{
+    radio_t        *r;
+    guint           i;
+
+    for (i = 0; i < rc->nradios; i++)
+    {
+        r = &rc->radios[i];
+        r->rig = rigctld_open(r->conf->host, r->conf->port);
+
+        // check to see if vfo option is enabled
+        r->conf->vfo_opt = get_vfo_opt(rc, r->rig);
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s:%s: VFO opt=%d (%s)"), __FILE__,
+                    __func__, r->conf->vfo_opt, r->conf->name);
+
+        /* in a group, only radios tuning both links use the split VFO */
+        if (rc->nradios > 1 && !radio_split(r))
+            continue;
+
+        switch (r->conf->type)
+        {
+
+        case RIG_TYPE_DUPLEX:
+            /* set rig into SAT mode (hamlib needs it even if rig already in SAT) */
+            setup_split(rc, r->conf, r->rig);
+            break;
+
+        case RIG_TYPE_TOGGLE_AUTO:
+        case RIG_TYPE_TOGGLE_MAN:
+            set_toggle(rc, r->conf, r->rig);
+            rc->last_toggle_tx = -1;
+            break;
+
+        default:
+            break;
+        }
+    }
+    rc->rig = rc->radios[0].rig;
+}
+
+/*
+ * Take the Doppler shift of the cycle from the Doppler table.
+ *
+ * The satellite time of the cycle follows from the satellite time of the
+ * input. The range rate is looked up for the measured latency later, when
+ * the frequencies are applied, and the shift is computed for the satellite
+ * frequencies of the controller, which include dial changes.
+ *
+ * Returns FALSE if there is no table or it does not cover that time.
+ */
+static gboolean table_doppler(radio_ctrl_t * rc, gint64 now)
+{
+    gdouble         t, rr, rr_dot;
+    gint64          lead;
+
+    if (rc->table == NULL || rc->cur.jul_time <= 0.0 ||
+        rc->cur.dop_time == 0 || rc->cur.time_rate <= 0.0)
+        return FALSE;
+
+    lead = MIN(rc->latency, MAX_DOPPLER_LEAD);
+    t = rc->cur.jul_time + (now + lead - rc->cur.dop_time) *
+        rc->cur.time_rate / (secday * G_USEC_PER_SEC);
+    if (!doppler_table_get(rc->table, t, &rr, &rr_dot))
+        return FALSE;
+
+    /* the rates are per second of the monotonic clock */
+    rr_dot *= rc->cur.time_rate;
+    rc->cur.dd = -rc->satfreq_down * rr / SPEED_OF_LIGHT;
+    rc->cur.dd_dot = -rc->satfreq_down * rr_dot / SPEED_OF_LIGHT;
+    rc->cur.du = rc->satfreq_up * rr / SPEED_OF_LIGHT;
+    rc->cur.du_dot = rc->satfreq_up * rr_dot / SPEED_OF_LIGHT;
+    rc->cur.dop_time = now;
+    rc->cur.dop_lead = lead;
+    rc->table_cycles++;
+
+    return TRUE;
+}
+
+/*
+ * Take the latest input for the next cycle.
+ *
+ * The satellite frequencies are only taken when the user has changed them;
+ * otherwise a dial change on the radio that the user interface has not yet
+ * shown would be undone.
+ */
+static void take_input(radio_ctrl_t * rc)
+{
+    gint64          now = g_get_monotonic_time();
+    gdouble         dt;
+    guint           i;
+
+    rc->cur = rc->in;
+    rc->cur_tolerance = rc->tolerance;
+
+    if (rc->cur.satfreq_seq != rc->satfreq_seq)
+    {
+        rc->satfreq_seq = rc->cur.satfreq_seq;
+        rc->satfreq_down = rc->cur.satfreq_down;
+        rc->satfreq_up = rc->cur.satfreq_up;
+
+        /* tune to what the user has set at once */
+        rc->cur_tolerance = 0.0;
+    }
+
+    if (rc->table_changed)
+    {
+        doppler_table_free(rc->table);
+        rc->table = rc->table_in;
+        rc->table_in = NULL;
+        rc->table_changed = FALSE;
+    }
+
+    /* the Doppler shift may be older than the cycle; take it from the
+       table or bring it forward */
+    if (rc->cur.tracking && !table_doppler(rc, now) &&
+        rc->cur.dop_time > 0 && now > rc->cur.dop_time &&
+        now - rc->cur.dop_time < MAX_DOPPLER_LEAD)
+    {
+        dt = (now - rc->cur.dop_time) / (gdouble) G_USEC_PER_SEC;
+        rc->cur.dd += rc->cur.dd_dot * dt;
+        rc->cur.du += rc->cur.du_dot * dt;
+        rc->cur.dop_time = now;
+    }
+
+    /* invalidate sync with radio */
+    if (rc->cur.resync_down != rc->resync_down)
+    {
+        rc->resync_down = rc->cur.resync_down;
+        rc->lastrxf = 0.0;
+        for (i = 0; i < rc->nradios; i++)
+            rc->radios[i].lastrxf = 0.0;
+    }
+    if (rc->cur.resync_up != rc->resync_up)
+    {
+        rc->resync_up = rc->cur.resync_up;
+        rc->lasttxf = 0.0;
+        for (i = 0; i < rc->nradios; i++)
+            rc->radios[i].lasttxf = 0.0;
+    }
+
+    /* no AOS or LOS on target change */
+    if (rc->cur.catnum != rc->catnum)
+    {
+        rc->catnum = rc->cur.catnum;
+        rc->prev_ele = rc->cur.el;
+    }
+}
+
+static gboolean notify_idle(gpointer data)
+{
+    radio_ctrl_t   *rc = data;
+
+    g_mutex_lock(&rc->lock);
+    rc->idle_id = 0;
+    g_mutex_unlock(&rc->lock);
+
+    /* the callback may free the controller */
+    rc->notify(rc, rc->data);
+
+    return FALSE;
+}
+
+/* Publish the result of a cycle and notify the user interface */
+static void put_output(radio_ctrl_t * rc, gint64 cycle_time)
+{
+    rc->out.satfreq_down = rc->satfreq_down;
+    rc->out.satfreq_up = rc->satfreq_up;
+    rc->out.dial_changed |= rc->dial_changed;
+    rc->out.rigfreq_down = rc->rigfreq_down;
+    rc->out.rigfreq_up = rc->rigfreq_up;
+    rc->out.failed = !rc->engaged;
+    rc->out.latency = rc->latency;
+    rc->out.cycles++;
+    rc->out.cycle_time = cycle_time;
+    rc->out.wrops = rc->wrops;
+    rc->out.tunes = rc->tunes;
+    rc->out.tune_error = rc->tune_error;
+    rc->out.table_cycles = rc->table_cycles;
+    rc->dial_changed = FALSE;
+
+    if (rc->notify != NULL && rc->idle_id == 0)
+        rc->idle_id = g_idle_add(notify_idle, rc);
+}
+
+/* Log the frequency command rate and the largest tuning error */
+static void log_tune_stats(radio_ctrl_t * rc)
+{
+    gdouble         secs;
+
+    if (rc->tunes == 0)
+        return;
+
+    secs = (g_get_monotonic_time() - rc->started) / (gdouble) G_USEC_PER_SEC;
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: %u frequency commands in %.0f s (%.2f/s), "
+                  "largest tuning error %.0f Hz, tolerance %.0f Hz"),
+                __func__, rc->tunes, secs, rc->tunes / MAX(secs, 1.0),
+                rc->tune_error, rc->cur_tolerance);
+
+    if (rc->table_cycles > 0)
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: %u of %u cycles took the Doppler shift "
+                      "from the Doppler table"), __func__,
+                    rc->table_cycles, rc->out.cycles);
+}
+
+/* The controller thread */
+static gpointer radio_ctrl_run(gpointer data)
+{
+    radio_ctrl_t   *rc = data;
+    gboolean        ptt_event;
+    gint64          start, next;
+
+    rigctrl_open(rc);
+
+    g_mutex_lock(&rc->lock);
+    next = g_get_monotonic_time();
+
+    while (rc->running && rc->engaged)
+    {
+        take_input(rc);
+        ptt_event = rc->ptt_event;
+        rc->ptt_event = FALSE;
+        g_mutex_unlock(&rc->lock);
+
+        start = g_get_monotonic_time();
+        rc->tune_due = G_MAXINT64;
+        if (ptt_event)
+            manage_ptt_event(rc);
+        else
+            exec_cycle(rc);
+
+        g_mutex_lock(&rc->lock);
+        put_output(rc, g_get_monotonic_time() - start);
+
+        /* cycles start at a fixed rate unless they overrun */
+        if (!ptt_event)
+        {
+            next += (gint64) rc->cycle * 1000;
+
+            /* within the tolerance, wait until the error reaches it */
+            if (rc->cur.tracking && rc->cur_tolerance > 0.0)
+                next = CLAMP(rc->tune_due, next,
+                             MAX(next, start + MAX_IDLE_CYCLE * 1000));
+
+            if (next < g_get_monotonic_time())
+            {
+                sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                            _("%s: Cycle took %" G_GINT64_FORMAT
+                              " usec, longer than the period"), __func__,
+                            rc->out.cycle_time);
+                next = g_get_monotonic_time();
+            }
+        }
+
+        while (rc->running && !rc->ptt_event &&
+               g_cond_wait_until(&rc->cond, &rc->lock, next));
+    }
+
+    g_mutex_unlock(&rc->lock);
+
+    rigctrl_close(rc);
+    log_tune_stats(rc);
+
+    return NULL;
+}
+
+static radio_conf_t *copy_conf(const radio_conf_t * conf)
+{
+    radio_conf_t   *copy;
+
+    copy = g_new(radio_conf_t, 1);
+    *copy = *conf;
+    copy->name = g_strdup(conf->name);
+    copy->host = g_strdup(conf->host);
+
+    return copy;
+}
+
+static void free_conf(radio_conf_t * conf)
+{
+    if (conf == NULL)
+        return;
+
+    g_free(conf->name);
+    g_free(conf->host);
+    g_free(conf);
+}
+
+/*
+ * Assign the roles of the radios of a group.
+ *
+ * Receivers tune the downlink and transmitters the uplink. The other radios
+ * tune the downlink unless there is a receiver, and the uplink unless there
+ * is a transmitter. A single radio keeps both roles, as its type decides
+ * what it does.
+ */
+static void assign_roles(radio_ctrl_t * rc)
+{
+    gboolean        have_rx = FALSE, have_tx = FALSE;
+    radio_t        *r;
+    guint           i;
+
+    for (i = 0; i < rc->nradios; i++)
+    {
+        have_rx |= (rc->radios[i].conf->type == RIG_TYPE_RX);
+        have_tx |= (rc->radios[i].conf->type == RIG_TYPE_TX);
+    }
+
+    for (i = 0; i < rc->nradios; i++)
+    {
+        r = &rc->radios[i];
+        if (r->conf->type == RIG_TYPE_RX)
+            r->role = ROLE_DOWN;
+        else if (r->conf->type == RIG_TYPE_TX)
+            r->role = ROLE_UP;
+        else
+            r->role = (have_rx ? 0 : ROLE_DOWN) | (have_tx ? 0 : ROLE_UP);
+
+        if (rc->nradios == 1)
+            continue;
+
+        if (r->role == 0)
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: %s is not used, there are dedicated radios "
+                          "for both links"), __func__, r->conf->name);
+        else
+            sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: %s tunes the %s"),
+                        __func__, r->conf->name,
+                        r->role == ROLE_DOWN ? "downlink" :
+                        r->role == ROLE_UP ? "uplink" : "downlink and uplink");
+    }
+}
+
+/**
+ * Create a radio controller and start its thread.
+ *
+ * @param confs The radio configurations; the first one is the primary radio.
+ * @param n The number of radios, at least 1.
+ * @param input The initial input.
+ * @param notify Function called in the main loop when the output has
+ *               changed, or NULL.
+ * @param data User data passed to notify.
+ * @return The new controller. Free it with radio_ctrl_free().
+ *
+ * The controller connects to the radios and runs a cycle every cycle period
+ * of the primary radio until it is freed or too many errors occur. With
+ * more than one radio, each tunes the links given by its type.
+ */
+radio_ctrl_t   *radio_ctrl_new(const radio_conf_t * const *confs, guint n,
+                               const radio_ctrl_input_t * input,
+                               radio_ctrl_notify_t notify, gpointer data)
+{
+    radio_ctrl_t   *rc;
+    guint           i;
+
+    g_return_val_if_fail(n > 0, NULL);
+
+    rc = g_new0(radio_ctrl_t, 1);
+    rc->radios = g_new0(radio_t, n);
+    rc->nradios = n;
+    rc->batches = g_new0(rigctld_batch_t, n);
+    for (i = 0; i < n; i++)
+        rc->radios[i].conf = copy_conf(confs[i]);
+    assign_roles(rc);
+
+    rc->conf = rc->radios[0].conf;
+    rc->cycle = rc->conf->cycle > 0 ? rc->conf->cycle : 1000;
+    rc->tolerance = MAX(rc->conf->tolerance, 0.0);
+    rc->cur_tolerance = rc->tolerance;
+    rc->started = g_get_monotonic_time();
+    rc->notify = notify;
+    rc->data = data;
+    g_mutex_init(&rc->lock);
+    g_cond_init(&rc->cond);
+
+    rc->in = *input;
+    rc->cur = *input;
+    rc->satfreq_seq = input->satfreq_seq;
+    rc->satfreq_down = input->satfreq_down;
+    rc->satfreq_up = input->satfreq_up;
+    rc->resync_down = input->resync_down;
+    rc->resync_up = input->resync_up;
+    rc->catnum = input->catnum;
+    rc->prev_ele = input->el;
+
+    rc->engaged = TRUE;
+    rc->lastrxptt = FALSE;
+    rc->lasttxptt = TRUE;
+    rc->last_toggle_tx = -1;
+
+    rc->running = TRUE;
+    rc->thread = g_thread_new("radio_ctrl", radio_ctrl_run, rc);
+
+    return rc;
+}
+
+/**
+ * Stop the controller thread, release the radios and free the controller.
+ *
+ * Must be called from the main loop, since pending notifications are
+ * removed.
+ */
+void radio_ctrl_free(radio_ctrl_t * rc)
+{
+    guint           i;
+
+    if (rc == NULL)
+        return;
+
+    g_mutex_lock(&rc->lock);
+    rc->running = FALSE;
+    g_cond_signal(&rc->cond);
+    g_mutex_unlock(&rc->lock);
+
+    g_thread_join(rc->thread);
+
+    if (rc->idle_id > 0)
+        g_source_remove(rc->idle_id);
+
+    for (i = 0; i < rc->nradios; i++)
+        free_conf(rc->radios[i].conf);
+    g_free(rc->radios);
+    g_free(rc->batches);
+    doppler_table_free(rc->table);
+    doppler_table_free(rc->table_in);
+    g_mutex_clear(&rc->lock);
+    g_cond_clear(&rc->cond);
+    g_free(rc);
+}
+
+/**
+ * Set the input of the controller.
+ *
+ * The input is used from the next cycle on.
+ */
+void radio_ctrl_set_input(radio_ctrl_t * rc, const radio_ctrl_input_t * input)
+{
+    g_mutex_lock(&rc->lock);
+    rc->in = *input;
+    g_mutex_unlock(&rc->lock);
+}
+
+/**
+ * Get the output of the last cycle.
+ *
+ * The dial_changed flag is cleared, so that each dial change is reported
+ * once.
+ */
+void radio_ctrl_get_output(radio_ctrl_t * rc, radio_ctrl_output_t * output)
+{
+    g_mutex_lock(&rc->lock);
+    *output = rc->out;
+    rc->out.dial_changed = FALSE;
+    g_mutex_unlock(&rc->lock);
+}
+
+/** Set the cycle period [msec]. */
+void radio_ctrl_set_cycle(radio_ctrl_t * rc, guint msec)
+{
+    g_mutex_lock(&rc->lock);
+    rc->cycle = msec;
+    g_mutex_unlock(&rc->lock);
+}
+
+/**
+ * Set the Doppler tuning error allowed [Hz].
+ *
+ * With 0, every change of the frequency by 1 Hz or more is sent.
+ */
+void radio_ctrl_set_tolerance(radio_ctrl_t * rc, gdouble hz)
+{
+    g_mutex_lock(&rc->lock);
+    rc->tolerance = MAX(hz, 0.0);
+    g_mutex_unlock(&rc->lock);
+}
+
+/**
+ * Set the Doppler table of the pass.
+ *
+ * The controller uses its own copy from the next cycle on; NULL removes the
+ * table. The input must give the satellite time for the table to be used.
+ */
+void radio_ctrl_set_doppler_table(radio_ctrl_t * rc,
+                                  const doppler_table_t * tab)
+{
+    g_mutex_lock(&rc->lock);
+    doppler_table_free(rc->table_in);
+    rc->table_in = doppler_table_copy(tab);
+    rc->table_changed = TRUE;
+    g_mutex_unlock(&rc->lock);
+}
+
+/**
+ * Toggle PTT, setting the TX frequency first when switching to TX.
+ *
+ * The event is handled by the controller thread as soon as the current
+ * cycle is finished.
+ */
+void radio_ctrl_ptt_event(radio_ctrl_t * rc)
+{
+    g_mutex_lock(&rc->lock);
+    rc->ptt_event = TRUE;
+    g_cond_signal(&rc->cond);
+    g_mutex_unlock(&rc->lock);
+}
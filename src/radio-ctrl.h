@@ -0,0 +1,107 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef RADIO_CTRL_H
+#define RADIO_CTRL_H 1
+
+#include <glib.h>
+
+#include "doppler-table.h"
+#include "radio-conf.h"
+
+
+#define MAX_DOPPLER_LEAD 10000000       /*!< Largest latency compensated for [usec]. */
+#define SPEED_OF_LIGHT 299792.4580      /*!< [km/s] */
+
+/** Opaque radio controller. */
+typedef struct _radio_ctrl radio_ctrl_t;
+
+/** Input of the radio controller, set by the user interface. */
+typedef struct {
+    gboolean        tracking;   /*!< Apply the Doppler shift. */
+    gboolean        trsplock;   /*!< Uplink and downlink are locked. */
+
+    gdouble         satfreq_down;       /*!< Satellite downlink frequency [Hz]. */
+    gdouble         satfreq_up; /*!< Satellite uplink frequency [Hz]. */
+    guint           satfreq_seq;        /*!< Changed when the user changes the
+                                           satellite frequencies. */
+
+    gdouble         dd, du;     /*!< Doppler shift down/up [Hz]. */
+    gdouble         dd_dot, du_dot;     /*!< Rate of change of dd and du [Hz/s]. */
+    gint64          dop_time;   /*!< Monotonic time dd and du were computed [usec]. */
+    gint64          dop_lead;   /*!< Lead time dd and du were predicted for [usec]. */
+    gdouble         jul_time;   /*!< Satellite time at dop_time (Julian date),
+                                   0 if unknown. */
+    gdouble         time_rate;  /*!< Satellite seconds per second; 1 in real time. */
+
+    gint            catnum;     /*!< Catalogue number of the target. */
+    gdouble         el;         /*!< Elevation of the target [deg]. */
+
+    gboolean        have_trsp;  /*!< The transponder passband below is valid. */
+    gdouble         downlow, downhigh;  /*!< Downlink passband [Hz]. */
+    gdouble         uplow, uphigh;      /*!< Uplink passband [Hz]. */
+    gboolean        invert;     /*!< The transponder is inverting. */
+
+    guint           resync_down;        /*!< Changed to invalidate the sync with
+                                           the receiver, e.g. after tuning. */
+    guint           resync_up;  /*!< Same for the transmitter. */
+} radio_ctrl_input_t;
+
+/** Output of the radio controller, shown by the user interface. */
+typedef struct {
+    gdouble         satfreq_down;       /*!< Satellite downlink frequency [Hz]. */
+    gdouble         satfreq_up; /*!< Satellite uplink frequency [Hz]. */
+    gboolean        dial_changed;       /*!< The satellite frequencies were
+                                           changed on the radio dial. */
+    gdouble         rigfreq_down;       /*!< Radio downlink frequency [Hz]. */
+    gdouble         rigfreq_up; /*!< Radio uplink frequency [Hz]. */
+    gboolean        failed;     /*!< Too many errors; the radio was released. */
+    gint64          latency;    /*!< Smoothed command-to-apply latency [usec]. */
+    guint           cycles;     /*!< Number of cycles executed. */
+    gint64          cycle_time; /*!< Duration of the last cycle [usec]. */
+    guint           wrops;      /*!< Number of commands sent. */
+    guint           tunes;      /*!< Frequency commands sent while tracking. */
+    gdouble         tune_error; /*!< Largest tuning error while tracking [Hz]. */
+    guint           table_cycles;       /*!< Cycles that took the Doppler shift
+                                           from the Doppler table. */
+} radio_ctrl_output_t;
+
+/**
+ * Function called in the main loop when the output has changed.
+ *
+ * It is called from an idle callback and not from the controller thread,
+ * so it can update widgets.
+ */
+typedef void    (*radio_ctrl_notify_t) (radio_ctrl_t * rc, gpointer data);
+
+
+radio_ctrl_t   *radio_ctrl_new(const radio_conf_t * const *confs, guint n,
+                               const radio_ctrl_input_t * input,
+                               radio_ctrl_notify_t notify, gpointer data);
+void            radio_ctrl_free(radio_ctrl_t * rc);
+void            radio_ctrl_set_input(radio_ctrl_t * rc,
+                                     const radio_ctrl_input_t * input);
+void            radio_ctrl_get_output(radio_ctrl_t * rc,
+                                      radio_ctrl_output_t * output);
+void            radio_ctrl_set_cycle(radio_ctrl_t * rc, guint msec);
+void            radio_ctrl_set_tolerance(radio_ctrl_t * rc, gdouble hz);
+void            radio_ctrl_set_doppler_table(radio_ctrl_t * rc,
+                                             const doppler_table_t * tab);
+void            radio_ctrl_ptt_event(radio_ctrl_t * rc);
+
+#endif
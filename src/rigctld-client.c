@@ -0,0 +1,622 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Client for the hamlib rigctld network protocol.
+ *
+ * Commands are sent in batches: all commands of a transaction are written
+ * at once and the replies are read back in order. rigctld executes the
+ * commands one after the other, so a set followed by a get returns the
+ * value after the set has completed and no delay is needed between them.
+ *
+ * Replies are framed line by line. A reply ends with an "RPRT n" line, or,
+ * in the default protocol, after the expected number of value lines of a
+ * successful get command. If the server supports the extended response
+ * protocol ('+' prefix) it is used, since every reply then ends with an
+ * RPRT line. Servers that only implement a subset of the protocol, e.g.
+ * SDR programs, get the default protocol.
+ *
+ * A transaction can span several servers: the commands are written to all
+ * of them first, and the replies are collected as they arrive by a single
+ * select() over all sockets. Each radio then costs one round trip in
+ * parallel, instead of one round trip after the other.
+ *
+ * When a transaction times out, the replies to its commands may still
+ * arrive and would be taken for the replies of the next transaction. The
+ * connection is therefore opened again before the next transaction, which
+ * leaves any late replies behind with the old socket.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <arpa/inet.h>          /* htons() */
+#include <netdb.h>              /* gethostbyname() */
+#include <netinet/in.h>         /* struct sockaddr_in */
+#include <sys/select.h>         /* select() */
+#include <sys/socket.h>         /* socket(), connect(), send() */
+#include <unistd.h>             /* close() */
+#else
+#include <winsock2.h>
+#endif
+
+#include "rigctld-client.h"
+#include "sat-log.h"
+
+
+/** Time allowed for all replies of a transaction [msec]. */
+#define RIGCTLD_TIMEOUT 1000
+
+/** Time allowed for the extended protocol probe [msec]. */
+#define PROBE_TIMEOUT 500
+
+#define RXBUF_SIZE 1024
+#define MAX_STATS 16
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+struct _rigctld {
+    gint            sock;       /*!< Connected socket. */
+    gchar          *host;       /*!< Server host, for log messages. */
+    gint            port;       /*!< Server port. */
+    gboolean        extended;   /*!< Use the extended response protocol. */
+    gboolean        stale;      /*!< Late replies may arrive; reconnect. */
+    guint           timeout;    /*!< Transaction timeout [msec]. */
+    gchar           rxbuf[RXBUF_SIZE];  /*!< Received data not yet parsed. */
+    gsize           rxlen;
+
+    /* transaction in progress */
+    rigctld_cmd_t  *cmds;       /*!< Commands waiting for replies or NULL. */
+    guint           ncmds;
+    guint           next;       /*!< First command without a complete reply. */
+    guint           nread;      /*!< Lines read of the reply of cmds[next]. */
+    guint           nvalues;    /*!< Value lines in the reply of cmds[next]. */
+    gint64          t0;         /*!< Time the commands were sent. */
+    gint64          deadline;   /*!< Time the replies are given up. */
+    rigctld_stat_t  stats[MAX_STATS];
+    guint           nstats;
+};
+
+
+static void close_socket(gint sock)
+{
+#ifndef WIN32
+    shutdown(sock, SHUT_RDWR);
+    close(sock);
+#else
+    shutdown(sock, SD_BOTH);
+    closesocket(sock);
+#endif
+}
+
+static gint connect_socket(const gchar * host, gint port)
+{
+    struct sockaddr_in addr;
+    struct hostent *h;
+    gint            sock;
+
+    h = gethostbyname(host);
+    if (h == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not resolve %s"), __func__, host);
+        return -1;
+    }
+
+    sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to create socket"), __func__);
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    memcpy(&addr.sin_addr.s_addr, h->h_addr_list[0], h->h_length);
+    addr.sin_port = htons(port);
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to connect to %s:%d"),
+                    __func__, host, port);
+        close_socket(sock);
+        return -1;
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Connection opened to %s:%d"), __func__, host, port);
+
+    return sock;
+}
+
+/** Take a complete line from the receive buffer, if there is one. */
+static gboolean take_line(rigctld_t * rig, gchar * line, gsize size)
+{
+    gchar          *nl;
+    gsize           len;
+
+    nl = memchr(rig->rxbuf, '\n', rig->rxlen);
+    if (nl == NULL)
+        return FALSE;
+
+    /* rxbuf is not NUL terminated, so it can not be copied as a string */
+    len = nl - rig->rxbuf;
+    memcpy(line, rig->rxbuf, MIN(len, size - 1));
+    line[MIN(len, size - 1)] = '\0';
+    g_strchomp(line);
+
+    rig->rxlen -= len + 1;
+    memmove(rig->rxbuf, nl + 1, rig->rxlen);
+
+    return TRUE;
+}
+
+/**
+ * Receive the data the server has sent.
+ *
+ * @return FALSE if the connection failed.
+ */
+static gboolean receive(rigctld_t * rig)
+{
+    gint            n;
+
+    /* a line longer than the buffer is of no use to us */
+    if (rig->rxlen == RXBUF_SIZE)
+        rig->rxlen = 0;
+
+    n = recv(rig->sock, rig->rxbuf + rig->rxlen, RXBUF_SIZE - rig->rxlen, 0);
+    if (n <= 0)
+        return FALSE;
+
+    rig->rxlen += n;
+
+    return TRUE;
+}
+
+/**
+ * Open a new connection after a transaction timed out or failed.
+ *
+ * @return FALSE if the server could not be reached; the next transaction
+ *         tries again.
+ */
+static gboolean reconnect(rigctld_t * rig)
+{
+    if (rig->sock >= 0)
+        close_socket(rig->sock);
+
+    rig->sock = connect_socket(rig->host, rig->port);
+    rig->rxlen = 0;
+    rig->stale = (rig->sock < 0);
+
+    return !rig->stale;
+}
+
+/** Update the latency counters of a command. */
+static void account(rigctld_t * rig, const rigctld_cmd_t * cmd)
+{
+    rigctld_stat_t *stat = NULL;
+    gchar           name[16];
+    guint           i;
+
+    g_strlcpy(name, cmd->cmd, MIN(strcspn(cmd->cmd, " ") + 1, sizeof(name)));
+
+    for (i = 0; i < rig->nstats; i++)
+    {
+        if (strcmp(rig->stats[i].name, name) == 0)
+        {
+            stat = &rig->stats[i];
+            break;
+        }
+    }
+
+    if (stat == NULL)
+    {
+        if (rig->nstats == MAX_STATS)
+            return;
+
+        stat = &rig->stats[rig->nstats++];
+        g_strlcpy(stat->name, name, sizeof(stat->name));
+    }
+
+    if (cmd->status != 0)
+        stat->errors++;
+
+    if (cmd->status == RIGCTLD_NO_REPLY)
+        return;
+
+    stat->count++;
+    stat->total += cmd->latency;
+    stat->last = cmd->latency;
+    if (cmd->latency > stat->max)
+        stat->max = cmd->latency;
+}
+
+/**
+ * Parse the received replies of the transaction in progress.
+ *
+ * @return TRUE once every command has a complete reply.
+ */
+static gboolean parse_replies(rigctld_t * rig)
+{
+    rigctld_cmd_t  *cmd;
+    gchar           line[128];
+    const gchar    *value;
+
+    while (rig->next < rig->ncmds && take_line(rig, line, sizeof(line)))
+    {
+        cmd = &rig->cmds[rig->next];
+
+        if (g_str_has_prefix(line, "RPRT"))
+        {
+            cmd->status = atoi(line + 4);
+        }
+        else if (rig->extended && rig->nread++ == 0)
+        {
+            /* the first line of an extended reply echoes the command */
+            continue;
+        }
+        else
+        {
+            /* values are the last word, e.g. "Frequency: 145800000" */
+            if (rig->nvalues++ == 0)
+            {
+                value = strrchr(line, ' ');
+                g_strlcpy(cmd->value, value ? value + 1 : line,
+                          sizeof(cmd->value));
+            }
+
+            if (rig->extended || cmd->nlines == 0 ||
+                rig->nvalues < cmd->nlines)
+                continue;
+
+            cmd->status = 0;
+        }
+
+        cmd->latency = g_get_monotonic_time() - rig->t0;
+        account(rig, cmd);
+        rig->next++;
+        rig->nread = 0;
+        rig->nvalues = 0;
+    }
+
+    return rig->next == rig->ncmds;
+}
+
+/**
+ * Connect to a rigctld server.
+ *
+ * @param host The host name of the server.
+ * @param port The port number.
+ * @return The connection, or NULL if the server could not be reached.
+ *         Close it with rigctld_close().
+ */
+rigctld_t      *rigctld_open(const gchar * host, gint port)
+{
+    rigctld_t      *rig;
+    rigctld_cmd_t   cmd;
+    gint            sock;
+
+    sock = connect_socket(host, port);
+    if (sock < 0)
+        return NULL;
+
+    rig = g_new0(rigctld_t, 1);
+    rig->sock = sock;
+    rig->host = g_strdup(host);
+    rig->port = port;
+
+    /* probe for the extended response protocol */
+    rig->extended = TRUE;
+    rig->timeout = PROBE_TIMEOUT;
+    rigctld_cmd_init(&cmd, 1, "f");
+    if (!rigctld_transact(rig, &cmd, 1) || cmd.status != 0)
+    {
+        rig->extended = FALSE;
+        rig->stale = TRUE;
+    }
+    rig->timeout = RIGCTLD_TIMEOUT;
+    memset(rig->stats, 0, sizeof(rig->stats));
+    rig->nstats = 0;
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: %s:%d uses the %s response protocol"), __func__,
+                host, port, rig->extended ? "extended" : "default");
+
+    return rig;
+}
+
+/** Close a rigctld connection and log its latency counters. */
+void rigctld_close(rigctld_t * rig)
+{
+    if (rig == NULL)
+        return;
+
+    if (rig->sock >= 0)
+    {
+        if (send(rig->sock, "q\n", 2, MSG_NOSIGNAL) != 2)
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not send quit to %s:%d"), __func__,
+                        rig->host, rig->port);
+
+        close_socket(rig->sock);
+    }
+
+    rigctld_log_stats(rig);
+    g_free(rig->host);
+    g_free(rig);
+}
+
+/**
+ * Initialise a command.
+ *
+ * @param cmd The command.
+ * @param nlines The number of value lines in the reply of a successful get
+ *               command; 0 for commands that only reply with RPRT.
+ * @param fmt printf() style format of the command, without newline.
+ */
+void rigctld_cmd_init(rigctld_cmd_t * cmd, guint nlines, const gchar * fmt,
+                      ...)
+{
+    va_list         args;
+
+    va_start(args, fmt);
+    g_vsnprintf(cmd->cmd, sizeof(cmd->cmd), fmt, args);
+    va_end(args);
+
+    cmd->nlines = nlines;
+    cmd->status = RIGCTLD_NO_REPLY;
+    cmd->value[0] = '\0';
+    cmd->latency = 0;
+}
+
+/**
+ * Send the commands of a batch.
+ *
+ * @return FALSE if there is no connection or it failed.
+ */
+static gboolean send_batch(rigctld_batch_t * batch)
+{
+    gchar           buf[RIGCTLD_MAX_PIPELINE * (sizeof(batch->cmds->cmd) + 2)];
+    rigctld_t      *rig = batch->rig;
+    rigctld_cmd_t  *cmds = batch->cmds;
+    gsize           len = 0;
+    gint            written;
+    guint           i;
+
+    for (i = 0; i < batch->n; i++)
+    {
+        cmds[i].status = RIGCTLD_NO_REPLY;
+        cmds[i].value[0] = '\0';
+        cmds[i].latency = 0;
+        len += g_snprintf(buf + len, sizeof(buf) - len, "%s%s\n",
+                          (rig && rig->extended) ? "+" : "", cmds[i].cmd);
+    }
+
+    if (rig == NULL)
+        return FALSE;
+
+    if (rig->stale && !reconnect(rig))
+        return FALSE;
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: sending %u commands (%d bytes) to %s:%d"),
+                __func__, batch->n, (gint) len, rig->host, rig->port);
+
+    rig->t0 = g_get_monotonic_time();
+    rig->deadline = rig->t0 + rig->timeout * 1000;
+
+    written = send(rig->sock, buf, len, MSG_NOSIGNAL);
+    if (written != (gint) len)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: rigctld port closed"), __func__);
+        rig->stale = TRUE;
+        return FALSE;
+    }
+
+    rig->cmds = cmds;
+    rig->ncmds = batch->n;
+    rig->next = 0;
+    rig->nread = 0;
+    rig->nvalues = 0;
+
+    return TRUE;
+}
+
+/** Give up the replies that did not arrive. */
+static void fail_batch(rigctld_batch_t * batch)
+{
+    rigctld_t      *rig = batch->rig;
+    guint           i;
+
+    sat_log_log(SAT_LOG_LEVEL_ERROR,
+                _("%s: No reply to \"%s\" from %s:%d"),
+                __func__, rig->cmds[rig->next].cmd, rig->host, rig->port);
+
+    for (i = rig->next; i < rig->ncmds; i++)
+        account(rig, &rig->cmds[i]);
+
+    rig->stale = TRUE;
+    rig->cmds = NULL;
+    batch->ok = FALSE;
+}
+
+/**
+ * Send commands and read their replies.
+ *
+ * @param rig The connection.
+ * @param cmds The commands; status, value and latency are filled in.
+ * @param n The number of commands, at most RIGCTLD_MAX_PIPELINE.
+ * @return FALSE if the connection failed or timed out. Commands without a
+ *         reply have status RIGCTLD_NO_REPLY.
+ *
+ * All commands are sent in one write, so the transaction takes one round
+ * trip plus the time the server needs to execute the commands.
+ */
+gboolean rigctld_transact(rigctld_t * rig, rigctld_cmd_t * cmds, guint n)
+{
+    rigctld_batch_t batch;
+
+    batch.rig = rig;
+    batch.cmds = cmds;
+    batch.n = n;
+
+    return rigctld_transact_all(&batch, 1);
+}
+
+/**
+ * Send commands to several servers and read their replies in parallel.
+ *
+ * @param batches The commands for each server; ok is set if all commands
+ *                of the batch got a reply. A batch may have no commands.
+ * @param n The number of batches.
+ * @return FALSE if any connection failed or timed out.
+ *
+ * The commands are written to all servers before any reply is read, so the
+ * transaction takes as long as the slowest server, not the sum of them.
+ */
+gboolean rigctld_transact_all(rigctld_batch_t * batches, guint n)
+{
+    rigctld_batch_t *batch;
+    rigctld_t      *rig;
+    struct timeval  tv;
+    fd_set          fds;
+    gint64          now, wait;
+    gboolean        retval = TRUE;
+    gint            maxfd, res;
+    guint           i;
+
+    for (i = 0; i < n; i++)
+    {
+        batch = &batches[i];
+        g_return_val_if_fail(batch->n <= RIGCTLD_MAX_PIPELINE, FALSE);
+
+        batch->ok = (batch->n == 0);
+        if (batch->n > 0 && !send_batch(batch))
+            retval = FALSE;
+    }
+
+    for (;;)
+    {
+        /* collect the sockets still waiting for replies */
+        FD_ZERO(&fds);
+        maxfd = -1;
+        now = g_get_monotonic_time();
+        wait = G_MAXINT64;
+
+        for (i = 0; i < n; i++)
+        {
+            batch = &batches[i];
+            rig = batch->rig;
+            if (rig == NULL || rig->cmds != batch->cmds || batch->ok)
+                continue;
+
+            if (parse_replies(rig))
+            {
+                rig->cmds = NULL;
+                batch->ok = TRUE;
+            }
+            else if (now >= rig->deadline)
+            {
+                fail_batch(batch);
+                retval = FALSE;
+            }
+            else
+            {
+                FD_SET(rig->sock, &fds);
+                maxfd = MAX(maxfd, rig->sock);
+                wait = MIN(wait, rig->deadline - now);
+            }
+        }
+
+        if (maxfd < 0)
+            break;
+
+        tv.tv_sec = wait / G_USEC_PER_SEC;
+        tv.tv_usec = wait % G_USEC_PER_SEC;
+        res = select(maxfd + 1, &fds, NULL, NULL, &tv);
+        if (res < 0 && errno == EINTR)
+            continue;
+
+        for (i = 0; i < n; i++)
+        {
+            batch = &batches[i];
+            rig = batch->rig;
+            if (rig == NULL || rig->cmds != batch->cmds || batch->ok)
+                continue;
+
+            /* a failed select() is not retried */
+            if (res < 0 ||
+                (FD_ISSET(rig->sock, &fds) && !receive(rig)))
+            {
+                sat_log_log(SAT_LOG_LEVEL_ERROR,
+                            _("%s: rigctld port closed"), __func__);
+                fail_batch(batch);
+                retval = FALSE;
+            }
+        }
+    }
+
+    return retval;
+}
+
+/**
+ * Get the latency counters of a connection.
+ *
+ * @param rig The connection.
+ * @param stats Location for the counters, one per command name.
+ * @return The number of counters.
+ */
+guint rigctld_get_stats(rigctld_t * rig, const rigctld_stat_t ** stats)
+{
+    *stats = rig->stats;
+
+    return rig->nstats;
+}
+
+/** Write the latency counters of a connection to the debug log. */
+void rigctld_log_stats(rigctld_t * rig)
+{
+    rigctld_stat_t *stat;
+    guint           i;
+
+    for (i = 0; i < rig->nstats; i++)
+    {
+        stat = &rig->stats[i];
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: %s:%d %-10s n=%u err=%u avg=%.1f ms "
+                      "max=%.1f ms last=%.1f ms"), __func__,
+                    rig->host, rig->port, stat->name, stat->count,
+                    stat->errors,
+                    stat->count ? stat->total / 1000.0 / stat->count : 0.0,
+                    stat->max / 1000.0, stat->last / 1000.0);
+    }
+}
@@ -0,0 +1,73 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef RIGCTLD_CLIENT_H
+#define RIGCTLD_CLIENT_H 1
+
+#include <glib.h>
+
+
+/** Maximum number of commands sent in one transaction. */
+#define RIGCTLD_MAX_PIPELINE 8
+
+/** Status of a command that did not get a reply. */
+#define RIGCTLD_NO_REPLY -1000
+
+/** Opaque connection to a rigctld compatible server. */
+typedef struct _rigctld rigctld_t;
+
+/** A command and its reply. */
+typedef struct {
+    gchar           cmd[64];    /*!< Command without the trailing newline. */
+    guint           nlines;     /*!< Value lines in a successful reply. */
+    gint            status;     /*!< RPRT code; 0 on success. */
+    gchar           value[64];  /*!< First value of the reply, if any. */
+    gint64          latency;    /*!< Time from sending to reply [usec]. */
+} rigctld_cmd_t;
+
+/** The commands for one server in a transaction with several servers. */
+typedef struct {
+    rigctld_t      *rig;        /*!< The connection; may be NULL. */
+    rigctld_cmd_t  *cmds;       /*!< The commands. */
+    guint           n;          /*!< Number of commands. */
+    gboolean        ok;         /*!< All commands got a reply. */
+} rigctld_batch_t;
+
+/** Latency counters of one command. */
+typedef struct {
+    gchar           name[16];   /*!< Command name (first word of the command). */
+    guint           count;      /*!< Number of replies. */
+    guint           errors;     /*!< Number of error replies and timeouts. */
+    gint64          total;      /*!< Sum of the latencies [usec]. */
+    gint64          max;        /*!< Largest latency [usec]. */
+    gint64          last;       /*!< Latency of the last reply [usec]. */
+} rigctld_stat_t;
+
+
+rigctld_t      *rigctld_open(const gchar * host, gint port);
+void            rigctld_close(rigctld_t * rig);
+void            rigctld_cmd_init(rigctld_cmd_t * cmd, guint nlines,
+                                 const gchar * fmt, ...) G_GNUC_PRINTF(3, 4);
+gboolean        rigctld_transact(rigctld_t * rig, rigctld_cmd_t * cmds,
+                                 guint n);
+gboolean        rigctld_transact_all(rigctld_batch_t * batches, guint n);
+guint           rigctld_get_stats(rigctld_t * rig,
+                                  const rigctld_stat_t ** stats);
+void            rigctld_log_stats(rigctld_t * rig);
+
+#endif
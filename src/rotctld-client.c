@@ -0,0 +1,918 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Client for the hamlib rotctld network protocol.
+ *
+ * All rotators are served by one I/O thread that waits in poll() on the
+ * sockets of every connection, so a rotctld that stops answering can not
+ * hold up the others or the caller. The sockets are non-blocking, and every
+ * state that waits for the network has a deadline:
+ *
+ *   DISCONNECTED  waiting for the next connection attempt
+ *   CONNECTING    non-blocking connect() in progress
+ *   IDLE          connected, waiting for the next command cycle
+ *   BUSY          a command has been sent and its reply is pending
+ *
+ * Each cycle sends the new target, if there is one, and reads back the
+ * position. Cycles start every cadence milliseconds, but the rotator is
+ * never kept busy more than half of the time. A command that is not
+ * answered within the timeout drops the connection, since a late reply
+ * would be taken for the reply to the next command. Connections that fail
+ * are retried with an exponential backoff.
+ *
+ * The host name is resolved by the I/O thread before each connection
+ * attempt, with the lock released, so a slow name server does not block the
+ * caller either.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <fcntl.h>              /* fcntl() */
+#include <netdb.h>              /* getaddrinfo() */
+#include <netinet/in.h>         /* struct sockaddr_in */
+#include <poll.h>               /* poll() */
+#include <sys/socket.h>         /* socket(), connect(), send() */
+#include <unistd.h>             /* close(), pipe() */
+#else
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define poll WSAPoll
+#endif
+
+#include "rotctld-client.h"
+#include "sat-log.h"
+
+
+/** Time allowed for establishing a connection [msec]. */
+#define CONNECT_TIMEOUT 5000
+
+/** First and largest delay between connection attempts [msec]. */
+#define RECONNECT_MIN 500
+#define RECONNECT_MAX 30000
+
+/** Shortest cadence [msec]. */
+#define MIN_CADENCE 100
+
+/** Longest time the I/O thread sleeps without checking its rotators. */
+#ifndef WIN32
+#define MAX_WAIT G_USEC_PER_SEC
+#else
+#define MAX_WAIT (G_USEC_PER_SEC / 10)  /* no wake-up pipe */
+#endif
+
+/** Status of a reply that could not be parsed. */
+#define BAD_REPLY -1000
+
+#define RXBUF_SIZE 256
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+typedef enum {
+    ROT_DISCONNECTED = 0,
+    ROT_CONNECTING,
+    ROT_IDLE,
+    ROT_BUSY
+} rot_state_t;
+
+typedef struct {
+    gchar           cmd[32];    /*!< Command without the trailing newline. */
+    guint           nvalues;    /*!< Value lines in a successful reply. */
+} rot_cmd_t;
+
+struct _rotctld {
+    gchar          *host;       /*!< Server host, for log messages. */
+    gint            port;       /*!< Server port. */
+    struct sockaddr_storage addr;       /*!< Resolved server address. */
+    socklen_t       addrlen;    /*!< Length of addr; 0 if not resolved. */
+    guint           cadence;    /*!< Time between command cycles [msec]. */
+    guint           timeout;    /*!< Time allowed for a reply [msec]. */
+
+    /* requests from the owner */
+    gdouble         trg_az;     /*!< Target azimuth. */
+    gdouble         trg_el;     /*!< Target elevation. */
+    gboolean        new_trg;    /*!< The target has not been sent yet. */
+    gboolean        stop;       /*!< Send a stop command. */
+    gboolean        closing;    /*!< Close the connection and free. */
+
+    rotctld_status_t status;
+
+    /* I/O thread state */
+    rot_state_t     state;
+    gint            sock;       /*!< Socket, or -1. */
+    gint            pfd;        /*!< Index in the poll set, or -1. */
+    gshort          revents;    /*!< Events returned by the last poll. */
+    gboolean        attempted;  /*!< A connection has been attempted. */
+    guint           backoff;    /*!< Delay before the next attempt [msec]. */
+    gint64          next_cycle; /*!< Start of the next cycle or attempt. */
+    gint64          cycle_start;
+    gint64          deadline;   /*!< Deadline of the connect or command. */
+    gint64          sent;       /*!< Time the current command was sent. */
+    gboolean        cycle_error;
+    rot_cmd_t       cmds[2];    /*!< Commands of the current cycle. */
+    guint           ncmds;
+    guint           cur;        /*!< Index of the pending command. */
+    gchar           txbuf[40];  /*!< Pending command, with newline. */
+    gsize           txlen;
+    gsize           txoff;      /*!< Bytes of txbuf already sent. */
+    gchar           rxbuf[RXBUF_SIZE];  /*!< Received data not yet parsed. */
+    gsize           rxlen;
+    gchar           values[2][64];      /*!< Value lines of the reply. */
+    guint           nvalues;
+};
+
+/* The I/O thread and the rotators it serves. The thread holds the mutex
+   except while it waits in poll(), so the public functions never wait for
+   network I/O. */
+static GMutex   loop_mutex;
+static GList   *rotators = NULL;
+static gboolean loop_running = FALSE;
+static gint     wake_fd[2] = { -1, -1 };
+
+
+static void close_socket(gint sock)
+{
+#ifndef WIN32
+    shutdown(sock, SHUT_RDWR);
+    close(sock);
+#else
+    shutdown(sock, SD_BOTH);
+    closesocket(sock);
+#endif
+}
+
+static gboolean set_nonblocking(gint sock)
+{
+#ifndef WIN32
+    gint            flags;
+
+    flags = fcntl(sock, F_GETFL, 0);
+
+    return flags >= 0 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+#else
+    u_long          mode = 1;
+
+    return ioctlsocket(sock, FIONBIO, &mode) == 0;
+#endif
+}
+
+/** Whether the last socket call failed only because it would block. */
+static gboolean would_block(void)
+{
+#ifndef WIN32
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS ||
+        errno == EINTR;
+#else
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#endif
+}
+
+/** Interrupt the poll() of the I/O thread. */
+static void wake_loop(void)
+{
+#ifndef WIN32
+    if (wake_fd[1] >= 0 && write(wake_fd[1], "w", 1) < 0 && errno != EAGAIN)
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not wake the rotctld thread: %s"),
+                    __func__, strerror(errno));
+#endif
+}
+
+static void log_stats(rotctld_t * rot)
+{
+    rotctld_status_t *st = &rot->status;
+    guint           replies = st->commands - st->timeouts;
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: %s:%d cycles=%u cmds=%u err=%u (%.1f%%) timeouts=%u "
+                  "reconnects=%u rtt avg=%.1f ms max=%.1f ms"), __func__,
+                rot->host, rot->port, st->cycles, st->commands, st->errors,
+                st->commands ? 100.0 * st->errors / st->commands : 0.0,
+                st->timeouts, st->reconnects,
+                replies ? st->rtt_total / 1000.0 / replies : 0.0,
+                st->rtt_max / 1000.0);
+}
+
+/** Drop the connection and schedule the next attempt. */
+static void connection_failed(rotctld_t * rot, gint64 now)
+{
+    /* a target that has not been acknowledged is sent again */
+    if (rot->state == ROT_BUSY && rot->cmds[rot->cur].cmd[0] == 'P')
+        rot->new_trg = TRUE;
+
+    if (rot->sock >= 0)
+        close_socket(rot->sock);
+
+    rot->sock = -1;
+    rot->state = ROT_DISCONNECTED;
+    rot->status.connected = FALSE;
+    rot->status.io_error = TRUE;
+    rot->next_cycle = now + rot->backoff * 1000;
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Reconnecting to %s:%d in %u ms"), __func__,
+                rot->host, rot->port, rot->backoff);
+
+    rot->backoff = MIN(rot->backoff * 2, RECONNECT_MAX);
+}
+
+/**
+ * Resolve the host name of a rotator.
+ *
+ * Called by the I/O thread without the lock; addr and addrlen are only
+ * used by the I/O thread.
+ */
+static void resolve(rotctld_t * rot)
+{
+    struct addrinfo hints;
+    struct addrinfo *res;
+    gchar           port[8];
+    gint            err;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    g_snprintf(port, sizeof(port), "%d", rot->port);
+
+    err = getaddrinfo(rot->host, port, &hints, &res);
+    if (err != 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not resolve %s: %s"), __func__,
+                    rot->host, gai_strerror(err));
+        rot->addrlen = 0;
+        return;
+    }
+
+    memcpy(&rot->addr, res->ai_addr, res->ai_addrlen);
+    rot->addrlen = res->ai_addrlen;
+    freeaddrinfo(res);
+}
+
+/**
+ * Resolve the host names of the rotators due for a connection attempt.
+ *
+ * Called with the lock held, which is released while resolving. Only the
+ * I/O thread removes rotators, so the ones collected stay valid.
+ */
+static void resolve_due(gint64 now)
+{
+    GList          *due = NULL;
+    GList          *node;
+    rotctld_t      *rot;
+
+    for (node = rotators; node != NULL; node = node->next)
+    {
+        rot = node->data;
+        if (rot->state == ROT_DISCONNECTED && !rot->closing &&
+            now >= rot->next_cycle)
+            due = g_list_prepend(due, rot);
+    }
+
+    if (due == NULL)
+        return;
+
+    g_mutex_unlock(&loop_mutex);
+    for (node = due; node != NULL; node = node->next)
+        resolve(node->data);
+    g_mutex_lock(&loop_mutex);
+
+    g_list_free(due);
+}
+
+static void start_connect(rotctld_t * rot, gint64 now)
+{
+    if (rot->attempted)
+        rot->status.reconnects++;
+    rot->attempted = TRUE;
+
+    if (rot->addrlen == 0)
+    {
+        connection_failed(rot, now);
+        return;
+    }
+
+    rot->sock = socket(rot->addr.ss_family, SOCK_STREAM, IPPROTO_TCP);
+    if (rot->sock < 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to create socket"), __func__);
+        connection_failed(rot, now);
+        return;
+    }
+
+    if (!set_nonblocking(rot->sock))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to make socket non-blocking"), __func__);
+        connection_failed(rot, now);
+        return;
+    }
+
+    rot->state = ROT_CONNECTING;
+    rot->deadline = now + CONNECT_TIMEOUT * 1000;
+
+    if (connect(rot->sock, (struct sockaddr *)&rot->addr,
+                rot->addrlen) < 0 && !would_block())
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to connect to %s:%d: %s"), __func__,
+                    rot->host, rot->port, strerror(errno));
+        connection_failed(rot, now);
+    }
+}
+
+static void finish_connect(rotctld_t * rot, gint64 now)
+{
+    socklen_t       len = sizeof(gint);
+    gint            err = 0;
+
+    if (getsockopt(rot->sock, SOL_SOCKET, SO_ERROR, (void *)&err, &len) < 0)
+        err = errno;
+
+    if (err != 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to connect to %s:%d: %s"), __func__,
+                    rot->host, rot->port, strerror(err));
+        connection_failed(rot, now);
+        return;
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Connection opened to %s:%d"), __func__,
+                rot->host, rot->port);
+
+    rot->state = ROT_IDLE;
+    rot->status.connected = TRUE;
+    rot->rxlen = 0;
+    rot->next_cycle = now;
+}
+
+/** Send what is left of the pending command. */
+static gboolean send_pending(rotctld_t * rot)
+{
+    gint            n;
+
+    n = send(rot->sock, rot->txbuf + rot->txoff, rot->txlen - rot->txoff,
+             MSG_NOSIGNAL);
+    if (n < 0)
+        return would_block();
+
+    rot->txoff += n;
+
+    return TRUE;
+}
+
+static void send_command(rotctld_t * rot, gint64 now)
+{
+    rot_cmd_t      *cmd = &rot->cmds[rot->cur];
+
+    rot->txlen = g_snprintf(rot->txbuf, sizeof(rot->txbuf), "%s\n", cmd->cmd);
+    rot->txoff = 0;
+    rot->nvalues = 0;
+    rot->sent = now;
+    rot->deadline = now + rot->timeout * 1000;
+    rot->state = ROT_BUSY;
+    rot->status.commands++;
+
+    if (!send_pending(rot))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: rotctld port %s:%d closed"), __func__,
+                    rot->host, rot->port);
+        connection_failed(rot, now);
+    }
+}
+
+static void add_command(rotctld_t * rot, guint nvalues, const gchar * cmd)
+{
+    g_strlcpy(rot->cmds[rot->ncmds].cmd, cmd, sizeof(rot->cmds[0].cmd));
+    rot->cmds[rot->ncmds].nvalues = nvalues;
+    rot->ncmds++;
+}
+
+static void start_cycle(rotctld_t * rot, gint64 now)
+{
+    gchar           az[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar           el[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar          *cmd;
+
+    rot->ncmds = 0;
+    rot->cur = 0;
+    rot->cycle_start = now;
+    rot->cycle_error = FALSE;
+
+    if (rot->stop)
+    {
+        add_command(rot, 0, "S");
+        rot->stop = FALSE;
+        rot->new_trg = FALSE;
+    }
+    else
+    {
+        if (rot->new_trg)
+        {
+            /* rotctld expects a decimal point regardless of locale */
+            cmd = g_strdup_printf("P %s %s",
+                                  g_ascii_formatd(az, sizeof(az), "%.2f",
+                                                  rot->trg_az),
+                                  g_ascii_formatd(el, sizeof(el), "%.2f",
+                                                  rot->trg_el));
+            add_command(rot, 0, cmd);
+            g_free(cmd);
+            rot->new_trg = FALSE;
+        }
+        add_command(rot, 2, "p");
+    }
+
+    send_command(rot, now);
+}
+
+static void end_cycle(rotctld_t * rot, gint64 now)
+{
+    rot->state = ROT_IDLE;
+    rot->status.cycles++;
+    rot->status.io_error = rot->cycle_error;
+
+    /* keep the rotator busy at most half of the time */
+    rot->next_cycle = MAX(rot->cycle_start + rot->cadence * 1000,
+                          now + (now - rot->cycle_start));
+}
+
+static void finish_command(rotctld_t * rot, gint retcode, gint64 now)
+{
+    rotctld_status_t *st = &rot->status;
+    rot_cmd_t      *cmd = &rot->cmds[rot->cur];
+    gint64          rtt = now - rot->sent;
+
+    st->rtt_last = rtt;
+    st->rtt_total += rtt;
+    if (rtt > st->rtt_max)
+        st->rtt_max = rtt;
+
+    if (retcode != 0)
+    {
+        st->errors++;
+        rot->cycle_error = TRUE;
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: %s:%d returned error %d to \"%s\""), __func__,
+                    rot->host, rot->port, retcode, cmd->cmd);
+
+        /* retry the target in the next cycle unless there is a newer one */
+        if (cmd->cmd[0] == 'P')
+            rot->new_trg = TRUE;
+    }
+    else
+    {
+        rot->backoff = RECONNECT_MIN;
+        if (cmd->nvalues == 2)
+        {
+            st->az = g_strtod(rot->values[0], NULL);
+            st->el = g_strtod(rot->values[1], NULL);
+            st->valid = TRUE;
+        }
+    }
+
+    if (++rot->cur < rot->ncmds)
+        send_command(rot, now);
+    else
+        end_cycle(rot, now);
+}
+
+/**
+ * Handle one line of a reply.
+ *
+ * A reply is an "RPRT n" line, or the value lines of a successful get
+ * command.
+ */
+static void handle_line(rotctld_t * rot, gchar * line, gint64 now)
+{
+    rot_cmd_t      *cmd = &rot->cmds[rot->cur];
+
+    if (strncmp(line, "RPRT", 4) == 0)
+    {
+        finish_command(rot, atoi(line + 4), now);
+    }
+    else if (rot->nvalues < cmd->nvalues)
+    {
+        g_strlcpy(rot->values[rot->nvalues++], line, sizeof(rot->values[0]));
+        if (rot->nvalues == cmd->nvalues)
+            finish_command(rot, 0, now);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: %s:%d returned bad response (%s)"), __func__,
+                    rot->host, rot->port, line);
+        finish_command(rot, BAD_REPLY, now);
+    }
+}
+
+/** Read what is available on the socket and handle complete lines. */
+static void receive(rotctld_t * rot, gint64 now)
+{
+    gchar          *nl;
+    gsize           len;
+    gint            n;
+
+    n = recv(rot->sock, rot->rxbuf + rot->rxlen, RXBUF_SIZE - rot->rxlen, 0);
+    if (n == 0 || (n < 0 && !would_block()))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Connection to %s:%d lost"), __func__,
+                    rot->host, rot->port);
+        connection_failed(rot, now);
+        return;
+    }
+
+    if (n < 0)
+        return;
+
+    rot->rxlen += n;
+
+    while (rot->state == ROT_BUSY &&
+           (nl = memchr(rot->rxbuf, '\n', rot->rxlen)) != NULL)
+    {
+        *nl = '\0';
+        len = nl - rot->rxbuf;
+        handle_line(rot, g_strchomp(rot->rxbuf), now);
+        rot->rxlen -= len + 1;
+        memmove(rot->rxbuf, nl + 1, rot->rxlen);
+    }
+
+    /* data outside of a reply or a line longer than the buffer is junk */
+    if (rot->state != ROT_BUSY || rot->rxlen == RXBUF_SIZE)
+        rot->rxlen = 0;
+}
+
+static void free_rotator(rotctld_t * rot)
+{
+    if (rot->sock >= 0)
+    {
+        if (rot->state == ROT_IDLE &&
+            send(rot->sock, "q\n", 2, MSG_NOSIGNAL) != 2)
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not send quit to %s:%d"), __func__,
+                        rot->host, rot->port);
+        close_socket(rot->sock);
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Connection to %s:%d closed"), __func__,
+                rot->host, rot->port);
+    log_stats(rot);
+
+    g_free(rot->host);
+    g_free(rot);
+}
+
+/**
+ * Advance the state of a rotator.
+ *
+ * @return FALSE if the rotator has been closed and can be freed.
+ */
+static gboolean service(rotctld_t * rot, gint64 now)
+{
+    gshort          revents = rot->revents;
+
+    rot->revents = 0;
+
+    switch (rot->state)
+    {
+    case ROT_DISCONNECTED:
+        if (rot->closing)
+            return FALSE;
+        if (now >= rot->next_cycle)
+            start_connect(rot, now);
+        break;
+
+    case ROT_CONNECTING:
+        if (rot->closing)
+            return FALSE;
+        if (revents)
+            finish_connect(rot, now);
+        else if (now >= rot->deadline)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Timeout connecting to %s:%d"), __func__,
+                        rot->host, rot->port);
+            connection_failed(rot, now);
+        }
+        break;
+
+    case ROT_IDLE:
+        if (revents)
+            receive(rot, now);
+        else if (rot->stop)
+            start_cycle(rot, now);
+        else if (rot->closing)
+            return FALSE;
+        else if (now >= rot->next_cycle)
+            start_cycle(rot, now);
+        break;
+
+    case ROT_BUSY:
+        if ((revents & POLLOUT) && !send_pending(rot))
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: rotctld port %s:%d closed"), __func__,
+                        rot->host, rot->port);
+            connection_failed(rot, now);
+        }
+        else if (revents & (POLLIN | POLLERR | POLLHUP))
+            receive(rot, now);
+        else if (now >= rot->deadline)
+        {
+            rot->status.timeouts++;
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: No reply to \"%s\" from %s:%d within %u ms"),
+                        __func__, rot->cmds[rot->cur].cmd, rot->host,
+                        rot->port, rot->timeout);
+            connection_failed(rot, now);
+        }
+        break;
+    }
+
+    return TRUE;
+}
+
+/** The events to poll for and the time of the next deadline. */
+static gshort wanted_events(rotctld_t * rot, gint64 now, gint64 * next)
+{
+    switch (rot->state)
+    {
+    case ROT_DISCONNECTED:
+        *next = rot->closing ? now : rot->next_cycle;
+        return 0;
+
+    case ROT_CONNECTING:
+        *next = rot->closing ? now : rot->deadline;
+        return POLLOUT;
+
+    case ROT_IDLE:
+        *next = (rot->stop || rot->closing) ? now : rot->next_cycle;
+        return POLLIN;
+
+    case ROT_BUSY:
+    default:
+        *next = rot->deadline;
+        return (rot->txoff < rot->txlen) ? POLLIN | POLLOUT : POLLIN;
+    }
+}
+
+/** Close the wake-up pipe of the I/O thread. Called with the lock held. */
+static void close_wake_pipe(void)
+{
+#ifndef WIN32
+    if (wake_fd[0] < 0)
+        return;
+
+    close(wake_fd[0]);
+    close(wake_fd[1]);
+    wake_fd[0] = wake_fd[1] = -1;
+#endif
+}
+
+/* The I/O thread. It runs as long as there are rotators to serve. */
+static gpointer loop_thread(gpointer data)
+{
+    struct pollfd  *pfds = NULL;
+    guint           size = 0;
+    guint           n;
+    GList          *node, *next_node;
+    rotctld_t      *rot;
+    gint64          now, next, wait;
+    gchar           buf[16];
+    gint            res = 0;
+
+    (void)data;
+
+    g_mutex_lock(&loop_mutex);
+
+    while (rotators != NULL)
+    {
+        resolve_due(g_get_monotonic_time());
+
+        now = g_get_monotonic_time();
+        wait = MAX_WAIT;
+        n = 0;
+
+        if (size < g_list_length(rotators) + 1)
+        {
+            size = g_list_length(rotators) + 1;
+            pfds = g_renew(struct pollfd, pfds, size);
+        }
+
+        if (wake_fd[0] >= 0)
+        {
+            pfds[n].fd = wake_fd[0];
+            pfds[n].events = POLLIN;
+            pfds[n].revents = 0;
+            n++;
+        }
+
+        for (node = rotators; node != NULL; node = next_node)
+        {
+            next_node = node->next;
+            rot = node->data;
+
+            if (!service(rot, now))
+            {
+                rotators = g_list_delete_link(rotators, node);
+                free_rotator(rot);
+                continue;
+            }
+
+            rot->pfd = -1;
+            pfds[n].events = wanted_events(rot, now, &next);
+            if (pfds[n].events)
+            {
+                pfds[n].fd = rot->sock;
+                pfds[n].revents = 0;
+                rot->pfd = n++;
+            }
+            wait = MIN(wait, next - now);
+        }
+
+        if (rotators == NULL)
+            break;
+
+        g_mutex_unlock(&loop_mutex);
+        res = poll(pfds, n, (gint) ((MAX(wait, 0) + 999) / 1000));
+        g_mutex_lock(&loop_mutex);
+
+        if (res < 0 && errno != EINTR)
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: poll() failed: %s"), __func__,
+                        strerror(errno));
+
+#ifndef WIN32
+        if (res > 0 && (pfds[0].revents & POLLIN))
+            while (read(wake_fd[0], buf, sizeof(buf)) > 0);
+#else
+        (void)buf;
+#endif
+
+        /* rotators added while polling have pfd -1 */
+        for (node = rotators; node != NULL; node = node->next)
+        {
+            rot = node->data;
+            if (res > 0 && rot->pfd >= 0)
+                rot->revents = pfds[rot->pfd].revents;
+        }
+    }
+
+    /* the last rotator has been closed and released */
+    close_wake_pipe();
+    loop_running = FALSE;
+    g_mutex_unlock(&loop_mutex);
+    g_free(pfds);
+
+    return NULL;
+}
+
+/** Create the wake-up pipe of the I/O thread. Called with the lock held. */
+static void create_wake_pipe(void)
+{
+#ifndef WIN32
+    if (wake_fd[0] >= 0)
+        return;
+
+    if (pipe(wake_fd) < 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Could not create pipe: %s"), __func__,
+                    strerror(errno));
+        wake_fd[0] = wake_fd[1] = -1;
+        return;
+    }
+
+    set_nonblocking(wake_fd[0]);
+    set_nonblocking(wake_fd[1]);
+#endif
+}
+
+/**
+ * Start controlling a rotator through a rotctld server.
+ *
+ * @param host The host name of the server.
+ * @param port The port number.
+ * @param cadence The time between command cycles [msec].
+ * @param timeout The time allowed for the reply to a command [msec].
+ * @return The connection. Close it with rotctld_close().
+ *
+ * The host name is resolved and the connection is made in the background
+ * by the I/O thread, and both are retried if they fail.
+ */
+rotctld_t      *rotctld_open(const gchar * host, gint port, guint cadence,
+                             guint timeout)
+{
+    rotctld_t      *rot;
+
+    rot = g_new0(rotctld_t, 1);
+    rot->host = g_strdup(host);
+    rot->port = port;
+    rot->cadence = MAX(cadence, MIN_CADENCE);
+    rot->timeout = timeout;
+    rot->state = ROT_DISCONNECTED;
+    rot->sock = -1;
+    rot->pfd = -1;
+    rot->backoff = RECONNECT_MIN;
+    rot->next_cycle = g_get_monotonic_time();
+
+    g_mutex_lock(&loop_mutex);
+    rotators = g_list_append(rotators, rot);
+    if (loop_running)
+    {
+        wake_loop();
+    }
+    else
+    {
+        create_wake_pipe();
+        loop_running = TRUE;
+        g_thread_unref(g_thread_new("gpredict_rotctl", loop_thread, NULL));
+    }
+    g_mutex_unlock(&loop_mutex);
+
+    return rot;
+}
+
+/**
+ * Stop controlling a rotator.
+ *
+ * @param rot The connection.
+ * @param stop Whether to send a stop command to the rotator first.
+ *
+ * The function does not wait for the network. The connection is closed and
+ * freed by the I/O thread once the pending command has completed or timed
+ * out, and it must not be used after this call.
+ */
+void rotctld_close(rotctld_t * rot, gboolean stop)
+{
+    if (rot == NULL)
+        return;
+
+    g_mutex_lock(&loop_mutex);
+    rot->closing = TRUE;
+    rot->stop = stop && rot->status.connected;
+    wake_loop();
+    g_mutex_unlock(&loop_mutex);
+}
+
+/** Set the time between command cycles [msec]. */
+void rotctld_set_cadence(rotctld_t * rot, guint cadence)
+{
+    g_mutex_lock(&loop_mutex);
+    rot->cadence = MAX(cadence, MIN_CADENCE);
+    g_mutex_unlock(&loop_mutex);
+}
+
+/**
+ * Set a new target position.
+ *
+ * The position is sent at the start of the next command cycle. A target
+ * that has not been sent yet is replaced.
+ */
+void rotctld_set_target(rotctld_t * rot, gdouble az, gdouble el)
+{
+    g_mutex_lock(&loop_mutex);
+    rot->trg_az = az;
+    rot->trg_el = el;
+    rot->new_trg = TRUE;
+    g_mutex_unlock(&loop_mutex);
+}
+
+/** Get the last position read from the rotator and the counters. */
+void rotctld_get_status(rotctld_t * rot, rotctld_status_t * status)
+{
+    g_mutex_lock(&loop_mutex);
+    *status = rot->status;
+    g_mutex_unlock(&loop_mutex);
+}
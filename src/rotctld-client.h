@@ -0,0 +1,56 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef ROTCTLD_CLIENT_H
+#define ROTCTLD_CLIENT_H 1
+
+#include <glib.h>
+
+
+/** Default time allowed for the reply to a command [msec]. */
+#define ROTCTLD_TIMEOUT 1000
+
+/** Opaque connection to a rotctld compatible server. */
+typedef struct _rotctld rotctld_t;
+
+/** Rotator status and counters. */
+typedef struct {
+    gdouble         az;         /*!< Last azimuth read from the rotator. */
+    gdouble         el;         /*!< Last elevation read from the rotator. */
+    gboolean        valid;      /*!< The position has been read at least once. */
+    gboolean        connected;  /*!< Connected to the server. */
+    gboolean        io_error;   /*!< The last cycle failed or no connection. */
+    guint           cycles;     /*!< Completed command cycles. */
+    guint           commands;   /*!< Commands sent. */
+    guint           errors;     /*!< Error and malformed replies. */
+    guint           timeouts;   /*!< Commands without reply in time. */
+    guint           reconnects; /*!< Connection attempts after the first. */
+    gint64          rtt_total;  /*!< Sum of the round-trip times [usec]. */
+    gint64          rtt_max;    /*!< Largest round-trip time [usec]. */
+    gint64          rtt_last;   /*!< Round-trip time of the last reply [usec]. */
+} rotctld_status_t;
+
+
+rotctld_t      *rotctld_open(const gchar * host, gint port, guint cadence,
+                             guint timeout);
+void            rotctld_close(rotctld_t * rot, gboolean stop);
+void            rotctld_set_cadence(rotctld_t * rot, guint cadence);
+void            rotctld_set_target(rotctld_t * rot, gdouble az, gdouble el);
+void            rotctld_get_status(rotctld_t * rot, rotctld_status_t * status);
+
+#endif
@@ -45,10 +45,36 @@
 #define KEY_MAXEL       "MaxEl"
 #define KEY_AZSTOPPOS   "AzStopPos"
 #define KEY_THLD        "Threshold"
+#define KEY_AZRATE      "AzRate"
+#define KEY_ELRATE      "ElRate"
+#define KEY_LEAD        "Lead"
 
 #define DEFAULT_CYCLE_MS    1000
 #define DEFAULT_THLD_DEG    5.0
 
+/* Read an optional non-negative value, falling back to the default */
+static gdouble read_optional_double(GKeyFile * cfg, const gchar * key,
+                                    gdouble def)
+{
+    GError         *error = NULL;
+    gdouble         value;
+
+    if (!g_key_file_has_key(cfg, GROUP, key, NULL))
+        return def;
+
+    value = g_key_file_get_double(cfg, GROUP, key, &error);
+    if (error != NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Invalid %s (%s). Using %.1f."),
+                    __func__, key, error->message, def);
+        g_clear_error(&error);
+        return def;
+    }
+
+    return MAX(value, 0.0);
+}
+
 /**
  * \brief Read rotator configuration.
  * \param conf Pointer to a rotor_conf_t structure where the data will be
@@ -216,6 +242,11 @@ gboolean rotor_conf_read(rotor_conf_t * conf)
         conf->azstoppos = conf->minaz;
     }
 
+    /* slew rates and lead time are only saved if not default */
+    conf->azrate = read_optional_double(cfg, KEY_AZRATE, DEFAULT_AZRATE);
+    conf->elrate = read_optional_double(cfg, KEY_ELRATE, DEFAULT_ELRATE);
+    conf->lead = read_optional_double(cfg, KEY_LEAD, DEFAULT_LEAD_SEC);
+
     g_key_file_free(cfg);
 
     return TRUE;
@@ -260,6 +291,21 @@ void rotor_conf_save(rotor_conf_t * conf)
     else
         g_key_file_set_double(cfg, GROUP, KEY_THLD, conf->threshold);
 
+    if (conf->azrate <= 0.0 || conf->azrate == DEFAULT_AZRATE)
+        g_key_file_remove_key(cfg, GROUP, KEY_AZRATE, NULL);
+    else
+        g_key_file_set_double(cfg, GROUP, KEY_AZRATE, conf->azrate);
+
+    if (conf->elrate <= 0.0 || conf->elrate == DEFAULT_ELRATE)
+        g_key_file_remove_key(cfg, GROUP, KEY_ELRATE, NULL);
+    else
+        g_key_file_set_double(cfg, GROUP, KEY_ELRATE, conf->elrate);
+
+    if (conf->lead == DEFAULT_LEAD_SEC)
+        g_key_file_remove_key(cfg, GROUP, KEY_LEAD, NULL);
+    else
+        g_key_file_set_double(cfg, GROUP, KEY_LEAD, conf->lead);
+
     /* build filename */
     confdir = get_hwconf_dir();
     fname = g_strconcat(confdir, G_DIR_SEPARATOR_S, conf->name, ".rot", NULL);
@@ -38,6 +38,10 @@ typedef enum {
     ROT_AZ_TYPE_180 = 1         /*!< Azimuth in range -180..+180 */
 } rot_az_type_t;
 
+#define DEFAULT_AZRATE      5.0 /*!< Default azimuth slew rate in deg/sec */
+#define DEFAULT_ELRATE      2.5 /*!< Default elevation slew rate in deg/sec */
+#define DEFAULT_LEAD_SEC    2.0 /*!< Default setpoint lead time in sec */
+
 /** \brief Rotator configuration. */
 typedef struct {
     gchar          *name;       /*!< Configuration file name, less .rot */
@@ -51,6 +55,9 @@ typedef struct {
     gdouble         maxel;      /*!< Upper elevation limit */
     gdouble         azstoppos;  /*!< absolute position of rotation stops; normally = minaz */
     gdouble         threshold;  /*!< Angle difference that triggers new motion command */
+    gdouble         azrate;     /*!< Azimuth slew rate in deg/sec */
+    gdouble         elrate;     /*!< Elevation slew rate in deg/sec */
+    gdouble         lead;       /*!< Time to send setpoints ahead in sec */
 } rotor_conf_t;
 
 
@@ -0,0 +1,90 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Rotator pointing schedule of a predicted pass.
+ *
+ * This samples the track with predict and hands it to
+ * rotor_schedule_new_from_track(). It is kept apart from rotor-schedule.c
+ * so that the simulator can build schedules without linking predict.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <string.h>
+
+#include "predict-tools.h"
+#include "rotor-schedule.h"
+
+
+/** Time between track samples [sec]. */
+#define SAMPLE_STEP 1.0
+
+/** Upper limit on the track samples of a pass. */
+#define MAX_SAMPLES 20000
+
+
+/**
+ * Compute the pointing schedule of a pass.
+ *
+ * @param sat The satellite.
+ * @param qth The observer location.
+ * @param pass The pass.
+ * @param conf The rotator configuration; the limits, threshold and slew
+ *             rates are used.
+ * @param flipped Whether the pass is tracked through zenith.
+ * @return The schedule, or NULL if the pass has no duration. Free it with
+ *         rotor_schedule_free().
+ */
+rotor_schedule_t *rotor_schedule_new(sat_t * sat, qth_t * qth, pass_t * pass,
+                                     rotor_conf_t * conf, gboolean flipped)
+{
+    rotor_schedule_t *sched;
+    sat_t           sat_working;
+    gdouble        *az, *el;
+    gdouble         step;
+    guint           n, i;
+
+    if (pass->los <= pass->aos)
+        return NULL;
+
+    n = (guint) ((pass->los - pass->aos) * secday / SAMPLE_STEP) + 2;
+    n = MIN(n, MAX_SAMPLES);
+    step = (pass->los - pass->aos) * secday / (n - 1);
+
+    /* sample the track; use a working copy so data does not get corrupted */
+    az = g_new(gdouble, n);
+    el = g_new(gdouble, n);
+    memcpy(&sat_working, sat, sizeof(sat_t));
+    for (i = 0; i < n; i++)
+    {
+        predict_calc(&sat_working, qth, pass->aos + i * step / secday);
+        az[i] = sat_working.az;
+        el[i] = sat_working.el;
+    }
+
+    sched = rotor_schedule_new_from_track(sat->nickname, pass->aos, step,
+                                          az, el, n, conf, flipped);
+    g_free(az);
+    g_free(el);
+
+    return sched;
+}
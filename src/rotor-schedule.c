@@ -0,0 +1,287 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Rotator pointing schedule.
+ *
+ * The schedule of a pass is computed once, when the pass is known. The
+ * track of the satellite, sampled at regular intervals from AOS to LOS, is
+ * converted to rotator coordinates, taking the flip decision and the limits
+ * of the rotator into account. The track is then covered with as few
+ * setpoints as possible: each setpoint is the furthest track point that is
+ * still within the threshold of the track from where the previous setpoint
+ * was left behind. The rotator therefore moves ahead of the satellite and
+ * waits for it, instead of chasing it one threshold at a time.
+ *
+ * Each setpoint is needed at the time the track enters its threshold. Using
+ * the slew rates of the rotator, the time needed to move there from the
+ * previous setpoint is subtracted, and the controller sends the setpoint
+ * that much before it is needed, plus a configurable lead time for command
+ * latency and acceleration.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+
+#include "rotor-schedule.h"
+#include "sat-log.h"
+
+
+/**
+ * Convert a satellite position to rotator coordinates.
+ *
+ * @param conf The rotator configuration.
+ * @param flipped Whether the pass is tracked through zenith. Only used if
+ *                the rotator can go beyond 90 deg elevation.
+ * @param az The azimuth of the satellite.
+ * @param el The elevation of the satellite.
+ * @param rotaz Location for the rotator azimuth.
+ * @param rotel Location for the rotator elevation.
+ *
+ * The azimuth is brought into the 360 deg range that starts at the
+ * rotation stop, and both angles are limited to the range of the rotator.
+ */
+void rotor_schedule_map(rotor_conf_t * conf, gboolean flipped, gdouble az,
+                        gdouble el, gdouble * rotaz, gdouble * rotel)
+{
+    if (flipped && conf->maxel >= 180.0)
+    {
+        el = 180.0 - el;
+        az += 180.0;
+    }
+
+    while (az >= conf->azstoppos + 360.0)
+        az -= 360.0;
+    while (az < conf->azstoppos)
+        az += 360.0;
+
+    *rotaz = CLAMP(az, conf->minaz, conf->maxaz);
+    *rotel = CLAMP(el, conf->minel, conf->maxel);
+}
+
+/** Bounding box of the track points of a setpoint. */
+typedef struct {
+    gdouble         minaz, maxaz;
+    gdouble         minel, maxel;
+} bounds_t;
+
+static void bounds_init(bounds_t * b, gdouble az, gdouble el)
+{
+    b->minaz = b->maxaz = az;
+    b->minel = b->maxel = el;
+}
+
+/**
+ * Add a track point to the bounds if it is within the threshold of all
+ * points so far, that is, if the box stays within the threshold.
+ */
+static gboolean bounds_extend(bounds_t * b, gdouble az, gdouble el,
+                              gdouble threshold)
+{
+    gdouble         minaz = MIN(b->minaz, az), maxaz = MAX(b->maxaz, az);
+    gdouble         minel = MIN(b->minel, el), maxel = MAX(b->maxel, el);
+
+    if (maxaz - minaz > threshold || maxel - minel > threshold)
+        return FALSE;
+
+    b->minaz = minaz;
+    b->maxaz = maxaz;
+    b->minel = minel;
+    b->maxel = maxel;
+
+    return TRUE;
+}
+
+/** Time needed to slew between two setpoints [sec]. */
+static gdouble travel_time(rotor_conf_t * conf, const rotor_setpoint_t * a,
+                           const rotor_setpoint_t * b)
+{
+    gdouble         taz = 0.0, tel = 0.0;
+
+    if (conf->azrate > 0.0)
+        taz = fabs(b->az - a->az) / conf->azrate;
+    if (conf->elrate > 0.0)
+        tel = fabs(b->el - a->el) / conf->elrate;
+
+    return MAX(taz, tel);
+}
+
+/**
+ * Compute the pointing schedule of a sampled track.
+ *
+ * @param satname The name of the satellite, for log messages.
+ * @param aos The time of the first track sample (Julian date).
+ * @param step The time between track samples [sec].
+ * @param sataz The azimuth of the satellite at each sample.
+ * @param satel The elevation of the satellite at each sample.
+ * @param n The number of track samples.
+ * @param conf The rotator configuration; the limits, threshold and slew
+ *             rates are used.
+ * @param flipped Whether the pass is tracked through zenith.
+ * @return The schedule, or NULL if the track has less than two samples.
+ *         Free it with rotor_schedule_free().
+ */
+rotor_schedule_t *rotor_schedule_new_from_track(const gchar * satname,
+                                                gdouble aos, gdouble step,
+                                                const gdouble * sataz,
+                                                const gdouble * satel,
+                                                guint n, rotor_conf_t * conf,
+                                                gboolean flipped)
+{
+    rotor_schedule_t *sched;
+    rotor_setpoint_t *sp;
+    bounds_t        box;
+    gdouble        *az, *el;
+    gdouble         travel;
+    guint           i, c, j;
+
+    if (n < 2)
+        return NULL;
+
+    az = g_new(gdouble, n);
+    el = g_new(gdouble, n);
+    for (i = 0; i < n; i++)
+        rotor_schedule_map(conf, flipped, sataz[i], satel[i], &az[i], &el[i]);
+
+    step /= secday;
+
+    sched = g_new0(rotor_schedule_t, 1);
+    sched->satname = g_strdup(satname);
+    sched->aos = aos;
+    sched->los = aos + (n - 1) * step;
+    sched->flipped = flipped && conf->maxel >= 180.0;
+    sched->points = g_new(rotor_setpoint_t, n);
+
+    for (c = 0; c < n; c = j + 1)
+    {
+        /* furthest track point within the threshold of the track from c */
+        j = c;
+        bounds_init(&box, az[c], el[c]);
+        while (j + 1 < n &&
+               bounds_extend(&box, az[j + 1], el[j + 1], conf->threshold))
+            j++;
+
+        sp = &sched->points[sched->npoints++];
+        sp->t = aos + c * step;
+        sp->az = az[j];
+        sp->el = el[j];
+
+        /* the setpoint is good until the track leaves its threshold */
+        while (j + 1 < n && fabs(az[j + 1] - sp->az) <= conf->threshold &&
+               fabs(el[j + 1] - sp->el) <= conf->threshold)
+            j++;
+    }
+
+    /* the first setpoint is sent at once to prepare for AOS */
+    sched->points[0].start = 0.0;
+    for (i = 1; i < sched->npoints; i++)
+    {
+        sp = &sched->points[i];
+        travel = travel_time(conf, sp - 1, sp);
+        if (travel > (sp->t - sp[-1].t) * secday)
+            sched->late++;
+
+        sp->start = MAX(sp->t - travel / secday, sp[-1].start);
+    }
+
+    g_free(az);
+    g_free(el);
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: %u setpoints for %s (%u samples, %u late%s)"),
+                __func__, sched->npoints, sched->satname, n, sched->late,
+                sched->flipped ? ", flipped" : "");
+
+    return sched;
+}
+
+/** Free a schedule and log the counters of the pass. */
+void rotor_schedule_free(rotor_schedule_t * sched)
+{
+    if (sched == NULL)
+        return;
+
+    if (sched->commands > 0)
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: %s pass: %u of %u setpoints sent, %u late, "
+                      "tracking error rms %.2f max %.2f deg (%u samples)"),
+                    __func__, sched->satname, sched->commands,
+                    sched->npoints, sched->late,
+                    sched->nerr ? sqrt(sched->err_sum2 / sched->nerr) : 0.0,
+                    sched->err_max, sched->nerr);
+
+    g_free(sched->satname);
+    g_free(sched->points);
+    g_free(sched);
+}
+
+/**
+ * Get the setpoint the rotator should be moving to.
+ *
+ * @param sched The schedule.
+ * @param t The current time.
+ * @param lead Time to send setpoints before they are due [sec].
+ * @return The last setpoint that is due at t + lead.
+ */
+const rotor_setpoint_t *rotor_schedule_get(rotor_schedule_t * sched,
+                                           gdouble t, gdouble lead)
+{
+    t += lead / secday;
+
+    while (sched->next < sched->npoints &&
+           sched->points[sched->next].start <= t)
+        sched->next++;
+
+    /* the time may also go backwards */
+    while (sched->next > 1 && sched->points[sched->next - 1].start > t)
+        sched->next--;
+
+    return &sched->points[MAX(sched->next, 1) - 1];
+}
+
+/**
+ * Add a sample of the tracking error.
+ *
+ * @param sched The schedule.
+ * @param sataz The azimuth of the satellite.
+ * @param satel The elevation of the satellite.
+ * @param rotaz The azimuth read from the rotator.
+ * @param rotel The elevation read from the rotator.
+ *
+ * The error is the angle between the two directions, so a flipped rotator
+ * pointing at the satellite has no error.
+ */
+void rotor_schedule_add_error(rotor_schedule_t * sched, gdouble sataz,
+                              gdouble satel, gdouble rotaz, gdouble rotel)
+{
+    gdouble         c, err;
+
+    c = sin(satel * de2ra) * sin(rotel * de2ra) +
+        cos(satel * de2ra) * cos(rotel * de2ra) * cos((sataz - rotaz) * de2ra);
+    err = acos(CLAMP(c, -1.0, 1.0)) / de2ra;
+
+    sched->nerr++;
+    sched->err_sum2 += err * err;
+    if (err > sched->err_max)
+        sched->err_max = err;
+}
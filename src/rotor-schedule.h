@@ -0,0 +1,73 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef ROTOR_SCHEDULE_H
+#define ROTOR_SCHEDULE_H 1
+
+#include <glib.h>
+
+#include "gtk-sat-data.h"
+#include "predict-tools.h"
+#include "rotor-conf.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** A rotator setpoint of the pointing schedule. */
+typedef struct {
+    gdouble         t;          /*!< Time the rotator must be there (Julian date). */
+    gdouble         start;      /*!< Time the rotator must start moving there. */
+    gdouble         az;         /*!< Azimuth in rotator coordinates. */
+    gdouble         el;         /*!< Elevation in rotator coordinates. */
+} rotor_setpoint_t;
+
+/** Pointing schedule of one pass and its counters. */
+typedef struct {
+    gchar          *satname;    /*!< Satellite name, for log messages. */
+    gdouble         aos;        /*!< AOS time of the pass. */
+    gdouble         los;        /*!< LOS time of the pass. */
+    gboolean        flipped;    /*!< Elevation goes beyond 90 deg. */
+    rotor_setpoint_t *points;   /*!< Setpoints in order of time. */
+    guint           npoints;
+    guint           late;       /*!< Setpoints the rotator can not reach in time. */
+    guint           next;       /*!< First setpoint not yet due. */
+    guint           commands;   /*!< Setpoints sent to the rotator. */
+    guint           nerr;       /*!< Number of tracking error samples. */
+    gdouble         err_sum2;   /*!< Sum of the squared tracking errors. */
+    gdouble         err_max;    /*!< Largest tracking error [deg]. */
+} rotor_schedule_t;
+
+
+rotor_schedule_t *rotor_schedule_new(sat_t * sat, qth_t * qth, pass_t * pass,
+                                     rotor_conf_t * conf, gboolean flipped);
+rotor_schedule_t *rotor_schedule_new_from_track(const gchar * satname,
+                                                gdouble aos, gdouble step,
+                                                const gdouble * sataz,
+                                                const gdouble * satel,
+                                                guint n, rotor_conf_t * conf,
+                                                gboolean flipped);
+void            rotor_schedule_free(rotor_schedule_t * sched);
+const rotor_setpoint_t *rotor_schedule_get(rotor_schedule_t * sched,
+                                           gdouble t, gdouble lead);
+void            rotor_schedule_add_error(rotor_schedule_t * sched,
+                                         gdouble sataz, gdouble satel,
+                                         gdouble rotaz, gdouble rotel);
+void            rotor_schedule_map(rotor_conf_t * conf, gboolean flipped,
+                                   gdouble az, gdouble el,
+                                   gdouble * rotaz, gdouble * rotel);
+
+#endif
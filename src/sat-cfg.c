@@ -126,6 +126,8 @@ sat_cfg_bool_t  sat_cfg_bool[SAT_CFG_BOOL_NUM] = {
     {"MODULES", "MAP_CURSOR_TRACK", FALSE},
     {"MODULES", "MAP_SHOW_GRID", TRUE},
     {"MODULES", "MAP_SHOW_TERMINATOR", FALSE},
+    {"MODULES", "MAP_SHOW_COVERAGE", FALSE},
+    {"MODULES", "MAP_SHOW_DAYNIGHT", FALSE},
     {"MODULES", "MAP_KEEP_RATIO", FALSE},
     {"MODULES", "POLAR_SAT_NAME", TRUE},
     {"MODULES", "POLAR_SAT_MARKER", TRUE},
@@ -46,6 +46,8 @@ typedef enum {
     SAT_CFG_BOOL_MAP_SHOW_CURS_TRACK,   /*!< Track mouse cursor on map. */
     SAT_CFG_BOOL_MAP_SHOW_GRID, /*!< Show grid on map. */
     SAT_CFG_BOOL_MAP_SHOW_TERMINATOR,   /*!< Show solar terminator on map. */
+    SAT_CFG_BOOL_MAP_SHOW_COVERAGE,     /*!< Show coverage heatmap on map. */
+    SAT_CFG_BOOL_MAP_SHOW_DAYNIGHT,     /*!< Show day/night shading on map. */
     SAT_CFG_BOOL_MAP_KEEP_RATIO,        /*!< Keep original aspect ratio */
     SAT_CFG_BOOL_POL_SHOW_SAT_NAME,     /*!< Show the satellite name */
     SAT_CFG_BOOL_POL_SHOW_SAT_MARKER,   /*!< Show the satellite marker */
@@ -0,0 +1,244 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Uniform grid index of screen rectangles.
+ *
+ * The map and polar views rebuild a grid on every frame with the positions
+ * of the satellite markers, which makes hit testing for mouse events
+ * independent of the number of satellites. A second grid holding the labels
+ * that have been placed so far is used to avoid drawing overlapping labels.
+ *
+ * Each item is registered in every cell it overlaps, so queries only have to
+ * look at the cells covering the query rectangle. The cell and item arrays
+ * are kept between frames and only grow.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <math.h>
+
+#include "sat-grid.h"
+
+
+typedef struct {
+    gdouble         x0, y0, x1, y1;     /*!< Bounding box. */
+    gpointer        data;       /*!< User data. */
+} grid_item_t;
+
+struct _sat_grid {
+    gdouble         cell;       /*!< Cell size in pixels. */
+    guint           cols;       /*!< Number of columns. */
+    guint           rows;       /*!< Number of rows. */
+    GArray         *items;      /*!< Items (grid_item_t). */
+    GPtrArray      *cells;      /*!< Item indices (GArray of guint) per cell. */
+};
+
+
+static void cell_free(gpointer data)
+{
+    g_array_free((GArray *) data, TRUE);
+}
+
+/**
+ * Create a new grid index.
+ *
+ * @param cell The cell size in pixels; about the size of a typical item.
+ * @return The new grid. Free it with sat_grid_free().
+ */
+sat_grid_t     *sat_grid_new(gdouble cell)
+{
+    sat_grid_t     *grid = g_new0(sat_grid_t, 1);
+
+    grid->cell = cell;
+    grid->items = g_array_new(FALSE, FALSE, sizeof(grid_item_t));
+    grid->cells = g_ptr_array_new_with_free_func(cell_free);
+
+    return grid;
+}
+
+void sat_grid_free(sat_grid_t * grid)
+{
+    if (grid == NULL)
+        return;
+
+    g_array_free(grid->items, TRUE);
+    g_ptr_array_free(grid->cells, TRUE);
+    g_free(grid);
+}
+
+/**
+ * Remove all items and set the area covered by the grid.
+ *
+ * @param grid The grid.
+ * @param width The width of the area in pixels.
+ * @param height The height of the area in pixels.
+ *
+ * Items outside the area are kept in the border cells.
+ */
+void sat_grid_reset(sat_grid_t * grid, gdouble width, gdouble height)
+{
+    guint           i, n;
+
+    grid->cols = MAX(1, (guint) ceil(width / grid->cell));
+    grid->rows = MAX(1, (guint) ceil(height / grid->cell));
+    n = grid->cols * grid->rows;
+
+    while (grid->cells->len < n)
+        g_ptr_array_add(grid->cells, g_array_new(FALSE, FALSE,
+                                                 sizeof(guint)));
+
+    for (i = 0; i < n; i++)
+        g_array_set_size(g_ptr_array_index(grid->cells, i), 0);
+
+    g_array_set_size(grid->items, 0);
+}
+
+/** Get the range of cells covering a rectangle. */
+static void cell_range(sat_grid_t * grid, gdouble x0, gdouble y0,
+                       gdouble x1, gdouble y1,
+                       guint * c0, guint * r0, guint * c1, guint * r1)
+{
+    *c0 = (guint) CLAMP(floor(x0 / grid->cell), 0, grid->cols - 1);
+    *c1 = (guint) CLAMP(floor(x1 / grid->cell), 0, grid->cols - 1);
+    *r0 = (guint) CLAMP(floor(y0 / grid->cell), 0, grid->rows - 1);
+    *r1 = (guint) CLAMP(floor(y1 / grid->cell), 0, grid->rows - 1);
+}
+
+/**
+ * Add a rectangle to the grid.
+ *
+ * @param grid The grid.
+ * @param x0 Left edge.
+ * @param y0 Top edge.
+ * @param x1 Right edge.
+ * @param y1 Bottom edge.
+ * @param data User data returned by sat_grid_find().
+ *
+ * Points are added as rectangles of zero size.
+ */
+void sat_grid_add(sat_grid_t * grid, gdouble x0, gdouble y0,
+                  gdouble x1, gdouble y1, gpointer data)
+{
+    grid_item_t     item;
+    guint           idx = grid->items->len;
+    guint           c0, r0, c1, r1, c, r;
+
+    item.x0 = x0;
+    item.y0 = y0;
+    item.x1 = x1;
+    item.y1 = y1;
+    item.data = data;
+    g_array_append_val(grid->items, item);
+
+    cell_range(grid, x0, y0, x1, y1, &c0, &r0, &c1, &r1);
+    for (r = r0; r <= r1; r++)
+        for (c = c0; c <= c1; c++)
+            g_array_append_val(g_ptr_array_index(grid->cells,
+                                                 r * grid->cols + c), idx);
+}
+
+/**
+ * Check whether a rectangle overlaps any rectangle in the grid.
+ *
+ * @param grid The grid.
+ * @param x0 Left edge.
+ * @param y0 Top edge.
+ * @param x1 Right edge.
+ * @param y1 Bottom edge.
+ * @return TRUE if the rectangle overlaps an item, FALSE otherwise.
+ */
+gboolean sat_grid_overlaps(sat_grid_t * grid, gdouble x0, gdouble y0,
+                           gdouble x1, gdouble y1)
+{
+    GArray         *list;
+    grid_item_t    *item;
+    guint           c0, r0, c1, r1, c, r, i;
+
+    cell_range(grid, x0, y0, x1, y1, &c0, &r0, &c1, &r1);
+    for (r = r0; r <= r1; r++)
+    {
+        for (c = c0; c <= c1; c++)
+        {
+            list = g_ptr_array_index(grid->cells, r * grid->cols + c);
+            for (i = 0; i < list->len; i++)
+            {
+                item = &g_array_index(grid->items, grid_item_t,
+                                      g_array_index(list, guint, i));
+                if (x0 < item->x1 && item->x0 < x1 &&
+                    y0 < item->y1 && item->y0 < y1)
+                    return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Find the item closest to a point.
+ *
+ * @param grid The grid.
+ * @param x The X coordinate.
+ * @param y The Y coordinate.
+ * @param radius The largest distance between the point and the centre of
+ *               the item.
+ * @return The user data of the closest item, or NULL if there is no item
+ *         within the radius.
+ */
+gpointer sat_grid_find(sat_grid_t * grid, gdouble x, gdouble y,
+                       gdouble radius)
+{
+    GArray         *list;
+    grid_item_t    *item;
+    gpointer        data = NULL;
+    gdouble         dx, dy, d2;
+    gdouble         best = radius * radius;
+    guint           c0, r0, c1, r1, c, r, i;
+
+    if (grid->items->len == 0)
+        return NULL;
+
+    cell_range(grid, x - radius, y - radius, x + radius, y + radius,
+               &c0, &r0, &c1, &r1);
+    for (r = r0; r <= r1; r++)
+    {
+        for (c = c0; c <= c1; c++)
+        {
+            list = g_ptr_array_index(grid->cells, r * grid->cols + c);
+            for (i = 0; i < list->len; i++)
+            {
+                item = &g_array_index(grid->items, grid_item_t,
+                                      g_array_index(list, guint, i));
+                dx = x - 0.5 * (item->x0 + item->x1);
+                dy = y - 0.5 * (item->y0 + item->y1);
+                d2 = dx * dx + dy * dy;
+                if (d2 < best)
+                {
+                    best = d2;
+                    data = item->data;
+                }
+            }
+        }
+    }
+
+    return data;
+}
@@ -0,0 +1,40 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_GRID_H
+#define SAT_GRID_H 1
+
+#include <glib.h>
+
+
+/** Opaque uniform grid index of screen rectangles. */
+typedef struct _sat_grid sat_grid_t;
+
+
+sat_grid_t     *sat_grid_new(gdouble cell);
+void            sat_grid_free(sat_grid_t * grid);
+void            sat_grid_reset(sat_grid_t * grid, gdouble width,
+                               gdouble height);
+void            sat_grid_add(sat_grid_t * grid, gdouble x0, gdouble y0,
+                             gdouble x1, gdouble y1, gpointer data);
+gboolean        sat_grid_overlaps(sat_grid_t * grid, gdouble x0, gdouble y0,
+                                  gdouble x1, gdouble y1);
+gpointer        sat_grid_find(sat_grid_t * grid, gdouble x, gdouble y,
+                              gdouble radius);
+
+#endif
@@ -0,0 +1,668 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Persistent satellite index.
+ *
+ * Listing the satellite catalog used to require reading every .sat file,
+ * including a full SGP4 initialisation, and every .cat file. The satellite
+ * index keeps the few fields needed by the satellite selector in a single
+ * file in the user cache directory. The file starts with a manifest of the
+ * satdata directory (number of .sat and .cat files and a hash of their names,
+ * sizes and modification times, and of the modification time of the
+ * directory) and it is rebuilt whenever the manifest no longer matches the
+ * directory contents. Checking the manifest only needs a stat() of each
+ * file, none of them is opened. The modification times are taken with
+ * nanoseconds where the platform has them, so that an edit made in the same
+ * second as the index is not missed.
+ *
+ * File format (one record per line, fields separated by TAB):
+ *
+ *   GPREDICT-SATINDEX <version> <file count> <manifest hash>
+ *   C <category name>
+ *   S <catnum> <epoch> <name> <nickname> <comma separated category indices>
+ *
+ * All C records come before the S records and are sorted by name.
+ */
+#define _DEFAULT_SOURCE         // st_mtim, see man 2 stat
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "compat.h"
+#include "gpredict-utils.h"
+#include "sat-index.h"
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+
+#define SAT_INDEX_FILE      "satindex.dat"
+#define SAT_INDEX_MAGIC     "GPREDICT-SATINDEX"
+#define SAT_INDEX_VERSION   3
+
+
+static void cat_free(sat_index_cat_t * cat)
+{
+    g_free(cat->name);
+    g_array_free(cat->members, TRUE);
+    g_free(cat);
+}
+
+static sat_index_cat_t *cat_new(gchar * name)
+{
+    sat_index_cat_t *cat = g_new0(sat_index_cat_t, 1);
+
+    cat->name = name;
+    cat->members = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    return cat;
+}
+
+static sat_index_t *index_new(void)
+{
+    sat_index_t    *index = g_new0(sat_index_t, 1);
+
+    index->sats = g_array_new(FALSE, FALSE, sizeof(sat_index_entry_t));
+    index->cats = g_ptr_array_new_with_free_func((GDestroyNotify) cat_free);
+
+    return index;
+}
+
+/**
+ * Free a satellite index.
+ *
+ * @param index The index returned by sat_index_load().
+ */
+void sat_index_free(sat_index_t * index)
+{
+    sat_index_entry_t *entry;
+    guint           i;
+
+    if (index == NULL)
+        return;
+
+    for (i = 0; i < index->sats->len; i++)
+    {
+        entry = &g_array_index(index->sats, sat_index_entry_t, i);
+        g_free(entry->name);
+        g_free(entry->nickname);
+    }
+    g_array_free(index->sats, TRUE);
+    g_ptr_array_free(index->cats, TRUE);
+    g_free(index);
+}
+
+/** Return the file name of the index, or NULL if it has no directory. */
+static gchar   *index_file_name(void)
+{
+    gchar          *dir;
+    gchar          *fname;
+
+    dir = g_build_filename(g_get_user_cache_dir(), "gpredict", NULL);
+    if (g_mkdir_with_parents(dir, 0755) != 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Could not create cache directory %s"),
+                    __func__, dir);
+        g_free(dir);
+        return NULL;
+    }
+
+    fname = g_build_filename(dir, SAT_INDEX_FILE, NULL);
+    g_free(dir);
+
+    return fname;
+}
+
+static gboolean is_data_file(const gchar * fname)
+{
+    return g_str_has_suffix(fname, ".sat") || g_str_has_suffix(fname, ".cat");
+}
+
+/** FNV-1a hash of a block of memory. */
+static guint64 hash_bytes(guint64 hash, gconstpointer data, gsize len)
+{
+    const guchar   *p = data;
+    gsize           i;
+
+    for (i = 0; i < len; i++)
+    {
+        hash ^= p[i];
+        hash *= G_GUINT64_CONSTANT(1099511628211);
+    }
+
+    return hash;
+}
+
+/** Modification time of a file [nsec], as precise as the platform has it. */
+static gint64 mtime_nsec(const GStatBuf * st)
+{
+#if defined(HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC)
+    return (gint64) st->st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) +
+        st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC_TV_NSEC)
+    return (gint64) st->st_mtimespec.tv_sec * G_GINT64_CONSTANT(1000000000) +
+        st->st_mtimespec.tv_nsec;
+#else
+    return (gint64) st->st_mtime * G_GINT64_CONSTANT(1000000000);
+#endif
+}
+
+/** Hash of a file name, size and modification time. */
+static guint64 hash_stat(const gchar * fname, const GStatBuf * st)
+{
+    guint64         hash = G_GUINT64_CONSTANT(14695981039346656037);
+    gint64          size = st->st_size;
+    gint64          mtime = mtime_nsec(st);
+
+    hash = hash_bytes(hash, fname, strlen(fname) + 1);
+    hash = hash_bytes(hash, &size, sizeof(size));
+    hash = hash_bytes(hash, &mtime, sizeof(mtime));
+
+    return hash;
+}
+
+/**
+ * Compute the manifest of the satdata directory.
+ *
+ * @param dirname The satdata directory.
+ * @param count Location where the number of .sat and .cat files is stored.
+ * @param hash Location where the manifest hash is stored.
+ * @return TRUE if the directory could be read, FALSE otherwise.
+ *
+ * The files are only stat()ed, not opened. The per-file hashes are summed so
+ * that the result does not depend on the order in which the directory is
+ * listed.
+ */
+static gboolean get_manifest(const gchar * dirname, guint * count,
+                             guint64 * hash)
+{
+    GDir           *dir;
+    GStatBuf        st;
+    const gchar    *fname;
+    gchar          *path;
+
+    if (g_stat(dirname, &st) != 0)
+        return FALSE;
+
+    dir = g_dir_open(dirname, 0, NULL);
+    if (!dir)
+        return FALSE;
+
+    *count = 0;
+    *hash = hash_stat("", &st);
+    while ((fname = g_dir_read_name(dir)))
+    {
+        if (!is_data_file(fname))
+            continue;
+
+        path = g_build_filename(dirname, fname, NULL);
+        if (g_stat(path, &st) == 0)
+        {
+            *hash += hash_stat(fname, &st);
+            (*count)++;
+        }
+        g_free(path);
+    }
+    g_dir_close(dir);
+
+    return TRUE;
+}
+
+/**
+ * Read the index fields from a .sat file.
+ *
+ * The TLE is only parsed to obtain the epoch; SGP4/SDP4 is not initialised.
+ * Satellites with invalid TLE data are skipped like gtk_sat_data_read_sat()
+ * would reject them.
+ */
+static gboolean read_sat_entry(const gchar * path, sat_index_entry_t * entry)
+{
+    GKeyFile       *data;
+    gchar          *tlestr1;
+    gchar          *tlestr2;
+    gchar          *rawtle;
+    tle_t           tle;
+    gboolean        ok = FALSE;
+
+    data = g_key_file_new();
+    if (!g_key_file_load_from_file(data, path, G_KEY_FILE_NONE, NULL))
+    {
+        g_key_file_free(data);
+        return FALSE;
+    }
+
+    tlestr1 = g_key_file_get_string(data, "Satellite", "TLE1", NULL);
+    tlestr2 = g_key_file_get_string(data, "Satellite", "TLE2", NULL);
+    if (tlestr1 != NULL && tlestr2 != NULL)
+    {
+        rawtle = g_strconcat(tlestr1, tlestr2, NULL);
+        if (Good_Elements(rawtle))
+        {
+            Convert_Satellite_Data(rawtle, &tle);
+            entry->epoch = Julian_Date_of_Epoch(tle.epoch);
+            ok = TRUE;
+        }
+        g_free(rawtle);
+    }
+    g_free(tlestr1);
+    g_free(tlestr2);
+
+    if (ok)
+    {
+        entry->name = g_key_file_get_string(data, "Satellite", "NAME", NULL);
+        if (entry->name == NULL)
+            entry->name = g_strdup("Error");
+
+        entry->nickname = g_key_file_get_string(data, "Satellite",
+                                                "NICKNAME", NULL);
+        if (entry->nickname == NULL)
+            entry->nickname = g_strdup(entry->name);
+    }
+
+    g_key_file_free(data);
+
+    return ok;
+}
+
+/**
+ * Read a .cat file into a new category.
+ *
+ * @param path The full path of the .cat file.
+ * @param fname The file name used in log messages.
+ * @param lookup Hash table mapping catnum to index + 1 in the satellite array.
+ * @return A new category or NULL if the file could not be read.
+ */
+static sat_index_cat_t *read_cat_file(const gchar * path, const gchar * fname,
+                                      GHashTable * lookup)
+{
+    sat_index_cat_t *cat;
+    GError         *error = NULL;
+    gchar          *contents;
+    gchar         **lines;
+    gint            catnum;
+    guint           idx;
+    guint           i;
+
+    if (!g_file_get_contents(path, &contents, NULL, &error))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to open %s: %s"),
+                    __func__, fname, error->message);
+        g_clear_error(&error);
+        return NULL;
+    }
+
+    /* .cat files contains clear text category name in the first line
+       then one satellite catalog number per line */
+    lines = g_strsplit(contents, "\n", 0);
+    g_free(contents);
+
+    if (lines[0] == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to read %s"), __func__, fname);
+        g_strfreev(lines);
+        return NULL;
+    }
+
+    cat = cat_new(g_strdup(g_strstrip(lines[0])));
+    for (i = 1; lines[i] != NULL; i++)
+    {
+        g_strstrip(lines[i]);
+        if (lines[i][0] == '\0')
+            continue;
+
+        catnum = (gint) g_ascii_strtoll(lines[i], NULL, 0);
+        idx = GPOINTER_TO_UINT(g_hash_table_lookup(lookup,
+                                                   GINT_TO_POINTER(catnum)));
+        if (idx == 0)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Error reading satellite %d (%s)"),
+                        __func__, catnum, fname);
+            continue;
+        }
+
+        idx--;
+        g_array_append_val(cat->members, idx);
+    }
+    g_strfreev(lines);
+
+    return cat;
+}
+
+static gint cat_compare(gconstpointer a, gconstpointer b)
+{
+    const sat_index_cat_t *cat_a = *(sat_index_cat_t * const *)a;
+    const sat_index_cat_t *cat_b = *(sat_index_cat_t * const *)b;
+
+    return gpredict_strcmp(cat_a->name, cat_b->name);
+}
+
+/** Build the index by reading the .sat and .cat files in dirname. */
+static sat_index_t *build_index(const gchar * dirname)
+{
+    sat_index_t    *index;
+    sat_index_entry_t entry;
+    sat_index_cat_t *cat;
+    GHashTable     *lookup;
+    GDir           *dir;
+    const gchar    *fname;
+    gchar          *path;
+
+    index = index_new();
+
+    dir = g_dir_open(dirname, 0, NULL);
+    if (!dir)
+        return index;
+
+    /* catnum -> position in index->sats + 1 */
+    lookup = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    while ((fname = g_dir_read_name(dir)))
+    {
+        if (!g_str_has_suffix(fname, ".sat"))
+            continue;
+
+        memset(&entry, 0, sizeof(entry));
+        entry.catnum = (gint) g_ascii_strtoll(fname, NULL, 0);
+
+        path = g_build_filename(dirname, fname, NULL);
+        if (read_sat_entry(path, &entry))
+        {
+            g_array_append_val(index->sats, entry);
+            g_hash_table_insert(lookup, GINT_TO_POINTER(entry.catnum),
+                                GUINT_TO_POINTER(index->sats->len));
+        }
+        g_free(path);
+    }
+
+    g_dir_rewind(dir);
+    while ((fname = g_dir_read_name(dir)))
+    {
+        if (!g_str_has_suffix(fname, ".cat"))
+            continue;
+
+        path = g_build_filename(dirname, fname, NULL);
+        cat = read_cat_file(path, fname, lookup);
+        if (cat != NULL)
+            g_ptr_array_add(index->cats, cat);
+        g_free(path);
+    }
+    g_dir_close(dir);
+    g_hash_table_destroy(lookup);
+
+    g_ptr_array_sort(index->cats, cat_compare);
+
+    return index;
+}
+
+/** Save index to fname together with the manifest it was built from. */
+static void save_index(sat_index_t * index, const gchar * fname,
+                       guint count, guint64 hash)
+{
+    sat_index_entry_t *entry;
+    sat_index_cat_t *cat;
+    GString        *out;
+    GString       **satcats;
+    GError         *error = NULL;
+    gchar           epoch[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar          *name;
+    gchar          *nickname;
+    guint           i, j, idx;
+
+    /* invert category membership so that it can be stored per satellite */
+    satcats = g_new0(GString *, index->sats->len);
+    for (i = 0; i < index->cats->len; i++)
+    {
+        cat = g_ptr_array_index(index->cats, i);
+        for (j = 0; j < cat->members->len; j++)
+        {
+            idx = g_array_index(cat->members, guint, j);
+            if (satcats[idx] == NULL)
+                satcats[idx] = g_string_new(NULL);
+            else
+                g_string_append_c(satcats[idx], ',');
+            g_string_append_printf(satcats[idx], "%u", i);
+        }
+    }
+
+    out = g_string_sized_new(64 * index->sats->len + 1024);
+    g_string_append_printf(out, "%s\t%d\t%u\t%" G_GUINT64_FORMAT "\n",
+                           SAT_INDEX_MAGIC, SAT_INDEX_VERSION, count, hash);
+
+    for (i = 0; i < index->cats->len; i++)
+    {
+        cat = g_ptr_array_index(index->cats, i);
+        name = g_strescape(cat->name, NULL);
+        g_string_append_printf(out, "C\t%s\n", name);
+        g_free(name);
+    }
+
+    for (i = 0; i < index->sats->len; i++)
+    {
+        entry = &g_array_index(index->sats, sat_index_entry_t, i);
+        name = g_strescape(entry->name, NULL);
+        nickname = g_strescape(entry->nickname, NULL);
+        g_ascii_dtostr(epoch, sizeof(epoch), entry->epoch);
+        g_string_append_printf(out, "S\t%d\t%s\t%s\t%s\t%s\n",
+                               entry->catnum, epoch, name, nickname,
+                               satcats[i] ? satcats[i]->str : "");
+        g_free(name);
+        g_free(nickname);
+        if (satcats[i] != NULL)
+            g_string_free(satcats[i], TRUE);
+    }
+    g_free(satcats);
+
+    if (!g_file_set_contents(fname, out->str, out->len, &error))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to write satellite index %s: %s"),
+                    __func__, fname, error->message);
+        g_clear_error(&error);
+    }
+
+    g_string_free(out, TRUE);
+}
+
+/**
+ * Split the next TAB separated field off a line.
+ *
+ * @param line Pointer to the current position; advanced past the field.
+ * @return The field (NUL terminated in place) or NULL at end of line.
+ */
+static gchar   *next_field(gchar ** line)
+{
+    gchar          *field = *line;
+    gchar          *tab;
+
+    if (field == NULL)
+        return NULL;
+
+    tab = strchr(field, '\t');
+    if (tab != NULL)
+    {
+        *tab = '\0';
+        *line = tab + 1;
+    }
+    else
+    {
+        *line = NULL;
+    }
+
+    return field;
+}
+
+/**
+ * Load the index from fname.
+ *
+ * @return The index or NULL if the file does not exist, is corrupt or was
+ *         built from a different manifest.
+ */
+static sat_index_t *load_index(const gchar * fname, guint count, guint64 hash)
+{
+    sat_index_t    *index;
+    sat_index_entry_t entry;
+    sat_index_cat_t *cat;
+    gchar          *contents;
+    gchar          *line;
+    gchar          *eol;
+    gchar          *pos;
+    gchar          *field[6];
+    gchar         **cats;
+    gchar           header[128];
+    guint           i, c, idx;
+
+    if (!g_file_get_contents(fname, &contents, NULL, NULL))
+        return NULL;
+
+    line = contents;
+    eol = strchr(line, '\n');
+    if (eol == NULL)
+    {
+        g_free(contents);
+        return NULL;
+    }
+    *eol = '\0';
+
+    g_snprintf(header, sizeof(header), "%s\t%d\t%u\t%" G_GUINT64_FORMAT,
+               SAT_INDEX_MAGIC, SAT_INDEX_VERSION, count, hash);
+    if (strcmp(line, header) != 0)
+    {
+        g_free(contents);
+        return NULL;
+    }
+
+    index = index_new();
+    for (line = eol + 1; *line != '\0'; line = eol + 1)
+    {
+        eol = strchr(line, '\n');
+        if (eol == NULL)
+            break;              /* truncated file */
+        *eol = '\0';
+
+        pos = line;
+        for (i = 0; i < 6; i++)
+            field[i] = next_field(&pos);
+
+        if (field[0] == NULL)
+            continue;
+
+        if (!strcmp(field[0], "C") && field[1] != NULL)
+        {
+            g_ptr_array_add(index->cats, cat_new(g_strcompress(field[1])));
+        }
+        else if (!strcmp(field[0], "S") && field[5] != NULL)
+        {
+            entry.catnum = (gint) g_ascii_strtoll(field[1], NULL, 10);
+            entry.epoch = g_ascii_strtod(field[2], NULL);
+            entry.name = g_strcompress(field[3]);
+            entry.nickname = g_strcompress(field[4]);
+            g_array_append_val(index->sats, entry);
+
+            idx = index->sats->len - 1;
+            if (field[5][0] == '\0')
+                continue;
+
+            cats = g_strsplit(field[5], ",", 0);
+            for (i = 0; cats[i] != NULL; i++)
+            {
+                c = (guint) g_ascii_strtoull(cats[i], NULL, 10);
+                if (c < index->cats->len)
+                {
+                    cat = g_ptr_array_index(index->cats, c);
+                    g_array_append_val(cat->members, idx);
+                }
+            }
+            g_strfreev(cats);
+        }
+    }
+
+    if (eol == NULL)
+    {
+        /* the file has been truncated; rebuild it */
+        sat_index_free(index);
+        index = NULL;
+    }
+
+    g_free(contents);
+
+    return index;
+}
+
+/**
+ * Load the satellite index.
+ *
+ * @return A newly allocated satellite index. Free it with sat_index_free().
+ *
+ * The index is read from disk if it matches the current contents of the
+ * satdata directory; otherwise it is rebuilt from the .sat and .cat files and
+ * saved for the next time.
+ */
+sat_index_t    *sat_index_load(void)
+{
+    sat_index_t    *index;
+    gchar          *dirname;
+    gchar          *fname;
+    guint           count;
+    guint64         hash;
+
+    dirname = get_satdata_dir();
+    if (!get_manifest(dirname, &count, &hash))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to open satdata directory %s."),
+                    __func__, dirname);
+        g_free(dirname);
+        return index_new();
+    }
+
+    fname = index_file_name();
+    index = fname ? load_index(fname, count, hash) : NULL;
+    if (index == NULL)
+    {
+        index = build_index(dirname);
+        if (fname)
+            save_index(index, fname, count, hash);
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Rebuilt satellite index (%u satellites, "
+                      "%u categories)"), __func__,
+                    index->sats->len, index->cats->len);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Loaded satellite index (%u satellites, "
+                      "%u categories)"), __func__,
+                    index->sats->len, index->cats->len);
+    }
+
+    g_free(fname);
+    g_free(dirname);
+
+    return index;
+}
@@ -0,0 +1,49 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_INDEX_H
+#define SAT_INDEX_H 1
+
+#include <glib.h>
+
+
+/** Satellite entry in the satellite index. */
+typedef struct {
+    gint            catnum;     /*!< Catalog number. */
+    gdouble         epoch;      /*!< Epoch of the TLE as Julian date. */
+    gchar          *name;       /*!< Satellite name. */
+    gchar          *nickname;   /*!< Satellite nickname. */
+} sat_index_entry_t;
+
+/** Satellite category in the satellite index. */
+typedef struct {
+    gchar          *name;       /*!< Category name (first line of the .cat file). */
+    GArray         *members;    /*!< Indices (guint) into sat_index_t.sats. */
+} sat_index_cat_t;
+
+/** In-memory satellite index. */
+typedef struct {
+    GArray         *sats;       /*!< Satellites (sat_index_entry_t). */
+    GPtrArray      *cats;       /*!< Categories (sat_index_cat_t) sorted by name. */
+} sat_index_t;
+
+
+sat_index_t    *sat_index_load(void);
+void            sat_index_free(sat_index_t * index);
+
+#endif
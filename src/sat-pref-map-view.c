@@ -37,6 +37,7 @@ static gchar   *mapf = NULL;
 
 /* content selectors */
 static GtkWidget *satname, *satfp, *satmarker, *qth, *next, *curs, *grid, *terminatoronoff;
+static GtkWidget *coverage, *daynight;
 
 /* colour selectors */
 static GtkWidget *qthc, *gridc, *tickc;
@@ -207,6 +208,12 @@ static void reset_cb(GtkWidget * button, gpointer cfg)
         gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(terminatoronoff),
                                      sat_cfg_get_bool_def
                                      (SAT_CFG_BOOL_MAP_SHOW_TERMINATOR));
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(coverage),
+                                     sat_cfg_get_bool_def
+                                     (SAT_CFG_BOOL_MAP_SHOW_COVERAGE));
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(daynight),
+                                     sat_cfg_get_bool_def
+                                     (SAT_CFG_BOOL_MAP_SHOW_DAYNIGHT));
         /* colours */
         rgba = sat_cfg_get_int_def(SAT_CFG_INT_MAP_QTH_COL);
         rgba_from_cfg(rgba, &gdk_rgba);
@@ -296,6 +303,12 @@ static void reset_cb(GtkWidget * button, gpointer cfg)
         gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(terminatoronoff),
                                      sat_cfg_get_bool
                                      (SAT_CFG_BOOL_MAP_SHOW_TERMINATOR));
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(coverage),
+                                     sat_cfg_get_bool
+                                     (SAT_CFG_BOOL_MAP_SHOW_COVERAGE));
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(daynight),
+                                     sat_cfg_get_bool
+                                     (SAT_CFG_BOOL_MAP_SHOW_DAYNIGHT));
 
         /* colours */
         rgba = sat_cfg_get_int(SAT_CFG_INT_MAP_QTH_COL);
@@ -422,6 +435,14 @@ void sat_pref_map_view_ok(GKeyFile * cfg)
                                    MOD_CFG_MAP_SHOW_TERMINATOR,
                                    gtk_toggle_button_get_active
                                    (GTK_TOGGLE_BUTTON(terminatoronoff)));
+            g_key_file_set_boolean(cfg, MOD_CFG_MAP_SECTION,
+                                   MOD_CFG_MAP_SHOW_COVERAGE,
+                                   gtk_toggle_button_get_active
+                                   (GTK_TOGGLE_BUTTON(coverage)));
+            g_key_file_set_boolean(cfg, MOD_CFG_MAP_SECTION,
+                                   MOD_CFG_MAP_SHOW_DAYNIGHT,
+                                   gtk_toggle_button_get_active
+                                   (GTK_TOGGLE_BUTTON(daynight)));
 
             /* colours */
             gtk_color_chooser_get_rgba(GTK_COLOR_CHOOSER(qthc), &gdk_rgba);
@@ -528,6 +549,12 @@ void sat_pref_map_view_ok(GKeyFile * cfg)
             sat_cfg_set_bool(SAT_CFG_BOOL_MAP_SHOW_TERMINATOR,
                              gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON
                                                           (terminatoronoff)));
+            sat_cfg_set_bool(SAT_CFG_BOOL_MAP_SHOW_COVERAGE,
+                             gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON
+                                                          (coverage)));
+            sat_cfg_set_bool(SAT_CFG_BOOL_MAP_SHOW_DAYNIGHT,
+                             gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON
+                                                          (daynight)));
 
 
             /* colours */
@@ -620,6 +647,12 @@ void sat_pref_map_view_ok(GKeyFile * cfg)
             g_key_file_remove_key(cfg,
                                   MOD_CFG_MAP_SECTION,
                                   MOD_CFG_MAP_SHOW_TERMINATOR, NULL);
+            g_key_file_remove_key(cfg,
+                                  MOD_CFG_MAP_SECTION,
+                                  MOD_CFG_MAP_SHOW_COVERAGE, NULL);
+            g_key_file_remove_key(cfg,
+                                  MOD_CFG_MAP_SECTION,
+                                  MOD_CFG_MAP_SHOW_DAYNIGHT, NULL);
             g_key_file_remove_key(cfg,
                                   MOD_CFG_MAP_SECTION,
                                   MOD_CFG_MAP_QTH_COL, NULL);
@@ -673,6 +706,8 @@ void sat_pref_map_view_ok(GKeyFile * cfg)
             sat_cfg_reset_bool(SAT_CFG_BOOL_MAP_SHOW_CURS_TRACK);
             sat_cfg_reset_bool(SAT_CFG_BOOL_MAP_SHOW_GRID);
             sat_cfg_reset_bool(SAT_CFG_BOOL_MAP_SHOW_TERMINATOR);
+            sat_cfg_reset_bool(SAT_CFG_BOOL_MAP_SHOW_COVERAGE);
+            sat_cfg_reset_bool(SAT_CFG_BOOL_MAP_SHOW_DAYNIGHT);
 
             /* colours */
             sat_cfg_reset_int(SAT_CFG_INT_MAP_QTH_COL);
@@ -999,6 +1034,50 @@ static void create_bool_selectors(GKeyFile * cfg, GtkBox * vbox)
     }
     g_signal_connect(terminatoronoff, "toggled", G_CALLBACK(content_changed), NULL);
     gtk_grid_attach(GTK_GRID(table), terminatoronoff, 3, 1, 1, 1);
+
+    /* Coverage heatmap */
+    coverage = gtk_check_button_new_with_label(_("Coverage Heatmap"));
+    gtk_widget_set_tooltip_text(coverage,
+                                _("Show how often each region is covered by "
+                                  "the satellites during the next 24 hours"));
+    if (cfg != NULL)
+    {
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(coverage),
+                                     mod_cfg_get_bool(cfg,
+                                                      MOD_CFG_MAP_SECTION,
+                                                      MOD_CFG_MAP_SHOW_COVERAGE,
+                                                      SAT_CFG_BOOL_MAP_SHOW_COVERAGE));
+    }
+    else
+    {
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(coverage),
+                                     sat_cfg_get_bool
+                                     (SAT_CFG_BOOL_MAP_SHOW_COVERAGE));
+    }
+    g_signal_connect(coverage, "toggled", G_CALLBACK(content_changed), NULL);
+    gtk_grid_attach(GTK_GRID(table), coverage, 0, 2, 1, 1);
+
+    /* Day/night shading */
+    daynight = gtk_check_button_new_with_label(_("Day/Night Shading"));
+    gtk_widget_set_tooltip_text(daynight,
+                                _("Shade the night side of the map with "
+                                  "civil, nautical and astronomical twilight"));
+    if (cfg != NULL)
+    {
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(daynight),
+                                     mod_cfg_get_bool(cfg,
+                                                      MOD_CFG_MAP_SECTION,
+                                                      MOD_CFG_MAP_SHOW_DAYNIGHT,
+                                                      SAT_CFG_BOOL_MAP_SHOW_DAYNIGHT));
+    }
+    else
+    {
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(daynight),
+                                     sat_cfg_get_bool
+                                     (SAT_CFG_BOOL_MAP_SHOW_DAYNIGHT));
+    }
+    g_signal_connect(daynight, "toggled", G_CALLBACK(content_changed), NULL);
+    gtk_grid_attach(GTK_GRID(table), daynight, 1, 2, 1, 1);
 }
 
 /**
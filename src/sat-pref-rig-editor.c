@@ -43,6 +43,7 @@ static GtkWidget *lo;           /* local oscillator of downconverter */
 static GtkWidget *loup;         /* local oscillator of upconverter */
 static GtkWidget *sigaos;       /* AOS signalling */
 static GtkWidget *siglos;       /* LOS signalling */
+static GtkWidget *tolerance;    /* Doppler tolerance */
 
 
 static void clear_widgets()
@@ -58,6 +59,7 @@ static void clear_widgets()
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ptt), FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(sigaos), FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(siglos), FALSE);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(tolerance), 0);
 }
 
 static void update_widgets(radio_conf_t * conf)
@@ -103,6 +105,9 @@ static void update_widgets(radio_conf_t * conf)
     /* AOS / LOS signalling */
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(sigaos), conf->signal_aos);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(siglos), conf->signal_los);
+
+    /* Doppler tolerance */
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(tolerance), conf->tolerance);
 }
 
 /*
@@ -436,6 +441,24 @@ static GtkWidget *create_editor_widgets(radio_conf_t * conf)
     gtk_widget_set_tooltip_text(siglos,
                                 _("Enable LOS signalling for this radio."));
 
+    /* Doppler tolerance */
+    label = gtk_label_new(_("Tolerance"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 9, 1, 1);
+
+    tolerance = gtk_spin_button_new_with_range(0, 5000, 10);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(tolerance), 0);
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(tolerance), 0);
+    gtk_widget_set_tooltip_text(tolerance,
+                                _("Doppler tuning error allowed before a new "
+                                  "frequency is sent to the radio. Use 0 to "
+                                  "send every change of 1 Hz."));
+    gtk_grid_attach(GTK_GRID(table), tolerance, 1, 9, 2, 1);
+
+    label = gtk_label_new(_("Hz"));
+    g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 3, 9, 1, 1);
+
     if (conf->name != NULL)
         update_widgets(conf);
 
@@ -511,6 +534,9 @@ static gboolean apply_changes(radio_conf_t * conf)
     conf->signal_aos = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(sigaos));
     conf->signal_los = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(siglos));
 
+    /* Doppler tolerance */
+    conf->tolerance = gtk_spin_button_get_value(GTK_SPIN_BUTTON(tolerance));
+
     return TRUE;
 }
 
@@ -61,7 +61,9 @@ static GtkTreeModel *create_and_fill_model()
                                    G_TYPE_DOUBLE,       // LO DOWN
                                    G_TYPE_DOUBLE,       // LO UO
                                    G_TYPE_BOOLEAN,      // AOS signalling
-                                   G_TYPE_BOOLEAN       // LOS signalling
+                                   G_TYPE_BOOLEAN,      // LOS signalling
+                                   G_TYPE_INT,  // Cycle period
+                                   G_TYPE_DOUBLE        // Doppler tolerance
         );
 
     gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(liststore),
@@ -98,6 +100,8 @@ static GtkTreeModel *create_and_fill_model()
                                        RIG_LIST_COL_LOUP, conf.loup,
                                        RIG_LIST_COL_SIGAOS, conf.signal_aos,
                                        RIG_LIST_COL_SIGLOS, conf.signal_los,
+                                       RIG_LIST_COL_CYCLE, conf.cycle,
+                                       RIG_LIST_COL_TOLERANCE, conf.tolerance,
                                        -1);
 
                     sat_log_log(SAT_LOG_LEVEL_DEBUG,
@@ -394,7 +398,9 @@ static void edit_cb(GtkWidget * button, gpointer data)
         .lo = 0.0,
         .loup = 0.0,
         .signal_aos = FALSE,
-        .signal_los = FALSE
+        .signal_los = FALSE,
+        .cycle = DEFAULT_CYCLE_MS,
+        .tolerance = 0.0
     };
 
     /* If there are no entries, we have a bug since the button should 
@@ -426,7 +432,9 @@ static void edit_cb(GtkWidget * button, gpointer data)
                            RIG_LIST_COL_LO, &conf.lo,
                            RIG_LIST_COL_LOUP, &conf.loup,
                            RIG_LIST_COL_SIGAOS, &conf.signal_aos,
-                           RIG_LIST_COL_SIGLOS, &conf.signal_los, -1);
+                           RIG_LIST_COL_SIGLOS, &conf.signal_los,
+                           RIG_LIST_COL_CYCLE, &conf.cycle,
+                           RIG_LIST_COL_TOLERANCE, &conf.tolerance, -1);
     }
     else
     {
@@ -462,7 +470,9 @@ static void edit_cb(GtkWidget * button, gpointer data)
                            RIG_LIST_COL_LO, conf.lo,
                            RIG_LIST_COL_LOUP, conf.loup,
                            RIG_LIST_COL_SIGAOS, conf.signal_aos,
-                           RIG_LIST_COL_SIGLOS, conf.signal_los, -1);
+                           RIG_LIST_COL_SIGLOS, conf.signal_los,
+                           RIG_LIST_COL_CYCLE, conf.cycle,
+                           RIG_LIST_COL_TOLERANCE, conf.tolerance, -1);
     }
 
     /* clean up memory */
@@ -690,6 +700,8 @@ static void add_cb(GtkWidget * button, gpointer data)
         .loup = 0.0,
         .signal_aos = FALSE,
         .signal_los = FALSE,
+        .cycle = DEFAULT_CYCLE_MS,
+        .tolerance = 0.0,
     };
 
     /* run rig conf editor */
@@ -712,7 +724,9 @@ static void add_cb(GtkWidget * button, gpointer data)
                            RIG_LIST_COL_LO, conf.lo,
                            RIG_LIST_COL_LOUP, conf.loup,
                            RIG_LIST_COL_SIGAOS, conf.signal_aos,
-                           RIG_LIST_COL_SIGLOS, conf.signal_los, -1);
+                           RIG_LIST_COL_SIGLOS, conf.signal_los,
+                           RIG_LIST_COL_CYCLE, conf.cycle,
+                           RIG_LIST_COL_TOLERANCE, conf.tolerance, -1);
 
         g_free(conf.name);
 
@@ -813,7 +827,9 @@ void sat_pref_rig_ok()
         .lo = 0.0,
         .loup = 0.0,
         .signal_aos = FALSE,
-        .signal_los = FALSE
+        .signal_los = FALSE,
+        .cycle = DEFAULT_CYCLE_MS,
+        .tolerance = 0.0
     };
 
     /* delete all .rig files */
@@ -859,7 +875,10 @@ void sat_pref_rig_ok()
                                RIG_LIST_COL_LO, &conf.lo,
                                RIG_LIST_COL_LOUP, &conf.loup,
                                RIG_LIST_COL_SIGAOS, &conf.signal_aos,
-                               RIG_LIST_COL_SIGLOS, &conf.signal_los, -1);
+                               RIG_LIST_COL_SIGLOS, &conf.signal_los,
+                               RIG_LIST_COL_CYCLE, &conf.cycle,
+                               RIG_LIST_COL_TOLERANCE, &conf.tolerance,
+                               -1);
             radio_conf_save(&conf);
 
             /* free conf buffer */
@@ -40,6 +40,9 @@ typedef enum {
     ROT_LIST_COL_AZSTOPPOS,     /*!< Position of the azimuth rotation stops.
                                    Should default to MINAZ, unless specified
                                    otherwise */
+    ROT_LIST_COL_AZRATE,        /*!< Azimuth slew rate. */
+    ROT_LIST_COL_ELRATE,        /*!< Elevation slew rate. */
+    ROT_LIST_COL_LEAD,          /*!< Setpoint lead time. */
     ROT_LIST_COL_NUM            /*!< The number of fields in the list. */
 } rotor_list_col_t;
 
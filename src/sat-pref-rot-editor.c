@@ -43,6 +43,9 @@ static GtkWidget *maxaz;
 static GtkWidget *minel;
 static GtkWidget *maxel;
 static GtkWidget *azstoppos;
+static GtkWidget *azrate;
+static GtkWidget *elrate;
+static GtkWidget *lead;
 
 /* Update widgets from the currently selected row in the treeview */
 static void update_widgets(rotor_conf_t * conf)
@@ -68,6 +71,11 @@ static void update_widgets(rotor_conf_t * conf)
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(minel), conf->minel);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(maxel), conf->maxel);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(azstoppos), conf->azstoppos);
+
+    /* slew rates and lead time */
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azrate), conf->azrate);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elrate), conf->elrate);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(lead), conf->lead);
 }
 
 /* called when the user clicks on the CLEAR button */
@@ -82,6 +90,9 @@ static void clear_widgets()
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(minel), 0);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(maxel), 90);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(azstoppos), 0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azrate), DEFAULT_AZRATE);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elrate), DEFAULT_ELRATE);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(lead), DEFAULT_LEAD_SEC);
 }
 
 /*
@@ -292,6 +303,46 @@ static GtkWidget *create_editor_widgets(rotor_conf_t * conf)
                                   "\342\206\222 +180\302\260 rotor is -180\302\260."));
     gtk_grid_attach(GTK_GRID(table), azstoppos, 3, 7, 1, 1);
 
+    gtk_grid_attach(GTK_GRID(table),
+                    gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
+                    0, 8, 4, 1);
+
+    /* Slew rates and lead time */
+    label = gtk_label_new(_(" Az rate"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 9, 1, 1);
+    azrate = gtk_spin_button_new_with_range(0.1, 90, 0.1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azrate), DEFAULT_AZRATE);
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(azrate), 1);
+    gtk_widget_set_tooltip_text(azrate,
+                                _("Azimuth slew rate of the rotator in "
+                                  "\302\260/sec. It is used to plan the "
+                                  "pointing schedule of a pass."));
+    gtk_grid_attach(GTK_GRID(table), azrate, 1, 9, 1, 1);
+
+    label = gtk_label_new(_(" El rate"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 9, 1, 1);
+    elrate = gtk_spin_button_new_with_range(0.1, 90, 0.1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elrate), DEFAULT_ELRATE);
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(elrate), 1);
+    gtk_widget_set_tooltip_text(elrate,
+                                _("Elevation slew rate of the rotator in "
+                                  "\302\260/sec. It is used to plan the "
+                                  "pointing schedule of a pass."));
+    gtk_grid_attach(GTK_GRID(table), elrate, 3, 9, 1, 1);
+
+    label = gtk_label_new(_(" Lead time"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 10, 1, 1);
+    lead = gtk_spin_button_new_with_range(0.0, 30.0, 0.5);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(lead), DEFAULT_LEAD_SEC);
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(lead), 1);
+    gtk_widget_set_tooltip_text(lead,
+                                _("Time in seconds to send each setpoint "
+                                  "ahead of the satellite."));
+    gtk_grid_attach(GTK_GRID(table), lead, 1, 10, 1, 1);
+
     if (conf->name != NULL)
         update_widgets(conf);
 
@@ -330,6 +381,11 @@ static gboolean apply_changes(rotor_conf_t * conf)
     /* az stop position */
     conf->azstoppos = gtk_spin_button_get_value(GTK_SPIN_BUTTON(azstoppos));
 
+    /* slew rates and lead time */
+    conf->azrate = gtk_spin_button_get_value(GTK_SPIN_BUTTON(azrate));
+    conf->elrate = gtk_spin_button_get_value(GTK_SPIN_BUTTON(elrate));
+    conf->lead = gtk_spin_button_get_value(GTK_SPIN_BUTTON(lead));
+
     return TRUE;
 }
 
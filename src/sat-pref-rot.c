@@ -58,6 +58,9 @@ static void add_cb(GtkWidget * button, gpointer data)
         .maxel = 90,
         .aztype = ROT_AZ_TYPE_360,
         .azstoppos = 0,
+        .azrate = DEFAULT_AZRATE,
+        .elrate = DEFAULT_ELRATE,
+        .lead = DEFAULT_LEAD_SEC,
     };
 
     /* run rot conf editor */
@@ -78,7 +81,10 @@ static void add_cb(GtkWidget * button, gpointer data)
                            ROT_LIST_COL_MINEL, conf.minel,
                            ROT_LIST_COL_MAXEL, conf.maxel,
                            ROT_LIST_COL_AZTYPE, conf.aztype,
-                           ROT_LIST_COL_AZSTOPPOS, conf.azstoppos, -1);
+                           ROT_LIST_COL_AZSTOPPOS, conf.azstoppos,
+                           ROT_LIST_COL_AZRATE, conf.azrate,
+                           ROT_LIST_COL_ELRATE, conf.elrate,
+                           ROT_LIST_COL_LEAD, conf.lead, -1);
 
         g_free(conf.name);
 
@@ -107,6 +113,9 @@ static void edit_cb(GtkWidget * button, gpointer data)
         .maxel = 90,
         .aztype = ROT_AZ_TYPE_360,
         .azstoppos = 0,         //used in the "new rotator" dialog
+        .azrate = DEFAULT_AZRATE,
+        .elrate = DEFAULT_ELRATE,
+        .lead = DEFAULT_LEAD_SEC,
     };
 
     /* If there are no entries, we have a bug since the button should 
@@ -137,7 +146,10 @@ static void edit_cb(GtkWidget * button, gpointer data)
                            ROT_LIST_COL_MINEL, &conf.minel,
                            ROT_LIST_COL_MAXEL, &conf.maxel,
                            ROT_LIST_COL_AZTYPE, &conf.aztype,
-                           ROT_LIST_COL_AZSTOPPOS, &conf.azstoppos, -1);
+                           ROT_LIST_COL_AZSTOPPOS, &conf.azstoppos,
+                           ROT_LIST_COL_AZRATE, &conf.azrate,
+                           ROT_LIST_COL_ELRATE, &conf.elrate,
+                           ROT_LIST_COL_LEAD, &conf.lead, -1);
     }
     else
     {
@@ -172,7 +184,10 @@ static void edit_cb(GtkWidget * button, gpointer data)
                            ROT_LIST_COL_MINEL, conf.minel,
                            ROT_LIST_COL_MAXEL, conf.maxel,
                            ROT_LIST_COL_AZTYPE, conf.aztype,
-                           ROT_LIST_COL_AZSTOPPOS, conf.azstoppos, -1);
+                           ROT_LIST_COL_AZSTOPPOS, conf.azstoppos,
+                           ROT_LIST_COL_AZRATE, conf.azrate,
+                           ROT_LIST_COL_ELRATE, conf.elrate,
+                           ROT_LIST_COL_LEAD, conf.lead, -1);
     }
 
     /* clean up memory */
@@ -258,7 +273,10 @@ static GtkTreeModel *create_and_fill_model()
                                    G_TYPE_DOUBLE,       // Min El
                                    G_TYPE_DOUBLE,       // Max El
                                    G_TYPE_INT,  // Az type
-                                   G_TYPE_DOUBLE        // Az Stop Position
+                                   G_TYPE_DOUBLE,       // Az Stop Position
+                                   G_TYPE_DOUBLE,       // Az slew rate
+                                   G_TYPE_DOUBLE,       // El slew rate
+                                   G_TYPE_DOUBLE        // Lead time
         );
     gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(liststore),
                                          ROT_LIST_COL_NAME,
@@ -291,7 +309,9 @@ static GtkTreeModel *create_and_fill_model()
                                        ROT_LIST_COL_MAXEL, conf.maxel,
                                        ROT_LIST_COL_AZTYPE, conf.aztype,
                                        ROT_LIST_COL_AZSTOPPOS, conf.azstoppos,
-                                       -1);
+                                       ROT_LIST_COL_AZRATE, conf.azrate,
+                                       ROT_LIST_COL_ELRATE, conf.elrate,
+                                       ROT_LIST_COL_LEAD, conf.lead, -1);
 
                     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                                 _("%s:%d: Read %s"),
@@ -575,6 +595,9 @@ void sat_pref_rot_ok()
         .maxel = 90,
         .aztype = ROT_AZ_TYPE_360,
         .azstoppos = 0,
+        .azrate = DEFAULT_AZRATE,
+        .elrate = DEFAULT_ELRATE,
+        .lead = DEFAULT_LEAD_SEC,
     };
 
 
@@ -621,7 +644,10 @@ void sat_pref_rot_ok()
                                ROT_LIST_COL_MINEL, &conf.minel,
                                ROT_LIST_COL_MAXEL, &conf.maxel,
                                ROT_LIST_COL_AZTYPE, &conf.aztype,
-                               ROT_LIST_COL_AZSTOPPOS, &conf.azstoppos, -1);
+                               ROT_LIST_COL_AZSTOPPOS, &conf.azstoppos,
+                               ROT_LIST_COL_AZRATE, &conf.azrate,
+                               ROT_LIST_COL_ELRATE, &conf.elrate,
+                               ROT_LIST_COL_LEAD, &conf.lead, -1);
             rotor_conf_save(&conf);
 
             /* free conf buffer */
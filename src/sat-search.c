@@ -0,0 +1,234 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Satellite search index.
+ *
+ * The satellite selector matches the search text as a case insensitive
+ * substring of the satellite name, nickname or catalog number. Instead of
+ * scanning every row on each keystroke, all 1, 2 and 3 character substrings
+ * (n-grams) of the searchable fields are indexed together with the list of
+ * satellites containing them:
+ *
+ *  - Queries of up to three characters are answered directly from the
+ *    posting list of the query itself.
+ *  - For longer queries the shortest posting list among the trigrams of the
+ *    query gives a small set of candidates, which are then verified.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <string.h>
+
+#include "sat-search.h"
+
+
+/** Maximum n-gram length stored in the index. */
+#define MAX_GRAM 3
+
+struct _sat_search {
+    GArray         *catnums;    /*!< Catalog number of each document (gint). */
+    GPtrArray      *texts;      /*!< Folded searchable text of each document. */
+    GHashTable     *postings;   /*!< n-gram key -> GArray of document IDs. */
+};
+
+
+/** Pack an n-gram of up to MAX_GRAM bytes into a hash table key. */
+static gpointer gram_key(const gchar * s, guint n)
+{
+    guint32         key = n << 24;
+    guint           i;
+
+    for (i = 0; i < n; i++)
+        key |= ((guint32) (guchar) s[i]) << (16 - 8 * i);
+
+    return GUINT_TO_POINTER(key);
+}
+
+static void postings_free(gpointer data)
+{
+    g_array_free((GArray *) data, TRUE);
+}
+
+/**
+ * Create a new, empty search index.
+ *
+ * @return The new index. Free it with sat_search_free().
+ */
+sat_search_t   *sat_search_new(void)
+{
+    sat_search_t   *search = g_new0(sat_search_t, 1);
+
+    search->catnums = g_array_new(FALSE, FALSE, sizeof(gint));
+    search->texts = g_ptr_array_new_with_free_func(g_free);
+    search->postings = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                             NULL, postings_free);
+
+    return search;
+}
+
+void sat_search_free(sat_search_t * search)
+{
+    if (search == NULL)
+        return;
+
+    g_array_free(search->catnums, TRUE);
+    g_ptr_array_free(search->texts, TRUE);
+    g_hash_table_destroy(search->postings);
+    g_free(search);
+}
+
+/** Add all n-grams of a single field to the posting lists of document id. */
+static void index_field(sat_search_t * search, const gchar * field, guint id)
+{
+    GArray         *list;
+    gpointer        key;
+    gsize           len = strlen(field);
+    gsize           i;
+    guint           n;
+
+    for (i = 0; i < len; i++)
+    {
+        for (n = 1; n <= MAX_GRAM && i + n <= len; n++)
+        {
+            key = gram_key(field + i, n);
+            list = g_hash_table_lookup(search->postings, key);
+            if (list == NULL)
+            {
+                list = g_array_new(FALSE, FALSE, sizeof(guint));
+                g_hash_table_insert(search->postings, key, list);
+            }
+
+            /* documents are added in order, so duplicates are adjacent */
+            if (list->len == 0 ||
+                g_array_index(list, guint, list->len - 1) != id)
+                g_array_append_val(list, id);
+        }
+    }
+}
+
+/**
+ * Add a satellite to the search index.
+ *
+ * @param search The search index.
+ * @param catnum The catalog number of the satellite.
+ * @param name The satellite name.
+ * @param nickname The satellite nickname (may be NULL).
+ */
+void sat_search_add(sat_search_t * search, gint catnum,
+                    const gchar * name, const gchar * nickname)
+{
+    gchar          *fields[3];
+    guint           id = search->catnums->len;
+    guint           i;
+
+    fields[0] = g_ascii_strdown(name ? name : "", -1);
+    fields[1] = g_ascii_strdown(nickname ? nickname : "", -1);
+    fields[2] = g_strdup_printf("%d", catnum);
+
+    for (i = 0; i < 3; i++)
+        index_field(search, fields[i], id);
+
+    g_array_append_val(search->catnums, catnum);
+
+    /* newline separated so that verification never matches across fields */
+    g_ptr_array_add(search->texts, g_strjoin("\n", fields[0], fields[1],
+                                             fields[2], NULL));
+
+    for (i = 0; i < 3; i++)
+        g_free(fields[i]);
+}
+
+/**
+ * Find the satellites matching a search string.
+ *
+ * @param search The search index.
+ * @param query The search string.
+ * @param matches Hash set that will contain the catalog numbers of the
+ *                matching satellites. Existing contents are removed.
+ *
+ * A satellite matches if the query is a case insensitive substring of its
+ * name, nickname or catalog number. An empty query matches all satellites.
+ */
+void sat_search_find(sat_search_t * search, const gchar * query,
+                     GHashTable * matches)
+{
+    GArray         *list;
+    GArray         *best = NULL;
+    gchar          *folded;
+    const gchar    *text;
+    gsize           len;
+    gsize           i;
+    guint           id;
+
+    g_hash_table_remove_all(matches);
+
+    folded = g_ascii_strdown(query, -1);
+    len = strlen(folded);
+
+    if (len == 0)
+    {
+        for (i = 0; i < search->catnums->len; i++)
+            g_hash_table_add(matches, GINT_TO_POINTER(g_array_index
+                                                      (search->catnums, gint,
+                                                       i)));
+    }
+    else if (len <= MAX_GRAM)
+    {
+        /* the posting list is the exact answer */
+        best = g_hash_table_lookup(search->postings, gram_key(folded, len));
+        for (i = 0; best != NULL && i < best->len; i++)
+        {
+            id = g_array_index(best, guint, i);
+            g_hash_table_add(matches, GINT_TO_POINTER(g_array_index
+                                                      (search->catnums, gint,
+                                                       id)));
+        }
+    }
+    else
+    {
+        /* pick the most selective trigram; a missing one means no match */
+        for (i = 0; i + MAX_GRAM <= len; i++)
+        {
+            list = g_hash_table_lookup(search->postings,
+                                       gram_key(folded + i, MAX_GRAM));
+            if (list == NULL)
+            {
+                best = NULL;
+                break;
+            }
+            if (best == NULL || list->len < best->len)
+                best = list;
+        }
+
+        for (i = 0; best != NULL && i < best->len; i++)
+        {
+            id = g_array_index(best, guint, i);
+            text = g_ptr_array_index(search->texts, id);
+            if (strstr(text, folded) != NULL)
+                g_hash_table_add(matches, GINT_TO_POINTER(g_array_index
+                                                          (search->catnums,
+                                                           gint, id)));
+        }
+    }
+
+    g_free(folded);
+}
@@ -0,0 +1,36 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_SEARCH_H
+#define SAT_SEARCH_H 1
+
+#include <glib.h>
+
+
+/** Opaque satellite search index. */
+typedef struct _sat_search sat_search_t;
+
+
+sat_search_t   *sat_search_new(void);
+void            sat_search_free(sat_search_t * search);
+void            sat_search_add(sat_search_t * search, gint catnum,
+                               const gchar * name, const gchar * nickname);
+void            sat_search_find(sat_search_t * search, const gchar * query,
+                                GHashTable * matches);
+
+#endif
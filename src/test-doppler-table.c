@@ -0,0 +1,216 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Tests of the Doppler table.
+ *
+ * The tables are made from functions with a known value and derivative at
+ * any time, and the interpolation is checked against them.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <math.h>
+
+#include "doppler-table.h"
+
+
+#define START 2458000.5
+
+/** Time between samples [sec]. */
+#define STEP 1.0
+
+/** Number of samples of the test tables. */
+#define NSAMPLES 601
+
+/** Time of closest approach of the test pass [sec after START]. */
+#define TCA 300.0
+
+/** Distance at closest approach divided by the speed [sec]. */
+#define TMIN 60.0
+
+/** Largest range rate of the test pass [km/s]. */
+#define RRMAX 7.0
+
+/*
+ * Rounding of the Julian date shifts the time of a sample by up to 20 usec,
+ * and the range rate changes by up to 0.12 km/s per second at TCA.
+ */
+#define EPS_SAMPLE 1e-5
+
+
+typedef gdouble (*func_t) (gdouble t);
+
+/** Range rate of a pass on a straight line at constant speed. */
+static gdouble pass_rr(gdouble t)
+{
+    t -= TCA;
+
+    return RRMAX * t / sqrt(t * t + TMIN * TMIN);
+}
+
+static gdouble pass_rr_dot(gdouble t)
+{
+    t -= TCA;
+
+    return RRMAX * TMIN * TMIN / pow(t * t + TMIN * TMIN, 1.5);
+}
+
+static gdouble line_rr(gdouble t)
+{
+    return -5.0 + 0.02 * t;
+}
+
+static gdouble parabola_rr(gdouble t)
+{
+    return 1e-4 * (t - TCA) * (t - TCA) - 3.0;
+}
+
+static doppler_table_t *make_table(func_t f)
+{
+    doppler_table_t *tab;
+    gdouble         rr[NSAMPLES];
+    guint           i;
+
+    for (i = 0; i < NSAMPLES; i++)
+        rr[i] = f(i * STEP);
+
+    tab = doppler_table_new("TEST", START, STEP, rr, NSAMPLES);
+    g_assert_nonnull(tab);
+
+    return tab;
+}
+
+static void test_samples(void)
+{
+    doppler_table_t *tab;
+    gdouble         rr, rr_dot;
+    guint           i;
+
+    tab = make_table(pass_rr);
+    g_assert_cmpuint(tab->n, ==, NSAMPLES);
+    g_assert_cmpfloat(fabs((tab->end - tab->start) * secday -
+                           (NSAMPLES - 1) * STEP), <, 1e-3);
+
+    for (i = 0; i < NSAMPLES; i++)
+    {
+        g_assert_true(doppler_table_get(tab, START + i * STEP / secday, &rr,
+                                        &rr_dot));
+        g_assert_cmpfloat(fabs(rr - pass_rr(i * STEP)), <, EPS_SAMPLE);
+    }
+
+    doppler_table_free(tab);
+}
+
+static void test_polynomials(void)
+{
+    doppler_table_t *tab;
+    gdouble         rr, rr_dot, t;
+    guint           i;
+
+    /* the spline is exact for a line everywhere */
+    tab = make_table(line_rr);
+    for (i = 0; i < 10 * (NSAMPLES - 1); i++)
+    {
+        t = i * STEP / 10.0 + 0.03;
+        g_assert_true(doppler_table_get(tab, START + t / secday, &rr,
+                                        &rr_dot));
+        g_assert_cmpfloat(fabs(rr - line_rr(t)), <, EPS_SAMPLE);
+        g_assert_cmpfloat(fabs(rr_dot - 0.02), <, 1e-9);
+    }
+    doppler_table_free(tab);
+
+    /* central differences are exact slopes of a parabola */
+    tab = make_table(parabola_rr);
+    for (i = 10; i < 10 * (NSAMPLES - 2); i++)
+    {
+        t = i * STEP / 10.0 + 0.03;
+        g_assert_true(doppler_table_get(tab, START + t / secday, &rr,
+                                        &rr_dot));
+        g_assert_cmpfloat(fabs(rr - parabola_rr(t)), <, EPS_SAMPLE);
+        g_assert_cmpfloat(fabs(rr_dot - 2e-4 * (t - TCA)), <, 1e-6);
+    }
+    doppler_table_free(tab);
+}
+
+static void test_pass(void)
+{
+    doppler_table_t *tab;
+    gdouble         rr, rr_dot, t;
+    gdouble         err = 0.0, err_dot = 0.0;
+    guint           i;
+
+    tab = make_table(pass_rr);
+    for (i = 0; i < 100 * (NSAMPLES - 1); i++)
+    {
+        t = i * STEP / 100.0;
+        g_assert_true(doppler_table_get(tab, START + t / secday, &rr,
+                                        &rr_dot));
+        err = MAX(err, fabs(rr - pass_rr(t)));
+        err_dot = MAX(err_dot, fabs(rr_dot - pass_rr_dot(t)));
+    }
+    doppler_table_free(tab);
+
+    /* 1e-4 km/s is 0.15 Hz at 435 MHz */
+    g_assert_cmpfloat(err, <, 1e-4);
+    g_assert_cmpfloat(err_dot, <, 1e-3 * pass_rr_dot(TCA));
+}
+
+static void test_bounds(void)
+{
+    doppler_table_t *tab, *copy;
+    gdouble         rr, rr_dot;
+    gdouble         samples[] = { 1.0, 2.0 };
+
+    tab = make_table(pass_rr);
+    g_assert_false(doppler_table_get(tab, START - 0.1 / secday, &rr,
+                                     &rr_dot));
+    g_assert_false(doppler_table_get(tab, tab->end + 0.1 / secday, &rr,
+                                     &rr_dot));
+    g_assert_true(doppler_table_get(tab, tab->end, &rr, &rr_dot));
+    g_assert_cmpfloat(fabs(rr - pass_rr((NSAMPLES - 1) * STEP)), <,
+                      EPS_SAMPLE);
+
+    copy = doppler_table_copy(tab);
+    g_assert_nonnull(copy);
+    g_assert_true(copy->rr != tab->rr);
+    g_assert_cmpfloat(copy->end, ==, tab->end);
+    g_assert_cmpfloat(copy->rr[NSAMPLES / 2], ==, tab->rr[NSAMPLES / 2]);
+    doppler_table_free(copy);
+    doppler_table_free(tab);
+
+    g_assert_null(doppler_table_new("TEST", START, STEP, samples, 1));
+    g_assert_null(doppler_table_new("TEST", START, 0.0, samples, 2));
+    g_assert_null(doppler_table_copy(NULL));
+    doppler_table_free(NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/doppler-table/samples", test_samples);
+    g_test_add_func("/doppler-table/polynomials", test_polynomials);
+    g_test_add_func("/doppler-table/pass", test_pass);
+    g_test_add_func("/doppler-table/bounds", test_bounds);
+
+    return g_test_run();
+}
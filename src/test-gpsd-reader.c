@@ -0,0 +1,97 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Tests of the gpsd reader.
+ *
+ * The reader is included so that fixes can be published without gpsd. A
+ * thread publishes fixes as fast as it can while the main thread reads
+ * them and checks that no fix is torn between two publications.
+ */
+#define GPSD_READER_TEST 1
+#include "gpsd-reader.c"
+
+#include <string.h>
+
+
+/** Number of fixes published by the writer thread. */
+#define NFIXES 10000000
+
+/** Publish fixes whose fields all follow from the count. */
+static gpointer writer(gpointer data)
+{
+    gpsd_reader_t  *reader = data;
+    guint           i;
+
+    for (i = 1; i <= NFIXES; i++)
+        publish(reader, i * 1e-6, -(gdouble) i, (gint) (i % 10000));
+
+    return NULL;
+}
+
+static void test_no_fix(void)
+{
+    gpsd_reader_t   reader;
+    gpsd_fix_t      fix;
+
+    memset(&reader, 0, sizeof(reader));
+    gpsd_reader_get_fix(&reader, &fix);
+    g_assert_cmpuint(fix.count, ==, 0);
+
+    publish(&reader, 55.7, 12.5, 10);
+    gpsd_reader_get_fix(&reader, &fix);
+    g_assert_cmpuint(fix.count, ==, 1);
+    g_assert_cmpfloat(fix.lat, ==, 55.7);
+    g_assert_cmpfloat(fix.lon, ==, 12.5);
+    g_assert_cmpint(fix.alt, ==, 10);
+    g_assert_cmpint(reader.seq, ==, 2);
+}
+
+static void test_concurrent(void)
+{
+    gpsd_reader_t   reader;
+    gpsd_fix_t      fix;
+    GThread        *thread;
+    guint           last = 0;
+
+    memset(&reader, 0, sizeof(reader));
+    thread = g_thread_new("writer", writer, &reader);
+
+    do
+    {
+        gpsd_reader_get_fix(&reader, &fix);
+        g_assert_cmpuint(fix.count, >=, last);
+        g_assert_cmpfloat(fix.lat, ==, fix.count * 1e-6);
+        g_assert_cmpfloat(fix.lon, ==, -(gdouble) fix.count);
+        g_assert_cmpint(fix.alt, ==, (gint) (fix.count % 10000));
+        last = fix.count;
+    } while (last < NFIXES);
+
+    g_thread_join(thread);
+}
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/gpsd-reader/no-fix", test_no_fix);
+    g_test_add_func("/gpsd-reader/concurrent", test_concurrent);
+
+    return g_test_run();
+}
@@ -0,0 +1,49 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Log for the test programs.
+ *
+ * sat-log.c needs the configuration and a log window, so the tests link
+ * this instead. Errors and warnings are written to stderr, where they show
+ * up in the test logs.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "sat-log.h"
+
+
+void sat_log_log(sat_log_level_t level, const char *fmt, ...)
+{
+    va_list         args;
+
+    if (level > SAT_LOG_LEVEL_WARN)
+        return;
+
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
@@ -0,0 +1,244 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Tests of the rigctld client.
+ *
+ * The client is included so that the reply parser can be tested on its
+ * own. The late reply test runs a small server in a thread.
+ */
+#include "rigctld-client.c"
+
+
+/** Append received data to the buffer of a connection. */
+static void feed(rigctld_t * rig, const gchar * data)
+{
+    gsize           len = strlen(data);
+
+    g_assert_cmpuint(rig->rxlen + len, <=, RXBUF_SIZE);
+    memcpy(rig->rxbuf + rig->rxlen, data, len);
+    rig->rxlen += len;
+}
+
+/** Start parsing the replies of a transaction. */
+static void start(rigctld_t * rig, rigctld_cmd_t * cmds, guint n)
+{
+    rig->cmds = cmds;
+    rig->ncmds = n;
+    rig->next = 0;
+    rig->nread = 0;
+    rig->nvalues = 0;
+    rig->t0 = g_get_monotonic_time();
+}
+
+static void test_default_protocol(void)
+{
+    rigctld_t       rig;
+    rigctld_cmd_t   cmds[4];
+
+    memset(&rig, 0, sizeof(rig));
+    rigctld_cmd_init(&cmds[0], 1, "f");
+    rigctld_cmd_init(&cmds[1], 2, "m");
+    rigctld_cmd_init(&cmds[2], 0, "F 145800000");
+    rigctld_cmd_init(&cmds[3], 1, "f");
+    start(&rig, cmds, 4);
+
+    /* a line split across two reads */
+    feed(&rig, "1458");
+    g_assert_false(parse_replies(&rig));
+    g_assert_cmpuint(rig.next, ==, 0);
+
+    feed(&rig, "00000\nFM\n");
+    g_assert_false(parse_replies(&rig));
+    g_assert_cmpuint(rig.next, ==, 1);
+    g_assert_cmpint(cmds[0].status, ==, 0);
+    g_assert_cmpstr(cmds[0].value, ==, "145800000");
+
+    /* a get that fails replies with RPRT instead of its values */
+    feed(&rig, "15000\nRPRT 0\nRPRT -11\n");
+    g_assert_true(parse_replies(&rig));
+    g_assert_cmpint(cmds[1].status, ==, 0);
+    g_assert_cmpstr(cmds[1].value, ==, "FM");
+    g_assert_cmpint(cmds[2].status, ==, 0);
+    g_assert_cmpint(cmds[3].status, ==, -11);
+    g_assert_cmpstr(cmds[3].value, ==, "");
+    g_assert_cmpuint(rig.rxlen, ==, 0);
+}
+
+static void test_extended_protocol(void)
+{
+    rigctld_t       rig;
+    rigctld_cmd_t   cmds[3];
+
+    memset(&rig, 0, sizeof(rig));
+    rig.extended = TRUE;
+    rigctld_cmd_init(&cmds[0], 1, "f");
+    rigctld_cmd_init(&cmds[1], 2, "m");
+    rigctld_cmd_init(&cmds[2], 0, "F 145800000");
+    start(&rig, cmds, 3);
+
+    feed(&rig, "get_freq:\nFrequency: 145800000\n");
+    g_assert_false(parse_replies(&rig));
+    g_assert_cmpuint(rig.next, ==, 0);
+
+    /* the reply ends with RPRT, not after the expected lines */
+    feed(&rig, "RPRT 0\nget_mode:\nMode: FM\nPassband: 15000\nRP");
+    g_assert_false(parse_replies(&rig));
+    g_assert_cmpuint(rig.next, ==, 1);
+    g_assert_cmpint(cmds[0].status, ==, 0);
+    g_assert_cmpstr(cmds[0].value, ==, "145800000");
+
+    feed(&rig, "RT 0\nset_freq: 145800000\nRPRT -11\n");
+    g_assert_true(parse_replies(&rig));
+    g_assert_cmpint(cmds[1].status, ==, 0);
+    g_assert_cmpstr(cmds[1].value, ==, "FM");
+    g_assert_cmpint(cmds[2].status, ==, -11);
+    g_assert_cmpuint(rig.rxlen, ==, 0);
+}
+
+static void test_long_line(void)
+{
+    rigctld_t       rig;
+    rigctld_cmd_t   cmd;
+
+    /* a full buffer holds no NUL to stop at */
+    memset(&rig, 0, sizeof(rig));
+    memset(rig.rxbuf, '7', RXBUF_SIZE - 1);
+    rig.rxbuf[RXBUF_SIZE - 1] = '\n';
+    rig.rxlen = RXBUF_SIZE;
+    rigctld_cmd_init(&cmd, 1, "f");
+    start(&rig, &cmd, 1);
+
+    g_assert_true(parse_replies(&rig));
+    g_assert_cmpint(cmd.status, ==, 0);
+    g_assert_cmpuint(strlen(cmd.value), ==, sizeof(cmd.value) - 1);
+    g_assert_cmpuint(strspn(cmd.value, "7"), ==, sizeof(cmd.value) - 1);
+    g_assert_cmpuint(rig.rxlen, ==, 0);
+}
+
+#ifndef WIN32
+/** Delay of the reply to the second command [msec]. */
+#define LATE_DELAY 300
+
+/**
+ * Server for the late reply test.
+ *
+ * It serves two connections, one after the other, and replies to every
+ * command with the number of commands received so far. The reply to the
+ * second command is delayed by LATE_DELAY.
+ */
+static gpointer late_server(gpointer data)
+{
+    gint            lsock = GPOINTER_TO_INT(data);
+    gchar           buf[256], reply[64];
+    gchar          *nl;
+    gsize           len;
+    gint            sock, conn, n, count = 0;
+    gboolean        quit;
+
+    for (conn = 0; conn < 2; conn++)
+    {
+        sock = accept(lsock, NULL, NULL);
+        g_assert_cmpint(sock, >=, 0);
+        len = 0;
+        quit = FALSE;
+
+        while (!quit && (n = recv(sock, buf + len, sizeof(buf) - len, 0)) > 0)
+        {
+            len += n;
+            while ((nl = memchr(buf, '\n', len)) != NULL)
+            {
+                quit = (buf[0] == 'q');
+                len -= nl - buf + 1;
+                memmove(buf, nl + 1, len);
+                if (quit)
+                    break;
+
+                if (++count == 2)
+                    g_usleep(LATE_DELAY * 1000);
+
+                n = g_snprintf(reply, sizeof(reply),
+                               "get_freq:\nFrequency: %d\nRPRT 0\n", count);
+                (void)send(sock, reply, n, MSG_NOSIGNAL);
+            }
+        }
+
+        close(sock);
+    }
+
+    return NULL;
+}
+
+static void test_late_reply(void)
+{
+    struct sockaddr_in addr;
+    socklen_t       addrlen = sizeof(addr);
+    rigctld_t      *rig;
+    rigctld_cmd_t   cmd;
+    GThread        *server;
+    gint            lsock;
+
+    lsock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    g_assert_cmpint(lsock, >=, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    g_assert_cmpint(bind(lsock, (struct sockaddr *)&addr, addrlen), ==, 0);
+    g_assert_cmpint(listen(lsock, 2), ==, 0);
+    g_assert_cmpint(getsockname(lsock, (struct sockaddr *)&addr, &addrlen),
+                    ==, 0);
+    server = g_thread_new("late_server", late_server,
+                          GINT_TO_POINTER(lsock));
+
+    /* the probe is the first command */
+    rig = rigctld_open("127.0.0.1", ntohs(addr.sin_port));
+    g_assert_nonnull(rig);
+    g_assert_true(rig->extended);
+
+    /* the reply to the second command arrives after the timeout */
+    rig->timeout = LATE_DELAY / 3;
+    rigctld_cmd_init(&cmd, 1, "f");
+    g_assert_false(rigctld_transact(rig, &cmd, 1));
+    g_assert_cmpint(cmd.status, ==, RIGCTLD_NO_REPLY);
+
+    /* the next transaction must not take the late reply for its own */
+    rig->timeout = RIGCTLD_TIMEOUT;
+    g_assert_true(rigctld_transact(rig, &cmd, 1));
+    g_assert_cmpint(cmd.status, ==, 0);
+    g_assert_cmpstr(cmd.value, ==, "3");
+
+    rigctld_close(rig);
+    g_thread_join(server);
+    close(lsock);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/rigctld/default-protocol", test_default_protocol);
+    g_test_add_func("/rigctld/extended-protocol", test_extended_protocol);
+    g_test_add_func("/rigctld/long-line", test_long_line);
+#ifndef WIN32
+    g_test_add_func("/rigctld/late-reply", test_late_reply);
+#endif
+
+    return g_test_run();
+}
@@ -0,0 +1,272 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Tests of the rotator pointing schedule.
+ *
+ * The schedules are computed from synthetic tracks, so no orbit prediction
+ * is needed.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <math.h>
+#include <string.h>
+
+#include "rotor-schedule.h"
+
+
+/** Duration of the test pass [sec]. */
+#define PASS_SEC 600
+
+/** Time between the track samples [sec]. */
+#define STEP 1.0
+
+#define NSAMPLES ((guint) (PASS_SEC / STEP) + 1)
+
+#define AOS 2458000.5
+
+
+static void init_conf(rotor_conf_t * conf)
+{
+    memset(conf, 0, sizeof(*conf));
+    conf->minaz = 0.0;
+    conf->maxaz = 360.0;
+    conf->minel = 0.0;
+    conf->maxel = 90.0;
+    conf->azstoppos = 0.0;
+    conf->threshold = 5.0;
+    conf->azrate = 5.0;
+    conf->elrate = 2.5;
+}
+
+/**
+ * Make a track that rises in the west, culminates at maxel and sets in
+ * the east, through north.
+ */
+static void make_track(gdouble * az, gdouble * el, gdouble maxel)
+{
+    gdouble         x;
+    guint           i;
+
+    for (i = 0; i < NSAMPLES; i++)
+    {
+        x = (gdouble) i / (NSAMPLES - 1);
+        az[i] = fmod(260.0 + 160.0 * x, 360.0);
+        el[i] = maxel * sin(G_PI * x);
+    }
+}
+
+/**
+ * Check that every track sample is within the threshold of the setpoint
+ * the rotator is at when the sample is due.
+ */
+static void check_coverage(rotor_schedule_t * sched, rotor_conf_t * conf,
+                           const gdouble * az, const gdouble * el)
+{
+    const rotor_setpoint_t *sp;
+    gdouble         rotaz, rotel, t;
+    guint           i, k = 0;
+
+    g_assert_cmpuint(sched->npoints, >, 0);
+    g_assert_cmpfloat(fabs(sched->points[0].t - AOS), <, 1e-9);
+
+    for (i = 0; i < NSAMPLES; i++)
+    {
+        t = AOS + i * STEP / secday;
+        while (k + 1 < sched->npoints &&
+               sched->points[k + 1].t <= t + 1e-9 / secday)
+            k++;
+
+        sp = &sched->points[k];
+        rotor_schedule_map(conf, sched->flipped, az[i], el[i], &rotaz,
+                           &rotel);
+        g_assert_cmpfloat(fabs(rotaz - sp->az), <=, conf->threshold);
+        g_assert_cmpfloat(fabs(rotel - sp->el), <=, conf->threshold);
+    }
+}
+
+/** Check that the setpoints are due in order and started before that. */
+static void check_order(rotor_schedule_t * sched)
+{
+    const rotor_setpoint_t *sp;
+    guint           i;
+
+    for (i = 1; i < sched->npoints; i++)
+    {
+        sp = &sched->points[i];
+        g_assert_cmpfloat(sp->t, >, sp[-1].t);
+        g_assert_cmpfloat(sp->start, >=, sp[-1].start);
+        g_assert_cmpfloat(sp->start, <=, sp->t);
+    }
+}
+
+static void test_coverage(void)
+{
+    rotor_schedule_t *sched;
+    rotor_conf_t    conf;
+    gdouble         az[NSAMPLES], el[NSAMPLES];
+    gdouble         thresholds[] = { 1.0, 5.0, 20.0 };
+    guint           i;
+
+    init_conf(&conf);
+    make_track(az, el, 60.0);
+
+    for (i = 0; i < G_N_ELEMENTS(thresholds); i++)
+    {
+        conf.threshold = thresholds[i];
+        sched = rotor_schedule_new_from_track("TEST", AOS, STEP, az, el,
+                                              NSAMPLES, &conf, FALSE);
+        g_assert_nonnull(sched);
+        check_coverage(sched, &conf, az, el);
+        check_order(sched);
+
+        /* the rotator moves a threshold at a time, not every sample */
+        g_assert_cmpuint(sched->npoints, <, NSAMPLES / 4);
+        rotor_schedule_free(sched);
+    }
+}
+
+static void test_flipped(void)
+{
+    rotor_schedule_t *sched;
+    rotor_conf_t    conf;
+    gdouble         az[NSAMPLES], el[NSAMPLES];
+
+    init_conf(&conf);
+    conf.maxel = 180.0;
+    make_track(az, el, 85.0);
+
+    sched = rotor_schedule_new_from_track("TEST", AOS, STEP, az, el,
+                                          NSAMPLES, &conf, TRUE);
+    g_assert_nonnull(sched);
+    g_assert_true(sched->flipped);
+    check_coverage(sched, &conf, az, el);
+    check_order(sched);
+    g_assert_cmpfloat(sched->points[0].el, >, 90.0);
+    rotor_schedule_free(sched);
+}
+
+static void test_stationary(void)
+{
+    rotor_schedule_t *sched;
+    rotor_conf_t    conf;
+    gdouble         az[NSAMPLES], el[NSAMPLES];
+    guint           i;
+
+    init_conf(&conf);
+    for (i = 0; i < NSAMPLES; i++)
+    {
+        az[i] = 180.0 + 0.5 * conf.threshold * sin(i * 0.1);
+        el[i] = 45.0;
+    }
+
+    sched = rotor_schedule_new_from_track("TEST", AOS, STEP, az, el,
+                                          NSAMPLES, &conf, FALSE);
+    g_assert_nonnull(sched);
+    g_assert_cmpuint(sched->npoints, ==, 1);
+    check_coverage(sched, &conf, az, el);
+    rotor_schedule_free(sched);
+
+    /* a track needs at least two samples */
+    g_assert_null(rotor_schedule_new_from_track("TEST", AOS, STEP, az, el, 1,
+                                                &conf, FALSE));
+}
+
+static void test_late(void)
+{
+    rotor_schedule_t *sched;
+    rotor_conf_t    conf;
+    gdouble         az[NSAMPLES], el[NSAMPLES];
+
+    init_conf(&conf);
+    make_track(az, el, 60.0);
+
+    /* the track crosses north, where the rotator turns around */
+    sched = rotor_schedule_new_from_track("TEST", AOS, STEP, az, el,
+                                          NSAMPLES, &conf, FALSE);
+    g_assert_cmpuint(sched->late, >, 0);
+    rotor_schedule_free(sched);
+
+    conf.azstoppos = 180.0;
+    conf.minaz = 180.0;
+    conf.maxaz = 540.0;
+    sched = rotor_schedule_new_from_track("TEST", AOS, STEP, az, el,
+                                          NSAMPLES, &conf, FALSE);
+    g_assert_cmpuint(sched->late, ==, 0);
+    check_coverage(sched, &conf, az, el);
+    rotor_schedule_free(sched);
+}
+
+/** The setpoint due at t: the last one started by t + lead. */
+static const rotor_setpoint_t *due(rotor_schedule_t * sched, gdouble t,
+                                   gdouble lead)
+{
+    guint           i = 0;
+
+    while (i + 1 < sched->npoints &&
+           sched->points[i + 1].start <= t + lead / secday)
+        i++;
+
+    return &sched->points[i];
+}
+
+static void test_get(void)
+{
+    rotor_schedule_t *sched;
+    rotor_conf_t    conf;
+    gdouble         az[NSAMPLES], el[NSAMPLES];
+    gdouble         t;
+    gint            i;
+
+    init_conf(&conf);
+    make_track(az, el, 60.0);
+    sched = rotor_schedule_new_from_track("TEST", AOS, STEP, az, el,
+                                          NSAMPLES, &conf, FALSE);
+
+    for (i = -10; i <= PASS_SEC + 10; i++)
+    {
+        t = AOS + (i + 0.5) / secday;
+        g_assert_true(rotor_schedule_get(sched, t, 2.0) == due(sched, t, 2.0));
+    }
+
+    /* the time may also go backwards */
+    for (i = PASS_SEC; i >= -10; i -= 7)
+    {
+        t = AOS + (i + 0.5) / secday;
+        g_assert_true(rotor_schedule_get(sched, t, 0.0) == due(sched, t, 0.0));
+    }
+
+    rotor_schedule_free(sched);
+}
+
+int main(int argc, char *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/rotor-schedule/coverage", test_coverage);
+    g_test_add_func("/rotor-schedule/flipped", test_flipped);
+    g_test_add_func("/rotor-schedule/stationary", test_stationary);
+    g_test_add_func("/rotor-schedule/late", test_late);
+    g_test_add_func("/rotor-schedule/get", test_get);
+
+    return g_test_run();
+}
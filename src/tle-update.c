@@ -61,7 +61,8 @@ static void     update_tle_in_file(const gchar * ldname,
                                    GHashTable * data,
                                    guint * sat_upd,
                                    guint * sat_ski,
-                                   guint * sat_nod, guint * sat_tot);
+                                   guint * sat_nod, guint * sat_tot,
+                                   GArray * changes);
 
 static guint    add_new_sats(GHashTable * data);
 static gboolean is_computer_generated_name(gchar * satname);
@@ -93,12 +94,17 @@ static void free_new_tle(gpointer data)
  * @param progress Pointer to progress indicator.
  * @param init_prgs Initial value of progress indicator, e.g 0.5 if we are updating
  *                  from network.
+ * @param changes GArray of tle_change_t where the satellites that have been
+ *                updated are appended (can be NULL).
  *
- * This function is used to update the TLE data from local files.
+ * This function is used to update the TLE data from local files. The change
+ * set in changes can be passed to mod_mgr_apply_tle_changes() so that the
+ * running modules only reload the satellites that have actually changed.
  */
 void tle_update_from_files(const gchar * dir, const gchar * filter,
                            gboolean silent, GtkWidget * progress,
-                           GtkWidget * label1, GtkWidget * label2)
+                           GtkWidget * label1, GtkWidget * label2,
+                           GArray * changes)
 {
     static GMutex   tle_file_in_progress;
 
@@ -277,7 +283,8 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
                     /* update TLE data in this file */
                     update_tle_in_file(ldname, fnam, data,
                                        &updated_tmp,
-                                       &skipped_tmp, &nodata_tmp, &total_tmp);
+                                       &skipped_tmp, &nodata_tmp, &total_tmp,
+                                       changes);
 
                     /* update statistics */
                     updated += updated_tmp;
@@ -466,10 +473,13 @@ static guint add_new_sats(GHashTable * data)
  * @param progress Pointer to a GtkProgressBar progress indicator (can be NULL)
  * @param label1 GtkLabel for activity string.
  * @param label2 GtkLabel for statistics string.
+ * @param changes GArray of tle_change_t receiving the updated satellites
+ *                (can be NULL), see tle_update_from_files().
  */
 void tle_update_from_network(gboolean silent,
                              GtkWidget * progress,
-                             GtkWidget * label1, GtkWidget * label2)
+                             GtkWidget * label1, GtkWidget * label2,
+                             GArray * changes)
 {
     static GMutex   tle_in_progress;
 
@@ -653,7 +663,7 @@ void tle_update_from_network(gboolean silent,
             /* call update_from_files */
             cache = sat_file_name("cache");
             tle_update_from_files(cache, NULL, silent, progress, label1,
-                                  label2);
+                                  label2, changes);
             g_free(cache);
         }
         else
@@ -1140,7 +1150,8 @@ static void update_tle_in_file(const gchar * ldname,
                                GHashTable * data,
                                guint * sat_upd,
                                guint * sat_ski,
-                               guint * sat_nod, guint * sat_tot)
+                               guint * sat_nod, guint * sat_tot,
+                               GArray * changes)
 {
     gchar          *path;
     guint           updated = 0;        /* number of updated sats */
@@ -1157,6 +1168,7 @@ static void update_tle_in_file(const gchar * ldname,
     GKeyFile       *satdata;
     gchar          *tlestr1, *tlestr2, *rawtle, *satname, *satnickname;
     gboolean        updateddata;
+    tle_change_t    change;
 
     /* get catalog number for this satellite */
     catstr = g_strsplit(fname, ".sat", 0);
@@ -1258,6 +1270,9 @@ static void update_tle_in_file(const gchar * ldname,
 
             /* Initialize flag for update */
             updateddata = FALSE;
+            change.catnum = catnr;
+            change.old_epoch = tle.epoch;
+            change.new_epoch = tle.epoch;
 
             if (ntle->satname != NULL)
             {
@@ -1308,6 +1323,7 @@ static void update_tle_in_file(const gchar * ldname,
                                       ntle->line2);
                 g_key_file_set_integer(satdata, "Satellite", "STATUS",
                                        ntle->status);
+                change.new_epoch = ntle->epoch;
                 updateddata = TRUE;
 
             }
@@ -1329,9 +1345,17 @@ static void update_tle_in_file(const gchar * ldname,
             if (updateddata == TRUE)
             {
                 if (gpredict_save_key_file(satdata, path))
+                {
                     skipped++;
+                }
                 else
+                {
                     updated++;
+
+                    /* record the change so that modules can reload this sat */
+                    if (changes != NULL)
+                        g_array_append_val(changes, change);
+                }
             }
             else
             {
@@ -66,6 +66,14 @@ typedef struct {
 } new_tle_t;
 
 
+/** Data structure describing a satellite whose local data has been updated. */
+typedef struct {
+    guint           catnum;     /*!< Catalog number. */
+    gdouble         old_epoch;  /*!< Epoch of the data that has been replaced. */
+    gdouble         new_epoch;  /*!< Epoch of the data now stored on disk. */
+} tle_change_t;
+
+
 /** Data structure to hold local TLE data. */
 typedef struct {
     tle_t           tle;        /*!< TLE data. */
@@ -77,12 +85,14 @@ void            tle_update_from_files(const gchar * dir,
                                       const gchar * filter,
                                       gboolean silent,
                                       GtkWidget * progress,
-                                      GtkWidget * label1, GtkWidget * label2);
+                                      GtkWidget * label1, GtkWidget * label2,
+                                      GArray * changes);
 
 void            tle_update_from_network(gboolean silent,
                                         GtkWidget * progress,
                                         GtkWidget * label1,
-                                        GtkWidget * label2);
+                                        GtkWidget * label2,
+                                        GArray * changes);
 
 const gchar    *tle_update_freq_to_str(tle_auto_upd_freq_t freq);
 